@@ -23,14 +23,15 @@ formulaeGlobal = {
     # Texture caching
     #
     # At glBindTexture time we can optionally write out the texture data
-    # as a .png file, for debugging.
+    # as a .png file, for debugging.  Once per version of each texture,
+    # encoded and written on the worker threads.
 
     'glBindTexture' : {
         'entries' : [ 'glBindTexture' ],
         'pre' : [
           'if (REGAL_CACHE && REGAL_CACHE_TEXTURE)',
           '{',
-          '  Cache::bindTexture(_next->call(&_next->glBindTexture),_next->call(&_next->glGetTexLevelParameteriv),_next->call(&_next->glGetTexImage), target, texture);',
+          '  Cache::bindTexture(*_context, *_next, target, texture);',
           '  return;',
           '}'
         ]
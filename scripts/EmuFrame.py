@@ -51,6 +51,8 @@ RegalContext *_context = REGAL_GET_CONTEXT();
 // Notify Regal::Frame about the swap buffers event.
 if (_context && _context->frame)
     _context->frame->wglSwapBuffers(*_context);
+// Time the swap as part of the next frame.
+Frame::Scope _frameScope(_context);
 #endif'''
     },
 
@@ -72,6 +74,8 @@ if (_context)
 // Notify Regal::Frame about the swap buffers event.
 if (_context && _context->frame)
     _context->frame->glXSwapBuffers(*_context);
+// Time the swap as part of the next frame.
+Frame::Scope _frameScope(_context);
 #endif'''
     },
 
@@ -101,6 +105,8 @@ RegalContext *_context = REGAL_GET_CONTEXT();
 // Notify Regal::Frame about the swap buffers event.
 if (_context && _context->frame)
     _context->frame->eglSwapBuffers(*_context);
+// Time the swap as part of the next frame.
+Frame::Scope _frameScope(_context);
 #endif'''
     },
 
@@ -114,6 +120,8 @@ RegalContext *_context = REGAL_GET_CONTEXT();
 // Notify Regal::Frame about the flush drawable event.
 if (_context && _context->frame)
     _context->frame->CGLFlushDrawable(*_context);
+// Time the swap as part of the next frame.
+Frame::Scope _frameScope(_context);
 #endif'''
     }
 }
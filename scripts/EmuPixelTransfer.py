@@ -9,6 +9,10 @@ xferFormulae = {
         'entries' : [ 'glActiveTexture(ARB|)' ],
         'prefix' : [ '_context->xfer->ShadowActiveTexture( ${arg0} );', ],
     },
+   'BindTexture' : {
+        'entries' : [ 'glBindTexture' ],
+        'prefix' : [ '_context->xfer->ShadowBindTexture( ${arg0plus} );', ],
+    },
     'TexImage2D' : {
         'entries' : [ 'gl(Compressed|)Tex(Sub|)Image2D(ARB|EXT|)' ],
         'impl' : [ '_context->xfer->${m1}Tex${m2}Image2D( _context, ${arg0plus} );', ],
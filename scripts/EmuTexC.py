@@ -54,7 +54,8 @@ texCFormulae = {
 
     'ShadowDeleteTexture' : {
         'entries' : [ 'glDeleteTextures(EXT|)' ],
-        'prefix' : '_context->texc->ShadowDeleteTextures( ${arg0plus} );',
+        'prefix' : [ '_context->texc->FlushUploads( *_context );',
+                     '_context->texc->ShadowDeleteTextures( ${arg0plus} );' ],
     },
 
     'ShadowGenTextures' : {
@@ -67,7 +68,8 @@ _context->texc->ShadowGenTextures( ${arg0}, ${arg1} );'''
 
     'ShadowGenerateMipmap' : {
         'entries' : [ 'glGenerateMipmap(EXT|)' ],
-        'prefix' : '_context->texc->ShadowGenerateMipmap( ${arg0plus} );',
+        'prefix' : [ '_context->texc->FlushUploads( *_context );',
+                     '_context->texc->ShadowGenerateMipmap( ${arg0plus} );' ],
     },
 
     'ShadowPixelStorei' : {
@@ -77,13 +79,17 @@ _context->texc->ShadowGenTextures( ${arg0}, ${arg1} );'''
 
     'ShadowTexImage2D' : {
         'entries' : [ 'glTexImage2D' ],
-        'prefix' : '_context->texc->ShadowTexImage2D( ${arg0}, ${arg1}, ${arg6}, ${arg7} );',
+        'prefix' : [ '_context->texc->FlushUploads( *_context, ${arg0}, ${arg1} );',
+                     '_context->texc->ShadowTexImage2D( ${arg0}, ${arg1}, ${arg6}, ${arg7} );' ],
     },
 
     'ConvertTexSubImage2D' : {
         'entries' : [ 'glTexSubImage2D' ],
         'impl' :
 '''
+if ( _context->texc->QueueTexSubImage2D( *_context, ${arg0plus} ) )
+  return;
+_context->texc->FlushUploads( *_context, ${arg0}, ${arg1} );
 GLenum targetFormat;
 GLenum targetType;
 _context->texc->GetFormatAndType( ${arg0}, ${arg1}, &targetFormat, &targetType );
@@ -101,4 +107,17 @@ else
   _context->dispatcher.emulation.glTexSubImage2D( ${arg0plus} );
 }'''
     },
+
+    # Pending asynchronous uploads are issued before anything that could
+    # sample, read back or respecify the texture.
+
+    'FlushUploads' : {
+        'entries' : [ 'gl(Multi|)Draw(Range|)(Arrays|Element|Elements)(Instanced|Indirect|BaseVertex|InstancedBaseVertex|Array|)(ARB|EXT|AMD|ATI|APPLE|)' ],
+        'prefix' : '_context->texc->FlushUploads( *_context );',
+    },
+
+    'FlushUploadsLevel' : {
+        'entries' : [ 'glGetTexImage', 'glCopyTexImage2D', 'glCompressedTex(Sub|)Image2D(ARB|)' ],
+        'prefix' : '_context->texc->FlushUploads( *_context, ${arg0}, ${arg1} );',
+    },
 }
@@ -365,9 +365,13 @@ def apiFuncDefineCode(apis, args):
 
       if function.needsContext:
         c += '  RegalContext *_context = REGAL_GET_CONTEXT();\n'
+        c += '  #if REGAL_FRAME\n'
+        c += '  Frame::Scope _frameScope(_context);\n'
+        c += '  #endif\n'
         c += listToString(indent(stripVertical(emuCodeGen(emue,'prefix')),'  '))
         c += '  #if REGAL_HTTP\n'
-        c += '  _context->http.callString = %s;\n' % logFunction( function, 'print_string' )
+        c += '  if (_context && _context->http.attached)\n'
+        c += '    _context->http.callString = %s;\n' % logFunction( function, 'print_string' )
         c += '  #endif\n'
         c += '  %s\n' % logFunction( function, 'App' )
         c += '  if (!_context) return'
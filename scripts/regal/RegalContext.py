@@ -122,6 +122,10 @@ struct EmuInfo;
 struct DebugInfo;
 struct Statistics;
 
+#if REGAL_CODE
+namespace Code { struct Output; };
+#endif
+
 ${EMU_FORWARD_DECLARE}
 
 struct RegalContext
@@ -219,8 +223,8 @@ ${EMU_MEMBER_DECLARE}
   // For RegalDispatchCode
 
 #if REGAL_CODE
-  FILE               *codeSource;
-  FILE               *codeHeader;
+  Code::Output       *codeSource;
+  Code::Output       *codeHeader;      // May be the same as codeSource
   size_t              codeInputNext;
   size_t              codeOutputNext;
   size_t              codeShaderNext;  // glCreateShader/glCreateShaderObjectARB
@@ -260,6 +264,7 @@ REGAL_GLOBAL_BEGIN
 #include "RegalDebugInfo.h"
 #include "RegalContextInfo.h"
 #include "RegalStatistics.h"
+#include "RegalCode.h"
 
 
 ${INCLUDES}#if REGAL_EMULATION
@@ -366,16 +371,27 @@ ${EMU_MEMBER_INIT}
   {
     if (Config::codeSourceFile.length())
     {
-      codeSource = fopen(Config::codeSourceFile.c_str(),"wt");
-      if (!codeSource)
+      codeSource = new Code::Output();
+      if (!codeSource->open(Config::codeSourceFile))
+      {
         Warning("Failed to open file ",Config::codeSourceFile," for writing code source.");
+        delete codeSource;
+        codeSource = NULL;
+      }
     }
     if (Config::codeHeaderFile.length())
     {
       if (Config::codeHeaderFile==Config::codeSourceFile)
         codeHeader = codeSource;
       else
-        codeHeader = fopen(Config::codeHeaderFile.c_str(),"wt");
+      {
+        codeHeader = new Code::Output();
+        if (!codeHeader->open(Config::codeHeaderFile))
+        {
+          delete codeHeader;
+          codeHeader = NULL;
+        }
+      }
       if (!codeHeader)
         Warning("Failed to open file ",Config::codeHeaderFile," for writing code header.");
     }
@@ -414,11 +430,10 @@ RegalContext::~RegalContext()
   shareGroup->remove(this);
 
 #if REGAL_CODE
-  if (codeSource)
-    fclose(codeSource);
+  if (codeHeader!=codeSource)
+    delete codeHeader;
 
-  if (codeHeader)
-    fclose(codeHeader);
+  delete codeSource;
 #endif
 }
 
@@ -71,6 +71,7 @@ REGAL_GLOBAL_BEGIN
 #include "RegalToken.h"
 #include "RegalHelper.h"
 #include "RegalContext.h"
+#include "RegalCode.h"
 
 using namespace ::REGAL_NAMESPACE_INTERNAL::Logging;
 using namespace ::REGAL_NAMESPACE_INTERNAL::Token;
@@ -141,8 +142,12 @@ def generateDispatchCode(apis, args):
           prefix += '/* '
           suffix += ' */'
 
-        h      = False
-        h1 =  '    std::string indent((_context->depthBeginEnd + _context->depthPushAttrib + 1)*2,\' \');\n'
+        h1 =  '    if (!_context->codeSource)\n'
+        if typeIsVoid(rType):
+          h1 += '      return;\n'
+        else:
+          h1 += '      return _ret;\n'
+        h1 += '    const ::boost::print::detail::pad<char> indent((_context->depthBeginEnd + _context->depthPushAttrib + 1)*2);\n'
         h2 =  ''
         body   =  ''
 
@@ -216,10 +221,10 @@ def generateDispatchCode(apis, args):
 
               elif i.input and i.size != None and (isinstance(i.size, str) or isinstance(i.size, unicode)) and i.size.startswith('helperGLPixelImageSize'):
                 h2 += '    size_t _%sIndex = _context->codeTextureNext++;\n'%(i.name)
-                h2 += '    _header << indent << \"const GLubyte texture\" << _%sIndex << \"[\" << helper::size::pixelImage(%s << \"] = \" '%(i.name,i.size.split('(',1)[1])
+                h2 += '    if (_context->codeHeader)\n'
+                h2 += '      *_context->codeHeader << indent << \"const GLubyte texture\" << _%sIndex << \"[\" << helper::size::pixelImage(%s << \"] = \" '%(i.name,i.size.split('(',1)[1])
                 h2 += '<< array<GLubyte,const char * const>(static_cast<const GLubyte *>(%s),helper::size::pixelImage(%s,\"\",\"{ \",\" }\",\",\") '%(i.name,i.size.split('(',1)[1])
                 h2 += '<< \";\\n\";\n'
-                h = True
                 body += '_code << \"texture\" << _%sIndex;\n'%(i.name)
 
               elif p.startswith('boost::print::optional'):
@@ -243,14 +248,7 @@ def generateDispatchCode(apis, args):
 
             body += '    _code << ");%s\\n";\n'%(suffix)
 
-        h1 += '    string_list< ::std::string > _code;\n'
-        body += '    if (_context->codeSource)\n'
-        body += '      fprintf(_context->codeSource,"%s",_code.str().c_str());\n'
-
-        if h:
-          h1 += '    string_list< ::std::string > _header;\n'
-          body += '    if (_context->codeHeader)\n'
-          body += '      fprintf(_context->codeHeader,"%s",_header.str().c_str());\n'
+        h1 += '    Code::Output &_code = *_context->codeSource;\n'
 
 #         body += '    Internal("code_%s",_code);\n'%name
 
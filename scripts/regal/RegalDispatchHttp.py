@@ -227,6 +227,7 @@ formulae = {
     'pre' : [
       '#if REGAL_HTTP',
       '_context->http.count.frame++;',
+      '_context->http.Frame( _context );',
       'switch( _context->http.runState ) {',
       '   case RS_Run:',
       '     break;',
@@ -56,7 +56,9 @@ public:
 public:
     static File *createZLib(void);
     static File *createSnappy(void);
-    static File *createForRead(const char *filename);
+    static File *createSnappyAsync(void);
+    static File *createSnappyMapped(void);
+    static File *createForRead(const char *filename, bool mapped = false);
     static File *createForWrite(const char *filename);
 public:
     File(const std::string &filename = std::string(),
@@ -0,0 +1,509 @@
+/**************************************************************************
+ *
+ * Copyright 2011 Zack Rusin
+ * All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ **************************************************************************/
+
+
+/*
+ * Memory mapped reading of snappy trace files.
+ *
+ * The chunk layout is described in trace_file_snappy.cpp.  Opening the
+ * file maps it and walks the chunk length headers, which gives the
+ * offset of every chunk without decompressing anything.  A pool of
+ * threads then decompresses the chunks following the one being read
+ * into a ring of buffers, so the parser only waits when it is faster
+ * than the decompression of all threads together.
+ *
+ * Offsets are the same as those of SnappyFile, the file offset of the
+ * chunk header and the offset within the uncompressed chunk, so
+ * bookmarks from either reader can be used with the other.
+ */
+
+
+#include <snappy.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <assert.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "os_thread.hpp"
+#include "trace_file.hpp"
+
+
+using namespace trace;
+
+
+class SnappyMappedFile : public File {
+public:
+    SnappyMappedFile();
+    virtual ~SnappyMappedFile();
+
+    virtual bool supportsOffsets() const;
+    virtual File::Offset currentOffset();
+    virtual void setCurrentOffset(const File::Offset &offset);
+protected:
+    virtual bool rawOpen(const std::string &filename, File::Mode mode);
+    virtual bool rawWrite(const void *buffer, size_t length);
+    virtual size_t rawRead(void *buffer, size_t length);
+    virtual int rawGetc();
+    virtual void rawClose();
+    virtual void rawFlush();
+    virtual bool rawSkip(size_t length);
+    virtual int rawPercentRead();
+
+private:
+    struct Chunk {
+        uint64_t offset;
+        const char *data;
+        size_t length;
+    };
+
+    struct Slot {
+        Slot() : chunk(0), ready(false) {}
+        size_t chunk;
+        bool ready;
+        std::vector<char> data;
+    };
+
+    bool map(const std::string &filename);
+    void unmap(void);
+    void startThreads(void);
+    void stopThreads(void);
+    void loadChunk(size_t chunk);
+    bool nextChunk(void);
+    static void *decompressThread(void *param);
+
+    const char *m_map;
+    size_t m_mapSize;
+#ifdef _WIN32
+    HANDLE m_handle;
+    HANDLE m_mapping;
+#else
+    int m_fd;
+#endif
+
+    std::vector<Chunk> m_chunks;
+
+    // Uncompressed data of chunk m_current
+    const char *m_ptr;
+    const char *m_end;
+    size_t m_current;
+
+    // Chunk i is decompressed into slot i % m_slots.size() when it is
+    // less than m_slots.size() chunks ahead of m_current.
+    std::vector<Slot> m_slots;
+    std::vector<os::thread> m_threads;
+    size_t m_next;
+    size_t m_busy;
+    bool m_quit;
+    os::mutex m_mutex;
+    os::condition_variable m_work;
+    os::condition_variable m_ready;
+};
+
+
+static unsigned
+numberOfThreads(void)
+{
+    long n;
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    n = long(info.dwNumberOfProcessors);
+#else
+    n = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    // The parser keeps one processor busy
+    return unsigned(std::min(std::max(n - 1, 1L), 8L));
+}
+
+
+SnappyMappedFile::SnappyMappedFile() :
+    File(),
+    m_map(NULL),
+    m_mapSize(0),
+#ifdef _WIN32
+    m_handle(INVALID_HANDLE_VALUE),
+    m_mapping(NULL),
+#else
+    m_fd(-1),
+#endif
+    m_ptr(NULL),
+    m_end(NULL),
+    m_current(0),
+    m_next(0),
+    m_busy(0),
+    m_quit(false)
+{
+}
+
+SnappyMappedFile::~SnappyMappedFile()
+{
+    close();
+}
+
+bool SnappyMappedFile::map(const std::string &filename)
+{
+#ifdef _WIN32
+    m_handle = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                           OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (m_handle == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(m_handle, &size) || !size.QuadPart) {
+        return false;
+    }
+    m_mapSize = size_t(size.QuadPart);
+    m_mapping = CreateFileMappingA(m_handle, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!m_mapping) {
+        return false;
+    }
+    m_map = static_cast<const char *>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    return m_map != NULL;
+#else
+    m_fd = ::open(filename.c_str(), O_RDONLY);
+    if (m_fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(m_fd, &st) != 0 || !st.st_size) {
+        return false;
+    }
+    m_mapSize = size_t(st.st_size);
+    void *map = mmap(NULL, m_mapSize, PROT_READ, MAP_PRIVATE, m_fd, 0);
+    if (map == MAP_FAILED) {
+        return false;
+    }
+    m_map = static_cast<const char *>(map);
+    madvise(map, m_mapSize, MADV_SEQUENTIAL);
+    return true;
+#endif
+}
+
+void SnappyMappedFile::unmap(void)
+{
+#ifdef _WIN32
+    if (m_map) {
+        UnmapViewOfFile(m_map);
+    }
+    if (m_mapping) {
+        CloseHandle(m_mapping);
+        m_mapping = NULL;
+    }
+    if (m_handle != INVALID_HANDLE_VALUE) {
+        CloseHandle(m_handle);
+        m_handle = INVALID_HANDLE_VALUE;
+    }
+#else
+    if (m_map) {
+        munmap(const_cast<char *>(m_map), m_mapSize);
+    }
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+#endif
+    m_map = NULL;
+    m_mapSize = 0;
+}
+
+bool SnappyMappedFile::rawOpen(const std::string &filename, File::Mode mode)
+{
+    if (mode != File::Read) {
+        return false;
+    }
+
+    if (!map(filename) ||
+        m_mapSize < 2 ||
+        m_map[0] != SNAPPY_BYTE1 || m_map[1] != SNAPPY_BYTE2) {
+        unmap();
+        return false;
+    }
+
+    // Index the chunks, a truncated last chunk is ignored as the
+    // stream reader would fail to read it
+
+    m_chunks.clear();
+    size_t pos = 2;
+    while (m_mapSize - pos >= 4) {
+        const unsigned char *buf = reinterpret_cast<const unsigned char *>(m_map + pos);
+        size_t length  =  (size_t)buf[0];
+        length |= ((size_t)buf[1] <<  8);
+        length |= ((size_t)buf[2] << 16);
+        length |= ((size_t)buf[3] << 24);
+        if (!length || length > m_mapSize - pos - 4) {
+            break;
+        }
+        Chunk chunk;
+        chunk.offset = pos;
+        chunk.data = m_map + pos + 4;
+        chunk.length = length;
+        m_chunks.push_back(chunk);
+        pos += 4 + length;
+    }
+
+    m_slots.resize(2 * numberOfThreads());
+    loadChunk(0);
+    return true;
+}
+
+bool SnappyMappedFile::rawWrite(const void *buffer, size_t length)
+{
+    return false;
+}
+
+void SnappyMappedFile::startThreads(void)
+{
+    m_quit = false;
+    unsigned count = unsigned(m_slots.size() / 2);
+    for (unsigned i = 0; i < count; ++i) {
+        m_threads.push_back(os::thread(decompressThread, this));
+    }
+}
+
+void SnappyMappedFile::stopThreads(void)
+{
+    {
+        os::unique_lock<os::mutex> lock(m_mutex);
+        m_quit = true;
+        for (size_t i = 0; i < m_threads.size(); ++i) {
+            m_work.signal();
+        }
+    }
+    for (size_t i = 0; i < m_threads.size(); ++i) {
+        m_threads[i].join();
+    }
+    m_threads.clear();
+}
+
+void *SnappyMappedFile::decompressThread(void *param)
+{
+    SnappyMappedFile *file = static_cast<SnappyMappedFile *>(param);
+    const size_t numSlots = file->m_slots.size();
+
+    os::unique_lock<os::mutex> lock(file->m_mutex);
+    for (;;) {
+        if (file->m_quit) {
+            break;
+        }
+        if (file->m_next >= file->m_chunks.size() ||
+            file->m_next >= file->m_current + numSlots) {
+            file->m_work.wait(lock);
+            continue;
+        }
+
+        size_t index = file->m_next++;
+        Slot &slot = file->m_slots[index % numSlots];
+        const Chunk &chunk = file->m_chunks[index];
+        ++file->m_busy;
+        lock.unlock();
+
+        // The slot's previous chunk is behind m_current, so nobody reads it
+        size_t length = 0;
+        bool ok = ::snappy::GetUncompressedLength(chunk.data, chunk.length, &length);
+        slot.data.resize(ok ? length : 0);
+        if (ok && length) {
+            ok = ::snappy::RawUncompress(chunk.data, chunk.length, &slot.data[0]);
+        }
+        if (!ok) {
+            slot.data.clear();
+        }
+
+        lock.lock();
+        slot.chunk = index;
+        slot.ready = true;
+        --file->m_busy;
+        file->m_ready.signal();
+    }
+
+    return NULL;
+}
+
+/*
+ * Make chunk the current one, restarting the decompression from it.
+ */
+void SnappyMappedFile::loadChunk(size_t chunk)
+{
+    stopThreads();
+
+    for (size_t i = 0; i < m_slots.size(); ++i) {
+        m_slots[i].ready = false;
+    }
+    m_current = chunk;
+    m_next = chunk;
+    m_ptr = m_end = NULL;
+
+    if (chunk < m_chunks.size()) {
+        startThreads();
+        os::unique_lock<os::mutex> lock(m_mutex);
+        Slot &slot = m_slots[chunk % m_slots.size()];
+        while (!slot.ready || slot.chunk != chunk) {
+            m_ready.wait(lock);
+        }
+        if (!slot.data.empty()) {
+            m_ptr = &slot.data[0];
+            m_end = m_ptr + slot.data.size();
+        }
+    }
+}
+
+bool SnappyMappedFile::nextChunk(void)
+{
+    os::unique_lock<os::mutex> lock(m_mutex);
+    if (m_current >= m_chunks.size()) {
+        return false;
+    }
+
+    ++m_current;
+    m_ptr = m_end = NULL;
+    if (m_current >= m_chunks.size()) {
+        return false;
+    }
+
+    // The slot of the previous chunk is free for the next one
+    m_work.signal();
+
+    Slot &slot = m_slots[m_current % m_slots.size()];
+    while (!slot.ready || slot.chunk != m_current) {
+        m_ready.wait(lock);
+    }
+    if (!slot.data.empty()) {
+        m_ptr = &slot.data[0];
+        m_end = m_ptr + slot.data.size();
+    }
+    return true;
+}
+
+size_t SnappyMappedFile::rawRead(void *buffer, size_t length)
+{
+    char *out = static_cast<char *>(buffer);
+    size_t read = 0;
+    while (read < length) {
+        if (m_ptr == m_end && !nextChunk()) {
+            break;
+        }
+        size_t size = std::min(length - read, size_t(m_end - m_ptr));
+        memcpy(out + read, m_ptr, size);
+        m_ptr += size;
+        read += size;
+    }
+    return read;
+}
+
+int SnappyMappedFile::rawGetc()
+{
+    if (m_ptr == m_end && !nextChunk()) {
+        return -1;
+    }
+    return (unsigned char)*m_ptr++;
+}
+
+void SnappyMappedFile::rawClose()
+{
+    stopThreads();
+    m_chunks.clear();
+    m_slots.clear();
+    m_ptr = m_end = NULL;
+    unmap();
+}
+
+void SnappyMappedFile::rawFlush()
+{
+}
+
+bool SnappyMappedFile::rawSkip(size_t length)
+{
+    while (length) {
+        if (m_ptr == m_end && !nextChunk()) {
+            return false;
+        }
+        size_t size = std::min(length, size_t(m_end - m_ptr));
+        m_ptr += size;
+        length -= size;
+    }
+    return true;
+}
+
+int SnappyMappedFile::rawPercentRead()
+{
+    if (m_chunks.empty()) {
+        return 100;
+    }
+    return int(100 * std::min(m_current, m_chunks.size()) / m_chunks.size());
+}
+
+bool SnappyMappedFile::supportsOffsets() const
+{
+    return true;
+}
+
+File::Offset SnappyMappedFile::currentOffset()
+{
+    if (m_current >= m_chunks.size()) {
+        return File::Offset(m_mapSize, 0);
+    }
+    const Slot &slot = m_slots[m_current % m_slots.size()];
+    size_t offsetInChunk = slot.data.empty() ? 0 : m_ptr - &slot.data[0];
+    return File::Offset(m_chunks[m_current].offset, uint32_t(offsetInChunk));
+}
+
+void SnappyMappedFile::setCurrentOffset(const File::Offset &offset)
+{
+    size_t lo = 0, hi = m_chunks.size();
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (m_chunks[mid].offset < offset.chunk) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    if (lo != m_current || !m_ptr) {
+        loadChunk(lo);
+    } else {
+        const Slot &slot = m_slots[m_current % m_slots.size()];
+        m_ptr = &slot.data[0];
+    }
+    assert(lo == m_chunks.size() || m_ptr + offset.offsetInChunk <= m_end);
+    if (m_ptr) {
+        m_ptr += offset.offsetInChunk;
+    }
+}
+
+
+File* File::createSnappyMapped(void) {
+    return new SnappyMappedFile;
+}
@@ -34,7 +34,7 @@ using namespace trace;
 
 
 File *
-File::createForRead(const char *filename)
+File::createForRead(const char *filename, bool mapped)
 {
     std::ifstream stream(filename, std::ifstream::binary | std::ifstream::in);
     if (!stream.is_open()) {
@@ -47,6 +47,16 @@ File::createForRead(const char *filename)
     stream.close();
 
     File *file;
+    if (mapped && byte1 == SNAPPY_BYTE1 && byte2 == SNAPPY_BYTE2) {
+        // Snappy files can be mapped and decompressed ahead of the reader,
+        // falling back to reading them as a stream when mapping fails
+        file = File::createSnappyMapped();
+        if (file->open(filename, File::Read)) {
+            return file;
+        }
+        delete file;
+    }
+
     if (byte1 == SNAPPY_BYTE1 && byte2 == SNAPPY_BYTE2) {
         file = File::createSnappy();
     } else if (byte1 == 0x1f && byte2 == 0x8b) {
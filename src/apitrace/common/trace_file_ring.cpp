@@ -0,0 +1,255 @@
+/**************************************************************************
+ *
+ * Copyright 2007-2013 VMware, Inc.
+ * All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ **************************************************************************/
+
+
+#include <assert.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "trace_format.hpp"
+#include "trace_file_ring.hpp"
+
+
+using namespace trace;
+
+
+static void
+appendVersion(std::string &segment)
+{
+    unsigned long long value = TRACE_VERSION;
+    do {
+        char c = value & 0x7f;
+        value >>= 7;
+        segment.push_back(value ? (c | 0x80) : c);
+    } while (value);
+}
+
+
+RingFile::RingFile(size_t maxSegments, size_t maxPrologue) :
+    m_maxSegments(maxSegments),
+    m_maxPrologue(maxPrologue),
+    m_truncated(false),
+    m_current(&m_prologue)
+{
+}
+
+RingFile::~RingFile()
+{
+    close();
+}
+
+void
+RingFile::nextSegment(unsigned call_no)
+{
+    if (m_segments.size() >= m_maxSegments) {
+        // Reuse the oldest segment's storage
+        m_segments.push_back(std::string());
+        m_segments.back().swap(m_segments.front());
+        m_segments.pop_front();
+        m_segments.back().clear();
+        m_firstCalls.pop_front();
+    } else {
+        m_segments.push_back(std::string());
+    }
+    m_firstCalls.push_back(call_no);
+    m_current = &m_segments.back();
+    appendVersion(*m_current);
+}
+
+const std::string &
+RingFile::segment(size_t index) const
+{
+    assert(index < numSegments());
+    return index ? m_segments[index - 1] : m_prologue;
+}
+
+unsigned
+RingFile::segmentFirstCall(size_t index) const
+{
+    assert(index < numSegments());
+    return index ? m_firstCalls[index - 1] : 0;
+}
+
+bool
+RingFile::supportsOffsets() const
+{
+    return false;
+}
+
+File::Offset
+RingFile::currentOffset()
+{
+    return File::Offset();
+}
+
+bool
+RingFile::rawOpen(const std::string &filename, File::Mode mode)
+{
+    if (mode != File::Write) {
+        return false;
+    }
+    m_prologue.clear();
+    m_segments.clear();
+    m_firstCalls.clear();
+    m_current = &m_prologue;
+    m_truncated = false;
+    return true;
+}
+
+bool
+RingFile::rawWrite(const void *buffer, size_t length)
+{
+    if (m_current == &m_prologue &&
+        (m_truncated || m_prologue.size() + length > m_maxPrologue)) {
+        // Drop the remainder so that the parser stops at the last whole call
+        m_truncated = true;
+        return false;
+    }
+    m_current->append(static_cast<const char *>(buffer), length);
+    return true;
+}
+
+size_t
+RingFile::rawRead(void *buffer, size_t length)
+{
+    return 0;
+}
+
+int
+RingFile::rawGetc()
+{
+    return -1;
+}
+
+void
+RingFile::rawClose()
+{
+}
+
+void
+RingFile::rawFlush()
+{
+}
+
+bool
+RingFile::rawSkip(size_t length)
+{
+    return false;
+}
+
+int
+RingFile::rawPercentRead()
+{
+    return 0;
+}
+
+
+class SegmentFile : public File {
+public:
+    SegmentFile(const std::string &segment) :
+        m_segment(segment),
+        m_pos(0)
+    {
+    }
+
+    virtual ~SegmentFile()
+    {
+        close();
+    }
+
+    virtual bool supportsOffsets() const
+    {
+        return false;
+    }
+
+    virtual File::Offset currentOffset()
+    {
+        return File::Offset();
+    }
+
+protected:
+    virtual bool rawOpen(const std::string &filename, File::Mode mode)
+    {
+        m_pos = 0;
+        return mode == File::Read;
+    }
+
+    virtual bool rawWrite(const void *buffer, size_t length)
+    {
+        return false;
+    }
+
+    virtual size_t rawRead(void *buffer, size_t length)
+    {
+        length = std::min(length, m_segment.size() - m_pos);
+        memcpy(buffer, m_segment.data() + m_pos, length);
+        m_pos += length;
+        return length;
+    }
+
+    virtual int rawGetc()
+    {
+        if (m_pos == m_segment.size()) {
+            return -1;
+        }
+        return (unsigned char)m_segment[m_pos++];
+    }
+
+    virtual void rawClose()
+    {
+    }
+
+    virtual void rawFlush()
+    {
+    }
+
+    virtual bool rawSkip(size_t length)
+    {
+        if (length > m_segment.size() - m_pos) {
+            return false;
+        }
+        m_pos += length;
+        return true;
+    }
+
+    virtual int rawPercentRead()
+    {
+        return m_segment.empty() ? 100 : int(100 * m_pos / m_segment.size());
+    }
+
+private:
+    const std::string &m_segment;
+    size_t m_pos;
+};
+
+
+File *
+RingFile::createSegmentReader(const std::string &segment)
+{
+    File *file = new SegmentFile(segment);
+    file->open(std::string(), File::Read);
+    return file;
+}
@@ -0,0 +1,97 @@
+/**************************************************************************
+ *
+ * Copyright 2007-2013 VMware, Inc.
+ * All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ **************************************************************************/
+
+/*
+ * In-memory trace files for the flight recorder.
+ */
+
+#ifndef _TRACE_FILE_RING_HPP_
+#define _TRACE_FILE_RING_HPP_
+
+
+#include <deque>
+#include <string>
+
+#include "trace_file.hpp"
+
+
+namespace trace {
+
+    /**
+     * Write-only file keeping the trace in memory as a list of segments.
+     *
+     * Each segment begins with the trace version, so that it can be
+     * parsed on its own as long as the writer re-emits signatures after
+     * nextSegment().  The first segment, the prologue, is kept for the
+     * lifetime of the file and is capped at maxPrologue bytes.  Of the
+     * others only the last maxSegments are retained.
+     */
+    class RingFile : public File {
+    public:
+        RingFile(size_t maxSegments, size_t maxPrologue);
+        virtual ~RingFile();
+
+        /**
+         * Start a new segment whose first call is call_no.
+         */
+        void nextSegment(unsigned call_no);
+
+        inline size_t numSegments(void) const { return 1 + m_segments.size(); }
+        const std::string &segment(size_t index) const;
+        unsigned segmentFirstCall(size_t index) const;
+
+        inline bool prologueTruncated(void) const { return m_truncated; }
+
+        virtual bool supportsOffsets() const;
+        virtual File::Offset currentOffset();
+
+        /**
+         * Read-only file over a segment, for the parser.
+         */
+        static File *createSegmentReader(const std::string &segment);
+
+    protected:
+        virtual bool rawOpen(const std::string &filename, File::Mode mode);
+        virtual bool rawWrite(const void *buffer, size_t length);
+        virtual size_t rawRead(void *buffer, size_t length);
+        virtual int rawGetc();
+        virtual void rawClose();
+        virtual void rawFlush();
+        virtual bool rawSkip(size_t length);
+        virtual int rawPercentRead();
+
+    private:
+        size_t m_maxSegments;
+        size_t m_maxPrologue;
+        bool m_truncated;
+        std::string m_prologue;
+        std::deque<std::string> m_segments;
+        std::deque<unsigned> m_firstCalls;
+        std::string *m_current;
+    };
+
+} /* namespace trace */
+
+#endif /* _TRACE_FILE_RING_HPP_ */
@@ -48,6 +48,13 @@
  * to offer a pretty good compression/disk io speed ratio
  * but that might change.
  *
+ * Asynchronous writing:
+ * A file created with createSnappyAsync keeps a second chunk
+ * buffer. A full chunk is swapped with it and handed to a
+ * background thread, which compresses and writes it while the
+ * caller fills the other one. The caller only waits when the
+ * background thread is still busy with the previous chunk.
+ *
  */
 
 
@@ -59,6 +66,7 @@
 #include <assert.h>
 #include <string.h>
 
+#include "os_thread.hpp"
 #include "trace_file.hpp"
 
 
@@ -72,7 +80,8 @@ using namespace trace;
 class SnappyFile : public File {
 public:
     SnappyFile(const std::string &filename = std::string(),
-               File::Mode mode = File::Read);
+               File::Mode mode = File::Read,
+               bool async = false);
     virtual ~SnappyFile();
 
     virtual bool supportsOffsets() const;
@@ -108,6 +117,9 @@ private:
         return m_stream.eof() && freeCacheSize() == 0;
     }
     void flushWriteCache();
+    void compressChunk(const char *chunk, size_t length);
+    void waitForPending();
+    static void *writerThread(void *param);
     void flushReadCache(size_t skipLength = 0);
     void createCache(size_t size);
     void writeCompressedLength(size_t length);
@@ -123,15 +135,31 @@ private:
 
     File::Offset m_currentOffset;
     std::streampos m_endPos;
+
+    // Asynchronous writing, m_pending is only touched by the
+    // background thread while m_pendingLength is not zero.
+    bool m_async;
+    char *m_pending;
+    size_t m_pendingLength;
+    bool m_quit;
+    os::mutex m_asyncMutex;
+    os::condition_variable m_ready;
+    os::condition_variable m_done;
+    os::thread m_thread;
 };
 
 SnappyFile::SnappyFile(const std::string &filename,
-                              File::Mode mode)
+                              File::Mode mode,
+                              bool async)
     : File(),
       m_cacheMaxSize(SNAPPY_CHUNK_SIZE),
       m_cacheSize(m_cacheMaxSize),
       m_cache(new char [m_cacheMaxSize]),
-      m_cachePtr(m_cache)
+      m_cachePtr(m_cache),
+      m_async(async),
+      m_pending(NULL),
+      m_pendingLength(0),
+      m_quit(false)
 {
     size_t maxCompressedLength =
         snappy::MaxCompressedLength(SNAPPY_CHUNK_SIZE);
@@ -143,6 +171,7 @@ SnappyFile::~SnappyFile()
     close();
     delete [] m_compressedCache;
     delete [] m_cache;
+    delete [] m_pending;
 }
 
 bool SnappyFile::rawOpen(const std::string &filename, File::Mode mode)
@@ -174,6 +203,15 @@ bool SnappyFile::rawOpen(const std::string &filename, File::Mode mode)
         // write the snappy file identifier
         m_stream << SNAPPY_BYTE1;
         m_stream << SNAPPY_BYTE2;
+
+        if (m_async) {
+            if (!m_pending) {
+                m_pending = new char[m_cacheMaxSize];
+            }
+            m_pendingLength = 0;
+            m_quit = false;
+            m_thread = os::thread(writerThread, this);
+        }
     }
     return m_stream.is_open();
 }
@@ -250,6 +288,15 @@ void SnappyFile::rawClose()
 {
     if (m_mode == File::Write) {
         flushWriteCache();
+        if (m_thread.joinable()) {
+            {
+                os::unique_lock<os::mutex> lock(m_asyncMutex);
+                m_quit = true;
+                m_ready.signal();
+            }
+            m_thread.join();
+            m_thread = os::thread();
+        }
     }
     m_stream.close();
     delete [] m_cache;
@@ -261,6 +308,7 @@ void SnappyFile::rawFlush()
 {
     assert(m_mode == File::Write);
     flushWriteCache();
+    waitForPending();
     m_stream.flush();
 }
 
@@ -269,18 +317,67 @@ void SnappyFile::flushWriteCache()
     size_t inputLength = usedCacheSize();
 
     if (inputLength) {
-        size_t compressedLength;
-
-        ::snappy::RawCompress(m_cache, inputLength,
-                              m_compressedCache, &compressedLength);
-
-        writeCompressedLength(compressedLength);
-        m_stream.write(m_compressedCache, compressedLength);
+        if (m_thread.joinable()) {
+            os::unique_lock<os::mutex> lock(m_asyncMutex);
+            while (m_pendingLength) {
+                m_done.wait(lock);
+            }
+            std::swap(m_cache, m_pending);
+            m_pendingLength = inputLength;
+            m_ready.signal();
+        } else {
+            compressChunk(m_cache, inputLength);
+        }
         m_cachePtr = m_cache;
     }
     assert(m_cachePtr == m_cache);
 }
 
+void SnappyFile::compressChunk(const char *chunk, size_t length)
+{
+    size_t compressedLength;
+
+    ::snappy::RawCompress(chunk, length,
+                          m_compressedCache, &compressedLength);
+
+    writeCompressedLength(compressedLength);
+    m_stream.write(m_compressedCache, compressedLength);
+}
+
+void SnappyFile::waitForPending()
+{
+    if (m_thread.joinable()) {
+        os::unique_lock<os::mutex> lock(m_asyncMutex);
+        while (m_pendingLength) {
+            m_done.wait(lock);
+        }
+    }
+}
+
+void *SnappyFile::writerThread(void *param)
+{
+    SnappyFile *file = static_cast<SnappyFile *>(param);
+
+    os::unique_lock<os::mutex> lock(file->m_asyncMutex);
+    for (;;) {
+        while (!file->m_pendingLength && !file->m_quit) {
+            file->m_ready.wait(lock);
+        }
+        if (!file->m_pendingLength) {
+            break;
+        }
+
+        lock.unlock();
+        file->compressChunk(file->m_pending, file->m_pendingLength);
+        lock.lock();
+
+        file->m_pendingLength = 0;
+        file->m_done.signal();
+    }
+
+    return NULL;
+}
+
 void SnappyFile::flushReadCache(size_t skipLength)
 {
     //assert(m_cachePtr == m_cache + m_cacheSize);
@@ -405,3 +502,7 @@ int SnappyFile::rawPercentRead()
 File* File::createSnappy(void) {
     return new SnappyFile;
 }
+
+File* File::createSnappyAsync(void) {
+    return new SnappyFile(std::string(), File::Read, true);
+}
@@ -30,17 +30,17 @@ unsigned Loader::numberOfFrames() const
 
 unsigned Loader::numberOfCallsInFrame(unsigned frameIdx) const
 {
-    if (frameIdx > m_frameBookmarks.size()) {
+    if (frameIdx >= m_frameBookmarks.size()) {
         return 0;
     }
-    FrameBookmarks::const_iterator itr =
-        m_frameBookmarks.find(frameIdx);
-    return itr->second.numberOfCalls;
+    return m_frameBookmarks[frameIdx].numberOfCalls;
 }
 
 bool Loader::open(const char *filename)
 {
-    if (!m_parser.open(filename)) {
+    m_frameBookmarks.clear();
+
+    if (!m_parser.open(filename, true)) {
         std::cerr << "error: failed to open " << filename << "\n";
         return false;
     }
@@ -52,7 +52,6 @@ bool Loader::open(const char *filename)
 
     trace::Call *call;
     ParseBookmark startBookmark;
-    unsigned numOfFrames = 0;
     unsigned numOfCalls = 0;
     int lastPercentReport = 0;
 
@@ -65,8 +64,7 @@ bool Loader::open(const char *filename)
             FrameBookmark frameBookmark(startBookmark);
             frameBookmark.numberOfCalls = numOfCalls;
 
-            m_frameBookmarks[numOfFrames] = frameBookmark;
-            ++numOfFrames;
+            m_frameBookmarks.push_back(frameBookmark);
 
             if (m_parser.percentRead() - lastPercentReport >= 5) {
                 std::cerr << "\tPercent scanned = "
@@ -87,6 +85,7 @@ bool Loader::open(const char *filename)
 void Loader::close()
 {
     m_parser.close();
+    m_frameBookmarks.clear();
 }
 
 bool Loader::isCallAFrameMarker(const trace::Call *call) const
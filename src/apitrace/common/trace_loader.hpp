@@ -5,7 +5,6 @@
 #include "trace_parser.hpp"
 
 #include <string>
-#include <map>
 #include <queue>
 #include <vector>
 
@@ -56,7 +55,8 @@ private:
     trace::Parser m_parser;
     FrameMarker m_frameMarker;
 
-    typedef std::map<int, FrameBookmark> FrameBookmarks;
+    // Indexed by frame, so seeking to a frame is a single setBookmark
+    typedef std::vector<FrameBookmark> FrameBookmarks;
     FrameBookmarks m_frameBookmarks;
 };
 
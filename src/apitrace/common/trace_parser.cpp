@@ -55,13 +55,20 @@ Parser::~Parser() {
 }
 
 
-bool Parser::open(const char *filename) {
+bool Parser::open(const char *filename, bool mapped) {
     assert(!file);
-    file = File::createForRead(filename);
+    file = File::createForRead(filename, mapped);
     if (!file) {
         return false;
     }
 
+    return open(file);
+}
+
+bool Parser::open(File *_file, unsigned first_call) {
+    file = _file;
+    next_call_no = first_call;
+
     version = read_uint();
     if (version > TRACE_VERSION) {
         std::cerr << "error: unsupported trace format version " << version << "\n";
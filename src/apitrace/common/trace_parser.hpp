@@ -104,7 +104,17 @@ public:
 
     ~Parser();
 
-    bool open(const char *filename);
+    /**
+     * Open a trace file, mapping snappy files and decompressing them on
+     * several threads when mapped is set.
+     */
+    bool open(const char *filename, bool mapped = false);
+
+    /**
+     * Parse an already opened file, taking ownership of it.  Calls are
+     * numbered from first_call, for traces that start mid-stream.
+     */
+    bool open(File *file, unsigned first_call = 0);
 
     void close(void);
 
@@ -121,6 +131,9 @@ public:
 
     void setBookmark(const ParseBookmark &bookmark);
 
+    static CallFlags
+    lookupCallFlags(const char *name);
+
     int percentRead()
     {
         return file->percentRead();
@@ -138,9 +151,6 @@ protected:
     EnumSig *parse_old_enum_sig();
     EnumSig *parse_enum_sig();
     BitmaskSig *parse_bitmask_sig();
-    
-    static CallFlags
-    lookupCallFlags(const char *name);
 
     Call *parse_Call(Mode mode);
 
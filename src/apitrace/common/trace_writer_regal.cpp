@@ -29,11 +29,17 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <signal.h>
+
+#include <algorithm>
 
 #include "os.hpp"
 #include "os_thread.hpp"
 #include "os_string.hpp"
+#include "os_time.hpp"
 #include "trace_file.hpp"
+#include "trace_file_ring.hpp"
+#include "trace_parser.hpp"
 #include "trace_writer_regal.hpp"
 #include "trace_format.hpp"
 #include "os_backtrace.hpp"
@@ -56,9 +62,36 @@ const FunctionSig realloc_sig = {3, "realloc", 2, realloc_args};
 
 
 const char *regalWriterFileName = NULL;
+bool regalWriterAsync = false;
+unsigned regalWriterRingFrames = 0;
+unsigned regalWriterRingHitch = 0;
+
+/*
+ * Largest amount of setup, before the first frame, kept by the flight
+ * recorder.
+ */
+static const size_t ringMaxPrologue = 512*1024*1024;
+
+static volatile bool ringTriggered = false;
+
+void regalWriterTrigger(void) {
+    ringTriggered = true;
+}
+
+#ifndef _WIN32
+static void ringSignalHandler(int sig) {
+    ringTriggered = true;
+}
+#endif
 
 RegalWriter::RegalWriter() :
-    acquired(0)
+    acquired(0),
+    ring(NULL),
+    frameCall(~0U),
+    leaveCall(~0U),
+    ringDumps(0),
+    ringCountdown(0),
+    lastFrame(0)
 {
     os::log("apitrace: loaded\n");
 }
@@ -118,7 +151,27 @@ RegalWriter::open(void)
         }
     }
 
-    os::log("apitrace: tracing to %s\n", lpFileName);
+    if (regalWriterRingFrames) {
+        // Keep the trace in memory, lpFileName only names the dumps
+        ringPrefix = lpFileName;
+        ringPrefix.trimExtension();
+        delete m_file;
+        ring = new RingFile(regalWriterRingFrames, ringMaxPrologue);
+        m_file = ring;
+#ifndef _WIN32
+        signal(SIGUSR2, ringSignalHandler);
+#endif
+        os::log("apitrace: recording the last %u frames for %s.ring*.trace\n",
+                regalWriterRingFrames, ringPrefix.str());
+    } else {
+        os::log("apitrace: tracing to %s\n", lpFileName);
+    }
+
+    if (regalWriterAsync && !ring) {
+        // Replace the unopened synchronous file created by Writer
+        delete m_file;
+        m_file = File::createSnappyAsync();
+    }
 
     if (!Writer::open(lpFileName)) {
         os::log("apitrace: error: failed to open %s\n", lpFileName);
@@ -141,6 +194,7 @@ void RegalWriter::checkProcessId(void) {
         // file, as it may cause it to flush and corrupt the parent's
         // trace, so we effectively leak the old file object.
         m_file = File::createSnappy();
+        ring = NULL;
         // Don't want to open the same file again
         os::unsetEnvironment("TRACE_FILE");
         open();
@@ -165,6 +219,9 @@ unsigned RegalWriter::beginEnter(const FunctionSig *sig, bool fake) {
     assert(this_thread_num);
     unsigned thread_id = this_thread_num - 1;
     unsigned call_no = Writer::beginEnter(sig, thread_id);
+    if (ring && isEndFrame(sig)) {
+        frameCall = call_no;
+    }
     if (!fake && os::backtrace_is_needed(sig->name)) {
         std::vector<RawStackFrame> backtrace = os::get_backtrace();
         beginBacktrace(backtrace.size());
@@ -185,11 +242,15 @@ void RegalWriter::endEnter(void) {
 void RegalWriter::beginLeave(unsigned call) {
     mutex.lock();
     ++acquired;
+    leaveCall = call;
     Writer::beginLeave(call);
 }
 
 void RegalWriter::endLeave(void) {
     Writer::endLeave();
+    if (ring && leaveCall == frameCall) {
+        ringFrame();
+    }
     --acquired;
     mutex.unlock();
 }
@@ -220,6 +281,87 @@ void RegalWriter::flush(void) {
 }
 
 
+bool RegalWriter::isEndFrame(const FunctionSig *sig) {
+    if (sig->id >= endFrame.size()) {
+        endFrame.resize(sig->id + 1, 0);
+    }
+    unsigned char &flag = endFrame[sig->id];
+    if (!flag) {
+        flag = Parser::lookupCallFlags(sig->name) & CALL_FLAG_END_FRAME ? 2 : 1;
+    }
+    return flag == 2;
+}
+
+/*
+ * Called with the mutex held, after the last call of a frame.
+ */
+void RegalWriter::ringFrame(void) {
+    long long now = os::getTime();
+    if (regalWriterRingHitch && lastFrame && !ringCountdown &&
+        (now - lastFrame)*1000 > (long long)regalWriterRingHitch*os::timeFrequency) {
+        os::log("apitrace: frame took %.1f ms\n",
+                (now - lastFrame)*1000.0/os::timeFrequency);
+        ringCountdown = std::max(regalWriterRingFrames/2, 1U);
+    }
+    lastFrame = now;
+
+    bool dump = ringTriggered;
+    if (ringCountdown && !--ringCountdown) {
+        dump = true;
+    }
+    if (dump) {
+        ringTriggered = false;
+        ringCountdown = 0;
+        ringDump();
+    }
+
+    // Each frame re-emits the signatures it uses, so that it can be
+    // parsed without the frames that were dropped before it.
+    ring->nextSegment(call_no);
+    functions.clear();
+    structs.clear();
+    enums.clear();
+    bitmasks.clear();
+    frames.clear();
+}
+
+/*
+ * Re-serialize the retained segments into a single trace.  Calls that
+ * straddle a frame boundary on other threads are dropped.
+ */
+void RegalWriter::ringDump(void) {
+    os::String name = os::String::format("%s.ring%u.trace", ringPrefix.str(), ringDumps++);
+
+    Writer dump;
+    if (!dump.open(name)) {
+        os::log("apitrace: error: failed to open %s\n", name.str());
+        return;
+    }
+
+    if (ring->prologueTruncated()) {
+        os::log("apitrace: warning: setup exceeded %u MB and was truncated\n",
+                unsigned(ringMaxPrologue >> 20));
+    }
+
+    for (size_t i = 0; i < ring->numSegments(); ++i) {
+        Parser parser;
+        if (!parser.open(RingFile::createSegmentReader(ring->segment(i)),
+                         ring->segmentFirstCall(i))) {
+            continue;
+        }
+        Call *call;
+        while ((call = parser.parse_call())) {
+            dump.writeCall(call);
+            delete call;
+        }
+    }
+
+    dump.close();
+    os::log("apitrace: wrote last %u frames to %s\n",
+            unsigned(ring->numSegments() - 1), name.str());
+}
+
+
 RegalWriter regalWriter;
 
 
@@ -33,6 +33,9 @@
 
 #include <stdint.h>
 
+#include <vector>
+
+#include "os_string.hpp"
 #include "os_thread.hpp"
 #include "os_process.hpp"
 #include "trace_writer.hpp"
@@ -45,6 +48,8 @@ namespace trace {
     extern const FunctionSig free_sig;
     extern const FunctionSig realloc_sig;
 
+    class RingFile;
+
     /**
      * A specialized Writer class, mean to trace the current process.
      *
@@ -78,6 +83,24 @@ namespace trace {
 
         void checkProcessId();
 
+        /**
+         * Flight recorder state, used when regalWriterRingFrames is set.
+         * Frame ends are detected with the parser's call flags, cached
+         * per function signature id.
+         */
+        RingFile *ring;
+        os::String ringPrefix;
+        std::vector<unsigned char> endFrame;
+        unsigned frameCall;
+        unsigned leaveCall;
+        unsigned ringDumps;
+        unsigned ringCountdown;
+        long long lastFrame;
+
+        bool isEndFrame(const FunctionSig *sig);
+        void ringFrame(void);
+        void ringDump(void);
+
     public:
         /**
          * Should never called directly -- use regalWriter singleton below
@@ -118,6 +141,28 @@ namespace trace {
      */
 
     extern const char *regalWriterFileName;
+
+    /**
+     * When set before the trace file is opened, chunks are compressed
+     * and written by a background thread rather than by the thread
+     * making the call.
+     */
+    extern bool regalWriterAsync;
+
+    /**
+     * When non-zero before the trace file is opened, nothing is written
+     * to disk until triggered: only the calls preceding the first frame
+     * and the last regalWriterRingFrames frames are kept in memory.  A
+     * trigger writes them to <name>.ring<n>.trace at the next frame
+     * boundary.  Triggers are regalWriterTrigger(), SIGUSR2 and, when
+     * regalWriterRingHitch is non-zero, a frame taking longer than that
+     * many milliseconds, in which case the dump is delayed by half the
+     * ring so that the frames following the hitch are captured too.
+     */
+    extern unsigned regalWriterRingFrames;
+    extern unsigned regalWriterRingHitch;
+    void regalWriterTrigger(void);
+
     void fakeMemcpy(const void *ptr, size_t size);
 
     /**
@@ -165,6 +165,7 @@ if __name__ == "__main__":
 #include "ir_reader.h"
 #include "program.h"
 #include "ast.h"
+#include "glsl_mutex.h"
 
 extern "C" struct gl_shader *
 _mesa_new_shader(struct gl_context *ctx, GLuint name, GLenum type);
@@ -232,9 +233,13 @@ read_builtins(GLenum target, const char *protos, const char **functions, unsigne
     print """
 static void *builtin_mem_ctx = NULL;
 
+/* Guards the profiles, which are read on first use by any thread. */
+static glsl_mutex builtin_mutex = GLSL_MUTEX_INITIALIZER;
+
 void
 _mesa_glsl_release_functions(void)
 {
+   glsl_mutex_guard guard(&builtin_mutex);
    ralloc_free(builtin_mem_ctx);
    builtin_mem_ctx = NULL;
    memset(builtin_profiles, 0, sizeof(builtin_profiles));
@@ -266,6 +271,8 @@ _mesa_glsl_initialize_functions(struct _mesa_glsl_parse_state *state)
    if (state->num_builtins_to_link > 0)
       return;
 
+   glsl_mutex_guard guard(&builtin_mutex);
+
    if (builtin_mem_ctx == NULL) {
       builtin_mem_ctx = ralloc_context(NULL); // "GLSL built-in functions"
       memset(&builtin_profiles, 0, sizeof(builtin_profiles));
@@ -0,0 +1,71 @@
+/*
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \file glsl_mutex.h
+ * Statically initialized mutex guarding the compiler's process-wide state,
+ * the glsl_type instance tables and the built-in function profiles, so
+ * that shaders can be compiled on several threads at once.
+ */
+
+#pragma once
+#ifndef GLSL_MUTEX_H
+#define GLSL_MUTEX_H
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+
+typedef SRWLOCK glsl_mutex;
+#define GLSL_MUTEX_INITIALIZER SRWLOCK_INIT
+
+static inline void glsl_mutex_lock(glsl_mutex *m)   { AcquireSRWLockExclusive(m); }
+static inline void glsl_mutex_unlock(glsl_mutex *m) { ReleaseSRWLockExclusive(m); }
+#else
+#include <pthread.h>
+
+typedef pthread_mutex_t glsl_mutex;
+#define GLSL_MUTEX_INITIALIZER PTHREAD_MUTEX_INITIALIZER
+
+static inline void glsl_mutex_lock(glsl_mutex *m)   { pthread_mutex_lock(m); }
+static inline void glsl_mutex_unlock(glsl_mutex *m) { pthread_mutex_unlock(m); }
+#endif
+
+#ifdef __cplusplus
+class glsl_mutex_guard {
+public:
+   explicit glsl_mutex_guard(glsl_mutex *m) : m(m) { glsl_mutex_lock(m); }
+   ~glsl_mutex_guard() { glsl_mutex_unlock(m); }
+
+private:
+   glsl_mutex *m;
+
+   glsl_mutex_guard(const glsl_mutex_guard &);
+   glsl_mutex_guard &operator=(const glsl_mutex_guard &);
+};
+#endif
+
+#endif /* GLSL_MUTEX_H */
@@ -29,6 +29,7 @@
 #include "glsl_types.h"
 #include "main/glminimal.h"
 #include "builtin_types.h"
+#include "glsl_mutex.h"
 extern "C" {
 #include "program/hash_table.h"
 }
@@ -38,6 +39,11 @@ hash_table *glsl_type::record_types = NULL;
 hash_table *glsl_type::interface_types = NULL;
 void *glsl_type::mem_ctx = NULL;
 
+/* Guards the instance tables, and mem_ctx once static initialization is
+ * done, for compiling on several threads.
+ */
+static glsl_mutex types_mutex = GLSL_MUTEX_INITIALIZER;
+
 void
 glsl_type::init_ralloc_type_ctx(void)
 {
@@ -512,6 +518,8 @@ const glsl_type *glsl_type::get_scalar_type() const
 void
 _mesa_glsl_release_types(void)
 {
+   glsl_mutex_guard guard(&types_mutex);
+
    if (glsl_type::array_types != NULL) {
       hash_table_dtor(glsl_type::array_types);
       glsl_type::array_types = NULL;
@@ -615,6 +623,7 @@ glsl_type::get_instance(unsigned base_type, unsigned rows, unsigned columns)
 const glsl_type *
 glsl_type::get_array_instance(const glsl_type *base, unsigned array_size)
 {
+   glsl_mutex_guard guard(&types_mutex);
 
    if (array_types == NULL) {
       array_types = hash_table_ctor(64, hash_table_string_hash,
@@ -705,6 +714,7 @@ glsl_type::get_record_instance(const glsl_struct_field *fields,
 			       unsigned num_fields,
 			       const char *name)
 {
+   glsl_mutex_guard guard(&types_mutex);
    const glsl_type key(fields, num_fields, name);
 
    if (record_types == NULL) {
@@ -732,6 +742,7 @@ glsl_type::get_interface_instance(const glsl_struct_field *fields,
 				  enum glsl_interface_packing packing,
 				  const char *name)
 {
+   glsl_mutex_guard guard(&types_mutex);
    const glsl_type key(fields, num_fields, packing, name);
 
    if (interface_types == NULL) {
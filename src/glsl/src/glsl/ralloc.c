@@ -66,10 +66,67 @@ struct ralloc_header
    struct ralloc_header *next;
 
    void (*destructor)(void *);
+
+   /* The arena this block was carved from, or NULL if it was malloc'd. */
+   struct ralloc_arena *arena;
+
+   /* The size requested for the block, not counting the header. */
+   size_t size;
 };
 
 typedef struct ralloc_header ralloc_header;
 
+/* Blocks are carved out of the arena at this alignment, which is at least
+ * what malloc guarantees for the allocations it replaces.
+ */
+#define ARENA_ALIGN 16
+
+struct ralloc_arena_chunk
+{
+   struct ralloc_arena_chunk *next;
+};
+
+struct ralloc_arena_dtor
+{
+   ralloc_header *block;
+   struct ralloc_arena_dtor *next;
+};
+
+/* Header of the first chunk rounded up to ARENA_ALIGN. */
+#define ARENA_CHUNK_HEADER \
+   ((sizeof(struct ralloc_arena_chunk) + ARENA_ALIGN - 1) & ~(size_t) (ARENA_ALIGN - 1))
+
+struct ralloc_arena
+{
+   /* The node created by ralloc_arena_size; freeing it frees the arena. */
+   ralloc_header *root;
+
+   /* Chunks, most recent first, and the free space left in the first one. */
+   struct ralloc_arena_chunk *chunks;
+   char *next;
+   char *end;
+
+   size_t chunk_size;
+
+   /* Blocks that were given a destructor, most recent first. */
+   struct ralloc_arena_dtor *dtors;
+
+   /* Set once a block from outside the arena is chained into it; the tree
+    * then has to be walked to find and free it.
+    */
+   bool walk;
+
+   /* Set once a block is stolen into a context outside the arena.  The
+    * arena can no longer know when it is unreferenced, so it is never
+    * released.
+    */
+   bool escaped;
+
+   struct ralloc_arena_stats stats;
+};
+
+typedef struct ralloc_arena ralloc_arena;
+
 static void unlink_block(ralloc_header *info);
 static void unsafe_free(ralloc_header *info);
 
@@ -84,6 +141,77 @@ get_header(const void *ptr)
 
 #define PTR_FROM_HEADER(info) (((char *) info) + sizeof(ralloc_header))
 
+/* Carve a zeroed block out of the arena, starting a new chunk if the current
+ * one is exhausted.  Blocks are never returned to the arena individually.
+ */
+static void *
+arena_carve(ralloc_arena *arena, size_t size)
+{
+   char *block;
+
+   size = (size + ARENA_ALIGN - 1) & ~(size_t) (ARENA_ALIGN - 1);
+
+   if (unlikely(size > (size_t) (arena->end - arena->next))) {
+      size_t chunk = arena->chunk_size;
+      struct ralloc_arena_chunk *c;
+
+      if (chunk < size + ARENA_CHUNK_HEADER)
+         chunk = size + ARENA_CHUNK_HEADER;
+
+      c = calloc(1, chunk);
+      if (c == NULL)
+         return NULL;
+
+      c->next = arena->chunks;
+      arena->chunks = c;
+      arena->next = ((char *) c) + ARENA_CHUNK_HEADER;
+      arena->end = ((char *) c) + chunk;
+      arena->stats.chunks++;
+      arena->stats.reserved += chunk;
+   }
+
+   block = arena->next;
+   arena->next += size;
+   arena->stats.bytes += size;
+   return block;
+}
+
+static ralloc_header *
+arena_alloc(ralloc_arena *arena, size_t size)
+{
+   ralloc_header *info = arena_carve(arena, size + sizeof(ralloc_header));
+   if (info != NULL)
+      arena->stats.allocations++;
+   return info;
+}
+
+/* Run the destructors of the blocks that are still alive. */
+static void
+arena_destruct(ralloc_arena *arena)
+{
+   struct ralloc_arena_dtor *d;
+
+   for (d = arena->dtors; d != NULL; d = d->next) {
+      void (*destructor)(void *) = d->block->destructor;
+      if (destructor != NULL) {
+         d->block->destructor = NULL;
+         destructor(PTR_FROM_HEADER(d->block));
+      }
+   }
+}
+
+static void
+arena_release(ralloc_arena *arena)
+{
+   struct ralloc_arena_chunk *c = arena->chunks;
+   while (c != NULL) {
+      struct ralloc_arena_chunk *next = c->next;
+      free(c);
+      c = next;
+   }
+   free(arena);
+}
+
 static void
 add_child(ralloc_header *parent, ralloc_header *info)
 {
@@ -106,14 +234,25 @@ ralloc_context(const void *ctx)
 void *
 ralloc_size(const void *ctx, size_t size)
 {
-   void *block = calloc(1, size + sizeof(ralloc_header));
-
-   ralloc_header *info = (ralloc_header *) block;
    ralloc_header *parent = ctx != NULL ? get_header(ctx) : NULL;
+   ralloc_header *info;
+
+   /* Children of an arena block are carved from the same arena. */
+   if (parent != NULL && parent->arena != NULL) {
+      info = arena_alloc(parent->arena, size);
+      if (unlikely(info == NULL))
+         return NULL;
+      info->arena = parent->arena;
+   } else {
+      info = (ralloc_header *) calloc(1, size + sizeof(ralloc_header));
+      if (unlikely(info == NULL))
+         return NULL;
+   }
 
    add_child(parent, info);
 
    info->canary = CANARY;
+   info->size = size;
 
    return PTR_FROM_HEADER(info);
 }
@@ -134,10 +273,30 @@ resize(void *ptr, size_t size)
    ralloc_header *child, *old, *info;
 
    old = get_header(ptr);
-   info = realloc(old, size + sizeof(ralloc_header));
 
-   if (info == NULL)
-      return NULL;
+   if (old->arena != NULL) {
+      /* Arena blocks can't grow in place; move to a fresh block and leave
+       * the old one to be released with the arena.
+       */
+      if (size <= old->size) {
+         old->size = size;
+         return ptr;
+      }
+
+      info = arena_alloc(old->arena, size);
+      if (info == NULL)
+         return NULL;
+
+      memcpy(info, old, sizeof(ralloc_header) + old->size);
+      if (old->arena->root == old)
+         old->arena->root = info;
+   } else {
+      info = realloc(old, size + sizeof(ralloc_header));
+      if (info == NULL)
+         return NULL;
+   }
+
+   info->size = size;
 
    /* Update parent and sibling's links to the reallocated node. */
    if (info != old && info->parent != NULL) {
@@ -230,8 +389,21 @@ unlink_block(ralloc_header *info)
 static void
 unsafe_free(ralloc_header *info)
 {
-   /* Recursively free any children...don't waste time unlinking them. */
+   ralloc_arena *arena = info->arena;
    ralloc_header *temp;
+
+   /* Freeing the root of an arena with nothing but its own blocks in it
+    * drops every block at once, without visiting them.
+    */
+   if (arena != NULL && arena->root == info && !arena->walk && !arena->escaped) {
+      arena_destruct(arena);
+      if (info->destructor != NULL)
+         info->destructor(PTR_FROM_HEADER(info));
+      arena_release(arena);
+      return;
+   }
+
+   /* Recursively free any children...don't waste time unlinking them. */
    while (info->child != NULL) {
       temp = info->child;
       info->child = temp->next;
@@ -239,10 +411,17 @@ unsafe_free(ralloc_header *info)
    }
 
    /* Free the block itself.  Call the destructor first, if any. */
-   if (info->destructor != NULL)
-      info->destructor(PTR_FROM_HEADER(info));
+   if (info->destructor != NULL) {
+      void (*destructor)(void *) = info->destructor;
+      info->destructor = NULL;
+      destructor(PTR_FROM_HEADER(info));
+   }
 
-   free(info);
+   /* Arena blocks go back with the arena, once its root is freed. */
+   if (arena == NULL)
+      free(info);
+   else if (arena->root == info && !arena->escaped)
+      arena_release(arena);
 }
 
 void
@@ -256,6 +435,13 @@ ralloc_steal(const void *new_ctx, void *ptr)
    info = get_header(ptr);
    parent = get_header(new_ctx);
 
+   if (info->arena != parent->arena) {
+      if (info->arena != NULL && info->arena->root != info)
+         info->arena->escaped = true;
+      if (parent->arena != NULL)
+         parent->arena->walk = true;
+   }
+
    unlink_block(info);
 
    add_child(parent, info);
@@ -295,9 +481,77 @@ void
 ralloc_set_destructor(const void *ptr, void(*destructor)(void *))
 {
    ralloc_header *info = get_header(ptr);
+
+   /* Arena blocks aren't visited when the arena is released, so remember
+    * the ones that have something to run.
+    */
+   if (info->arena != NULL && info->arena->root != info &&
+       info->destructor == NULL && destructor != NULL) {
+      struct ralloc_arena_dtor *d = arena_carve(info->arena, sizeof(*d));
+      if (d != NULL) {
+         d->block = info;
+         d->next = info->arena->dtors;
+         info->arena->dtors = d;
+      } else {
+         info->arena->walk = true;
+      }
+   }
+
    info->destructor = destructor;
 }
 
+void *
+ralloc_arena_size(const void *ctx, size_t size, size_t chunk_size)
+{
+   ralloc_header *parent = ctx != NULL ? get_header(ctx) : NULL;
+   ralloc_header *info;
+   ralloc_arena *arena;
+
+   arena = calloc(1, sizeof(ralloc_arena));
+   if (unlikely(arena == NULL))
+      return NULL;
+
+   arena->chunk_size = chunk_size > 0 ? chunk_size : RALLOC_ARENA_CHUNK_SIZE;
+
+   info = arena_alloc(arena, size);
+   if (unlikely(info == NULL)) {
+      free(arena);
+      return NULL;
+   }
+
+   info->arena = arena;
+   arena->root = info;
+
+   /* The arena is released as a whole, so a parent outside it has to visit
+    * its root when it is freed.
+    */
+   if (parent != NULL && parent->arena != NULL)
+      parent->arena->walk = true;
+
+   add_child(parent, info);
+
+   info->canary = CANARY;
+   info->size = size;
+
+   return PTR_FROM_HEADER(info);
+}
+
+bool
+ralloc_arena_get_stats(const void *ptr, struct ralloc_arena_stats *stats)
+{
+   ralloc_header *info;
+
+   if (unlikely(ptr == NULL))
+      return false;
+
+   info = get_header(ptr);
+   if (info->arena == NULL)
+      return false;
+
+   *stats = info->arena->stats;
+   return true;
+}
+
 char *
 ralloc_strdup(const void *ctx, const char *str)
 {
@@ -253,6 +253,47 @@ void *ralloc_autofree_context(void);
  */
 void ralloc_set_destructor(const void *ptr, void(*destructor)(void *));
 
+/// \defgroup arena Arena Functions @{
+/**
+ * Default size of the chunks an arena reserves from malloc.
+ */
+#define RALLOC_ARENA_CHUNK_SIZE (64 * 1024)
+
+/**
+ * Allocation counters of an arena.
+ */
+struct ralloc_arena_stats
+{
+   unsigned allocations; /**< Blocks carved from the arena */
+   size_t bytes;         /**< Bytes handed out, including headers */
+   unsigned chunks;      /**< Chunks reserved from malloc */
+   size_t reserved;      /**< Bytes reserved from malloc */
+};
+
+/**
+ * Allocate a new block that roots a bump-pointer arena.
+ *
+ * The block is chained off \p ctx like any other, but everything allocated
+ * out of it (or out of its descendants) is carved from chunks of
+ * \p chunk_size bytes, or \c RALLOC_ARENA_CHUNK_SIZE if zero, rather than
+ * taken from malloc one block at a time.  Freeing an individual block in the
+ * arena runs its destructor but does not return its memory; freeing the root
+ * returns all of it at once, without walking the tree unless a destructor or
+ * a block from outside the arena requires it.
+ *
+ * A block stolen out of the arena into an unrelated context keeps the whole
+ * arena alive for the rest of the program.
+ */
+void *ralloc_arena_size(const void *ctx, size_t size, size_t chunk_size);
+
+/**
+ * Fetch the counters of the arena \p ptr was allocated from.
+ *
+ * \return false if \p ptr is not part of an arena.
+ */
+bool ralloc_arena_get_stats(const void *ptr, struct ralloc_arena_stats *stats);
+/// @}
+
 /// \defgroup array String Functions @{
 /**
  * Duplicate a string, allocating the memory from the given context.
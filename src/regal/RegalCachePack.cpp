@@ -0,0 +1,475 @@
+/*
+  Copyright (c) 2011-2012 NVIDIA Corporation
+  Copyright (c) 2011-2012 Cass Everitt
+  Copyright (c) 2012 Scott Nations
+  Copyright (c) 2012 Mathias Schott
+  Copyright (c) 2012 Nigel Stewart
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+  OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+  OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+/*
+
+ Disk-based cache pack file
+
+ */
+
+#include "pch.h" /* For MS precompiled header support */
+
+#include "RegalUtil.h"
+
+#if REGAL_CACHE
+
+REGAL_GLOBAL_BEGIN
+
+#include "RegalConfig.h"
+#include "RegalLog.h"
+#include "RegalCachePack.h"
+
+#include <lookup3.h>
+
+#include <map>
+#include <cstdio>
+#include <cstring>
+
+#if !REGAL_SYS_WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+using namespace ::std;
+using ::boost::uint32_t;
+using ::boost::uint64_t;
+
+REGAL_GLOBAL_END
+
+REGAL_NAMESPACE_BEGIN
+
+namespace Cache {
+
+using namespace Thread;
+
+namespace {
+
+// Both files start with a 16 byte header: magic and version.
+// Pack data is 8 byte aligned, index entries are 24 bytes.
+
+const char   packMagic[8]  = { 'R','E','G','A','L','P','C','K' };
+const char   indexMagic[8] = { 'R','E','G','A','L','I','D','X' };
+const uint32_t version     = 1;
+const size_t headerSize    = 16;
+
+struct IndexEntry
+{
+  uint64_t key;
+  uint64_t offset;
+  uint64_t size;
+};
+
+inline string packFile (const string &directory) { return makePath(directory,"regal.pack"); }
+inline string indexFile(const string &directory) { return makePath(directory,"regal.idx");  }
+
+bool
+writeHeader(FILE *f, const char *magic)
+{
+  char header[headerSize];
+  memset(header,0,headerSize);
+  memcpy(header,magic,8);
+  memcpy(header+8,&version,sizeof(version));
+  return fwrite(header,headerSize,1,f)==1;
+}
+
+bool
+checkHeader(const char *data, size_t size, const char *magic)
+{
+  uint32_t v = 0;
+  if (size<headerSize || memcmp(data,magic,8))
+    return false;
+  memcpy(&v,data+8,sizeof(v));
+  return v==version;
+}
+
+bool
+create(const string &directory)
+{
+  FILE *pack  = fopen(packFile(directory).c_str(),"wb");
+  FILE *index = fopen(indexFile(directory).c_str(),"wb");
+  bool ok = pack && index && writeHeader(pack,packMagic) && writeHeader(index,indexMagic);
+  if (pack)  fclose(pack);
+  if (index) fclose(index);
+  return ok;
+}
+
+// Advisory lock of the index, for appending
+
+inline void lockFile(FILE *f)
+{
+#if !REGAL_SYS_WIN32
+  flock(fileno(f),LOCK_EX);
+#else
+  UNUSED_PARAMETER(f);
+#endif
+}
+
+inline void unlockFile(FILE *f)
+{
+#if !REGAL_SYS_WIN32
+  fflush(f);
+  flock(fileno(f),LOCK_UN);
+#else
+  UNUSED_PARAMETER(f);
+#endif
+}
+
+}
+
+Pack::File::File()
+: fd(-1),
+  data(NULL),
+  size(0)
+{
+}
+
+bool
+Pack::File::map(const string &filename)
+{
+  unmap();
+
+#if !REGAL_SYS_WIN32
+  fd = ::open(filename.c_str(),O_RDONLY);
+  if (fd<0)
+    return false;
+
+  struct stat st;
+  if (fstat(fd,&st) || !st.st_size)
+  {
+    unmap();
+    return false;
+  }
+
+  void *p = mmap(NULL,st.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+  if (p==MAP_FAILED)
+  {
+    unmap();
+    return false;
+  }
+
+  data = static_cast<const char *>(p);
+  size = st.st_size;
+  return true;
+#else
+
+  // No mmap, read it all instead
+
+  FILE *f = fopen(filename.c_str(),"rb");
+  if (!f)
+    return false;
+  fseek(f,0,SEEK_END);
+  long n = ftell(f);
+  fseek(f,0,SEEK_SET);
+  char *buffer = n>0 ? new char[n] : NULL;
+  if (buffer && fread(buffer,1,n,f)==size_t(n))
+  {
+    data = buffer;
+    size = n;
+  }
+  else
+    delete [] buffer;
+  fclose(f);
+  return data!=NULL;
+#endif
+}
+
+void
+Pack::File::unmap()
+{
+#if !REGAL_SYS_WIN32
+  if (data)
+    munmap(const_cast<char *>(data),size);
+  if (fd>=0)
+    ::close(fd);
+#else
+  delete [] data;
+#endif
+  fd   = -1;
+  data = NULL;
+  size = 0;
+}
+
+Pack::Pack()
+{
+}
+
+Pack::~Pack()
+{
+  close();
+}
+
+bool
+Pack::open(const string &directory)
+{
+  ScopedLock lock(&_mutex);
+
+  close();
+
+  if (!fileExists(indexFile(directory).c_str()) && !create(directory))
+  {
+    Warning("Could not create cache pack in ",directory,", permissions problem?");
+    return false;
+  }
+
+  if (!_pack.map(packFile(directory)) || !_index.map(indexFile(directory)) ||
+      !checkHeader(_pack.data,_pack.size,packMagic) || !checkHeader(_index.data,_index.size,indexMagic))
+  {
+    Warning("Cache pack in ",directory," not valid, ignoring.");
+    close();
+    return false;
+  }
+
+  _directory = directory;
+
+  // Later entries supersede earlier ones.  Entries referring beyond the
+  // end of the pack are from an interrupted write, and are ignored.
+
+  const size_t n = (_index.size-headerSize)/sizeof(IndexEntry);
+  for (size_t i=0; i<n; ++i)
+  {
+    IndexEntry e;
+    memcpy(&e,_index.data+headerSize+i*sizeof(IndexEntry),sizeof(IndexEntry));
+    if (e.offset<headerSize || e.offset>_pack.size || e.size>_pack.size-e.offset)
+      continue;
+    if (!_entries.count(e.key))
+      _keys.push_back(e.key);
+    Entry &entry = _entries[e.key];
+    entry.data = _pack.data+e.offset;
+    entry.size = size_t(e.size);
+  }
+
+  Info("Cache pack ",packFile(directory)," opened, ",_entries.size()," entries.");
+  return true;
+}
+
+void
+Pack::close()
+{
+  ScopedLock lock(&_mutex);
+
+  _entries.clear();
+  _keys.clear();
+  for (size_t i=0; i<_written.size(); ++i)
+    delete _written[i];
+  _written.clear();
+  _pack.unmap();
+  _index.unmap();
+  _directory.clear();
+}
+
+bool
+Pack::find(uint64_t key, const void *&data, size_t &size) const
+{
+  ScopedLock lock(&_mutex);
+
+  hash_map<uint64_t, Entry>::const_iterator i = _entries.find(key);
+  if (i==_entries.end())
+    return false;
+  data = i->second.data;
+  size = i->second.size;
+  return true;
+}
+
+bool
+Pack::contains(uint64_t key) const
+{
+  ScopedLock lock(&_mutex);
+  return _entries.find(key)!=_entries.end();
+}
+
+void
+Pack::keys(vector<uint64_t> &keys) const
+{
+  ScopedLock lock(&_mutex);
+  keys = _keys;
+}
+
+bool
+Pack::insert(uint64_t key, const void *data, size_t size, bool replace)
+{
+  ScopedLock lock(&_mutex);
+
+  if (_directory.empty() || (!replace && _entries.find(key)!=_entries.end()))
+    return false;
+
+  FILE *index = fopen(indexFile(_directory).c_str(),"ab");
+  FILE *pack  = index ? fopen(packFile(_directory).c_str(),"ab") : NULL;
+  if (!pack)
+  {
+    if (index)
+      fclose(index);
+    Warning("Could not write cache pack in ",_directory,", permissions problem?");
+    return false;
+  }
+
+  // The data is appended before the index entry, so a reader never
+  // sees an entry for incomplete data.
+
+  lockFile(index);
+
+  fseek(pack,0,SEEK_END);
+  long offset = ftell(pack);
+  static const char zero[8] = { 0 };
+  const size_t padding = (8 - size_t(offset)%8)%8;
+
+  IndexEntry e;
+  e.key    = key;
+  e.offset = uint64_t(offset) + padding;
+  e.size   = size;
+
+  bool ok = offset>=long(headerSize);
+  ok = ok && (!padding || fwrite(zero,padding,1,pack)==1);
+  ok = ok && (!size    || fwrite(data,size,1,pack)==1);
+  ok = ok && !fflush(pack);
+  ok = ok && fwrite(&e,sizeof(e),1,index)==1;
+
+  unlockFile(index);
+  fclose(pack);
+  fclose(index);
+
+  if (!ok)
+  {
+    Warning("Could not write cache pack in ",_directory);
+    return false;
+  }
+
+  vector<char> *copy = new vector<char>(static_cast<const char *>(data),static_cast<const char *>(data)+size);
+  _written.push_back(copy);
+
+  if (!_entries.count(key))
+    _keys.push_back(key);
+  Entry &entry = _entries[key];
+  entry.data = copy->empty() ? NULL : &(*copy)[0];
+  entry.size = size;
+  return true;
+}
+
+bool
+Pack::compact(const string &directory)
+{
+  File pack;
+  File index;
+  if (!pack.map(packFile(directory)) || !index.map(indexFile(directory)) ||
+      !checkHeader(pack.data,pack.size,packMagic) || !checkHeader(index.data,index.size,indexMagic))
+    return false;
+
+  // Keep the last complete entry for each key, in the original order
+
+  map<uint64_t, size_t> latest;
+  const size_t n = (index.size-headerSize)/sizeof(IndexEntry);
+  vector<IndexEntry> entries(n);
+  for (size_t i=0; i<n; ++i)
+  {
+    memcpy(&entries[i],index.data+headerSize+i*sizeof(IndexEntry),sizeof(IndexEntry));
+    const IndexEntry &e = entries[i];
+    if (e.offset>=headerSize && e.offset<=pack.size && e.size<=pack.size-e.offset)
+      latest[e.key] = i;
+  }
+
+  const string packTmp  = packFile(directory)  + ".tmp";
+  const string indexTmp = indexFile(directory) + ".tmp";
+
+  FILE *p = fopen(packTmp.c_str(),"wb");
+  FILE *x = fopen(indexTmp.c_str(),"wb");
+  bool ok = p && x && writeHeader(p,packMagic) && writeHeader(x,indexMagic);
+
+  uint64_t offset = headerSize;
+  static const char zero[8] = { 0 };
+  for (size_t i=0; ok && i<n; ++i)
+  {
+    map<uint64_t, size_t>::const_iterator j = latest.find(entries[i].key);
+    if (j==latest.end() || j->second!=i)
+      continue;
+
+    IndexEntry e = entries[i];
+    const size_t padding = size_t((8 - offset%8)%8);
+    ok = ok && (!padding || fwrite(zero,padding,1,p)==1);
+    ok = ok && (!e.size  || fwrite(pack.data+e.offset,size_t(e.size),1,p)==1);
+    e.offset = offset + padding;
+    ok = ok && fwrite(&e,sizeof(e),1,x)==1;
+    offset = e.offset + e.size;
+  }
+
+  if (p) fclose(p);
+  if (x) fclose(x);
+  pack.unmap();
+  index.unmap();
+
+  ok = ok && !rename(packTmp.c_str(),packFile(directory).c_str());
+  ok = ok && !rename(indexTmp.c_str(),indexFile(directory).c_str());
+  if (!ok)
+  {
+    remove(packTmp.c_str());
+    remove(indexTmp.c_str());
+    Warning("Could not compact cache pack in ",directory);
+    return false;
+  }
+
+  Info("Cache pack ",packFile(directory)," compacted, ",latest.size()," of ",n," entries kept.");
+  return true;
+}
+
+Pack &
+Pack::instance()
+{
+  static Pack  *pack = NULL;
+  static Mutex  mutex;
+
+  ScopedLock lock(&mutex);
+  if (!pack)
+  {
+    pack = new Pack();
+    if (Config::cacheCompact)
+      compact(Config::cacheDirectory);
+    pack->open(Config::cacheDirectory);
+  }
+  return *pack;
+}
+
+uint64_t
+packKey(const char *tag, const void *data, size_t size, uint64_t key)
+{
+  uint32_t pc = uint32_t(key);
+  uint32_t pb = uint32_t(key>>32);
+  if (tag)
+    Lookup3::hashlittle2(tag,strlen(tag),&pc,&pb);
+  Lookup3::hashlittle2(data,size,&pc,&pb);
+  return uint64_t(pc) | (uint64_t(pb)<<32);
+}
+
+};
+
+REGAL_NAMESPACE_END
+
+#endif // REGAL_CACHE
@@ -0,0 +1,152 @@
+/*
+  Copyright (c) 2011-2012 NVIDIA Corporation
+  Copyright (c) 2011-2012 Cass Everitt
+  Copyright (c) 2012 Scott Nations
+  Copyright (c) 2012 Mathias Schott
+  Copyright (c) 2012 Nigel Stewart
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+  OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+  OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+/*
+
+ Disk-based cache pack file
+
+ */
+
+#ifndef __REGAL_CACHE_PACK_H__
+#define __REGAL_CACHE_PACK_H__
+
+#include "RegalUtil.h"
+
+#if REGAL_CACHE
+
+REGAL_GLOBAL_BEGIN
+
+#include <string>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+
+#include "RegalMutex.h"
+#include "RegalSharedHashMap.h"
+
+REGAL_GLOBAL_END
+
+REGAL_NAMESPACE_BEGIN
+
+namespace Cache {
+
+  //
+  // Pack
+  //
+  // Cached shaders, textures and programs are appended to a single
+  // pack file, regal.pack, with a fixed-size index entry per object
+  // appended to regal.idx.  Both are memory-mapped when first used,
+  // and the index loaded into a hash table, so a lookup involves
+  // no file system calls.
+  //
+  // Objects written by this process are kept in memory.  A key
+  // written more than once (by concurrent processes, for example)
+  // resolves to the last entry, until the pack is compacted.
+  //
+
+  struct Pack
+  {
+  public:
+    Pack();
+    ~Pack();
+
+    // Open the pack in the given directory, creating it if need be
+
+    bool open(const ::std::string &directory);
+    void close();
+
+    // Lookup a cached object, the data remains valid until close()
+
+    bool find(::boost::uint64_t key, const void *&data, size_t &size) const;
+
+    bool contains(::boost::uint64_t key) const;
+
+    // Keys of all the objects, in the order first written
+
+    void keys(::std::vector< ::boost::uint64_t> &keys) const;
+
+    // Append an object, if the key isn't already in the pack,
+    // or to supersede it.
+
+    bool insert(::boost::uint64_t key, const void *data, size_t size, bool replace = false);
+
+    // Rewrite the pack without superseded or incomplete entries,
+    // while no other process is using it.
+
+    static bool compact(const ::std::string &directory);
+
+    // The process-wide pack in Config::cacheDirectory
+
+    static Pack &instance();
+
+  private:
+
+    struct Entry
+    {
+      const char *data;
+      size_t      size;
+    };
+
+    struct File
+    {
+      File();
+
+      bool map(const ::std::string &filename);
+      void unmap();
+
+      int         fd;
+      const char *data;
+      size_t      size;
+    };
+
+    ::std::string                         _directory;
+    File                                  _pack;
+    File                                  _index;
+    hash_map< ::boost::uint64_t, Entry>   _entries;
+    ::std::vector< ::boost::uint64_t>     _keys;
+    ::std::vector< ::std::vector<char> *> _written;
+    mutable Thread::Mutex                 _mutex;
+
+    Pack(const Pack &other);
+    Pack &operator=(const Pack &other);
+  };
+
+  // 64-bit key of an object, with a tag for the kind of object
+
+  ::boost::uint64_t packKey(const char *tag, const void *data, size_t size, ::boost::uint64_t key = 0);
+
+};
+
+REGAL_NAMESPACE_END
+
+#endif // REGAL_CACHE
+
+#endif
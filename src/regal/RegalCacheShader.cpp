@@ -35,7 +35,11 @@
 REGAL_GLOBAL_BEGIN
 
 #include "RegalConfig.h"
+#include "RegalContext.h"
+#include "RegalContextInfo.h"
+#include "RegalDispatch.h"
 #include "RegalCacheShader.h"
+#include "RegalCachePack.h"
 
 #include <lookup3.h>
 
@@ -45,6 +49,7 @@ REGAL_GLOBAL_BEGIN
 
 using namespace ::std;
 using ::boost::print::print_string;
+using ::boost::uint64_t;
 
 REGAL_GLOBAL_END
 
@@ -55,70 +60,59 @@ namespace Cache {
 void
 shaderSource(PFNGLSHADERSOURCEPROC proc, GLuint shader, GLsizei count, const GLchar * const * string, const GLint *length)
 {
+#if REGAL_CACHE
   if (REGAL_CACHE && REGAL_CACHE_SHADER && Config::cache && Config::cacheShader)
   {
-    // Compute 32-bit hash of shader source
+    // Compute 64-bit key of shader source
 
-    uint32_t hash = 0;
+    ::std::string source;
     for (GLsizei i=0; i<count; ++i)
-      hash = Lookup3::hashlittle(string[i], length ? length[i] : strlen(string[i]), hash);
+      source.append(string[i], length && length[i]>=0 ? length[i] : strlen(string[i]));
 
-    ::std::string filename = makePath(Config::cacheDirectory,print_string(boost::print::hex(hash),".txt"));
+    const uint64_t key = packKey("shader",source.c_str(),source.length());
+    Pack &pack = Pack::instance();
 
-    // Cache it to disk, iff it's not there yet
+    // Cache it to the pack, iff it's not there yet
 
-    if (REGAL_CACHE_SHADER_WRITE && Config::cacheShaderWrite && !fileExists(filename.c_str()))
+    if (REGAL_CACHE_SHADER_WRITE && Config::cacheShaderWrite && !pack.contains(key))
     {
-      FILE *f = fopen(filename.c_str(),"wt");
-      if (!f)
+      if (pack.insert(key,source.c_str(),source.length()))
       {
-        Warning("Could not write shader to file ",filename,", permissions problem?");
-      }
-      else
-      {
-        Internal("Regal::ShaderCache::glShaderSource","shader=",shader," hash=",boost::print::hex(hash)," filename=",filename," written.");
-        Info("Cached shader ",boost::print::hex(hash)," written: ",filename);
-        for (GLsizei i=0; i<count; ++i)
-          fwrite(string[i], length ? length[i] : strlen(string[i]),1,f);
-        fclose(f);
+        Internal("Regal::ShaderCache::glShaderSource","shader=",shader," key=",boost::print::hex(key)," written.");
+        Info("Cached shader ",boost::print::hex(key)," written.");
       }
     }
     else
     {
-      // Read from disk cache, if reading is enabled
+      // Read from the pack, if reading is enabled
       // export REGAL_CACHE_SHADER_READ=1
 
       if (REGAL_CACHE_SHADER_READ && Config::cacheShaderRead)
       {
-        std::string buffer;
+        const void *data = NULL;
+        size_t      size = 0;
 
-        // Try opening the file
-
-        FILE *f = fopen(filename.c_str(),"rt");
-
-        if (!f)
+        if (!pack.find(key,data,size))
         {
-          Internal("Regal::ShaderCache::glShaderSource","shader=",shader," hash=",boost::print::hex(hash)," filename=",filename," not found.");
-          Info("Cached shader ",boost::print::hex(hash)," not found: ",filename);
+          Internal("Regal::ShaderCache::glShaderSource","shader=",shader," key=",boost::print::hex(key)," not found.");
+          Info("Cached shader ",boost::print::hex(key)," not found.");
           goto done;
         }
 
-        buffer = fileRead(f);
-
-        Internal("Regal::ShaderCache::glShaderSource","shader=",shader," hash=",boost::print::hex(hash)," filename=",filename," read.");
-        Info("Cached shader ",boost::print::hex(hash)," read: ",filename);
+        Internal("Regal::ShaderCache::glShaderSource","shader=",shader," key=",boost::print::hex(key)," read.");
+        Info("Cached shader ",boost::print::hex(key)," read.");
 
-        const GLchar *bufferPtr[2];
-        bufferPtr[0] = &buffer[0];
-        bufferPtr[1] = NULL;
+        const GLchar *bufferPtr[1];
+        const GLint   bufferLength[1] = { GLint(size) };
+        bufferPtr[0] = static_cast<const GLchar *>(data);
 
-        proc(shader,1,bufferPtr,NULL);
+        proc(shader,1,bufferPtr,bufferLength);
         return;
       }
       else
       {
-        Internal("Regal::ShaderCache::glShaderSource","shader=",shader," hash=",boost::print::hex(hash)," filename=",filename," not read.");
-        Info("Cached shader ",boost::print::hex(hash)," not read: ",filename);
+        Internal("Regal::ShaderCache::glShaderSource","shader=",shader," key=",boost::print::hex(key)," not read.");
+        Info("Cached shader ",boost::print::hex(key)," not read.");
       }
     }
   }
@@ -126,9 +120,216 @@ shaderSource(PFNGLSHADERSOURCEPROC proc, GLuint shader, GLsizei count, const GLc
   // Call the driver
 
 done:
+#endif
   proc(shader,count,string,length);
 }
 
+#if REGAL_CACHE
+
+Programs::Programs()
+: enabled(false),
+  oes(false),
+  driver(0)
+{
+}
+
+void
+Programs::Init(RegalContext &ctx)
+{
+  RegalAssert(ctx.info);
+  const ContextInfo &info = *ctx.info;
+
+  const bool core = !info.es2 && !info.es1 && (info.gl_version_major>4 || (info.gl_version_major==4 && info.gl_version_minor>=1));
+  const bool es3  = info.es2 && info.gles_version_major>=3;
+
+  oes     = info.es2 && !es3 && info.gl_oes_get_program_binary;
+  enabled = REGAL_CACHE_SHADER && Config::cache && Config::cacheShader &&
+            (Config::cacheShaderRead || Config::cacheShaderWrite) &&
+            (core || es3 || oes || info.gl_arb_get_program_binary);
+
+  // Some drivers advertise the extension, but no binary formats
+
+  if (enabled)
+  {
+    GLint formats = 0;
+    RegalAssert(ctx.dispatcher.driver.glGetIntegerv);
+    ctx.dispatcher.driver.glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS,&formats);
+    enabled = formats>0;
+  }
+
+  driver = Lookup3::hashlittle(info.vendor.c_str(),  info.vendor.length(),   0);
+  driver = Lookup3::hashlittle(info.renderer.c_str(),info.renderer.length(), driver);
+  driver = Lookup3::hashlittle(info.version.c_str(), info.version.length(),  driver);
+
+  RegalContext *sharingWith = ctx.shareGroup->front();
+  if (sharingWith && sharingWith!=&ctx && sharingWith->programs)
+  {
+    deferred = sharingWith->programs->deferred;
+    bindings = sharingWith->programs->bindings;
+  }
+
+  Info("Program binary cache ",enabled ? "enabled" : "not available");
+}
+
+void
+compileShader(RegalContext &ctx, DispatchTableGL &tbl, GLuint shader)
+{
+  if (REGAL_CACHE_SHADER_READ && Config::cacheShaderRead && ctx.programs && ctx.programs->enabled)
+  {
+    ctx.programs->deferred[shader] = true;
+    return;
+  }
+
+  tbl.call(&tbl.glCompileShader)(shader);
+}
+
+void
+compileDeferred(RegalContext &ctx, DispatchTableGL &tbl, GLuint shader)
+{
+  if (ctx.programs && ctx.programs->deferred.erase(shader))
+    tbl.call(&tbl.glCompileShader)(shader);
+}
+
+void
+deleteShader(RegalContext &ctx, DispatchTableGL &tbl, GLuint shader)
+{
+  if (ctx.programs)
+    ctx.programs->deferred.erase(shader);
+
+  tbl.call(&tbl.glDeleteShader)(shader);
+}
+
+void
+bindAttribLocation(RegalContext &ctx, DispatchTableGL &tbl, GLuint program, GLuint index, const GLchar *name)
+{
+  if (ctx.programs && ctx.programs->enabled && name)
+    ctx.programs->bindings[program][name] = index;
+
+  tbl.call(&tbl.glBindAttribLocation)(program,index,name);
+}
+
+void
+deleteProgram(RegalContext &ctx, DispatchTableGL &tbl, GLuint program)
+{
+  if (ctx.programs)
+    ctx.programs->bindings.erase(program);
+
+  tbl.call(&tbl.glDeleteProgram)(program);
+}
+
+void
+linkProgram(RegalContext &ctx, DispatchTableGL &tbl, GLuint program)
+{
+  Programs *programs = ctx.programs.get();
+
+  if (!programs || !programs->enabled)
+  {
+    tbl.call(&tbl.glLinkProgram)(program);
+    return;
+  }
+
+  PFNGLPROGRAMBINARYPROC    programBinary    = programs->oes ? tbl.call(&tbl.glProgramBinaryOES)    : tbl.call(&tbl.glProgramBinary);
+  PFNGLGETPROGRAMBINARYPROC getProgramBinary = programs->oes ? tbl.call(&tbl.glGetProgramBinaryOES) : tbl.call(&tbl.glGetProgramBinary);
+
+  // Compute 64-bit hash of the attached shaders, attribute bindings and driver
+
+  uint32_t hash[2] = { programs->driver, 0 };
+
+  GLint count = 0;
+  tbl.call(&tbl.glGetProgramiv)(program,GL_ATTACHED_SHADERS,&count);
+  vector<GLuint> shaders(count>0 ? count : 0);
+  if (count>0)
+    tbl.call(&tbl.glGetAttachedShaders)(program,count,NULL,&shaders[0]);
+
+  string source;
+  for (size_t i=0; i<shaders.size(); ++i)
+  {
+    GLint type = 0;
+    GLint length = 0;
+    tbl.call(&tbl.glGetShaderiv)(shaders[i],GL_SHADER_TYPE,&type);
+    tbl.call(&tbl.glGetShaderiv)(shaders[i],GL_SHADER_SOURCE_LENGTH,&length);
+    source.resize(length>0 ? length : 1);
+    GLsizei size = 0;
+    tbl.call(&tbl.glGetShaderSource)(shaders[i],GLsizei(source.size()),&size,&source[0]);
+    Lookup3::hashlittle2(&type,sizeof(type),&hash[0],&hash[1]);
+    Lookup3::hashlittle2(source.c_str(),size,&hash[0],&hash[1]);
+  }
+
+  map<GLuint, map<string, GLuint> >::const_iterator b = programs->bindings->find(program);
+  if (b!=programs->bindings->end())
+    for (map<string, GLuint>::const_iterator i = b->second.begin(); i!=b->second.end(); ++i)
+    {
+      Lookup3::hashlittle2(i->first.c_str(),i->first.length()+1,&hash[0],&hash[1]);
+      Lookup3::hashlittle2(&i->second,sizeof(i->second),&hash[0],&hash[1]);
+    }
+
+  const uint64_t key = uint64_t(hash[0]) | (uint64_t(hash[1])<<32);
+  Pack &pack = Pack::instance();
+
+  bool rejected = false;
+
+  // Load the program binary, iff it's in the cache
+
+  if (REGAL_CACHE_SHADER_READ && Config::cacheShaderRead)
+  {
+    const void *data = NULL;
+    size_t      size = 0;
+
+    if (pack.find(key,data,size) && size>sizeof(GLenum))
+    {
+      GLenum format = 0;
+      memcpy(&format,data,sizeof(GLenum));
+      programBinary(program,format,static_cast<const char *>(data)+sizeof(GLenum),GLsizei(size-sizeof(GLenum)));
+
+      GLint status = GL_FALSE;
+      tbl.call(&tbl.glGetProgramiv)(program,GL_LINK_STATUS,&status);
+      if (status==GL_TRUE)
+      {
+        Internal("Regal::Cache::linkProgram","program=",program," key=",boost::print::hex(key)," read.");
+        Info("Cached program ",boost::print::hex(key)," read.");
+        return;
+      }
+
+      Warning("Cached program ",boost::print::hex(key)," rejected by driver, linking.");
+      rejected = true;
+    }
+  }
+
+  // Compile and link as usual
+
+  for (size_t i=0; i<shaders.size(); ++i)
+    compileDeferred(ctx,tbl,shaders[i]);
+
+  tbl.call(&tbl.glLinkProgram)(program);
+
+  // Write the program binary, iff it linked
+
+  if (REGAL_CACHE_SHADER_WRITE && Config::cacheShaderWrite)
+  {
+    GLint status = GL_FALSE;
+    GLint length = 0;
+    tbl.call(&tbl.glGetProgramiv)(program,GL_LINK_STATUS,&status);
+    if (status==GL_TRUE)
+      tbl.call(&tbl.glGetProgramiv)(program,GL_PROGRAM_BINARY_LENGTH,&length);
+    if (length>0)
+    {
+      vector<char> buffer(sizeof(GLenum)+length);
+      GLenum format = 0;
+      getProgramBinary(program,length,&length,&format,&buffer[sizeof(GLenum)]);
+      memcpy(&buffer[0],&format,sizeof(GLenum));
+      buffer.resize(sizeof(GLenum)+length);
+
+      if (pack.insert(key,&buffer[0],buffer.size(),rejected))
+      {
+        Internal("Regal::Cache::linkProgram","program=",program," key=",boost::print::hex(key)," written.");
+        Info("Cached program ",boost::print::hex(key)," written.");
+      }
+    }
+  }
+}
+
+#endif // REGAL_CACHE
+
 };
 
 REGAL_NAMESPACE_END
@@ -44,14 +44,59 @@ REGAL_GLOBAL_BEGIN
 
 #include <GL/Regal.h>
 
+#include <map>
+#include <string>
+
+#include "RegalSharedMap.h"
+
 REGAL_GLOBAL_END
 
 REGAL_NAMESPACE_BEGIN
 
+struct RegalContext;
+struct DispatchTableGL;
+
 namespace Cache {
 
   void shaderSource(PFNGLSHADERSOURCEPROC proc, GLuint shader, GLsizei count, const GLchar * const * string, const GLint *length);
 
+#if REGAL_CACHE
+
+  // Program binary caching
+  //
+  // At glLinkProgram the attached shader sources, attribute bindings
+  // and driver identity are hashed.  On a hit the cached binary is
+  // loaded with glProgramBinary, and the driver compile and link are
+  // skipped.  On a miss the linked binary is written to the cache.
+  //
+  // glCompileShader is deferred until link time, or until the compile
+  // status or info log is queried.
+
+  struct Programs
+  {
+    Programs();
+
+    void Init(RegalContext &ctx);
+
+    bool   enabled;       // Program binaries supported and caching enabled
+    bool   oes;           // OES_get_program_binary entry points
+    GLuint driver;        // Hash of vendor, renderer and version strings
+
+    // Shared with the share group
+
+    shared_map<GLuint, bool>                                deferred;
+    shared_map<GLuint, ::std::map< ::std::string, GLuint> > bindings;
+  };
+
+  void compileShader     (RegalContext &ctx, DispatchTableGL &tbl, GLuint shader);
+  void compileDeferred   (RegalContext &ctx, DispatchTableGL &tbl, GLuint shader);
+  void deleteShader      (RegalContext &ctx, DispatchTableGL &tbl, GLuint shader);
+  void bindAttribLocation(RegalContext &ctx, DispatchTableGL &tbl, GLuint program, GLuint index, const GLchar *name);
+  void deleteProgram     (RegalContext &ctx, DispatchTableGL &tbl, GLuint program);
+  void linkProgram       (RegalContext &ctx, DispatchTableGL &tbl, GLuint program);
+
+#endif
+
 };
 
 REGAL_NAMESPACE_END
@@ -43,12 +43,15 @@ REGAL_GLOBAL_BEGIN
 
 #include "RegalConfig.h"
 #include "RegalToken.h"
+#include "RegalContext.h"
+#include "RegalContextInfo.h"
+#include "RegalDispatch.h"
+#include "RegalWorker.h"
 #include "RegalCacheTexture.h"
-#include "RegalScopedPtr.h"
-
-#include <lookup3.h>           // 32-bit memory hashing function
+#include "RegalCachePack.h"
 
 #include <string>
+#include <vector>
 #include <boost/print/print_string.hpp>
 
 #if !REGAL_NO_PNG
@@ -58,6 +61,7 @@ REGAL_GLOBAL_BEGIN
 
 using namespace ::std;
 using ::boost::print::print_string;
+using ::boost::uint64_t;
 
 REGAL_GLOBAL_END
 
@@ -65,137 +69,350 @@ REGAL_NAMESPACE_BEGIN
 
 namespace Cache {
 
+#if REGAL_CACHE
+
+using namespace Thread;
+
+#if !REGAL_NO_PNG
+static void
+pngWrite(png_structp pngPtr, png_bytep data, png_size_t length)
+{
+  vector<char> *buffer = static_cast<vector<char> *>(png_get_io_ptr(pngPtr));
+  buffer->insert(buffer->end(), data, data + length);
+}
+
 static void
-cacheTextureTarget(PFNGLGETTEXLEVELPARAMETERIVPROC getTexLevelProc, PFNGLGETTEXIMAGEPROC getTexImageProc, GLenum target)
+pngFlush(png_structp pngPtr)
 {
-  RegalAssert(getTexLevelProc);
-  RegalAssert(getTexImageProc);
+  UNUSED_PARAMETER(pngPtr);
+}
+#endif
 
-  if (REGAL_CACHE && REGAL_CACHE_TEXTURE && Config::cache && Config::cacheTexture)
+//
+// Capture - RGBA pixels of a texture, hashed and written on a worker thread
+//
+
+struct Capture : public Thread::Task
+{
+  Capture(GLenum target, GLint width, GLint height)
+  : target(target), width(width), height(height)
   {
-    // Query the texture dimensions
-    // TODO: Query the internal format and channels too?
+  }
 
-    GLint width = 0;
-    GLint height = 0;
+  void run();
 
-    getTexLevelProc(target, 0, GL_TEXTURE_WIDTH,  &width);
-    getTexLevelProc(target, 0, GL_TEXTURE_HEIGHT, &height);
+  GLenum       target;
+  GLint        width;
+  GLint        height;
+  vector<char> pixels;
+};
 
-    const GLint size = width*height;
-    const GLint bytes = size*4;
+void
+Capture::run()
+{
+  // Compute 64-bit key of the dimensions and data
 
-    Internal("Regal::CacheTexture::texture","width=",width," height=",height);
+  const uint64_t key = packKey("texture", &pixels[0], pixels.size(), (uint64_t(width)<<32) | uint64_t(height));
+  Pack &pack = Pack::instance();
 
-    if (!width || !height)
-      return;
+  Info("glBindTexture(",Token::GLenumToString(target),") width=",width," height=",height," key=",boost::print::hex(key));
 
-    // Fetch the RGBA texture data
-    // TODO: Handle packing alignment...
+  // Cache it to the pack as .png, iff it's not there yet
 
-    scoped_array<GLbyte> buffer(new GLbyte [bytes]);
+  if (pack.contains(key))
+  {
+    vector<char>().swap(pixels);
+    return;
+  }
 
-    getTexImageProc(target,0,GL_RGBA,GL_UNSIGNED_BYTE,buffer.get());
+#if !REGAL_NO_PNG
+  static png_color_8 pngSBIT = {8, 8, 8, 0, 8};
 
-    // Compute 32-bit hash
+  vector<char> png;
+  {
+    png_structp pngPtr = png_create_write_struct(PNG_LIBPNG_VER_STRING,NULL,NULL,NULL);
+    if (pngPtr)
+    {
+      png_infop pngInfo = png_create_info_struct(pngPtr);
+      if (pngInfo)
+      {
+        png_set_write_fn(pngPtr, &png, pngWrite, pngFlush);
+
+        // Z_NO_COMPRESSION, Z_BEST_SPEED, Z_BEST_COMPRESSION,
+        // Z_DEFAULT_COMPRESSION
+
+        png_set_compression_level(pngPtr, Config::cacheTextureCompression);
+        png_set_IHDR(pngPtr, pngInfo, width, height,
+                     8, PNG_COLOR_TYPE_RGBA, PNG_INTERLACE_NONE,
+                     PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+        png_set_pHYs(pngPtr, pngInfo, 72 * 40, 72 * 40, PNG_RESOLUTION_METER);
+        png_set_sBIT(pngPtr, pngInfo, &pngSBIT);
+        png_write_info(pngPtr, pngInfo);
+        for (int y = height; y--; )
+          png_write_row(pngPtr, reinterpret_cast<png_byte *>(&pixels[0] + y * width * 4));
+        png_write_end(pngPtr, pngInfo);
+      }
+      png_destroy_write_struct(&pngPtr, &pngInfo);
+    }
+  }
 
-    uint32_t hash = 0;
-    hash = Lookup3::hashlittle(buffer.get(), bytes, hash);
+  if (png.size() && pack.insert(key, &png[0], png.size()))
+  {
+    Internal("Regal::CacheTexture::texture"," key=",boost::print::hex(key)," written.");
+    Info("Cached texture written: ",boost::print::hex(key));
+  }
+#endif
 
-    string filename = makePath(Config::cacheDirectory,print_string(boost::print::hex(hash),".png"));
+  vector<char>().swap(pixels);
+}
 
-    Info("glBindTexture(",Token::GLenumToString(target),") width=",width," height=",height," hash=",boost::print::hex(hash));
+//
+// Textures
+//
 
-    // Cache it to disk, iff it's not there yet
-    // export REGAL_CACHE_TEXTURE_WRITE=1
+Textures::Textures()
+: enabled(false),
+  pixelBufferObject(false),
+  active(GL_TEXTURE0),
+  serial(0)
+{
+}
 
-    if (REGAL_CACHE_TEXTURE_WRITE && Config::cacheTextureWrite && !fileExists(filename.c_str()))
-    {
-#if !REGAL_NO_PNG
-      static png_color_8 pngSBIT = {8, 8, 8, 0, 8};
+Textures::~Textures()
+{
+  for (size_t i = 0; i < readbacks.size(); ++i)
+    delete readbacks[i].capture;
+  for (size_t i = 0; i < writes.size(); ++i)
+  {
+    Workers::instance().wait(writes[i]);
+    delete writes[i];
+  }
+}
 
-      FILE *fp = fopen(filename.c_str(), "wb");
-      if (fp)
-      {
-        png_structp pngPtr = png_create_write_struct(PNG_LIBPNG_VER_STRING,NULL,NULL,NULL);
-        if (pngPtr)
-        {
-          png_infop pngInfo = png_create_info_struct(pngPtr);
-          if (pngInfo)
-          {
-            png_init_io(pngPtr, fp);
-
-            // Z_NO_COMPRESSION, Z_BEST_SPEED, Z_BEST_COMPRESSION,
-            // Z_DEFAULT_COMPRESSION
-
-            png_set_compression_level(pngPtr, Z_BEST_COMPRESSION);
-            png_set_IHDR(pngPtr, pngInfo, width, height,
-                         8, PNG_COLOR_TYPE_RGBA, PNG_INTERLACE_NONE,
-                         PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
-            png_set_pHYs(pngPtr, pngInfo, 72 * 40, 72 * 40, PNG_RESOLUTION_METER);
-            png_set_sBIT(pngPtr, pngInfo, &pngSBIT);
-            png_write_info(pngPtr, pngInfo);
-            for (int y = height; y--; )
-              png_write_row(pngPtr, reinterpret_cast<png_byte *>(buffer.get() + y * width * 4));
-            png_write_end(pngPtr, pngInfo);
-          }
-          png_destroy_write_struct(&pngPtr, &pngInfo);
-        }
-        fclose(fp);
-
-        Internal("Regal::CacheTexture::texture"," hash=",boost::print::hex(hash)," filename=",filename," written.");
-        Info("Cached texture written: ",filename);
-      }
-      else
-      {
-        Warning("Could not write texture to file ",filename,", permissions problem?");
-      }
-#endif
+void
+Textures::Init(RegalContext &ctx)
+{
+  RegalAssert(ctx.info);
+
+  // Only write for now, reading the .png back is not supported
+
+  enabled = REGAL_CACHE_TEXTURE && REGAL_CACHE_TEXTURE_WRITE && Config::cache && Config::cacheTexture && Config::cacheTextureWrite;
+  pixelBufferObject = !ctx.info->es1 && !ctx.info->es2 && (ctx.info->gl_version_2_1 || ctx.info->gl_arb_pixel_buffer_object);
+
+  RegalContext *sharingWith = ctx.shareGroup->front();
+  if (sharingWith && sharingWith!=&ctx && sharingWith->textures)
+    captured = sharingWith->textures->captured;
+}
+
+void
+Textures::Cleanup(RegalContext &ctx)
+{
+  DispatchTableGL &tbl = ctx.dispatcher.front();
+
+  finishReadbacks(tbl,true);
+  if (buffers.size())
+    tbl.call(&tbl.glDeleteBuffers)(GLsizei(buffers.size()),&buffers[0]);
+  buffers.clear();
+
+  while (writes.size())
+  {
+    Workers::instance().wait(writes.front());
+    delete writes.front();
+    writes.pop_front();
+  }
+}
+
+void
+Textures::activeTexture(GLenum texture)
+{
+  active = texture;
+}
+
+void
+Textures::bindTexture(GLenum target, GLuint texture)
+{
+  bindings[std::make_pair(active,target)] = texture;
+}
+
+void
+Textures::modified(GLenum target)
+{
+  switch (target)
+  {
+    case GL_TEXTURE_CUBE_MAP_POSITIVE_X:
+    case GL_TEXTURE_CUBE_MAP_NEGATIVE_X:
+    case GL_TEXTURE_CUBE_MAP_POSITIVE_Y:
+    case GL_TEXTURE_CUBE_MAP_NEGATIVE_Y:
+    case GL_TEXTURE_CUBE_MAP_POSITIVE_Z:
+    case GL_TEXTURE_CUBE_MAP_NEGATIVE_Z:
+      target = GL_TEXTURE_CUBE_MAP;
+      break;
+    default:
+      break;
+  }
+
+  map<pair<GLenum,GLenum>, GLuint>::const_iterator i = bindings.find(std::make_pair(active,target));
+  captured.erase(i==bindings.end() ? 0 : i->second);
+}
+
+void
+Textures::deleteTextures(GLsizei n, const GLuint *textures)
+{
+  for (GLsizei i = 0; textures && i < n; ++i)
+    captured.erase(textures[i]);
+}
+
+void
+Textures::capture(DispatchTableGL &tbl, GLenum target)
+{
+  // Query the texture dimensions
+  // TODO: Query the internal format and channels too?
+
+  GLint width = 0;
+  GLint height = 0;
+
+  tbl.call(&tbl.glGetTexLevelParameteriv)(target, 0, GL_TEXTURE_WIDTH,  &width);
+  tbl.call(&tbl.glGetTexLevelParameteriv)(target, 0, GL_TEXTURE_HEIGHT, &height);
+
+  Internal("Regal::CacheTexture::texture","width=",width," height=",height);
+
+  if (width<=0 || height<=0)
+    return;
+
+  const size_t bytes = size_t(width)*height*4;
+  Capture *capture = new Capture(target,width,height);
+
+  // Fetch the RGBA texture data
+  // TODO: Handle packing alignment...
+
+  if (!pixelBufferObject)
+  {
+    capture->pixels.resize(bytes);
+    tbl.call(&tbl.glGetTexImage)(target,0,GL_RGBA,GL_UNSIGNED_BYTE,&capture->pixels[0]);
+    write(capture);
+    return;
+  }
+
+  Readback readback;
+  readback.capture = capture;
+  readback.serial  = serial;
+  readback.buffer  = 0;
+  if (buffers.size())
+  {
+    readback.buffer = buffers.back();
+    buffers.pop_back();
+  }
+  else
+    tbl.call(&tbl.glGenBuffers)(1,&readback.buffer);
+
+  GLint packBuffer = 0;
+  tbl.call(&tbl.glGetIntegerv)(GL_PIXEL_PACK_BUFFER_BINDING,&packBuffer);
+  tbl.call(&tbl.glBindBuffer)(GL_PIXEL_PACK_BUFFER,readback.buffer);
+  tbl.call(&tbl.glBufferData)(GL_PIXEL_PACK_BUFFER,bytes,NULL,GL_STREAM_READ);
+  tbl.call(&tbl.glGetTexImage)(target,0,GL_RGBA,GL_UNSIGNED_BYTE,NULL);
+  tbl.call(&tbl.glBindBuffer)(GL_PIXEL_PACK_BUFFER,packBuffer);
+
+  readbacks.push_back(readback);
+}
+
+void
+Textures::finishReadbacks(DispatchTableGL &tbl, bool all)
+{
+  // Map readbacks issued at least READBACK_LATENCY binds ago, by
+  // which time the copy has usually completed.
+
+  if (readbacks.empty() || (!all && readbacks.front().serial + READBACK_LATENCY > serial))
+    return;
+
+  GLint packBuffer = 0;
+  tbl.call(&tbl.glGetIntegerv)(GL_PIXEL_PACK_BUFFER_BINDING,&packBuffer);
+
+  while (readbacks.size() && (all || readbacks.front().serial + READBACK_LATENCY <= serial))
+  {
+    Readback readback = readbacks.front();
+    readbacks.pop_front();
+
+    Capture *capture = readback.capture;
+    const size_t bytes = size_t(capture->width)*capture->height*4;
+
+    tbl.call(&tbl.glBindBuffer)(GL_PIXEL_PACK_BUFFER,readback.buffer);
+    const char *data = static_cast<const char *>(tbl.call(&tbl.glMapBuffer)(GL_PIXEL_PACK_BUFFER,GL_READ_ONLY));
+    if (data)
+    {
+      capture->pixels.assign(data,data+bytes);
+      tbl.call(&tbl.glUnmapBuffer)(GL_PIXEL_PACK_BUFFER);
+      write(capture);
     }
     else
-    {
-      // Read from disk cache, if reading is enabled
-      // export REGAL_CACHE_TEXTURE_READ=1
+      delete capture;
 
-      if (REGAL_CACHE_TEXTURE_READ && Config::cacheTextureRead)
-      {
-#if !REGAL_NO_PNG
-        // TODO
-#endif
-        return;
-      }
-    }
+    buffers.push_back(readback.buffer);
   }
+
+  tbl.call(&tbl.glBindBuffer)(GL_PIXEL_PACK_BUFFER,packBuffer);
 }
 
 void
-bindTexture(PFNGLBINDTEXTUREPROC bindTextureProc, PFNGLGETTEXLEVELPARAMETERIVPROC getTexLevelProc, PFNGLGETTEXIMAGEPROC getTexImageProc, GLenum target, GLuint texture)
+Textures::write(Capture *capture)
 {
-  RegalAssert(bindTextureProc);
-  RegalAssert(getTexLevelProc);
-  RegalAssert(getTexImageProc);
+  Workers &workers = Workers::instance();
+
+  // Bounded, wait for the oldest if need be
+
+  while (writes.size() >= MAX_WRITES)
+  {
+    workers.wait(writes.front());
+    delete writes.front();
+    writes.pop_front();
+  }
+
+  writes.push_back(capture);
+  workers.submit(capture);
+}
 
-  bindTextureProc(target,texture);
+#endif // REGAL_CACHE
+
+void
+bindTexture(RegalContext &ctx, DispatchTableGL &tbl, GLenum target, GLuint texture)
+{
+  tbl.call(&tbl.glBindTexture)(target,texture);
 
   Internal("Cache::BindTexture(",Token::GLenumToString(target),",",texture,")");
 
+#if REGAL_CACHE
+  Textures *textures = ctx.textures.get();
+  if (!textures || !textures->enabled)
+    return;
+
+  ++textures->serial;
+  textures->finishReadbacks(tbl,false);
+
+  // Once per version of each texture
+
+  if (!texture || textures->captured.count(texture))
+    return;
+  textures->captured[texture] = true;
+
   switch (target)
   {
     case GL_TEXTURE_CUBE_MAP:
-      cacheTextureTarget(getTexLevelProc,getTexImageProc,GL_TEXTURE_CUBE_MAP_POSITIVE_X);
-      cacheTextureTarget(getTexLevelProc,getTexImageProc,GL_TEXTURE_CUBE_MAP_NEGATIVE_X);
-      cacheTextureTarget(getTexLevelProc,getTexImageProc,GL_TEXTURE_CUBE_MAP_POSITIVE_Y);
-      cacheTextureTarget(getTexLevelProc,getTexImageProc,GL_TEXTURE_CUBE_MAP_NEGATIVE_Y);
-      cacheTextureTarget(getTexLevelProc,getTexImageProc,GL_TEXTURE_CUBE_MAP_POSITIVE_Z);
-      cacheTextureTarget(getTexLevelProc,getTexImageProc,GL_TEXTURE_CUBE_MAP_NEGATIVE_Z);
+      textures->capture(tbl,GL_TEXTURE_CUBE_MAP_POSITIVE_X);
+      textures->capture(tbl,GL_TEXTURE_CUBE_MAP_NEGATIVE_X);
+      textures->capture(tbl,GL_TEXTURE_CUBE_MAP_POSITIVE_Y);
+      textures->capture(tbl,GL_TEXTURE_CUBE_MAP_NEGATIVE_Y);
+      textures->capture(tbl,GL_TEXTURE_CUBE_MAP_POSITIVE_Z);
+      textures->capture(tbl,GL_TEXTURE_CUBE_MAP_NEGATIVE_Z);
       break;
 
     // TODO - arrays, etc
 
     default:
-      cacheTextureTarget(getTexLevelProc,getTexImageProc,target);
+      textures->capture(tbl,target);
       break;
   }
+#else
+  UNUSED_PARAMETER(ctx);
+#endif
 }
 
 };
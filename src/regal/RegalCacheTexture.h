@@ -44,15 +44,81 @@ REGAL_GLOBAL_BEGIN
 
 #include <GL/Regal.h>
 
+#include <map>
+#include <deque>
+#include <vector>
+
+#include "RegalSharedMap.h"
+
 REGAL_GLOBAL_END
 
 REGAL_NAMESPACE_BEGIN
 
+struct RegalContext;
+struct DispatchTableGL;
+
+namespace Thread { struct Task; }
+
 namespace Cache {
 
+#if REGAL_CACHE
+
+  struct Capture;
+
+  // Texture capture, per context
+  //
+  // Each texture is captured once per version, an upload to a texture
+  // makes it eligible again.  The readback goes through a pixel buffer
+  // object where supported, which is mapped a few binds later.  Hashing,
+  // .png encoding and writing to the pack happen on the worker threads,
+  // with at most MAX_WRITES in flight.
+
+  struct Textures
+  {
+    enum { MAX_WRITES = 16, READBACK_LATENCY = 4 };
+
+    Textures();
+    ~Textures();
+
+    void Init(RegalContext &ctx);
+    void Cleanup(RegalContext &ctx);
+
+    // Shadowed by the cache dispatch layer
+
+    void activeTexture(GLenum texture);
+    void bindTexture(GLenum target, GLuint texture);
+    void modified(GLenum target);
+    void deleteTextures(GLsizei n, const GLuint *textures);
+
+    // Readback of the bound texture, and the pipeline after it
+
+    void capture(DispatchTableGL &tbl, GLenum target);
+    void finishReadbacks(DispatchTableGL &tbl, bool all);
+    void write(Capture *capture);
+
+    struct Readback
+    {
+      GLuint   buffer;
+      Capture *capture;
+      size_t   serial;
+    };
+
+    bool                                        enabled;
+    bool                                        pixelBufferObject;
+    GLenum                                      active;
+    ::std::map< ::std::pair<GLenum,GLenum>, GLuint> bindings;
+    shared_map<GLuint, bool>                    captured;
+    ::std::deque<Readback>                      readbacks;
+    ::std::vector<GLuint>                       buffers;
+    ::std::deque<Thread::Task *>                writes;
+    size_t                                      serial;
+  };
+
+#endif
+
   // glBindTexture handler
 
-  void bindTexture(PFNGLBINDTEXTUREPROC bindTextureProc, PFNGLGETTEXLEVELPARAMETERIVPROC getTexLevelProc, PFNGLGETTEXIMAGEPROC getTexImageProc, GLenum target, GLuint texture);
+  void bindTexture(RegalContext &ctx, DispatchTableGL &tbl, GLenum target, GLuint texture);
 
 };
 
@@ -0,0 +1,128 @@
+/*
+  Copyright (c) 2011-2013 NVIDIA Corporation
+  Copyright (c) 2013 Mark Adams
+  Copyright (c) 2013 Nigel Stewart
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+  OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+  OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+
+ Regal buffered output for RegalDispatchCode
+
+ */
+
+#include "pch.h" /* For MS precompiled header support */
+
+#include "RegalUtil.h"
+
+REGAL_GLOBAL_BEGIN
+
+#include "RegalCode.h"
+#include "RegalLog.h"
+#include "RegalLogSink.h"
+
+REGAL_GLOBAL_END
+
+REGAL_NAMESPACE_BEGIN
+
+namespace Code
+{
+
+Output::Output(size_t blockSize)
+: _file(NULL)
+, _sink(NULL)
+, _size(0)
+{
+  _buffer.resize(blockSize);
+}
+
+Output::~Output()
+{
+  close();
+}
+
+bool
+Output::open(const std::string &filename)
+{
+  close();
+
+  _file = fopen(filename.c_str(),"wt");
+  if (!_file)
+    return false;
+
+  // The ring holds a few blocks, so that the context only waits
+  // for the writer when the disk can't keep up
+
+  _sink = new Logging::Sink(consume,commit,this,_buffer.size()*8);
+  _sink->start();
+  return true;
+}
+
+void
+Output::close()
+{
+  if (!_file)
+    return;
+
+  flush();
+  delete _sink;
+  _sink = NULL;
+  fclose(_file);
+  _file = NULL;
+}
+
+void
+Output::flush()
+{
+  if (_size)
+    write(&_buffer[0],_size);
+  _size = 0;
+}
+
+void
+Output::write(const char *data, size_t size)
+{
+  if (_sink)
+    _sink->push(0,data,size);
+}
+
+void
+Output::consume(void *user, unsigned int kind, const char *data, size_t size)
+{
+  UNUSED_PARAMETER(kind);
+  Output *output = static_cast<Output *>(user);
+  fwrite(data,1,size,output->_file);
+}
+
+void
+Output::commit(void *user)
+{
+  Output *output = static_cast<Output *>(user);
+  fflush(output->_file);
+}
+
+}
+
+REGAL_NAMESPACE_END
+
@@ -0,0 +1,125 @@
+/*
+  Copyright (c) 2011-2013 NVIDIA Corporation
+  Copyright (c) 2013 Mark Adams
+  Copyright (c) 2013 Nigel Stewart
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+  OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+  OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+
+ Regal buffered output for RegalDispatchCode
+
+ */
+
+#ifndef __REGAL_CODE_H__
+#define __REGAL_CODE_H__
+
+#include "RegalUtil.h"
+
+REGAL_GLOBAL_BEGIN
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <boost/print/interface.hpp>
+
+REGAL_GLOBAL_END
+
+REGAL_NAMESPACE_BEGIN
+
+namespace Logging { struct Sink; }
+
+namespace Code
+{
+  //
+  // Output
+  //
+  // Generated code is formatted straight into a buffer of the context,
+  // with the boost::print length and write of each value, so that the
+  // common path makes no heap allocations.  Full buffers are written to
+  // the file by the writer thread of a log sink, in blocks of blockSize.
+  //
+
+  struct Output
+  {
+  public:
+    Output(size_t blockSize = 256*1024);
+    ~Output();
+
+    bool open(const std::string &filename);
+    void close();                       // Writes out everything so far
+
+    inline bool isOpen() const { return _file!=NULL; }
+
+    void flush();                       // Pass the buffer to the writer
+
+    template<typename I>
+    Output &
+    operator<<(I i)
+    {
+      const size_t size = ::boost::print::extend::length(i);
+      if (_size + size > _buffer.size())
+      {
+        flush();
+        if (size > _buffer.size())
+        {
+          large(i,size);
+          return *this;
+        }
+      }
+      char *j = &_buffer[_size];
+      ::boost::print::extend::write(j,i);
+      _size += size;
+      return *this;
+    }
+
+  private:
+    template<typename I>
+    void large(const I &i, const size_t size)
+    {
+      std::vector<char> tmp(size);
+      char *j = &tmp[0];
+      ::boost::print::extend::write(j,i);
+      write(&tmp[0],size);
+    }
+
+    void write(const char *data, size_t size);
+
+    static void consume(void *user, unsigned int kind, const char *data, size_t size);
+    static void commit(void *user);
+
+    FILE              *_file;
+    Logging::Sink     *_sink;
+    std::vector<char>  _buffer;
+    size_t             _size;
+
+    Output(const Output &other);
+    Output &operator=(const Output &other);
+  };
+}
+
+REGAL_NAMESPACE_END
+
+#endif
@@ -117,6 +117,9 @@ namespace Config {
 
   int  frameLimit          = 0;  // Unlimited
 
+  bool frameTiming         = false;
+  int  frameTimingWindow   = 100;
+
   bool frameMd5Color       = false;
   bool frameMd5Stencil     = false;
   bool frameMd5Depth       = false;
@@ -125,6 +128,8 @@ namespace Config {
   unsigned char frameMd5StencilMask = std::numeric_limits<unsigned char>::max();
   size_t        frameMd5DepthMask   = std::numeric_limits<size_t       >::max();
 
+  bool frameHashFast       = false;
+
   bool frameSaveColor             = false;
   bool frameSaveStencil           = false;
   bool frameSaveDepth             = false;
@@ -135,6 +140,18 @@ namespace Config {
   ::std::string frameSaveStencilPrefix("stencil_");
   ::std::string frameSaveDepthPrefix  ("depth_");
 
+  int  frameCompression           = 1;  // Z_BEST_SPEED
+
+  bool          xferRecode16      = false;
+  bool          asyncTextureUpload = false;
+
+  int           workerThreads     = 2;
+
+  int           glslMemoSize      = 4096;
+  bool          glslArena         = true;
+  ::std::string glslBakeFile;
+  bool          glslAlphaUniform  = false;
+
   bool          cache             = REGAL_CACHE;
   bool          cacheShader       = false;
   bool          cacheShaderRead   = false;
@@ -142,7 +159,9 @@ namespace Config {
   bool          cacheTexture      = false;
   bool          cacheTextureRead  = false;
   bool          cacheTextureWrite = false;
+  int           cacheTextureCompression = 9;
   ::std::string cacheDirectory("./");
+  bool          cacheCompact      = false;
 
 #if REGAL_CODE
   ::std::string codeSourceFile("code.cpp");
@@ -153,6 +172,9 @@ namespace Config {
 #endif
 
   ::std::string traceFile;
+  bool          traceAsync = false;
+  int           traceRing = 0;
+  int           traceRingHitch = 0;
 
   bool          enableThreadLocking = REGAL_THREAD_LOCKING;
 
@@ -279,6 +301,8 @@ namespace Config {
     //
 
     getEnv( "REGAL_FRAME_LIMIT",      frameLimit);
+    getEnv( "REGAL_FRAME_TIMING",     frameTiming);
+    getEnv( "REGAL_FRAME_TIMING_WINDOW", frameTimingWindow);
 
     //
 
@@ -288,15 +312,33 @@ namespace Config {
     getEnv( "REGAL_MD5_COLOR_MASK",   frameMd5ColorMask);
     getEnv( "REGAL_MD5_STENCIL_MASK", frameMd5StencilMask);
     getEnv( "REGAL_MD5_DEPTH_MASK",   frameMd5DepthMask);
+    getEnv( "REGAL_MD5_FAST",         frameHashFast);
 
     //
 
     getEnv( "REGAL_SAVE_COLOR",    frameSaveColor);
     getEnv( "REGAL_SAVE_STENCIL",  frameSaveStencil);
     getEnv( "REGAL_SAVE_DEPTH",    frameSaveDepth);
+    getEnv( "REGAL_SAVE_COMPRESSION", frameCompression);
 
     getEnv( "REGAL_FRAME_CAPTURE", frameCapture);
 
+    // Pixel transfer
+
+    getEnv( "REGAL_XFER_RECODE16", xferRecode16);
+    getEnv( "REGAL_ASYNC_TEXTURE_UPLOAD", asyncTextureUpload);
+
+    // Worker threads
+
+    getEnv( "REGAL_WORKER_THREADS", workerThreads);
+
+    // GLSL optimizer
+
+    getEnv( "REGAL_GLSL_MEMO_SIZE", glslMemoSize);
+    getEnv( "REGAL_GLSL_ARENA",     glslArena);
+    getEnv( "REGAL_GLSL_BAKE_FILE", glslBakeFile);
+    getEnv( "REGAL_GLSL_ALPHA_UNIFORM", glslAlphaUniform);
+
     // Caching
 
 #if REGAL_CACHE
@@ -313,14 +355,19 @@ namespace Config {
     getEnv( "REGAL_CACHE_TEXTURE",       cacheTexture,      REGAL_CACHE_TEXTURE);
     getEnv( "REGAL_CACHE_TEXTURE_WRITE", cacheTextureWrite, REGAL_CACHE_TEXTURE_WRITE);
     getEnv( "REGAL_CACHE_TEXTURE_READ",  cacheTextureRead,  REGAL_CACHE_TEXTURE_READ);
+    getEnv( "REGAL_CACHE_TEXTURE_COMPRESSION", cacheTextureCompression);
 
     getEnv( "REGAL_CACHE_DIRECTORY", cacheDirectory );
+    getEnv( "REGAL_CACHE_COMPACT",   cacheCompact );
 #endif
 
     getEnv( "REGAL_CODE_SOURCE", codeSourceFile, REGAL_CODE);
     getEnv( "REGAL_CODE_HEADER", codeHeaderFile, REGAL_CODE);
 
     getEnv( "REGAL_TRACE_FILE", traceFile, REGAL_TRACE);
+    getEnv( "REGAL_TRACE_ASYNC", traceAsync, REGAL_TRACE);
+    getEnv( "REGAL_TRACE_RING", traceRing, REGAL_TRACE);
+    getEnv( "REGAL_TRACE_RING_HITCH", traceRingHitch, REGAL_TRACE);
 
 #if REGAL_THREAD_LOCKING
     getEnv( "REGAL_THREAD_LOCKING", enableThreadLocking );
@@ -423,19 +470,42 @@ namespace Config {
     Info("REGAL_FORCE_EMU_TEXC      ", forceEmuTexC        ? "enabled" : "disabled");
 
     Info("REGAL_FRAME_LIMIT         ", frameLimit                                  );
+    Info("REGAL_FRAME_TIMING        ", frameTiming         ? "enabled" : "disabled");
+    Info("REGAL_FRAME_TIMING_WINDOW ", frameTimingWindow                           );
 
     Info("REGAL_MD5_COLOR           ", frameMd5Color       ? "enabled" : "disabled");
     Info("REGAL_MD5_STENCIL         ", frameMd5Stencil     ? "enabled" : "disabled");
     Info("REGAL_MD5_DEPTH           ", frameMd5Depth       ? "enabled" : "disabled");
+    Info("REGAL_MD5_FAST            ", frameHashFast       ? "enabled" : "disabled");
 
     Info("REGAL_SAVE_COLOR          ", frameSaveColor      ? "enabled" : "disabled");
     Info("REGAL_SAVE_STENCIL        ", frameSaveStencil    ? "enabled" : "disabled");
     Info("REGAL_SAVE_DEPTH          ", frameSaveDepth      ? "enabled" : "disabled");
+    Info("REGAL_SAVE_COMPRESSION    ", frameCompression                            );
+
+#if REGAL_EMU_XFER
+    Info("REGAL_XFER_RECODE16       ", xferRecode16        ? "enabled" : "disabled");
+#endif
+
+#if REGAL_EMU_TEXC
+    Info("REGAL_ASYNC_TEXTURE_UPLOAD ", asyncTextureUpload ? "enabled" : "disabled");
+#endif
+
+    Info("REGAL_WORKER_THREADS      ", workerThreads                               );
+
+#if REGAL_GLSL_OPTIMIZER
+    Info("REGAL_GLSL_MEMO_SIZE      ", glslMemoSize                                );
+    Info("REGAL_GLSL_ARENA          ", glslArena           ? "enabled" : "disabled");
+#endif
+    Info("REGAL_GLSL_BAKE_FILE      ", glslBakeFile                                );
+    Info("REGAL_GLSL_ALPHA_UNIFORM  ", glslAlphaUniform    ? "enabled" : "disabled");
 
 #if REGAL_CACHE
     Info("REGAL_CACHE               ", cache               ? "enabled" : "disabled");
     Info("REGAL_CACHE_TEXTURE       ", cacheTexture        ? "enabled" : "disabled");
     Info("REGAL_CACHE_TEXTURE_WRITE ", cacheTextureWrite   ? "enabled" : "disabled");
+    Info("REGAL_CACHE_TEXTURE_COMPRESSION ", cacheTextureCompression);
+    Info("REGAL_CACHE_COMPACT       ", cacheCompact        ? "enabled" : "disabled");
 #endif
 
 #if REGAL_CODE
@@ -445,6 +515,9 @@ namespace Config {
 
 #if REGAL_TRACE
     Info("REGAL_TRACE_FILE          ", traceFile                                   );
+    Info("REGAL_TRACE_ASYNC         ", traceAsync          ? "enabled" : "disabled");
+    Info("REGAL_TRACE_RING          ", traceRing                                   );
+    Info("REGAL_TRACE_RING_HITCH    ", traceRingHitch                              );
 #endif
 
     Info("REGAL_THREAD_LOCKING      ", enableThreadLocking ? "enabled" : "disabled");
@@ -547,10 +620,15 @@ namespace Config {
 
       jo.object("frame");
         jo.member("limit",     frameLimit);
+        jo.object("timing");
+          jo.member("enable",  frameTiming);
+          jo.member("window",  frameTimingWindow);
+        jo.end();
         jo.object("md5");
           jo.member("color",   frameMd5Color);
           jo.member("stencil", frameMd5Stencil);
           jo.member("depth",   frameMd5Depth);
+          jo.member("fast",    frameHashFast);
           jo.object("mask");
             jo.member("color",   frameMd5ColorMask);
             jo.member("stencil", frameMd5StencilMask);
@@ -568,9 +646,29 @@ namespace Config {
             jo.member("stencil", frameSaveStencilPrefix);
             jo.member("depth",   frameSaveDepthPrefix);
           jo.end();
+          jo.member("compression", frameCompression);
         jo.end();
       jo.end();
 
+      jo.object("xfer");
+        jo.member("recode16",     xferRecode16);
+      jo.end();
+
+      jo.object("texc");
+        jo.member("asyncUpload",  asyncTextureUpload);
+      jo.end();
+
+      jo.object("workers");
+        jo.member("threads",      workerThreads);
+      jo.end();
+
+      jo.object("glsl");
+        jo.member("memoSize",     glslMemoSize);
+        jo.member("arena",        glslArena);
+        jo.member("bakeFile",     glslBakeFile);
+        jo.member("alphaUniform", glslAlphaUniform);
+      jo.end();
+
       jo.object("cache");
         jo.member("enable",       cache);
         jo.member("shader",       cacheShader);
@@ -579,11 +677,16 @@ namespace Config {
         jo.member("texture",      cacheShader);
         jo.member("textureWrite", cacheShaderWrite);
         jo.member("textureRead",  cacheShaderRead);
+        jo.member("textureCompression", cacheTextureCompression);
         jo.member("directory",    cacheDirectory);
+        jo.member("compact",      cacheCompact);
       jo.end();
 
       jo.object("trace");
         jo.member("file",         traceFile);
+        jo.member("async",        traceAsync);
+        jo.member("ring",         traceRing);
+        jo.member("ringHitch",    traceRingHitch);
       jo.end();
 
     jo.end();
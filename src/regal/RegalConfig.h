@@ -135,6 +135,9 @@ namespace Config
 
   extern int  frameLimit;        // Maximum number of frames
 
+  extern bool frameTiming;       // CPU and GPU frame timing
+  extern int  frameTimingWindow; // Frames per timing report
+
   extern bool frameMd5Color;     // Log md5 hash of color buffer
   extern bool frameMd5Stencil;
   extern bool frameMd5Depth;
@@ -143,6 +146,8 @@ namespace Config
   extern unsigned char frameMd5StencilMask; //
   extern size_t        frameMd5DepthMask;   //
 
+  extern bool frameHashFast;     // Log a non-cryptographic hash instead of md5
+
   extern bool frameSaveColor;    // Save color buffer to PNG file
   extern bool frameSaveStencil;
   extern bool frameSaveDepth;
@@ -151,8 +156,26 @@ namespace Config
   extern ::std::string frameSaveStencilPrefix;
   extern ::std::string frameSaveDepthPrefix;
 
+  extern int  frameCompression;  // zlib level of saved PNGs
+
   extern bool frameCapture;                   // Capture files and md5sums for other functions too
 
+  // Pixel transfer
+
+  extern bool          xferRecode16;   // Store decompressed S3TC textures as RGB565, RGBA4444 or RGBA5551
+  extern bool          asyncTextureUpload;   // Convert and upload textures on worker threads, before the next draw
+
+  // Worker threads
+
+  extern int           workerThreads;
+
+  // GLSL optimizer
+
+  extern int           glslMemoSize;   // KB of optimized shader source to keep in memory, 0 to disable
+  extern bool          glslArena;      // Allocate each shader's IR from a single arena
+  extern ::std::string glslBakeFile;   // Table of optimized shaders written by regalbake
+  extern bool          glslAlphaUniform; // Alpha test function from a uniform, one program instance for all
+
   // Caching
 
   extern bool          cache;
@@ -162,7 +185,9 @@ namespace Config
   extern bool          cacheTexture;
   extern bool          cacheTextureRead;
   extern bool          cacheTextureWrite;
+  extern int           cacheTextureCompression;
   extern ::std::string cacheDirectory;
+  extern bool          cacheCompact;
 
   // Code dispatch
 
@@ -172,6 +197,9 @@ namespace Config
   // Trace
 
   extern ::std::string traceFile;
+  extern bool          traceAsync;      // compress and write on a background thread
+  extern int           traceRing;       // frames kept in memory until triggered, 0 to write everything
+  extern int           traceRingHitch;  // ms per frame that triggers a ring dump, 0 to disable
 
   // Thread locking
 
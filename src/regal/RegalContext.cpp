@@ -54,9 +54,14 @@ REGAL_GLOBAL_BEGIN
 #include "RegalDebugInfo.h"
 #include "RegalContextInfo.h"
 #include "RegalStatistics.h"
+#include "RegalCode.h"
 
 #include "RegalMarker.h"
 #include "RegalFrame.h"
+#if REGAL_CACHE
+#include "RegalCacheShader.h"
+#include "RegalCacheTexture.h"
+#endif
 #if REGAL_EMULATION
 #include "RegalObj.h"
 #include "RegalHint.h"
@@ -94,6 +99,10 @@ RegalContext::RegalContext()
 #if REGAL_FRAME
   frame(NULL),
 #endif /* REGAL_FRAME */
+#if REGAL_CACHE
+  programs(NULL),
+  textures(NULL),
+#endif
 #if REGAL_EMULATION
   emuLevel(0),
   obj(NULL),
@@ -190,6 +199,19 @@ RegalContext::Init()
   }
   #endif /* REGAL_FRAME */
 
+  #if REGAL_CACHE
+  if (!programs)
+  {
+    programs = new Cache::Programs;
+    programs->Init(*this);
+  }
+  if (!textures)
+  {
+    textures = new Cache::Textures;
+    textures->Init(*this);
+  }
+  #endif
+
 #if REGAL_EMULATION
 
 #if !REGAL_FORCE_EMULATION
@@ -480,16 +502,27 @@ RegalContext::Init()
   {
     if (Config::codeSourceFile.length())
     {
-      codeSource = fopen(Config::codeSourceFile.c_str(),"wt");
-      if (!codeSource)
+      codeSource = new Code::Output();
+      if (!codeSource->open(Config::codeSourceFile))
+      {
         Warning("Failed to open file ",Config::codeSourceFile," for writing code source.");
+        delete codeSource;
+        codeSource = NULL;
+      }
     }
     if (Config::codeHeaderFile.length())
     {
       if (Config::codeHeaderFile==Config::codeSourceFile)
         codeHeader = codeSource;
       else
-        codeHeader = fopen(Config::codeHeaderFile.c_str(),"wt");
+      {
+        codeHeader = new Code::Output();
+        if (!codeHeader->open(Config::codeHeaderFile))
+        {
+          delete codeHeader;
+          codeHeader = NULL;
+        }
+      }
       if (!codeHeader)
         Warning("Failed to open file ",Config::codeHeaderFile," for writing code header.");
     }
@@ -528,11 +561,10 @@ RegalContext::~RegalContext()
   shareGroup->remove(this);
 
 #if REGAL_CODE
-  if (codeSource)
-    fclose(codeSource);
+  if (codeHeader!=codeSource)
+    delete codeHeader;
 
-  if (codeHeader)
-    fclose(codeHeader);
+  delete codeSource;
 #endif
 }
 
@@ -545,6 +577,16 @@ RegalContext::Cleanup()
 {
   Internal("RegalContext::Cleanup","()");
 
+#if REGAL_CACHE
+  if (textures)
+    textures->Cleanup(*this);
+#endif
+
+#if REGAL_FRAME
+  if (frame)
+    frame->Cleanup(*this);
+#endif
+
 #if REGAL_EMULATION
   // emu
   #if REGAL_EMU_OBJ
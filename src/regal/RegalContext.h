@@ -69,6 +69,10 @@ struct EmuInfo;
 struct DebugInfo;
 struct Statistics;
 
+#if REGAL_CODE
+namespace Code { struct Output; };
+#endif
+
 struct Marker;
 struct Frame;
 #if REGAL_EMULATION
@@ -89,6 +93,10 @@ namespace Emu { struct Vao; };
 namespace Emu { struct TexC; };
 namespace Emu { struct Filt; };
 #endif
+#if REGAL_CACHE
+namespace Cache { struct Programs; };
+namespace Cache { struct Textures; };
+#endif
 
 struct RegalContext
 {
@@ -141,6 +149,10 @@ struct RegalContext
 #if REGAL_FRAME
   scoped_ptr<Frame             > frame;
 #endif /* REGAL_FRAME */
+#if REGAL_CACHE
+  scoped_ptr<Cache::Programs   > programs;
+  scoped_ptr<Cache::Textures   > textures;
+#endif
 #if REGAL_EMULATION
   // Fixed function emulation
   int emuLevel;
@@ -206,8 +218,8 @@ struct RegalContext
   // For RegalDispatchCode
 
 #if REGAL_CODE
-  FILE               *codeSource;
-  FILE               *codeHeader;
+  Code::Output       *codeSource;
+  Code::Output       *codeHeader;      // May be the same as codeSource
   size_t              codeInputNext;
   size_t              codeOutputNext;
   size_t              codeShaderNext;  // glCreateShader/glCreateShaderObjectARB
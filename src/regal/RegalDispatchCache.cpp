@@ -37,7 +37,7 @@
 
 #include "RegalUtil.h"
 
-#if REGAL_CACHE && REGAL_CACHE_SHADER
+#if REGAL_CACHE
 
 REGAL_GLOBAL_BEGIN
 
@@ -46,26 +46,236 @@ REGAL_GLOBAL_BEGIN
 #include "RegalContext.h"
 #include "RegalDispatcher.h"
 #include "RegalCacheShader.h"
+#include "RegalCacheTexture.h"
 
 REGAL_GLOBAL_END
 
 REGAL_NAMESPACE_BEGIN
 
+#if REGAL_CACHE_SHADER
+
 static void REGAL_CALL cache_glShaderSource(GLuint shader, GLsizei count, const GLchar * const * string, const GLint *length)
 {
   RegalContext *_context = REGAL_GET_CONTEXT();
   RegalAssert(_context);
   DispatchTableGL *_next = _context->dispatcher.cache.next();
   RegalAssert(_next);
+  Cache::compileDeferred(*_context, *_next, shader);
   if (Config::cache && Config::cacheShader)
     Cache::shaderSource(_next->call(&_next->glShaderSource), shader, count, string, length);
   else
     _next->call(&_next->glShaderSource)(shader, count, string, length);
 }
 
+static void REGAL_CALL cache_glCompileShader(GLuint shader)
+{
+  RegalContext *_context = REGAL_GET_CONTEXT();
+  RegalAssert(_context);
+  DispatchTableGL *_next = _context->dispatcher.cache.next();
+  RegalAssert(_next);
+  Cache::compileShader(*_context, *_next, shader);
+}
+
+static void REGAL_CALL cache_glGetShaderiv(GLuint shader, GLenum pname, GLint *params)
+{
+  RegalContext *_context = REGAL_GET_CONTEXT();
+  RegalAssert(_context);
+  DispatchTableGL *_next = _context->dispatcher.cache.next();
+  RegalAssert(_next);
+  if (pname==GL_COMPILE_STATUS || pname==GL_INFO_LOG_LENGTH)
+    Cache::compileDeferred(*_context, *_next, shader);
+  _next->call(&_next->glGetShaderiv)(shader, pname, params);
+}
+
+static void REGAL_CALL cache_glGetShaderInfoLog(GLuint shader, GLsizei bufSize, GLsizei *length, GLchar *infoLog)
+{
+  RegalContext *_context = REGAL_GET_CONTEXT();
+  RegalAssert(_context);
+  DispatchTableGL *_next = _context->dispatcher.cache.next();
+  RegalAssert(_next);
+  Cache::compileDeferred(*_context, *_next, shader);
+  _next->call(&_next->glGetShaderInfoLog)(shader, bufSize, length, infoLog);
+}
+
+static void REGAL_CALL cache_glDeleteShader(GLuint shader)
+{
+  RegalContext *_context = REGAL_GET_CONTEXT();
+  RegalAssert(_context);
+  DispatchTableGL *_next = _context->dispatcher.cache.next();
+  RegalAssert(_next);
+  Cache::deleteShader(*_context, *_next, shader);
+}
+
+static void REGAL_CALL cache_glBindAttribLocation(GLuint program, GLuint index, const GLchar *name)
+{
+  RegalContext *_context = REGAL_GET_CONTEXT();
+  RegalAssert(_context);
+  DispatchTableGL *_next = _context->dispatcher.cache.next();
+  RegalAssert(_next);
+  Cache::bindAttribLocation(*_context, *_next, program, index, name);
+}
+
+static void REGAL_CALL cache_glDeleteProgram(GLuint program)
+{
+  RegalContext *_context = REGAL_GET_CONTEXT();
+  RegalAssert(_context);
+  DispatchTableGL *_next = _context->dispatcher.cache.next();
+  RegalAssert(_next);
+  Cache::deleteProgram(*_context, *_next, program);
+}
+
+static void REGAL_CALL cache_glLinkProgram(GLuint program)
+{
+  RegalContext *_context = REGAL_GET_CONTEXT();
+  RegalAssert(_context);
+  DispatchTableGL *_next = _context->dispatcher.cache.next();
+  RegalAssert(_next);
+  Cache::linkProgram(*_context, *_next, program);
+}
+
+#endif // REGAL_CACHE_SHADER
+
+#if REGAL_CACHE_TEXTURE
+
+// Texture bindings and uploads, for capturing each version of a texture once
+
+static void REGAL_CALL cache_glActiveTexture(GLenum texture)
+{
+  RegalContext *_context = REGAL_GET_CONTEXT();
+  RegalAssert(_context);
+  DispatchTableGL *_next = _context->dispatcher.cache.next();
+  RegalAssert(_next);
+  if (_context->textures)
+    _context->textures->activeTexture(texture);
+  _next->call(&_next->glActiveTexture)(texture);
+}
+
+static void REGAL_CALL cache_glBindTexture(GLenum target, GLuint texture)
+{
+  RegalContext *_context = REGAL_GET_CONTEXT();
+  RegalAssert(_context);
+  DispatchTableGL *_next = _context->dispatcher.cache.next();
+  RegalAssert(_next);
+  if (_context->textures)
+    _context->textures->bindTexture(target, texture);
+  _next->call(&_next->glBindTexture)(target, texture);
+}
+
+static void REGAL_CALL cache_glDeleteTextures(GLsizei n, const GLuint *textures)
+{
+  RegalContext *_context = REGAL_GET_CONTEXT();
+  RegalAssert(_context);
+  DispatchTableGL *_next = _context->dispatcher.cache.next();
+  RegalAssert(_next);
+  if (_context->textures)
+    _context->textures->deleteTextures(n, textures);
+  _next->call(&_next->glDeleteTextures)(n, textures);
+}
+
+static void REGAL_CALL cache_glTexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const GLvoid *pixels)
+{
+  RegalContext *_context = REGAL_GET_CONTEXT();
+  RegalAssert(_context);
+  DispatchTableGL *_next = _context->dispatcher.cache.next();
+  RegalAssert(_next);
+  if (_context->textures)
+    _context->textures->modified(target);
+  _next->call(&_next->glTexImage2D)(target, level, internalformat, width, height, border, format, type, pixels);
+}
+
+static void REGAL_CALL cache_glTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const GLvoid *pixels)
+{
+  RegalContext *_context = REGAL_GET_CONTEXT();
+  RegalAssert(_context);
+  DispatchTableGL *_next = _context->dispatcher.cache.next();
+  RegalAssert(_next);
+  if (_context->textures)
+    _context->textures->modified(target);
+  _next->call(&_next->glTexSubImage2D)(target, level, xoffset, yoffset, width, height, format, type, pixels);
+}
+
+static void REGAL_CALL cache_glCopyTexImage2D(GLenum target, GLint level, GLenum internalformat, GLint x, GLint y, GLsizei width, GLsizei height, GLint border)
+{
+  RegalContext *_context = REGAL_GET_CONTEXT();
+  RegalAssert(_context);
+  DispatchTableGL *_next = _context->dispatcher.cache.next();
+  RegalAssert(_next);
+  if (_context->textures)
+    _context->textures->modified(target);
+  _next->call(&_next->glCopyTexImage2D)(target, level, internalformat, x, y, width, height, border);
+}
+
+static void REGAL_CALL cache_glCopyTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint x, GLint y, GLsizei width, GLsizei height)
+{
+  RegalContext *_context = REGAL_GET_CONTEXT();
+  RegalAssert(_context);
+  DispatchTableGL *_next = _context->dispatcher.cache.next();
+  RegalAssert(_next);
+  if (_context->textures)
+    _context->textures->modified(target);
+  _next->call(&_next->glCopyTexSubImage2D)(target, level, xoffset, yoffset, x, y, width, height);
+}
+
+static void REGAL_CALL cache_glCompressedTexImage2D(GLenum target, GLint level, GLenum internalformat, GLsizei width, GLsizei height, GLint border, GLsizei imageSize, const GLvoid *data)
+{
+  RegalContext *_context = REGAL_GET_CONTEXT();
+  RegalAssert(_context);
+  DispatchTableGL *_next = _context->dispatcher.cache.next();
+  RegalAssert(_next);
+  if (_context->textures)
+    _context->textures->modified(target);
+  _next->call(&_next->glCompressedTexImage2D)(target, level, internalformat, width, height, border, imageSize, data);
+}
+
+static void REGAL_CALL cache_glCompressedTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLsizei imageSize, const GLvoid *data)
+{
+  RegalContext *_context = REGAL_GET_CONTEXT();
+  RegalAssert(_context);
+  DispatchTableGL *_next = _context->dispatcher.cache.next();
+  RegalAssert(_next);
+  if (_context->textures)
+    _context->textures->modified(target);
+  _next->call(&_next->glCompressedTexSubImage2D)(target, level, xoffset, yoffset, width, height, format, imageSize, data);
+}
+
+static void REGAL_CALL cache_glGenerateMipmap(GLenum target)
+{
+  RegalContext *_context = REGAL_GET_CONTEXT();
+  RegalAssert(_context);
+  DispatchTableGL *_next = _context->dispatcher.cache.next();
+  RegalAssert(_next);
+  if (_context->textures)
+    _context->textures->modified(target);
+  _next->call(&_next->glGenerateMipmap)(target);
+}
+
+#endif // REGAL_CACHE_TEXTURE
+
 void InitDispatchTableCache(DispatchTableGL &tbl)
 {
-  tbl.glShaderSource = cache_glShaderSource;
+#if REGAL_CACHE_SHADER
+  tbl.glShaderSource       = cache_glShaderSource;
+  tbl.glCompileShader      = cache_glCompileShader;
+  tbl.glGetShaderiv        = cache_glGetShaderiv;
+  tbl.glGetShaderInfoLog   = cache_glGetShaderInfoLog;
+  tbl.glDeleteShader       = cache_glDeleteShader;
+  tbl.glBindAttribLocation = cache_glBindAttribLocation;
+  tbl.glDeleteProgram      = cache_glDeleteProgram;
+  tbl.glLinkProgram        = cache_glLinkProgram;
+#endif
+
+#if REGAL_CACHE_TEXTURE
+  tbl.glActiveTexture           = cache_glActiveTexture;
+  tbl.glBindTexture             = cache_glBindTexture;
+  tbl.glDeleteTextures          = cache_glDeleteTextures;
+  tbl.glTexImage2D              = cache_glTexImage2D;
+  tbl.glTexSubImage2D           = cache_glTexSubImage2D;
+  tbl.glCopyTexImage2D          = cache_glCopyTexImage2D;
+  tbl.glCopyTexSubImage2D       = cache_glCopyTexSubImage2D;
+  tbl.glCompressedTexImage2D    = cache_glCompressedTexImage2D;
+  tbl.glCompressedTexSubImage2D = cache_glCompressedTexSubImage2D;
+  tbl.glGenerateMipmap          = cache_glGenerateMipmap;
+#endif
 }
 
 REGAL_NAMESPACE_END
@@ -6566,6 +6566,14 @@ static void REGAL_CALL emu_glGetTexImage(GLenum target, GLint level, GLenum form
     case 4 :
     case 3 :
     case 2 :
+      #if REGAL_EMU_TEXC
+      if (_context->texc)
+      {
+        Push<int> pushLevel(_context->emuLevel);
+        _context->emuLevel = 1;
+        _context->texc->FlushUploads( *_context, target, level );
+      }
+      #endif
     case 1 :
       #if REGAL_EMU_FILTER
       if (_context->filt) break;
@@ -17156,6 +17164,7 @@ static void REGAL_CALL emu_glTexImage2D(GLenum target, GLint level, GLint intern
       {
         Push<int> pushLevel(_context->emuLevel);
         _context->emuLevel = 1;
+        _context->texc->FlushUploads( *_context, target, level );
         _context->texc->ShadowTexImage2D( target, level, format, type );
       }
       #endif
@@ -19402,6 +19411,14 @@ static void REGAL_CALL emu_glBindTexture(GLenum target, GLuint texture)
     case 13 :
     case 12 :
     case 11 :
+      #if REGAL_EMU_XFER
+      if (_context->xfer)
+      {
+        Push<int> pushLevel(_context->emuLevel);
+        _context->emuLevel = 10;
+        _context->xfer->ShadowBindTexture( target, texture );
+      }
+      #endif
     case 10 :
     case 9 :
     case 8 :
@@ -19661,6 +19678,16 @@ static void REGAL_CALL emu_glCopyTexImage2D(GLenum target, GLint level, GLenum i
         _context->iff->ShadowTexInfo( target, internalformat );
       }
       #endif
+    case 3 :
+    case 2 :
+      #if REGAL_EMU_TEXC
+      if (_context->texc)
+      {
+        Push<int> pushLevel(_context->emuLevel);
+        _context->emuLevel = 1;
+        _context->texc->FlushUploads( *_context, target, level );
+      }
+      #endif
     case 1 :
     default:
       break;
@@ -19729,6 +19756,7 @@ static void REGAL_CALL emu_glDeleteTextures(GLsizei n, const GLuint *textures)
       {
         Push<int> pushLevel(_context->emuLevel);
         _context->emuLevel = 1;
+        _context->texc->FlushUploads( *_context );
         _context->texc->ShadowDeleteTextures( n, textures );
       }
       #endif
@@ -19920,6 +19948,16 @@ static void REGAL_CALL emu_glDrawArrays(GLenum mode, GLint first, GLsizei count)
         _context->dsa->Restore( _context );
       }
       #endif
+    case 3 :
+    case 2 :
+      #if REGAL_EMU_TEXC
+      if (_context->texc)
+      {
+        Push<int> pushLevel(_context->emuLevel);
+        _context->emuLevel = 1;
+        _context->texc->FlushUploads( *_context );
+      }
+      #endif
     case 1 :
     default:
       break;
@@ -20012,6 +20050,16 @@ static void REGAL_CALL emu_glDrawElements(GLenum mode, GLsizei count, GLenum typ
         _context->dsa->Restore( _context );
       }
       #endif
+    case 3 :
+    case 2 :
+      #if REGAL_EMU_TEXC
+      if (_context->texc)
+      {
+        Push<int> pushLevel(_context->emuLevel);
+        _context->emuLevel = 1;
+        _context->texc->FlushUploads( *_context );
+      }
+      #endif
     case 1 :
     default:
       break;
@@ -20888,6 +20936,9 @@ static void REGAL_CALL emu_glTexSubImage2D(GLenum target, GLint level, GLint xof
         Push<int> pushLevel(_context->emuLevel);
         _context->emuLevel = 1;
 
+        if ( _context->texc->QueueTexSubImage2D( *_context, target, level, xoffset, yoffset, width, height, format, type, pixels ) )
+          return;
+        _context->texc->FlushUploads( *_context, target, level );
         GLenum targetFormat;
         GLenum targetType;
         _context->texc->GetFormatAndType( target, level, &targetFormat, &targetType );
@@ -21084,6 +21135,14 @@ static void REGAL_CALL emu_glDrawRangeElements(GLenum mode, GLuint start, GLuint
     case 4 :
     case 3 :
     case 2 :
+      #if REGAL_EMU_TEXC
+      if (_context->texc)
+      {
+        Push<int> pushLevel(_context->emuLevel);
+        _context->emuLevel = 1;
+        _context->texc->FlushUploads( *_context );
+      }
+      #endif
     case 1 :
       #if REGAL_EMU_FILTER
       if (_context->filt) break;
@@ -21488,6 +21547,16 @@ static void REGAL_CALL emu_glCompressedTexImage2D(GLenum target, GLint level, GL
       #if REGAL_EMU_XFER
       if (_context->xfer) break;
       #endif
+    case 3 :
+    case 2 :
+      #if REGAL_EMU_TEXC
+      if (_context->texc)
+      {
+        Push<int> pushLevel(_context->emuLevel);
+        _context->emuLevel = 1;
+        _context->texc->FlushUploads( *_context, target, level );
+      }
+      #endif
     case 1 :
     default:
       break;
@@ -21542,6 +21611,16 @@ static void REGAL_CALL emu_glCompressedTexSubImage2D(GLenum target, GLint level,
       #if REGAL_EMU_XFER
       if (_context->xfer) break;
       #endif
+    case 3 :
+    case 2 :
+      #if REGAL_EMU_TEXC
+      if (_context->texc)
+      {
+        Push<int> pushLevel(_context->emuLevel);
+        _context->emuLevel = 1;
+        _context->texc->FlushUploads( *_context, target, level );
+      }
+      #endif
     case 1 :
     default:
       break;
@@ -24121,6 +24200,16 @@ static void REGAL_CALL emu_glMultiDrawArrays(GLenum mode, const GLint *first, co
         _context->dsa->Restore( _context );
       }
       #endif
+    case 3 :
+    case 2 :
+      #if REGAL_EMU_TEXC
+      if (_context->texc)
+      {
+        Push<int> pushLevel(_context->emuLevel);
+        _context->emuLevel = 1;
+        _context->texc->FlushUploads( *_context );
+      }
+      #endif
     case 1 :
     default:
       break;
@@ -24178,6 +24267,16 @@ static void REGAL_CALL emu_glMultiDrawElements(GLenum mode, const GLsizei *count
         _context->dsa->Restore( _context );
       }
       #endif
+    case 3 :
+    case 2 :
+      #if REGAL_EMU_TEXC
+      if (_context->texc)
+      {
+        Push<int> pushLevel(_context->emuLevel);
+        _context->emuLevel = 1;
+        _context->texc->FlushUploads( *_context );
+      }
+      #endif
     case 1 :
     default:
       break;
@@ -33155,6 +33254,16 @@ static void REGAL_CALL emu_glDrawArraysInstanced(GLenum mode, GLint first, GLsiz
         _context->dsa->Restore( _context );
       }
       #endif
+    case 3 :
+    case 2 :
+      #if REGAL_EMU_TEXC
+      if (_context->texc)
+      {
+        Push<int> pushLevel(_context->emuLevel);
+        _context->emuLevel = 1;
+        _context->texc->FlushUploads( *_context );
+      }
+      #endif
     case 1 :
     default:
       break;
@@ -33212,6 +33321,16 @@ static void REGAL_CALL emu_glDrawElementsInstanced(GLenum mode, GLsizei count, G
         _context->dsa->Restore( _context );
       }
       #endif
+    case 3 :
+    case 2 :
+      #if REGAL_EMU_TEXC
+      if (_context->texc)
+      {
+        Push<int> pushLevel(_context->emuLevel);
+        _context->emuLevel = 1;
+        _context->texc->FlushUploads( *_context );
+      }
+      #endif
     case 1 :
     default:
       break;
@@ -33562,6 +33681,16 @@ static void REGAL_CALL emu_glDrawArraysIndirect(GLenum mode, const GLvoid *indir
         _context->dsa->Restore( _context );
       }
       #endif
+    case 3 :
+    case 2 :
+      #if REGAL_EMU_TEXC
+      if (_context->texc)
+      {
+        Push<int> pushLevel(_context->emuLevel);
+        _context->emuLevel = 1;
+        _context->texc->FlushUploads( *_context );
+      }
+      #endif
     case 1 :
     default:
       break;
@@ -33619,6 +33748,16 @@ static void REGAL_CALL emu_glDrawElementsIndirect(GLenum mode, GLenum type, cons
         _context->dsa->Restore( _context );
       }
       #endif
+    case 3 :
+    case 2 :
+      #if REGAL_EMU_TEXC
+      if (_context->texc)
+      {
+        Push<int> pushLevel(_context->emuLevel);
+        _context->emuLevel = 1;
+        _context->texc->FlushUploads( *_context );
+      }
+      #endif
     case 1 :
     default:
       break;
@@ -33716,6 +33855,16 @@ static void REGAL_CALL emu_glMultiDrawArraysIndirectAMD(GLenum mode, const GLvoi
         _context->dsa->Restore( _context );
       }
       #endif
+    case 3 :
+    case 2 :
+      #if REGAL_EMU_TEXC
+      if (_context->texc)
+      {
+        Push<int> pushLevel(_context->emuLevel);
+        _context->emuLevel = 1;
+        _context->texc->FlushUploads( *_context );
+      }
+      #endif
     case 1 :
     default:
       break;
@@ -33773,6 +33922,16 @@ static void REGAL_CALL emu_glMultiDrawElementsIndirectAMD(GLenum mode, GLenum ty
         _context->dsa->Restore( _context );
       }
       #endif
+    case 3 :
+    case 2 :
+      #if REGAL_EMU_TEXC
+      if (_context->texc)
+      {
+        Push<int> pushLevel(_context->emuLevel);
+        _context->emuLevel = 1;
+        _context->texc->FlushUploads( *_context );
+      }
+      #endif
     case 1 :
     default:
       break;
@@ -33934,6 +34093,16 @@ static void REGAL_CALL emu_glDrawElementArrayAPPLE(GLenum mode, GLint first, GLs
         _context->dsa->Restore( _context );
       }
       #endif
+    case 3 :
+    case 2 :
+      #if REGAL_EMU_TEXC
+      if (_context->texc)
+      {
+        Push<int> pushLevel(_context->emuLevel);
+        _context->emuLevel = 1;
+        _context->texc->FlushUploads( *_context );
+      }
+      #endif
     case 1 :
     default:
       break;
@@ -33982,6 +34151,16 @@ static void REGAL_CALL emu_glDrawRangeElementArrayAPPLE(GLenum mode, GLuint star
         _context->so->PreDraw( *_context );
       }
       #endif
+    case 3 :
+    case 2 :
+      #if REGAL_EMU_TEXC
+      if (_context->texc)
+      {
+        Push<int> pushLevel(_context->emuLevel);
+        _context->emuLevel = 1;
+        _context->texc->FlushUploads( *_context );
+      }
+      #endif
     case 1 :
     default:
       break;
@@ -34039,6 +34218,16 @@ static void REGAL_CALL emu_glMultiDrawElementArrayAPPLE(GLenum mode, const GLint
         _context->dsa->Restore( _context );
       }
       #endif
+    case 3 :
+    case 2 :
+      #if REGAL_EMU_TEXC
+      if (_context->texc)
+      {
+        Push<int> pushLevel(_context->emuLevel);
+        _context->emuLevel = 1;
+        _context->texc->FlushUploads( *_context );
+      }
+      #endif
     case 1 :
     default:
       break;
@@ -34087,6 +34276,16 @@ static void REGAL_CALL emu_glMultiDrawRangeElementArrayAPPLE(GLenum mode, GLuint
         _context->so->PreDraw( *_context );
       }
       #endif
+    case 3 :
+    case 2 :
+      #if REGAL_EMU_TEXC
+      if (_context->texc)
+      {
+        Push<int> pushLevel(_context->emuLevel);
+        _context->emuLevel = 1;
+        _context->texc->FlushUploads( *_context );
+      }
+      #endif
     case 1 :
     default:
       break;
@@ -34588,6 +34787,16 @@ static void REGAL_CALL emu_glDrawElementsBaseVertex(GLenum mode, GLsizei count,
         _context->dsa->Restore( _context );
       }
       #endif
+    case 3 :
+    case 2 :
+      #if REGAL_EMU_TEXC
+      if (_context->texc)
+      {
+        Push<int> pushLevel(_context->emuLevel);
+        _context->emuLevel = 1;
+        _context->texc->FlushUploads( *_context );
+      }
+      #endif
     case 1 :
     default:
       break;
@@ -34678,6 +34887,16 @@ static void REGAL_CALL emu_glDrawElementsInstancedBaseVertex(GLenum mode, GLsize
         _context->dsa->Restore( _context );
       }
       #endif
+    case 3 :
+    case 2 :
+      #if REGAL_EMU_TEXC
+      if (_context->texc)
+      {
+        Push<int> pushLevel(_context->emuLevel);
+        _context->emuLevel = 1;
+        _context->texc->FlushUploads( *_context );
+      }
+      #endif
     case 1 :
     default:
       break;
@@ -34762,6 +34981,14 @@ static void REGAL_CALL emu_glDrawRangeElementsBaseVertex(GLenum mode, GLuint sta
     case 4 :
     case 3 :
     case 2 :
+      #if REGAL_EMU_TEXC
+      if (_context->texc)
+      {
+        Push<int> pushLevel(_context->emuLevel);
+        _context->emuLevel = 1;
+        _context->texc->FlushUploads( *_context );
+      }
+      #endif
     case 1 :
       #if REGAL_EMU_FILTER
       if (_context->filt) break;
@@ -34888,6 +35115,16 @@ static void REGAL_CALL emu_glMultiDrawElementsBaseVertex(GLenum mode, const GLsi
         _context->dsa->Restore( _context );
       }
       #endif
+    case 3 :
+    case 2 :
+      #if REGAL_EMU_TEXC
+      if (_context->texc)
+      {
+        Push<int> pushLevel(_context->emuLevel);
+        _context->emuLevel = 1;
+        _context->texc->FlushUploads( *_context );
+      }
+      #endif
     case 1 :
     default:
       break;
@@ -34977,6 +35214,16 @@ static void REGAL_CALL emu_glDrawArraysInstancedARB(GLenum mode, GLint first, GL
         _context->dsa->Restore( _context );
       }
       #endif
+    case 3 :
+    case 2 :
+      #if REGAL_EMU_TEXC
+      if (_context->texc)
+      {
+        Push<int> pushLevel(_context->emuLevel);
+        _context->emuLevel = 1;
+        _context->texc->FlushUploads( *_context );
+      }
+      #endif
     case 1 :
     default:
       break;
@@ -35034,6 +35281,16 @@ static void REGAL_CALL emu_glDrawElementsInstancedARB(GLenum mode, GLsizei count
         _context->dsa->Restore( _context );
       }
       #endif
+    case 3 :
+    case 2 :
+      #if REGAL_EMU_TEXC
+      if (_context->texc)
+      {
+        Push<int> pushLevel(_context->emuLevel);
+        _context->emuLevel = 1;
+        _context->texc->FlushUploads( *_context );
+      }
+      #endif
     case 1 :
     default:
       break;
@@ -35807,6 +36064,7 @@ static void REGAL_CALL emu_glGenerateMipmap(GLenum target)
       {
         Push<int> pushLevel(_context->emuLevel);
         _context->emuLevel = 1;
+        _context->texc->FlushUploads( *_context );
         _context->texc->ShadowGenerateMipmap( target );
       }
       #endif
@@ -38074,6 +38332,16 @@ static void REGAL_CALL emu_glMultiDrawArraysIndirect(GLenum mode, const GLvoid *
         _context->dsa->Restore( _context );
       }
       #endif
+    case 3 :
+    case 2 :
+      #if REGAL_EMU_TEXC
+      if (_context->texc)
+      {
+        Push<int> pushLevel(_context->emuLevel);
+        _context->emuLevel = 1;
+        _context->texc->FlushUploads( *_context );
+      }
+      #endif
     case 1 :
     default:
       break;
@@ -38131,6 +38399,16 @@ static void REGAL_CALL emu_glMultiDrawElementsIndirect(GLenum mode, GLenum type,
         _context->dsa->Restore( _context );
       }
       #endif
+    case 3 :
+    case 2 :
+      #if REGAL_EMU_TEXC
+      if (_context->texc)
+      {
+        Push<int> pushLevel(_context->emuLevel);
+        _context->emuLevel = 1;
+        _context->texc->FlushUploads( *_context );
+      }
+      #endif
     case 1 :
     default:
       break;
@@ -43636,6 +43914,16 @@ static void REGAL_CALL emu_glCompressedTexImage2DARB(GLenum target, GLint level,
       #if REGAL_EMU_XFER
       if (_context->xfer) break;
       #endif
+    case 3 :
+    case 2 :
+      #if REGAL_EMU_TEXC
+      if (_context->texc)
+      {
+        Push<int> pushLevel(_context->emuLevel);
+        _context->emuLevel = 1;
+        _context->texc->FlushUploads( *_context, target, level );
+      }
+      #endif
     case 1 :
     default:
       break;
@@ -43690,6 +43978,16 @@ static void REGAL_CALL emu_glCompressedTexSubImage2DARB(GLenum target, GLint lev
       #if REGAL_EMU_XFER
       if (_context->xfer) break;
       #endif
+    case 3 :
+    case 2 :
+      #if REGAL_EMU_TEXC
+      if (_context->texc)
+      {
+        Push<int> pushLevel(_context->emuLevel);
+        _context->emuLevel = 1;
+        _context->texc->FlushUploads( *_context, target, level );
+      }
+      #endif
     case 1 :
     default:
       break;
@@ -48994,6 +49292,16 @@ static void REGAL_CALL emu_glDrawElementArrayATI(GLenum mode, GLsizei count)
         _context->dsa->Restore( _context );
       }
       #endif
+    case 3 :
+    case 2 :
+      #if REGAL_EMU_TEXC
+      if (_context->texc)
+      {
+        Push<int> pushLevel(_context->emuLevel);
+        _context->emuLevel = 1;
+        _context->texc->FlushUploads( *_context );
+      }
+      #endif
     case 1 :
     default:
       break;
@@ -49042,6 +49350,16 @@ static void REGAL_CALL emu_glDrawRangeElementArrayATI(GLenum mode, GLuint start,
         _context->so->PreDraw( *_context );
       }
       #endif
+    case 3 :
+    case 2 :
+      #if REGAL_EMU_TEXC
+      if (_context->texc)
+      {
+        Push<int> pushLevel(_context->emuLevel);
+        _context->emuLevel = 1;
+        _context->texc->FlushUploads( *_context );
+      }
+      #endif
     case 1 :
     default:
       break;
@@ -66273,6 +66591,16 @@ static void REGAL_CALL emu_glDrawArraysInstancedEXT(GLenum mode, GLint start, GL
         _context->dsa->Restore( _context );
       }
       #endif
+    case 3 :
+    case 2 :
+      #if REGAL_EMU_TEXC
+      if (_context->texc)
+      {
+        Push<int> pushLevel(_context->emuLevel);
+        _context->emuLevel = 1;
+        _context->texc->FlushUploads( *_context );
+      }
+      #endif
     case 1 :
     default:
       break;
@@ -66330,6 +66658,16 @@ static void REGAL_CALL emu_glDrawElementsInstancedEXT(GLenum mode, GLsizei count
         _context->dsa->Restore( _context );
       }
       #endif
+    case 3 :
+    case 2 :
+      #if REGAL_EMU_TEXC
+      if (_context->texc)
+      {
+        Push<int> pushLevel(_context->emuLevel);
+        _context->emuLevel = 1;
+        _context->texc->FlushUploads( *_context );
+      }
+      #endif
     case 1 :
     default:
       break;
@@ -66380,6 +66718,16 @@ static void REGAL_CALL emu_glDrawRangeElementsEXT(GLenum mode, GLuint start, GLu
         _context->so->PreDraw( *_context );
       }
       #endif
+    case 3 :
+    case 2 :
+      #if REGAL_EMU_TEXC
+      if (_context->texc)
+      {
+        Push<int> pushLevel(_context->emuLevel);
+        _context->emuLevel = 1;
+        _context->texc->FlushUploads( *_context );
+      }
+      #endif
     case 1 :
     default:
       break;
@@ -67594,6 +67942,7 @@ static void REGAL_CALL emu_glGenerateMipmapEXT(GLenum target)
       {
         Push<int> pushLevel(_context->emuLevel);
         _context->emuLevel = 1;
+        _context->texc->FlushUploads( *_context );
         _context->texc->ShadowGenerateMipmap( target );
       }
       #endif
@@ -68291,6 +68640,16 @@ static void REGAL_CALL emu_glMultiDrawArraysEXT(GLenum mode, const GLint *first,
         _context->dsa->Restore( _context );
       }
       #endif
+    case 3 :
+    case 2 :
+      #if REGAL_EMU_TEXC
+      if (_context->texc)
+      {
+        Push<int> pushLevel(_context->emuLevel);
+        _context->emuLevel = 1;
+        _context->texc->FlushUploads( *_context );
+      }
+      #endif
     case 1 :
     default:
       break;
@@ -68348,6 +68707,16 @@ static void REGAL_CALL emu_glMultiDrawElementsEXT(GLenum mode, const GLsizei *co
         _context->dsa->Restore( _context );
       }
       #endif
+    case 3 :
+    case 2 :
+      #if REGAL_EMU_TEXC
+      if (_context->texc)
+      {
+        Push<int> pushLevel(_context->emuLevel);
+        _context->emuLevel = 1;
+        _context->texc->FlushUploads( *_context );
+      }
+      #endif
     case 1 :
     default:
       break;
@@ -70002,6 +70371,7 @@ static void REGAL_CALL emu_glDeleteTexturesEXT(GLsizei n, const GLuint *textures
       {
         Push<int> pushLevel(_context->emuLevel);
         _context->emuLevel = 1;
+        _context->texc->FlushUploads( *_context );
         _context->texc->ShadowDeleteTextures( n, textures );
       }
       #endif
@@ -70461,6 +70831,16 @@ static void REGAL_CALL emu_glDrawArraysEXT(GLenum mode, GLint first, GLsizei cou
         _context->dsa->Restore( _context );
       }
       #endif
+    case 3 :
+    case 2 :
+      #if REGAL_EMU_TEXC
+      if (_context->texc)
+      {
+        Push<int> pushLevel(_context->emuLevel);
+        _context->emuLevel = 1;
+        _context->texc->FlushUploads( *_context );
+      }
+      #endif
     case 1 :
     default:
       break;
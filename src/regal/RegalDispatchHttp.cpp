@@ -55681,6 +55681,7 @@ static BOOL REGAL_CALL http_wglSwapBuffers(HDC hDC)
     if( _context ) {
       #if REGAL_HTTP
       _context->http.count.frame++;
+      _context->http.Frame( _context );
       switch( _context->http.runState ) {
          case RS_Run:
            break;
@@ -57866,6 +57867,7 @@ static void REGAL_CALL http_glXSwapBuffers(Display *dpy, GLXDrawable drawable)
     if( _context ) {
       #if REGAL_HTTP
       _context->http.count.frame++;
+      _context->http.Frame( _context );
       switch( _context->http.runState ) {
          case RS_Run:
            break;
@@ -60459,6 +60461,7 @@ static CGLError REGAL_CALL http_CGLFlushDrawable(CGLContextObj ctx)
     if( _context ) {
       #if REGAL_HTTP
       _context->http.count.frame++;
+      _context->http.Frame( _context );
       switch( _context->http.runState ) {
          case RS_Run:
            break;
@@ -62299,6 +62302,7 @@ static EGLBoolean REGAL_CALL http_eglSwapBuffers(EGLDisplay dpy, EGLSurface surf
     if( _context ) {
       #if REGAL_HTTP
       _context->http.count.frame++;
+      _context->http.Frame( _context );
       switch( _context->http.runState ) {
          case RS_Run:
            break;
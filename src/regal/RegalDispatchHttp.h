@@ -34,7 +34,6 @@ REGAL_GLOBAL_BEGIN
 #include <set>
 #include <map>
 #include <vector>
-#include <deque>
 #include <string>
 
 #if REGAL_HTTP
@@ -44,6 +43,7 @@ REGAL_GLOBAL_BEGIN
 #endif
 
 #include "RegalMutex.h"
+#include "RegalTimer.h"
 
 REGAL_GLOBAL_END
 
@@ -122,6 +122,14 @@ enum HttpRunState {
 
 struct DispatchTableGL;
 
+// One entry of the call log ring, the text is truncated to fit
+
+struct HttpCallRecord {
+  GLuint64 call;
+  GLuint   size;        // length of the untruncated call string
+  char     text[244];   // not NUL terminated
+};
+
 struct DispatchHttpState
 {
 public:
@@ -141,6 +149,8 @@ public:
   int currentBreakpoint;                         // -1 while not at breaktpoint
 
   void YieldToHttpServer( RegalContext * ctx, bool log = true );  // called by rendering thread
+  void Frame( RegalContext * ctx );                                // called by rendering thread at swap
+  void Request();                                                  // called by http server
 
   void AcquireAppContext( RegalContext * ctx );      // called by http server
   void ReleaseAppContext( RegalContext * ctx );      // called by http server
@@ -154,7 +164,16 @@ public:
   int stepOverGroupDepth;
   int inBeginEnd;
   std::string callString;
-  std::deque<std::string> callLog;
+  std::vector<HttpCallRecord> callLog;           // ring, call n is at n % callLog.size()
+
+  // The http layer is erased from the dispatch stack while no requests
+  // arrive, and inserted again at the next swap after one does.
+
+  bool attached;
+  bool appHoldsContext;
+  DispatchTableGL *attachBefore;
+  Timer timer;
+  volatile GLuint lastRequest;                   // milliseconds, from timer
 
   struct EventCount {
     EventCount() {
@@ -195,6 +214,19 @@ public:
     PFNGLGETTEXTUREPARAMETERFVEXTPROC GetTextureParameter;
     PFNGLGETUNIFORMLOCATIONPROC GetUniformLocation;
     PFNGLREADPIXELSPROC ReadPixels;
+
+    // pixel pack buffer readback
+
+    PFNGLFLUSHPROC Flush;
+    PFNGLGENBUFFERSPROC GenBuffers;
+    PFNGLDELETEBUFFERSPROC DeleteBuffers;
+    PFNGLBINDBUFFERPROC BindBuffer;
+    PFNGLBUFFERDATAPROC BufferData;
+    PFNGLMAPBUFFERRANGEPROC MapBufferRange;
+    PFNGLUNMAPBUFFERPROC UnmapBuffer;
+    PFNGLFENCESYNCPROC FenceSync;
+    PFNGLCLIENTWAITSYNCPROC ClientWaitSync;
+    PFNGLDELETESYNCPROC DeleteSync;
   };
 
   GlProcs gl;
@@ -46,6 +46,8 @@ REGAL_GLOBAL_END
 
 REGAL_NAMESPACE_BEGIN
 
+void (*DispatcherGL::driverInit)(DispatchTableGL &tbl) = NULL;
+
 DispatcherGL::DispatcherGL()
 : Dispatcher()
 {
@@ -108,7 +110,10 @@ DispatcherGL::DispatcherGL()
   ::memset(&driver,0,sizeof(DispatchTableGL));
   InitDispatchTablePpapi(driver);               // ES 2.0 functions only
   #else
-  Loader::Init(driver);                         // Desktop/ES2.0 lazy loader
+  if (driverInit)
+    driverInit(driver);                         // Supplied by the application
+  else
+    Loader::Init(driver);                       // Desktop/ES2.0 lazy loader
   #endif
   push_back(driver,Config::enableDriver);
   #endif
@@ -92,6 +92,11 @@ public:
   DispatcherGL();
   ~DispatcherGL();
 
+  // Replaces the driver loader for contexts created afterwards, for tools
+  // such as regalreplay that run without an OpenGL implementation.
+
+  static void (*driverInit)(DispatchTableGL &tbl);
+
   inline void push_back(DispatchTableGL &table, bool enable)
   {
     // Disabling the missing table would be bad!
@@ -36,7 +36,14 @@
 
 REGAL_GLOBAL_BEGIN
 
+#include <vector>
+#include <string>
+#include <algorithm>
+
+#include <boost/print/print_string.hpp>
+
 #include "md5.h"
+#include <lookup3.h>
 
 #if !REGAL_NO_PNG
 #include <zlib.h>
@@ -48,12 +55,173 @@ using ::boost::print::print_string;
 #endif
 
 #include "RegalFrame.h"
+#include "RegalWorker.h"
 #include "RegalStatistics.h"
 
 REGAL_GLOBAL_END
 
 REGAL_NAMESPACE_BEGIN
 
+using Thread::Workers;
+
+namespace {
+
+// Frames a readback stays in flight before it is mapped
+
+const size_t READBACK_FRAMES = 3;
+
+// Captures queued for the workers, before waiting for the oldest
+
+const size_t MAX_WRITES = 8;
+
+// Timestamp queries in flight, before frames go untimed on the GPU
+
+const size_t TIMING_QUERIES = 8;
+
+//
+// ColorCapture - RGBA pixels of a frame, saved and hashed on a worker thread
+//
+
+struct ColorCapture : public Thread::Task
+{
+  ColorCapture(size_t frame, GLint width, GLint height)
+  : frame(frame), width(width), height(height),
+    save(Config::frameSaveColor),
+    md5(Config::frameMd5Color),
+    fast(Config::frameHashFast),
+    mask(Config::frameMd5ColorMask),
+    compression(Config::frameCompression),
+    prefix(Config::frameSaveColorPrefix)
+  {
+  }
+
+  void run();
+
+  size_t        frame;
+  GLint         width;
+  GLint         height;
+  bool          save;
+  bool          md5;
+  bool          fast;
+  unsigned char mask;
+  int           compression;
+  std::string   prefix;
+  std::vector<GLubyte> pixels;
+};
+
+void
+ColorCapture::run()
+{
+  GLubyte *buffer = &pixels[0];
+  const size_t bufferSize = pixels.size();
+
+#if !REGAL_NO_PNG
+  if (save)
+  {
+    static png_color_8 pngSBIT = {8, 8, 8, 0, 8};
+
+    string filename = print_string(prefix,boost::print::right(frame,3,'0'),".png");
+    FILE *fp = fopen(filename.c_str(), "wb");
+    if (fp)
+    {
+      png_structp pngPtr = png_create_write_struct(PNG_LIBPNG_VER_STRING,NULL,NULL,NULL);
+      if (pngPtr)
+      {
+        png_infop pngInfo = png_create_info_struct(pngPtr);
+        if (pngInfo)
+        {
+          png_init_io(pngPtr, fp);
+
+          // Z_NO_COMPRESSION, Z_BEST_SPEED, Z_BEST_COMPRESSION,
+          // Z_DEFAULT_COMPRESSION
+
+          png_set_compression_level(pngPtr, compression);
+          png_set_IHDR(pngPtr, pngInfo, width, height,
+                       8, PNG_COLOR_TYPE_RGBA, PNG_INTERLACE_NONE,
+                       PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+          png_set_pHYs(pngPtr, pngInfo, 72 * 40, 72 * 40, PNG_RESOLUTION_METER);
+          png_set_sBIT(pngPtr, pngInfo, &pngSBIT);
+          png_write_info(pngPtr, pngInfo);
+          for (int y = height; y--; )
+            png_write_row(pngPtr, reinterpret_cast<png_byte *>(buffer + y * width * 4));
+          png_write_end(pngPtr, pngInfo);
+        }
+        png_destroy_write_struct(&pngPtr, &pngInfo);
+      }
+      fclose(fp);
+    }
+  }
+#endif
+
+  if (md5)
+  {
+    // Apply masking
+
+    if (mask!=0xff)
+      for (size_t i=0; i<bufferSize; ++i)
+        buffer[i] &= mask;
+
+    if (fast)
+    {
+      // Non-cryptographic, for comparing against golden images
+
+      uint32_t pc = 0;
+      uint32_t pb = 0;
+      Lookup3::hashlittle2(buffer,bufferSize,&pc,&pb);
+
+      char hash[17];
+      sprintf(hash,"%08x%08x",pb,pc);
+
+      Info("Color hash ",hash," frame ",frame);
+    }
+    else
+    {
+      // Compute pixel md5sum
+
+      MD5Context md5c;
+      MD5Init(&md5c);
+      MD5Update(&md5c, buffer, static_cast<unsigned int>(bufferSize));
+
+      unsigned char digest[16];
+      MD5Final(digest, &md5c);
+
+      // Convert md5sum to string
+
+      char md5sum[sizeof(digest)*2+1];
+      for (size_t i=0; i<sizeof(digest); ++i)
+        sprintf(md5sum+i*2,"%02x",digest[i]);
+
+      Info("Color md5sum ",md5sum," frame ",frame);
+    }
+  }
+
+  std::vector<GLubyte>().swap(pixels);
+}
+
+}
+
+Frame::~Frame()
+{
+  finishWrites();
+}
+
+void
+Frame::Cleanup(RegalContext &ctx)
+{
+  DispatchTableGL &tbl = ctx.dispatcher.front();
+
+  finishReadbacks(tbl);
+  for (size_t i = 0; i < readbacks.size(); ++i)
+    if (readbacks[i].buffer)
+      tbl.call(&tbl.glDeleteBuffers)(1,&readbacks[i].buffer);
+  readbacks.clear();
+  readbackNext = 0;
+
+  finishWrites();
+
+  timingQueryCleanup(tbl);
+}
+
 void Frame::capture(RegalContext &context,const bool frameTerminator)
 {
   Internal("Regal::Frame::capture context=",boost::print::optional(&context,Logging::pointers));
@@ -78,6 +246,11 @@ void Frame::capture(RegalContext &context,const bool frameTerminator)
 #endif
     }
 
+    if (Config::frameTiming)
+      timing(context);
+    else
+      timingStart = 0;
+
     if (Logging::frameStatistics)
     {
       #if REGAL_STATISTICS
@@ -115,93 +288,371 @@ void Frame::capture(RegalContext &context,const bool frameTerminator)
     if (width>0 && height>0)
     {
       if (Config::frameMd5Color || Config::frameSaveColor)
-      {
-        // Read the pixels as RGBA
+        readColor(context,*_next,width,height);
+    }
+  }
+
+  if (frameTerminator)
+  {
+    // Exit from the application if Config::frameLimit is reached,
+    // once the frames still in flight are written out.
+
+    if ( Config::frameLimit>0 && frame>=size_t(Config::frameLimit))
+    {
+      finishReadbacks(context.dispatcher.front());
+      finishWrites();
+      exit(0);
+    }
+  }
+}
 
-        const GLint bufferSize = width*height*4*sizeof(GLbyte);
-        GLbyte *buffer = (GLbyte *) calloc(bufferSize,1);
+void
+Frame::readColor(RegalContext &ctx, DispatchTableGL &tbl, GLint width, GLint height)
+{
+  if (!initialized)
+  {
+    RegalAssert(ctx.info);
+    pixelBufferObject = !ctx.info->es1 && !ctx.info->es2 && (ctx.info->gl_version_2_1 || ctx.info->gl_arb_pixel_buffer_object);
+    if (pixelBufferObject)
+      readbacks.resize(READBACK_FRAMES);
+    initialized = true;
+  }
 
-//       _next->call(&_next->glReadBuffer)(GL_FRONT);
-       _next->call(&_next->glReadPixels)(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, buffer);
+  const GLsizeiptr size = GLsizeiptr(width)*height*4;
 
-        // Do once we have the pixels, could we do the rest in another
-        // thread?
+  if (!pixelBufferObject)
+  {
+    // Read the pixels as RGBA, straight into client memory
 
-#if !REGAL_NO_PNG
-        if (Config::frameSaveColor)
-        {
-          static png_color_8 pngSBIT = {8, 8, 8, 0, 8};
-
-          string filename = print_string(Config::frameSaveColorPrefix,boost::print::right(frame,3,'0'),".png");
-          FILE *fp = fopen(filename.c_str(), "wb");
-          if (fp)
-          {
-            png_structp pngPtr = png_create_write_struct(PNG_LIBPNG_VER_STRING,NULL,NULL,NULL);
-            if (pngPtr)
-            {
-              png_infop pngInfo = png_create_info_struct(pngPtr);
-              if (pngInfo)
-              {
-                png_init_io(pngPtr, fp);
-
-                // Z_NO_COMPRESSION, Z_BEST_SPEED, Z_BEST_COMPRESSION,
-                // Z_DEFAULT_COMPRESSION
-
-                png_set_compression_level(pngPtr, Z_BEST_COMPRESSION);
-                png_set_IHDR(pngPtr, pngInfo, width, height,
-                             8, PNG_COLOR_TYPE_RGBA, PNG_INTERLACE_NONE,
-                             PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
-                png_set_pHYs(pngPtr, pngInfo, 72 * 40, 72 * 40, PNG_RESOLUTION_METER);
-                png_set_sBIT(pngPtr, pngInfo, &pngSBIT);
-                png_write_info(pngPtr, pngInfo);
-                for (int y = height; y--; )
-                  png_write_row(pngPtr, reinterpret_cast<png_byte *>(buffer + y * width * 4));
-                png_write_end(pngPtr, pngInfo);
-              }
-              png_destroy_write_struct(&pngPtr, &pngInfo);
-            }
-            fclose(fp);
-          }
-        }
-#endif
+    ColorCapture *capture = new ColorCapture(frame,width,height);
+    capture->pixels.resize(size);
+    tbl.call(&tbl.glReadPixels)(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, &capture->pixels[0]);
+    write(capture);
+    return;
+  }
 
-        if (Config::frameMd5Color)
-        {
-          // Apply masking
+  // The buffer next in the ring holds the oldest readback
 
-          for (GLint i=0; i<bufferSize; ++i)
-            buffer[i] &= Config::frameMd5ColorMask;
+  Readback &readback = readbacks[readbackNext];
+  readbackNext = (readbackNext + 1) % readbacks.size();
 
-          // Compute pixel md5sum
+  if (readback.pending)
+    finishReadback(tbl,readback);
 
-          MD5Context md5c;
-          MD5Init(&md5c);
-          MD5Update(&md5c, reinterpret_cast<const unsigned char *>(buffer), bufferSize);
+  GLint packBuffer = 0;
+  tbl.call(&tbl.glGetIntegerv)(GL_PIXEL_PACK_BUFFER_BINDING,&packBuffer);
 
-          unsigned char digest[16];
-          MD5Final(digest, &md5c);
+  if (!readback.buffer)
+    tbl.call(&tbl.glGenBuffers)(1,&readback.buffer);
+  tbl.call(&tbl.glBindBuffer)(GL_PIXEL_PACK_BUFFER,readback.buffer);
+  if (readback.size!=size)
+  {
+    tbl.call(&tbl.glBufferData)(GL_PIXEL_PACK_BUFFER,size,NULL,GL_STREAM_READ);
+    readback.size = size;
+  }
+  tbl.call(&tbl.glReadPixels)(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+  tbl.call(&tbl.glBindBuffer)(GL_PIXEL_PACK_BUFFER,packBuffer);
 
-          // Convert md5sum to string
+  readback.frame   = frame;
+  readback.width   = width;
+  readback.height  = height;
+  readback.pending = true;
+}
 
-          char md5sum[sizeof(digest)*2+1];
-          for (size_t i=0; i<sizeof(digest); ++i)
-            sprintf(md5sum+i*2,"%02x",digest[i]);
+void
+Frame::finishReadback(DispatchTableGL &tbl, Readback &readback)
+{
+  RegalAssert(readback.pending);
+  readback.pending = false;
 
-          Info("Color md5sum ",md5sum);
-        }
+  GLint packBuffer = 0;
+  tbl.call(&tbl.glGetIntegerv)(GL_PIXEL_PACK_BUFFER_BINDING,&packBuffer);
+  tbl.call(&tbl.glBindBuffer)(GL_PIXEL_PACK_BUFFER,readback.buffer);
 
-        free(buffer);
-      }
+  const GLubyte *data = static_cast<const GLubyte *>(tbl.call(&tbl.glMapBuffer)(GL_PIXEL_PACK_BUFFER,GL_READ_ONLY));
+  if (data)
+  {
+    ColorCapture *capture = new ColorCapture(readback.frame,readback.width,readback.height);
+    capture->pixels.assign(data,data+readback.size);
+    tbl.call(&tbl.glUnmapBuffer)(GL_PIXEL_PACK_BUFFER);
+    write(capture);
+  }
+
+  tbl.call(&tbl.glBindBuffer)(GL_PIXEL_PACK_BUFFER,packBuffer);
+}
+
+void
+Frame::finishReadbacks(DispatchTableGL &tbl)
+{
+  // Oldest first, so that captures are written in frame order
+
+  for (size_t i = 0; i < readbacks.size(); ++i)
+  {
+    Readback &readback = readbacks[(readbackNext + i) % readbacks.size()];
+    if (readback.pending)
+      finishReadback(tbl,readback);
+  }
+}
+
+void
+Frame::finishWrites()
+{
+  while (writes.size())
+  {
+    Workers::instance().wait(writes.front());
+    delete writes.front();
+    writes.pop_front();
+  }
+}
+
+void
+Frame::write(Thread::Task *task)
+{
+  Workers &workers = Workers::instance();
+
+  // Bounded, wait for the oldest if need be
+
+  while (writes.size() >= MAX_WRITES)
+  {
+    workers.wait(writes.front());
+    delete writes.front();
+    writes.pop_front();
+  }
+
+  writes.push_back(task);
+  workers.submit(task);
+}
+
+double
+Frame::Window::min() const
+{
+  return samples.size() ? *std::min_element(samples.begin(),samples.end()) : 0.0;
+}
+
+double
+Frame::Window::avg() const
+{
+  double sum = 0.0;
+  for (size_t i = 0; i < samples.size(); ++i)
+    sum += samples[i];
+  return samples.size() ? sum/samples.size() : 0.0;
+}
+
+// Nearest rank, so a window of 100 frames reports its second slowest
+
+double
+Frame::Window::p99() const
+{
+  if (samples.empty())
+    return 0.0;
+
+  std::vector<double> sorted(samples);
+  const size_t rank = (sorted.size()*99 + 99)/100;
+  std::nth_element(sorted.begin(),sorted.begin()+(rank-1),sorted.end());
+  return sorted[rank-1];
+}
+
+std::string
+Frame::timingJSON() const
+{
+  Thread::ScopedLock lock(&timingMutex);
+  return timingReport;
+}
+
+void
+Frame::timing(RegalContext &ctx)
+{
+  const Timer::Value now = timingTimer.now();
+
+  if (timingStart)
+  {
+    const Timer::Value elapsed = now - timingStart;
+    const Timer::Value inside  = std::min(timingRegal,elapsed);
+    timingFrame .push(elapsed*0.001);
+    timingInside.push(inside*0.001);
+    timingApp   .push((elapsed-inside)*0.001);
+  }
+
+  timingStart = now;
+  timingRegal = 0;
+
+  timingQuery(ctx,ctx.dispatcher.front());
+
+  if (timingFrame.size() >= size_t(std::max(Config::frameTimingWindow,1)))
+    timingLog();
+}
+
+void
+Frame::timingQuery(RegalContext &ctx, DispatchTableGL &tbl)
+{
+  if (!queriesInitialized)
+  {
+    RegalAssert(ctx.info);
+    queryTimestamp = !ctx.info->es1 && !ctx.info->es2 && (ctx.info->gl_version_3_3 || ctx.info->gl_arb_timer_query);
+    queryDisjoint  = ctx.info->es2 && ctx.info->gl_ext_disjoint_timer_query;
+
+    // Timestamps are optional for EXT_disjoint_timer_query
+
+    if (queryDisjoint)
+    {
+      GLint bits = 0;
+      tbl.call(&tbl.glGetQueryivEXT)(GL_TIMESTAMP,GL_QUERY_COUNTER_BITS,&bits);
+      queryDisjoint = bits>0;
+    }
+
+    if (queryTimestamp || queryDisjoint)
+      queries.resize(TIMING_QUERIES);
+    queriesInitialized = true;
+  }
+
+  if (queries.empty())
+    return;
+
+  // Timestamps from either side of a disjoint operation, such as a
+  // change of GPU clock, can not be compared
+
+  if (queryDisjoint)
+  {
+    GLint disjoint = 0;
+    tbl.call(&tbl.glGetIntegerv)(GL_GPU_DISJOINT_EXT,&disjoint);
+    if (disjoint)
+    {
+      for (size_t i = 0; i < queries.size(); ++i)
+        queries[i].frame = 0;
+      queryLastFrame = 0;
     }
   }
 
-  if (frameTerminator)
+  // Collect the completed queries, oldest first, without waiting
+
+  for (size_t i = 0; i < queries.size(); ++i)
   {
-    // Exit from the application if Config::frameLimit is reached.
+    Query &query = queries[(queryNext + i) % queries.size()];
+    if (!query.pending)
+      continue;
 
-    if ( Config::frameLimit>0 && frame>=size_t(Config::frameLimit))
-      exit(0);
+    GLint    available = 0;
+    GLuint64 timestamp = 0;
+    if (queryDisjoint)
+    {
+      tbl.call(&tbl.glGetQueryObjectivEXT)(query.query,GL_QUERY_RESULT_AVAILABLE,&available);
+      if (!available)
+        break;
+      tbl.call(&tbl.glGetQueryObjectui64vEXT)(query.query,GL_QUERY_RESULT,&timestamp);
+    }
+    else
+    {
+      tbl.call(&tbl.glGetQueryObjectiv)(query.query,GL_QUERY_RESULT_AVAILABLE,&available);
+      if (!available)
+        break;
+      tbl.call(&tbl.glGetQueryObjectui64v)(query.query,GL_QUERY_RESULT,&timestamp);
+    }
+    query.pending = false;
+
+    if (query.frame && queryLastFrame && query.frame==queryLastFrame+1 && timestamp>queryLast)
+      timingGpu.push((timestamp-queryLast)*1.0e-6);
+
+    queryLast      = timestamp;
+    queryLastFrame = query.frame;
+  }
+
+  // With every query still in flight, leave this frame untimed
+  // rather than stall the pipeline
+
+  Query &query = queries[queryNext];
+  if (query.pending)
+    return;
+
+  if (queryDisjoint)
+  {
+    if (!query.query)
+      tbl.call(&tbl.glGenQueriesEXT)(1,&query.query);
+    tbl.call(&tbl.glQueryCounterEXT)(query.query,GL_TIMESTAMP);
+  }
+  else
+  {
+    if (!query.query)
+      tbl.call(&tbl.glGenQueries)(1,&query.query);
+    tbl.call(&tbl.glQueryCounter)(query.query,GL_TIMESTAMP);
   }
+
+  query.frame   = frame;
+  query.pending = true;
+  queryNext = (queryNext + 1) % queries.size();
+}
+
+void
+Frame::timingQueryCleanup(DispatchTableGL &tbl)
+{
+  for (size_t i = 0; i < queries.size(); ++i)
+    if (queries[i].query)
+    {
+      if (queryDisjoint)
+        tbl.call(&tbl.glDeleteQueriesEXT)(1,&queries[i].query);
+      else
+        tbl.call(&tbl.glDeleteQueries)(1,&queries[i].query);
+    }
+  queries.clear();
+  queryNext          = 0;
+  queryLastFrame     = 0;
+  queriesInitialized = false;
+}
+
+void
+Frame::timingLog()
+{
+  static const char * const names[] = { "cpu", "regal", "app", "gpu" };
+  const Window * const windows[]    = { &timingFrame, &timingInside, &timingApp, &timingGpu };
+
+  // Info log and JSON log counters
+
+  std::string text;
+  std::string json = ::boost::print::print_string("{ \"frame\" : ",frame,", \"frames\" : ",timingFrame.size());
+
+  const char *keys[12];
+  double      values[12];
+  size_t      count = 0;
+
+  for (size_t i = 0; i < 4; ++i)
+  {
+    const Window &window = *windows[i];
+    if (!window.size())
+      continue;
+
+    const double min = window.min();
+    const double avg = window.avg();
+    const double p99 = window.p99();
+
+    text += ::boost::print::print_string(' ',names[i],' ',min,'/',avg,'/',p99);
+    json += ::boost::print::print_string(", \"",names[i],"\" : { \"samples\" : ",window.size(),
+                                         ", \"min\" : ",min,", \"avg\" : ",avg,", \"p99\" : ",p99," }");
+
+    static const char * const series[4][3] =
+    {
+      { "cpu.min",   "cpu.avg",   "cpu.p99"   },
+      { "regal.min", "regal.avg", "regal.p99" },
+      { "app.min",   "app.avg",   "app.p99"   },
+      { "gpu.min",   "gpu.avg",   "gpu.p99"   }
+    };
+
+    keys[count] = series[i][0]; values[count++] = min;
+    keys[count] = series[i][1]; values[count++] = avg;
+    keys[count] = series[i][2]; values[count++] = p99;
+  }
+  json += " }";
+
+  Info("Frame ",frame," timing, ",timingFrame.size()," frames, min/avg/p99 msec:",text);
+  Logging::Counter("frame timing",keys,values,count);
+
+  {
+    Thread::ScopedLock lock(&timingMutex);
+    timingReport.swap(json);
+  }
+
+  timingFrame .clear();
+  timingInside.clear();
+  timingApp   .clear();
+  timingGpu   .clear();
 }
 
 REGAL_NAMESPACE_END
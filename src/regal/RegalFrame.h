@@ -44,29 +44,56 @@
 
 REGAL_GLOBAL_BEGIN
 
+#include <deque>
+#include <vector>
+#include <string>
+
 #include "RegalTimer.h"
+#include "RegalMutex.h"
+#include "RegalConfig.h"
 #include "RegalContext.h"
 
 REGAL_GLOBAL_END
 
 REGAL_NAMESPACE_BEGIN
 
+namespace Thread { struct Task; }
+
 struct Frame {
 
   Frame()
   : frame(0),
     frameSamples(0),
-    mode(AutoDetect)
+    mode(AutoDetect),
+    initialized(false),
+    pixelBufferObject(false),
+    readbackNext(0),
+    timingDepth(0),
+    timingEnter(0),
+    timingStart(0),
+    timingRegal(0),
+    queriesInitialized(false),
+    queryTimestamp(false),
+    queryDisjoint(false),
+    queryNext(0),
+    queryLast(0),
+    queryLastFrame(0)
   {
     frameTimer.restart();
   }
 
+  ~Frame();
+
   void Init(RegalContext &ctx)
   {
     UNUSED_PARAMETER(ctx);
     Internal("Regal::Frame::Init","()");
   }
 
+  // Finish pending readbacks and release the pixel pack buffers
+
+  void Cleanup(RegalContext &ctx);
+
   //
   // Per-frame state and configuration
   //
@@ -77,6 +104,55 @@ struct Frame {
   size_t              frameSamples;
   Timer               frameSimpleTimeout;
 
+  //
+  // Frame timing
+  //
+  // CPU time between frame terminators is split into the time spent
+  // inside GL entry points, Regal and the driver below it, and the time
+  // spent in the application.  GPU time is the difference between
+  // timestamp queries issued at each frame terminator, collected once
+  // available rather than waited for.
+  //
+
+  // Samples of a reporting window, in milliseconds
+
+  struct Window
+  {
+    std::vector<double> samples;
+
+    inline void   push(double sample) { samples.push_back(sample); }
+    inline size_t size() const        { return samples.size();     }
+    inline void   clear()             { samples.clear();           }
+
+    double min() const;
+    double avg() const;
+    double p99() const;
+  };
+
+  // Time spent inside the outermost entry point of the current thread
+
+  struct Scope
+  {
+    inline Scope(RegalContext *ctx)
+    : frame(Config::frameTiming && ctx ? ctx->frame.get() : NULL)
+    {
+      if (frame && !frame->timingDepth++)
+        frame->timingEnter = frame->timingTimer.now();
+    }
+
+    inline ~Scope()
+    {
+      if (frame && !--frame->timingDepth)
+        frame->timingRegal += frame->timingTimer.now() - frame->timingEnter;
+    }
+
+    Frame *frame;
+  };
+
+  // Most recent report, for the browser interface
+
+  std::string timingJSON() const;
+
   // Handlers for possible frame terminators
 
   inline void glFrameTerminatorGREMEDY(RegalContext &ctx) { if (mode==AutoDetect) mode = FrameTerminatorGREMEDY; if (mode==FrameTerminatorGREMEDY) capture(ctx,true); }
@@ -100,6 +176,81 @@ private:
   };
 
   Mode mode;
+
+  //
+  // Color buffer readback
+  //
+  // With pixel buffer objects, the pixels of a frame are read into one of
+  // a ring of buffers and mapped when the ring comes around to it again,
+  // by which time the GPU is long done.  Saving and hashing is done by
+  // the worker threads.
+  //
+
+  struct Readback
+  {
+    Readback() : buffer(0), size(0), frame(0), width(0), height(0), pending(false) {}
+
+    GLuint     buffer;
+    GLsizeiptr size;
+    size_t     frame;
+    GLint      width;
+    GLint      height;
+    bool       pending;
+  };
+
+  bool                        initialized;
+  bool                        pixelBufferObject;
+  std::vector<Readback>       readbacks;
+  size_t                      readbackNext;
+  std::deque<Thread::Task *>  writes;
+
+  void readColor(RegalContext &ctx, DispatchTableGL &tbl, GLint width, GLint height);
+  void finishReadback(DispatchTableGL &tbl, Readback &readback);
+  void finishReadbacks(DispatchTableGL &tbl);
+  void finishWrites();
+  void write(Thread::Task *task);
+
+  //
+  // Timing state
+  //
+
+  Timer                  timingTimer;
+  size_t                 timingDepth;
+  Timer::Value           timingEnter;
+  Timer::Value           timingStart;   // Frame terminator of the previous frame
+  Timer::Value           timingRegal;   // Inside entry points, so far this frame
+
+  Window                 timingFrame;
+  Window                 timingInside;
+  Window                 timingApp;
+  Window                 timingGpu;
+
+  mutable Thread::Mutex  timingMutex;
+  std::string            timingReport;
+
+  // Ring of timestamp queries, one per frame in flight
+
+  struct Query
+  {
+    Query() : query(0), frame(0), pending(false) {}
+
+    GLuint query;
+    size_t frame;
+    bool   pending;
+  };
+
+  bool                   queriesInitialized;
+  bool                   queryTimestamp;
+  bool                   queryDisjoint;  // EXT_disjoint_timer_query
+  std::vector<Query>     queries;
+  size_t                 queryNext;
+  GLuint64               queryLast;      // Most recent timestamp
+  size_t                 queryLastFrame; // ... and its frame, zero if none
+
+  void timing(RegalContext &ctx);
+  void timingQuery(RegalContext &ctx, DispatchTableGL &tbl);
+  void timingQueryCleanup(DispatchTableGL &tbl);
+  void timingLog();
 };
 
 REGAL_NAMESPACE_END
@@ -89,6 +89,7 @@ REGAL_GLOBAL_BEGIN
 #include "RegalFavicon.h"
 #include "RegalContextInfo.h"
 #include "RegalEmuInfo.h"
+#include "RegalFrame.h"
 
 #include <map>
 
@@ -102,6 +103,10 @@ using boost::print::print_string;
 
 #include "civetweb.h"
 
+#if REGAL_TRACE
+namespace trace { extern void regalWriterTrigger(void); }
+#endif
+
 REGAL_GLOBAL_END
 
 REGAL_NAMESPACE_BEGIN
@@ -111,6 +116,8 @@ namespace Http
 {
   bool enabled = REGAL_HTTP;      // Enabled by default
   int  port    = REGAL_HTTP_PORT; // HTTP listening port - 8080 by default
+  int  idle    = REGAL_HTTP_IDLE; // Detach from the dispatch stack after 5 seconds without requests
+  int  callLogSize = REGAL_HTTP_CALL_LOG;
 
   mg_callbacks callbacks;         // Callbacks
   mg_context   *ctx = NULL;       // civetweb context
@@ -182,6 +189,8 @@ namespace Http
 #ifndef REGAL_NO_GETENV
     getEnv("REGAL_HTTP", enabled);
     getEnv("REGAL_HTTP_PORT", port);
+    getEnv("REGAL_HTTP_IDLE", idle);
+    getEnv("REGAL_HTTP_CALL_LOG", callLogSize);
 #endif
 
     // Compile-time HTTP configuration
@@ -218,6 +227,16 @@ namespace Http
            request_info->query_string   ? request_info->query_string   : "");
 #endif
 
+    // Ask every context to put the http layer back into its dispatch stack
+
+    for( size_t i = 0;; i++ ) {
+      RegalContext * ctx = ::REGAL_NAMESPACE_INTERNAL::Init::getContextByIndex( i );
+      if( !ctx ) {
+        break;
+      }
+      ctx->http.Request();
+    }
+
     Connection connection( conn );
 
     if( connection.path.size() > 0 ) {
@@ -319,6 +338,96 @@ namespace Http
     SendText( conn, "text/html", html );
   }
 
+  // Encode bottom-up RGBA pixels as PNG and send them. This runs on the
+  // civetweb thread after the app context has been released.
+
+  void SendPng( Connection & conn, unsigned char * pixels, int width, int height )
+  {
+    int stride = width * 4;
+    int out_len = 0;
+    unsigned char * img = stbi_write_png_to_mem( pixels + ( height - 1 ) * stride, -stride, width, height, 4, &out_len );
+    if( img == NULL ) {
+      return;
+    }
+
+    string http = print_string(
+                               "HTTP/1.1 200 OK\r\n"
+                               "Content-Type: image/png\r\n"
+                               "Expires: Fri, 30 Oct 1998 14:19:41 GMT\r\n"
+                               "Cache-Control: no-cache, must-revalidate\r\n"
+                               "Content-Length: ", out_len, "\r\n"
+                               "\r\n");
+
+    mg_write(conn.connection, http.c_str(), http.length() );
+    mg_write(conn.connection, img, out_len );
+
+    free( img );
+  }
+
+  // Pixels read back through a pixel pack buffer. Begin and End are called
+  // with the app context acquired and only queue the transfer, Copy is called
+  // with the context acquired again later, once the app has carried on.
+
+  struct Readback {
+    Readback( RegalContext * ctx ) : h( ctx->http ), pbo( 0 ), sync( 0 ), size( 0 ), prev( 0 ) {
+      const ContextInfo & info = *ctx->info;
+      supported = info.es2 ? info.gl_version_major >= 3 :
+                  ( info.gl_version_3_2 || info.gl_arb_sync ) &&
+                  ( info.gl_version_3_0 || info.gl_arb_map_buffer_range );
+    }
+
+    ~Readback() {
+      RegalAssert( !pbo );
+    }
+
+    // Bind a buffer of the given size for reading into, at offset zero
+
+    bool Begin( GLsizeiptr n ) {
+      if( !supported ) {
+        return false;
+      }
+      size = n;
+      h.gl.GetIntegerv( GL_PIXEL_PACK_BUFFER_BINDING, &prev );
+      h.gl.GenBuffers( 1, &pbo );
+      h.gl.BindBuffer( GL_PIXEL_PACK_BUFFER, pbo );
+      h.gl.BufferData( GL_PIXEL_PACK_BUFFER, size, NULL, GL_STREAM_READ );
+      return true;
+    }
+
+    void End() {
+      sync = h.gl.FenceSync( GL_SYNC_GPU_COMMANDS_COMPLETE, 0 );
+      h.gl.Flush();
+      h.gl.BindBuffer( GL_PIXEL_PACK_BUFFER, prev );
+    }
+
+    bool Pending() const {
+      return pbo != 0;
+    }
+
+    void Copy( unsigned char * dst ) {
+      h.gl.GetIntegerv( GL_PIXEL_PACK_BUFFER_BINDING, &prev );
+      h.gl.ClientWaitSync( sync, 0, GLuint64( 1000000000 ) );
+      h.gl.DeleteSync( sync );
+      h.gl.BindBuffer( GL_PIXEL_PACK_BUFFER, pbo );
+      const void * src = h.gl.MapBufferRange( GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT );
+      if( src ) {
+        memcpy( dst, src, size );
+        h.gl.UnmapBuffer( GL_PIXEL_PACK_BUFFER );
+      }
+      h.gl.BindBuffer( GL_PIXEL_PACK_BUFFER, prev );
+      h.gl.DeleteBuffers( 1, &pbo );
+      pbo = 0;
+      sync = 0;
+    }
+
+    DispatchHttpState & h;
+    bool supported;
+    GLuint pbo;
+    GLsync sync;
+    GLsizeiptr size;
+    GLint prev;
+  };
+
   void SendRootDocument( Connection & conn ) {
     string head;
 #if REGAL_HTTP_LOCAL_JQUERY
@@ -570,50 +679,42 @@ namespace Http
           SendText( conn, "application/json", json );
         } else if( conn.path.size() == 3 && conn.path[2] == "image" ) {
           if( ctx->emuInfo->gl_ext_direct_state_access == GL_TRUE || ctx->info->gl_ext_direct_state_access ) {
-            ctx->http.AcquireAppContext( ctx );
-            GLfloat fwidth, fheight;
-            h.gl.GetTextureLevelParameter( texname, texinfo.target, 0, GL_TEXTURE_WIDTH, &fwidth );
-            h.gl.GetTextureLevelParameter( texname, texinfo.target, 0, GL_TEXTURE_HEIGHT, &fheight );
+            Readback rb( ctx );
+            int width = 0;
+            int height = 0;
+            unsigned char * pixels = NULL;
+            {
+              ScopedContextAcquire sca( ctx );
+              GLfloat fwidth, fheight;
+              h.gl.GetTextureLevelParameter( texname, texinfo.target, 0, GL_TEXTURE_WIDTH, &fwidth );
+              h.gl.GetTextureLevelParameter( texname, texinfo.target, 0, GL_TEXTURE_HEIGHT, &fheight );
+
+              width = fwidth;
+              height = fheight;
+
+              if( width <= 0 || height <= 0 ) {
+                // evil
+                return;
+              }
 
-            int width = fwidth;
-            int height = fheight;
+              pixels = new unsigned char[ height * width * 4 ];
 
-            if( width <= 0 || height <= 0 ) {
-              // evil
-              return;
+              if( rb.Begin( height * width * 4 ) ) {
+                h.gl.GetTextureImage( texname, texinfo.target, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL );
+                rb.End();
+              } else {
+                h.gl.GetTextureImage( texname, texinfo.target, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels );
+              }
             }
 
-            int stride = width * 4;
-            unsigned char * pixels = new unsigned char[ int(height + 1) * stride ];
-
-            h.gl.GetTextureImage( texname, texinfo.target, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels );
-            ctx->http.ReleaseAppContext( ctx );
-
-            for( int j = 0; j < height/2; j++ ) {
-              unsigned char * s = pixels + (height - 1 - j) * stride;
-              unsigned char * d = pixels + j * stride;
-              unsigned char * t = pixels + height * stride;
-              memcpy( t, d, stride );
-              memcpy( d, s, stride );
-              memcpy( s, t, stride );
+            if( rb.Pending() ) {
+              ScopedContextAcquire sca( ctx );
+              rb.Copy( pixels );
             }
-            int out_len = 0;
-            unsigned char * img = stbi_write_png_to_mem(pixels, width * 4, width, height, 4, &out_len );
 
-            string http = print_string(
-                                       "HTTP/1.1 200 OK\r\n"
-                                       "Content-Type: image/png\r\n"
-                                       "Expires: Fri, 30 Oct 1998 14:19:41 GMT\r\n"
-                                       "Cache-Control: no-cache, must-revalidate\r\n"
-                                       "Content-Length: ", out_len, "\r\n"
-                                       "\r\n");
-
-            mg_write(conn.connection, http.c_str(), http.length() );
-            mg_write(conn.connection, img, out_len );
+            SendPng( conn, pixels, width, height );
 
             delete [] pixels;
-            free( img );
-
           }
         }
       }
@@ -1064,53 +1165,54 @@ namespace Http
 
       RegalContext * ctx = ::REGAL_NAMESPACE_INTERNAL::Init::getContextByIndex( 0 );
       if( ctx && ctx->http.fbo.count( fbo ) > 0 ) {
-        ScopedContextAcquire sca( ctx );
         DispatchHttpState & h = ctx->http;
-        GLint currFbo = -1;
-        h.gl.GetIntegerv( GL_READ_FRAMEBUFFER_BINDING, & currFbo );
-        if( fbo != currFbo ) {
-          SendText( conn, "application/json", "\"can't query the non-current FBO yet\"" );
-          return;
-        }
-        HttpFboInfo & fi = ctx->http.fbo[ fbo ];
-
-        h.gl.Finish();
-        if( fbo == 0 ) {
-          GLint vp[4];
-          h.gl.GetIntegerv( GL_VIEWPORT, vp );
-          fi.width = vp[0] + vp[2];
-          fi.height = vp[1] + vp[3];
-        }
+        Readback rb( ctx );
+        int width = 0;
+        int height = 0;
+        unsigned char * pixels = NULL;
+        {
+          ScopedContextAcquire sca( ctx );
+          GLint currFbo = -1;
+          h.gl.GetIntegerv( GL_READ_FRAMEBUFFER_BINDING, & currFbo );
+          if( fbo != currFbo ) {
+            SendText( conn, "application/json", "\"can't query the non-current FBO yet\"" );
+            return;
+          }
+          HttpFboInfo & fi = ctx->http.fbo[ fbo ];
 
-        int stride = fi.width * 4;
+          if( fbo == 0 ) {
+            GLint vp[4];
+            h.gl.GetIntegerv( GL_VIEWPORT, vp );
+            fi.width = vp[0] + vp[2];
+            fi.height = vp[1] + vp[3];
+          }
 
-        unsigned char * pixels = new unsigned char[ (fi.height+1) * stride ];
+          width = fi.width;
+          height = fi.height;
+          if( width <= 0 || height <= 0 ) {
+            SendText( conn, "application/json", "\"empty framebuffer\"" );
+            return;
+          }
+
+          pixels = new unsigned char[ height * width * 4 ];
 
-        h.gl.ReadPixels( 0, 0, fi.width, fi.height, GL_RGBA, GL_UNSIGNED_BYTE, pixels );
-        for( int j = 0; j < fi.height/2; j++ ) {
-          unsigned char * s = pixels + (fi.height -1 - j) * stride;
-          unsigned char * d = pixels + j * stride;
-          unsigned char * t = pixels + fi.height * stride;
-          memcpy( t, d, stride );
-          memcpy( d, s, stride );
-          memcpy( s, t, stride );
+          if( rb.Begin( height * width * 4 ) ) {
+            h.gl.ReadPixels( 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, NULL );
+            rb.End();
+          } else {
+            h.gl.Finish();
+            h.gl.ReadPixels( 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels );
+          }
         }
-        int out_len = 0;
-        unsigned char * img = stbi_write_png_to_mem(pixels, fi.width * 4, fi.width, fi.height, 4, &out_len );
 
-        string http = print_string(
-                                   "HTTP/1.1 200 OK\r\n"
-                                   "Content-Type: image/png\r\n"
-                                   "Expires: Fri, 30 Oct 1998 14:19:41 GMT\r\n"
-                                   "Cache-Control: no-cache, must-revalidate\r\n"
-                                   "Content-Length: ", out_len, "\r\n"
-                                   "\r\n");
+        if( rb.Pending() ) {
+          ScopedContextAcquire sca( ctx );
+          rb.Copy( pixels );
+        }
 
-        mg_write(conn.connection, http.c_str(), http.length() );
-        mg_write(conn.connection, img, out_len );
+        SendPng( conn, pixels, width, height );
 
         delete [] pixels;
-        free( img );
 
         return;
       }
@@ -1171,7 +1273,8 @@ namespace Http
         ScopedContextAcquire sca( ctx );
         DispatchHttpState & h = ctx->http;
         json += string( indent, ' ' ) + "\"count\": " + EventCountToJson( h.count, indent ) + ",\n";
-        GLint64 front = h.count.call - h.callLog.size() + 1;
+        GLint64 filled = GLint64( min( h.count.call, GLuint64( h.callLog.size() ) ) );
+        GLint64 front = h.count.call - filled + 1;
         if( startLine < 0 ) {
           startLine = int(GLint64(h.count.call) + GLint64(startLine) + 1 );
         }
@@ -1179,13 +1282,16 @@ namespace Http
         numLines = min( numLines, GLint64( h.count.call - startLine + 1) );
         json += string( indent, ' ' ) + "\"startLine\": " + print_string( startLine, ",\n" );
         json += string( indent, ' ' ) + "\"numLines\": " + print_string( numLines, ",\n" );
-        json += string( indent, ' ' ) + "\"maxLines\": " + print_string( h.callLog.size(), ",\n" );
+        json += string( indent, ' ' ) + "\"maxLines\": " + print_string( filled, ",\n" );
 
         json += string( indent, ' ' ) + "\"log\": [\n";
         indent += 2;
-        size_t base = startLine - front;
         for( GLint64 i = 0; i < numLines; i++ ) {
-          string esc = EscapeJson( h.callLog[ base + i ] );
+          const HttpCallRecord & r = h.callLog[ ( startLine - 1 + i ) % h.callLog.size() ];
+          string esc = EscapeJson( string( r.text, min( size_t( r.size ), sizeof( r.text ) ) ) );
+          if( r.size > sizeof( r.text ) ) {
+            esc += "...";
+          }
           json += string( indent, ' ' ) + print_string( "\"", esc, "\",\n");
         }
         indent -= 2;
@@ -1216,6 +1322,7 @@ namespace Http
       else if (!strcmp("GL_LOG_HTTP_REGAL",    conn.request_info->query_string)) Logging::enableHttp     = true;
 
       else if (!strcmp("REGAL_FRAME_TIME",     conn.request_info->query_string)) Logging::frameTime      = true;
+      else if (!strcmp("REGAL_FRAME_TIMING",   conn.request_info->query_string)) Config::frameTiming     = true;
 
       else if (!strcmp("REGAL_MD5_COLOR",      conn.request_info->query_string)) Config::frameMd5Color    = true;
       else if (!strcmp("REGAL_MD5_STENCIL",    conn.request_info->query_string)) Config::frameMd5Stencil  = true;
@@ -1246,6 +1353,7 @@ namespace Http
       else if (!strcmp("GL_LOG_HTTP_REGAL",    conn.request_info->query_string)) Logging::enableHttp     = false;
 
       else if (!strcmp("REGAL_FRAME_TIME",     conn.request_info->query_string)) Logging::frameTime      = false;
+      else if (!strcmp("REGAL_FRAME_TIMING",   conn.request_info->query_string)) Config::frameTiming     = false;
 
       else if (!strcmp("REGAL_MD5_COLOR",      conn.request_info->query_string)) Config::frameMd5Color    = false;
       else if (!strcmp("REGAL_MD5_STENCIL",    conn.request_info->query_string)) Config::frameMd5Stencil  = false;
@@ -1263,6 +1371,41 @@ namespace Http
     }
   };
 
+#if REGAL_TRACE
+  struct TraceHandler : public RequestHandler {
+    virtual void HandleRequest( Connection & conn ) {
+      string body;
+      if( Config::traceRing > 0 ) {
+        trace::regalWriterTrigger();
+        body += print_string("Writing the last ", Config::traceRing, " frames at the next frame boundary.");
+      } else {
+        body += "Set REGAL_TRACE_RING to record frames in memory.";
+      }
+      SendHTML( conn, body );
+    }
+    virtual string GetHandlerString() {
+      return "trace";
+    }
+  };
+#endif
+
+#if REGAL_FRAME
+  struct FrameHandler : public RequestHandler {
+    virtual void HandleRequest( Connection & conn ) {
+      RegalContext * ctx = ::REGAL_NAMESPACE_INTERNAL::Init::getContextByIndex( 0 );
+      string json = ctx && ctx->frame ? ctx->frame->timingJSON() : string();
+      if( json.empty() ) {
+        SendHTML( conn, "Set REGAL_FRAME_TIMING, or <a href=\"/glEnable?REGAL_FRAME_TIMING\">enable</a> it, for frame timing." );
+        return;
+      }
+      SendText( conn, "application/json", json );
+    }
+    virtual string GetHandlerString() {
+      return "frame";
+    }
+  };
+#endif
+
   struct DebugHandler : public RequestHandler {
     virtual void HandleRequest( Connection & conn ) {
       RegalAssert( conn.path.size() >= 1 && conn.path[0] == "debug" );
@@ -1337,6 +1480,12 @@ namespace Http
                                   new Http::LogHandler,
                                   new Http::EnableHandler,
                                   new Http::DisableHandler,
+#if REGAL_TRACE
+                                  new Http::TraceHandler,
+#endif
+#if REGAL_FRAME
+                                  new Http::FrameHandler,
+#endif
                                   new Http::FaviconHandler,
                                   new Http::ScriptHandler };
     for( size_t i = 0; i < sizeof(h)/sizeof(h[0]); i++ ) {
@@ -1377,7 +1526,8 @@ namespace Http
 
 }
 
-DispatchHttpState::DispatchHttpState() : runState( RS_Run ), debugGroupStackDepth( -1 ), stepOverGroupDepth( -1 ), inBeginEnd( 0 )
+DispatchHttpState::DispatchHttpState() : runState( RS_Run ), debugGroupStackDepth( -1 ), stepOverGroupDepth( -1 ), inBeginEnd( 0 ),
+  attached( true ), appHoldsContext( false ), attachBefore( NULL ), lastRequest( 0 )
 {
   contextMutex = new Thread::Mutex();
   breakpointMutex = new Thread::Mutex( Thread::MT_Normal );
@@ -1395,6 +1545,12 @@ DispatchHttpState::DispatchHttpState() : runState( RS_Run ), debugGroupStackDept
 void DispatchHttpState::Init( RegalContext * ctx )
 {
   gl.Initialize( ctx->dispatcher.http.next() );
+  attached = ctx->dispatcher.isEnabled( ctx->dispatcher.http );
+  callLog.resize( size_t( max( Http::callLogSize, 0 ) ) );
+
+  // Nothing has been requested yet, so detach at the first swap
+
+  lastRequest = GLuint( timer.now() / 1000 ) - GLuint( Http::idle ) - 1;
 }
 
 DispatchHttpState::~DispatchHttpState()
@@ -1408,13 +1564,11 @@ DispatchHttpState::~DispatchHttpState()
 
 void DispatchHttpState::YieldToHttpServer( RegalContext * ctx, bool log )
 {
-  if( log ) {
-    callLog.push_back( callString );
-    static GLuint64 sz = 0;
-    sz = max( sz, ( count.call - count.lastFrame + 1 ) );
-    if( callLog.size() > sz ) {
-      callLog.erase( callLog.begin(), callLog.begin() + ( callLog.size() - sz  ) );
-    }
+  if( log && callLog.size() ) {
+    HttpCallRecord & r = callLog[ count.call % callLog.size() ];
+    r.call = count.call;
+    r.size = GLuint( callString.size() );
+    memcpy( r.text, callString.data(), min( callString.size(), sizeof( r.text ) ) );
   }
 
   // invoked by the app thread from the http dispatch
@@ -1424,6 +1578,7 @@ void DispatchHttpState::YieldToHttpServer( RegalContext * ctx, bool log )
     breakpointMutex->acquire(); // this will stall until the server releases the breakpoint
     breakpointMutex->release();
     contextMutex->acquire();
+    appHoldsContext = true;
     ctx->unparkContext( *dispatcherGlobal.http.next() );
   }
 
@@ -1460,6 +1615,7 @@ void DispatchHttpState::YieldToHttpServer( RegalContext * ctx, bool log )
     contextMutex->release();
     // wait a bit?
     contextMutex->acquire();
+    appHoldsContext = true;
     ctx->unparkContext( *dispatcherGlobal.http.next() );
   }
   if( log ) {
@@ -1467,6 +1623,39 @@ void DispatchHttpState::YieldToHttpServer( RegalContext * ctx, bool log )
   }
 }
 
+void DispatchHttpState::Frame( RegalContext * ctx )
+{
+  DispatcherGL & dispatcher = ctx->dispatcher;
+  if( !dispatcher.isEnabled( dispatcher.http ) || Http::idle <= 0 ) {
+    return;
+  }
+
+  const bool idle = GLuint( timer.now() / 1000 ) - lastRequest > GLuint( Http::idle );
+
+  if( attached ) {
+    if( idle && runState == RS_Run && inBeginEnd == 0 && !httpServerWantsContext ) {
+      // Keep holding the context while detached, so the server
+      // waits in AcquireAppContext until the layer is back.
+      if( !appHoldsContext ) {
+        contextMutex->acquire();
+        appHoldsContext = true;
+      }
+      attachBefore = dispatcher.http.next();
+      dispatcher.erase( dispatcher.http );
+      attached = false;
+    }
+  } else if( !idle ) {
+    RegalAssert( attachBefore );
+    dispatcher.insert( *attachBefore, dispatcher.http );
+    attached = true;
+  }
+}
+
+void DispatchHttpState::Request()
+{
+  lastRequest = GLuint( timer.now() / 1000 );
+}
+
 void DispatchHttpState::AcquireAppContext( RegalContext * ctx )
 {
   ctx->http.httpServerWantsContext = true;
@@ -1505,6 +1694,16 @@ void DispatchHttpState::GlProcs::Initialize( DispatchTableGL * tbl ) {
   GetTextureParameter      = tbl->call( &tbl->glGetTextureParameterfvEXT );
   GetUniformLocation       = tbl->call( &tbl->glGetUniformLocation );
   ReadPixels               = tbl->call( &tbl->glReadPixels );
+  Flush                    = tbl->call( &tbl->glFlush );
+  GenBuffers               = tbl->call( &tbl->glGenBuffers );
+  DeleteBuffers            = tbl->call( &tbl->glDeleteBuffers );
+  BindBuffer               = tbl->call( &tbl->glBindBuffer );
+  BufferData               = tbl->call( &tbl->glBufferData );
+  MapBufferRange           = tbl->call( &tbl->glMapBufferRange );
+  UnmapBuffer              = tbl->call( &tbl->glUnmapBuffer );
+  FenceSync                = tbl->call( &tbl->glFenceSync );
+  ClientWaitSync           = tbl->call( &tbl->glClientWaitSync );
+  DeleteSync               = tbl->call( &tbl->glDeleteSync );
 }
 
 REGAL_NAMESPACE_END
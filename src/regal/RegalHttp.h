@@ -62,6 +62,14 @@ REGAL_NAMESPACE_BEGIN
 #define REGAL_HTTP_PORT 8080
 #endif
 
+#ifndef REGAL_HTTP_IDLE
+#define REGAL_HTTP_IDLE 5000
+#endif
+
+#ifndef REGAL_HTTP_CALL_LOG
+#define REGAL_HTTP_CALL_LOG 4096
+#endif
+
 namespace Http
 {
   void Init();
@@ -72,6 +80,8 @@ namespace Http
 
   extern bool enabled;
   extern int  port;
+  extern int  idle;         // milliseconds without requests before detaching, 0 to stay attached
+  extern int  callLogSize;  // number of calls kept for /log
 
 }
 
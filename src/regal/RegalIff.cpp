@@ -49,8 +49,10 @@ typedef boost::print::string_list<string> string_list;
 #include "RegalIff.h"
 #include "RegalLog.h"
 #include "RegalToken.h"
+#include "RegalConfig.h"
 #include "RegalHelper.h"
 #include "RegalShader.h"
+#include "RegalWorker.h"
 
 REGAL_GLOBAL_END
 
@@ -4002,6 +4004,19 @@ void Iff::UpdateUniforms( RegalContext * ctx )
         }
         break;
       }
+      case FFU_AlphaFunc:
+      {
+        if ( ui.ver != u.alphaTest.ver )
+        {
+          ui.ver = u.alphaTest.ver;
+          const CompareFunc cf = p.alphaTest.enable ? p.alphaTest.comp : CF_Always;
+          const GLfloat lt = ( cf == CF_Less    || cf == CF_Lequal   || cf == CF_NotEqual || cf == CF_Always ) ? 1.0f : 0.0f;
+          const GLfloat eq = ( cf == CF_Equal   || cf == CF_Lequal   || cf == CF_Gequal   || cf == CF_Always ) ? 1.0f : 0.0f;
+          const GLfloat gt = ( cf == CF_Greater || cf == CF_NotEqual || cf == CF_Gequal   || cf == CF_Always ) ? 1.0f : 0.0f;
+          tbl.glUniform3f( ui.slot, lt, eq, gt );
+        }
+        break;
+      }
       case FFU_Attrib:
       {
         if ( ui.ver != u.vabVer )
@@ -4196,6 +4211,21 @@ GLuint Iff::GetFixedFunctionStateHash() {
   return ffstate.processed.hash;
 }
 
+// Fixed function vertex shader source generation, for a worker thread
+
+struct GenerateVertexShaderTask : public Thread::Task
+{
+  GenerateVertexShaderTask( const Iff * rff_ ) : rff( rff_ ) {}
+
+  virtual void run()
+  {
+    GenerateVertexShaderSource( rff, rff->ffstate, src );
+  }
+
+  const Iff * rff;
+  string_list src;
+};
+
 void Iff::UseFixedFunctionProgram( RegalContext * ctx )
 {
   Internal("Regal::Iff::UseFixedFunctionProgram", boost::print::optional(ctx,Logging::pointers));
@@ -4244,8 +4274,18 @@ void Iff::UseFixedFunctionProgram( RegalContext * ctx )
       tbl.call(&tbl.glDeleteProgram)( p->pg );
       *p = Program();
     }
-    GLuint vs = CreateFixedFunctionVertexShader( ctx );
-    GLuint fs = CreateFixedFunctionFragmentShader( ctx );
+    // generate the vertex shader on a worker thread meanwhile
+    ffstate.Process( this );
+    GenerateVertexShaderTask vsTask( this );
+    Thread::Workers & workers = Thread::Workers::instance();
+    workers.submit( &vsTask );
+    string_list fsSrc;
+    GenerateFragmentShaderSource( this, fsSrc );
+    workers.wait( &vsTask );
+    GLuint vs, fs;
+    DispatchTableGL & tbl = ctx->dispatcher.emulation;
+    Program::Shader( ctx, tbl, GL_VERTEX_SHADER, vs, vsTask.src.str().c_str() );
+    Program::Shader( ctx, tbl, GL_FRAGMENT_SHADER, fs, fsSrc.str().c_str() );
     p->Init( ctx, ffstate.processed, vs, fs );
     p->progcount = progcount;
   }
@@ -4273,6 +4313,19 @@ GLuint Iff::CreateFixedFunctionFragmentShader( RegalContext * ctx ) {
   return fs;
 }
 
+// The vertex and fragment shader sources for the current fixed function
+// state, without creating any GL objects.
+
+void Iff::FixedFunctionSources( string & vs, string & fs ) {
+  ffstate.Process( this );
+  string_list vsSrc;
+  string_list fsSrc;
+  GenerateVertexShaderSource( this, ffstate, vsSrc );
+  GenerateFragmentShaderSource( this, fsSrc );
+  vs = vsSrc.str();
+  fs = fsSrc.str();
+}
+
 bool NeedsUserShaderProgramInstance( State::Store & st ) {
   return st.alphaTest.enable && st.alphaTest.comp != Iff::CF_Always;
 }
@@ -4321,7 +4374,9 @@ void Iff::UseShaderProgram( RegalContext * ctx )
       currinst->prevInstance->LocateUniforms( ctx, tbl );
     }
 
-    UserProgramInstanceKey k( ffstate.processed );
+    // with the alpha test in uniforms, one instance serves every function
+
+    UserProgramInstanceKey k( Config::glslAlphaUniform ? UserProgramInstanceKey( CF_Uniform ) : UserProgramInstanceKey( ffstate.processed ) );
     if( currinst->prevInstance == NULL || k != currinst->prevKey ) {
       currinst->prevKey = k;
       currinst->prevInstance = & currinst->instances[ k ];
@@ -4336,16 +4391,10 @@ void Iff::UseShaderProgram( RegalContext * ctx )
       std::vector<ShaderInstance::ShaderSource> sources;
       // alter the original sources as necessary, use a fetched or cached copy as preferred
       ShaderInstance::GetProgramSources( tbl, currinst->program.prog, sources);
-      for( size_t i = 0; i < sources.size(); i++ ) {
-        ShaderInstance::ShaderSource & ss = sources[i];
-        string output_src;
-        // If a tranformation or optimization failed should we optionally fallback
-        // to a passthru shader if it's a fragment shader?
-        // For now, blame glsl parse and fall back to existing source string.
-        if ( OptimizeGLSL( gles, ss.type, ss.src, output_src, k.alphaFunc ) ) {
-          ss.src = output_src;
-        }
-      }
+      // If a tranformation or optimization failed should we optionally fallback
+      // to a passthru shader if it's a fragment shader?
+      // For now, blame glsl parse and fall back to existing source string.
+      OptimizeGLSL( gles, sources, k.alphaFunc );
 
       ShaderInstance::CreateProgramInstance( tbl, currinst->program, sources, upi.inst );
       upi.LocateUniforms( ctx, tbl );
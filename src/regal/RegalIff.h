@@ -446,6 +446,7 @@ enum RegalFFUniformEnum
   FFU_ConstantColor,
   FFU_Attrib,
   FFU_AlphaRef,
+  FFU_AlphaFunc,
 };
 
 struct RegalFFUniformInfo
@@ -605,6 +606,7 @@ static const RegalFFUniformInfo regalFFUniformInfo[] =
   { FFU_ConstantColor, "rglConstantColor" },
   { FFU_Attrib, "rglAttrib[0]" },
   { FFU_AlphaRef, "rglAlphaRef" },
+  { FFU_AlphaFunc, "rglAlphaFunc" },
 };
 
 template <typename T> bool RFFIsVector( const T p )
@@ -893,7 +895,8 @@ struct Iff
     CF_Greater,
     CF_NotEqual,
     CF_Gequal,
-    CF_Always
+    CF_Always,
+    CF_Uniform    // any of the above, from the rglAlphaFunc uniform
   };
 
   enum TexturePriority
@@ -2414,6 +2417,7 @@ struct Iff
   GLuint GetFixedFunctionStateHash();
   GLuint CreateFixedFunctionVertexShader( RegalContext * ctx );
   GLuint CreateFixedFunctionFragmentShader( RegalContext * ctx );
+  void FixedFunctionSources( std::string & vs, std::string & fs );
   void UseFixedFunctionProgram( RegalContext * ctx );
   void UseShaderProgram( RegalContext * ctx );
   void ShaderSource( RegalContext *ctx, GLuint shader, GLsizei count, const GLchar * const * string, const GLint *length);
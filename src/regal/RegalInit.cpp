@@ -56,7 +56,12 @@ using namespace std;
 #include "RegalMutex.h"
 
 #if REGAL_TRACE
-namespace trace { extern const char *regalWriterFileName; }
+namespace trace {
+  extern const char *regalWriterFileName;
+  extern bool regalWriterAsync;
+  extern unsigned regalWriterRingFrames;
+  extern unsigned regalWriterRingHitch;
+}
 #endif
 
 REGAL_GLOBAL_END
@@ -136,6 +141,9 @@ Init::Init()
 
 #if REGAL_TRACE
   trace::regalWriterFileName = Config::traceFile.c_str();
+  trace::regalWriterAsync    = Config::traceAsync;
+  trace::regalWriterRingFrames = Config::traceRing > 0 ? unsigned(Config::traceRing) : 0;
+  trace::regalWriterRingHitch  = Config::traceRingHitch > 0 ? unsigned(Config::traceRingHitch) : 0;
 #endif
 
 #if REGAL_HTTP
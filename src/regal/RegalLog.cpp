@@ -48,9 +48,11 @@ REGAL_GLOBAL_BEGIN
 #include "RegalThread.h"
 #include "RegalContext.h"
 #include "RegalMutex.h"
+#include "RegalLogSink.h"
 
 #if !REGAL_SYS_WIN32
 #include <pthread.h>
+#include <signal.h>
 #endif
 
 // Otherwise we'd need to #include <windows.h>
@@ -117,6 +119,18 @@ namespace Logging {
   std::string  jsonFilename;
   FILE        *jsonOutput   = NULL;
 
+  bool         async         = false;
+  std::size_t  asyncRingSize = 256;
+  Sink        *sink          = NULL;
+
+  bool          binary         = false;
+  std::string   binaryFilename = "regal.rlog";
+  FILE         *binaryOutput   = NULL;
+  Thread::Mutex binaryMutex;
+
+  void startSink();
+  void stopSink();
+
   Thread::Mutex          *bufferMutex = NULL;
   std::list<std::string> *buffer = NULL;
   std::size_t             bufferSize  = 0;
@@ -174,6 +188,10 @@ namespace Logging {
     getEnv("REGAL_LOG_JSON",       json);
     getEnv("REGAL_LOG_JSON_FILE",  jsonFilename);
     getEnv("REGAL_HTTP_LOG_LIMIT", bufferLimit);
+    getEnv("REGAL_LOG_ASYNC",      async);
+    getEnv("REGAL_LOG_ASYNC_RING", asyncRingSize);
+    getEnv("REGAL_LOG_BINARY",      binary);
+    getEnv("REGAL_LOG_BINARY_FILE", binaryFilename);
 #endif
 
 #ifdef REGAL_HTTP_LOG_LIMIT
@@ -195,6 +213,22 @@ namespace Logging {
     if (jsonOutput)
       fprintf(jsonOutput,"%s","{ \"traceEvents\" : [\n");
 
+    // Binary logging
+
+    if (binary && binaryFilename.length())
+      binaryOutput = fileOpen(binaryFilename.c_str(),"wb");
+    if (binaryOutput)
+    {
+      string h;
+      Binary::header(h);
+      fwrite(h.c_str(),h.length(),1,binaryOutput);
+    }
+
+    if (async)
+      startSink();
+
+    binary = binaryOutput!=NULL;
+
     Internal("Logging::Init","()");
 
     initialized = true;
@@ -243,6 +277,9 @@ namespace Logging {
     Info("REGAL_LOG_ONCE            ", once            ? "enabled" : "disabled");
 #endif
 
+    Info("REGAL_LOG_ASYNC           ", sink            ? "enabled" : "disabled");
+    Info("REGAL_LOG_BINARY          ", binary          ? "enabled" : "disabled");
+
 #if REGAL_LOG_POINTERS
     Info("REGAL_LOG_POINTERS        ", pointers        ? "enabled" : "disabled");
 #endif
@@ -265,6 +302,13 @@ namespace Logging {
 
     initialized = false;
 
+    binary = false;
+
+    stopSink();
+
+    if (binaryOutput)
+      fileClose(&binaryOutput);
+
     if (logOutput)
       fileClose(&logOutput);
 
@@ -318,13 +362,17 @@ namespace Logging {
       jo.member("filename",    logFilename);
       jo.member("json",        json);
       jo.member("jsonFile",    jsonFilename);
+      jo.member("async",       async);
+      jo.member("asyncRing",   asyncRingSize);
+      jo.member("binary",      binary);
+      jo.member("binaryFile",  binaryFilename);
       jo.member("bufferLimit", bufferLimit);
 
     jo.end();
 #endif
   }
 
-  inline size_t indent()
+  size_t indent()
   {
     // For OSX we need avoid REGAL_GET_CONTEXT implicitly
     // trying to create a RegalContext and triggering more
@@ -357,22 +405,48 @@ namespace Logging {
     return indent;
   }
 
-  inline string message(const char *prefix, const char *delim, const char *name, const string &str)
+  string message(const char *prefix, const char *delim, const char *name, const string &str, size_t indentation, size_t processId, size_t threadId)
   {
     static const char *trimSuffix = " ...";
     string_list trimPrefix;
     trimPrefix << print_string(prefix ? prefix : "",delim ? delim : "");
     if (process)
-      trimPrefix << print_string(hex(Thread::procId()),delim ? delim : "");
+      trimPrefix << print_string(hex(processId),delim ? delim : "");
     if (thread)
-      trimPrefix << print_string(hex(Thread::threadId()),delim ? delim : "");
-    trimPrefix << print_string(string(indent(),' '),name ? name : "",name ? " " : "");
-    return print_string(trim(str.c_str(),'\n',maxLines>0 ? maxLines : ~0,trimPrefix.str().c_str(),trimSuffix), '\n');
+      trimPrefix << print_string(hex(threadId),delim ? delim : "");
+    trimPrefix << print_string(string(indentation,' '),name ? name : "",name ? " " : "");
+    string m = print_string(trim(str.c_str(),'\n',maxLines>0 ? maxLines : ~0,trimPrefix.str().c_str(),trimSuffix), '\n');
+
+    // Number the lines of multi-line messages
+
+    string full_prefix = string(prefix ? prefix : "") + string(delim ? delim : "");
+    size_t p = m.find( full_prefix, 0 );
+    int count = 0;
+    if( m.find( full_prefix, full_prefix.size() ) != string::npos )
+    {
+      while( p != string::npos && count < 1000 )
+      {
+        std::string lineNumber;
+        boost::print::printf(lineNumber, "%03i ", count);
+        p += full_prefix.size();
+        m.insert( p, lineNumber.c_str(), lineNumber.size() );
+        p = m.find( full_prefix, p );
+        count++;
+      }
+    }
+
+    return m;
   }
 
-  inline string jsonObject(const char *prefix, const char *name, const string &str)
+  string jsonObject(const char *prefix, const char *name, const string &str, size_t processId, size_t threadId, Timer::Value time)
   {
 #if REGAL_NO_JSON
+    UNUSED_PARAMETER(prefix);
+    UNUSED_PARAMETER(name);
+    UNUSED_PARAMETER(str);
+    UNUSED_PARAMETER(processId);
+    UNUSED_PARAMETER(threadId);
+    UNUSED_PARAMETER(time);
     return string();
 #else
     //
@@ -393,9 +467,9 @@ namespace Logging {
 
     jo.object();
     jo.member("cat",prefix);
-    jo.member("pid",Thread::procId());
-    jo.member("tid",Thread::threadId()%(1<<16));
-    jo.member("ts", timer.now());
+    jo.member("pid",processId);
+    jo.member("tid",threadId%(1<<16));
+    jo.member("ts", time);
 
     // Unnamed logging events such as error, warning and info ones
 
@@ -504,6 +578,141 @@ namespace Logging {
     }
   }
 
+  // Asynchronous output
+  //
+  // Log lines are queued for the sink's writer thread, which appends them
+  // to the HTTP buffer and batches the file writes.
+
+  enum SinkKind
+  {
+    SINK_LOG = 0,
+    SINK_JSON,
+    SINK_BINARY
+  };
+
+  string sinkLog;
+  string sinkJson;
+  string sinkBinary;
+
+  void sinkConsume(void *user, unsigned int kind, const char *data, size_t size)
+  {
+    UNUSED_PARAMETER(user);
+
+    switch (kind)
+    {
+      case SINK_LOG:
+      {
+#if REGAL_LOG
+        if (log && logOutput)
+          sinkLog.append(data,size);
+#endif
+        string m(data,size);
+        append(m);
+        break;
+      }
+
+      case SINK_JSON:
+        sinkJson.append(data,size);
+        break;
+
+      case SINK_BINARY:
+        sinkBinary.append(data,size);
+        break;
+
+      default:
+        break;
+    }
+  }
+
+  void sinkCommit(void *user)
+  {
+    UNUSED_PARAMETER(user);
+
+    if (sinkLog.length() && logOutput)
+    {
+      fwrite(sinkLog.c_str(),sinkLog.length(),1,logOutput);
+      fflush(logOutput);
+    }
+    if (sinkJson.length() && jsonOutput)
+      fwrite(sinkJson.c_str(),sinkJson.length(),1,jsonOutput);
+    if (sinkBinary.length() && binaryOutput)
+      fwrite(sinkBinary.c_str(),sinkBinary.length(),1,binaryOutput);
+    sinkLog.clear();
+    sinkJson.clear();
+    sinkBinary.clear();
+  }
+
+  // Write out the queued log if the process crashes, then hand
+  // the signal to whichever handler was there before.
+
+#if REGAL_WORKER_THREADS && !REGAL_SYS_WIN32
+  const int        crashSignals[] = { SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT };
+  struct sigaction crashHandlers[sizeof(crashSignals)/sizeof(crashSignals[0])];
+
+  void crashHandler(int sig)
+  {
+    if (sink)
+      sink->drain();
+
+    for (size_t i = 0; i<array_size(crashSignals); ++i)
+      if (crashSignals[i]==sig)
+        sigaction(sig,&crashHandlers[i],NULL);
+    raise(sig);
+  }
+#endif
+
+  void startSink()
+  {
+    if (sink || (!logOutput && !jsonOutput && !binaryOutput && !buffer))
+      return;
+
+    sink = new Sink(sinkConsume,sinkCommit,NULL,asyncRingSize*1024);
+    if (!sink->start())
+    {
+      delete sink;
+      sink = NULL;
+      return;
+    }
+
+#if REGAL_WORKER_THREADS && !REGAL_SYS_WIN32
+    struct sigaction sa;
+    memset(&sa,0,sizeof(sa));
+    sa.sa_handler = crashHandler;
+    sigemptyset(&sa.sa_mask);
+    for (size_t i = 0; i<array_size(crashSignals); ++i)
+      sigaction(crashSignals[i],&sa,&crashHandlers[i]);
+#endif
+  }
+
+  void stopSink()
+  {
+    if (!sink)
+      return;
+
+#if REGAL_WORKER_THREADS && !REGAL_SYS_WIN32
+    for (size_t i = 0; i<array_size(crashSignals); ++i)
+      sigaction(crashSignals[i],&crashHandlers[i],NULL);
+#endif
+
+    Sink *s = sink;
+    s->stop();
+    sink = NULL;
+    delete s;
+  }
+
+  // Binary records go through the sink too, if there is one
+
+  void Binary::write(const char *data, size_t size)
+  {
+    if (sink)
+      sink->push(SINK_BINARY,data,size);
+    else if (binaryOutput)
+    {
+      Thread::ScopedLock lock(&binaryMutex);
+      fwrite(data,size,1,binaryOutput);
+    }
+  }
+
   void createLocks()
   {
     bufferMutex = new Thread::Mutex();
@@ -520,23 +729,7 @@ namespace Logging {
   {
     if (initialized && str.length())
     {
-      string m = message(prefix,delim,name,str);
-
-      string full_prefix = string(prefix) + string(delim);
-      size_t p = m.find( full_prefix, 0 );
-      int count = 0;
-      if( m.find( full_prefix, full_prefix.size() ) != string::npos )
-      {
-        while( p != string::npos && count < 1000 )
-        {
-          std::string lineNumber;
-          boost::print::printf(lineNumber, "%03i ", count);
-          p += full_prefix.size();
-          m.insert( p, lineNumber.c_str(), lineNumber.size() );
-          p = m.find( full_prefix, p );
-          count++;
-        }
-      }
+      string m = message(prefix,delim,name,str,indent(),Thread::procId(),Thread::threadId());
 
 #if 1
       UNUSED_PARAMETER(file);
@@ -581,6 +774,9 @@ namespace Logging {
         }
 #endif
 
+      if (binary)
+        Binary::text(mode,prefix,name,str);
+
       RegalContext *rCtx = NULL;
 
 #if !REGAL_SYS_WGL && !REGAL_NO_TLS
@@ -617,11 +813,21 @@ namespace Logging {
 #if REGAL_LOG_JSON && !REGAL_NO_JSON
       if (json && jsonOutput)
       {
-        string m = jsonObject(prefix,name,str) + ",\n";
-        fwrite(m.c_str(),m.length(),1,jsonOutput);
+        string m = jsonObject(prefix,name,str,Thread::procId(),Thread::threadId(),timer.now()) + ",\n";
+        if (sink)
+          sink->push(SINK_JSON,m.c_str(),m.length());
+        else
+          fwrite(m.c_str(),m.length(),1,jsonOutput);
       }
 #endif
 
+      if (sink)
+      {
+        if ((log && logOutput) || buffer)
+          sink->push(SINK_LOG,m.c_str(),m.length());
+        return;
+      }
+
 #if REGAL_LOG
       if (log && logOutput)
       {
@@ -633,6 +839,40 @@ namespace Logging {
       append(m);
     }
   }
+
+  void Counter(const char *name, const char * const *keys, const double *values, size_t count)
+  {
+#if REGAL_LOG_JSON && !REGAL_NO_JSON
+    if (!initialized || !json || !jsonOutput)
+      return;
+
+    Json::Output jo;
+
+    jo.object();
+    jo.member("cat","counter");
+    jo.member("pid",Thread::procId());
+    jo.member("tid",Thread::threadId()%(1<<16));
+    jo.member("ts", timer.now());
+    jo.member("ph", "C");
+    jo.member("name",name);
+    jo.object("args");
+      for (size_t i = 0; i<count; ++i)
+        jo.member(keys[i],values[i]);
+    jo.end();
+    jo.end();
+
+    string m = jo.str() + ",\n";
+    if (sink)
+      sink->push(SINK_JSON,m.c_str(),m.length());
+    else
+      fwrite(m.c_str(),m.length(),1,jsonOutput);
+#else
+    UNUSED_PARAMETER(name);
+    UNUSED_PARAMETER(keys);
+    UNUSED_PARAMETER(values);
+    UNUSED_PARAMETER(count);
+#endif
+  }
 }
 
 REGAL_NAMESPACE_END
@@ -171,6 +171,29 @@ namespace Logging
 
   extern void Output(const Mode mode, const char *file, const int line, const char *prefix, const char *delim, const char *name, const std::string &str = std::string());
 
+  // Formatting of messages, for the text and JSON logs
+
+  extern size_t      indent();
+  extern std::string message(const char *prefix, const char *delim, const char *name, const std::string &str, size_t indent, size_t process, size_t thread);
+  extern std::string jsonObject(const char *prefix, const char *name, const std::string &str, size_t process, size_t thread, unsigned long long time);
+
+  // Counter event for the JSON log, such as per-frame timing
+
+  extern void Counter(const char *name, const char * const *keys, const double *values, size_t count);
+
+  // A logging call site, for the binary log.  The id is assigned when
+  // the site is first logged.
+
+  struct Site
+  {
+    Mode         mode;
+    const char  *file;
+    int          line;
+    const char  *prefix;
+    const char  *name;
+    unsigned int id;
+  };
+
   extern void createLocks();
 
   // Runtime control of logging
@@ -213,6 +236,17 @@ namespace Logging
   extern std::string  jsonFilename;
   extern FILE        *jsonOutput;
 
+  // Asynchronous output
+
+  extern bool         async;          // Log and JSON files written by a background thread
+  extern std::size_t  asyncRingSize;  // KB queued per logging thread
+
+  // Binary output, decoded offline by regallog
+
+  extern bool         binary;         // App, driver and internal logging as binary records
+  extern std::string  binaryFilename;
+  extern FILE        *binaryOutput;
+
   // Buffering for HTTP query purposes
 
   extern std::size_t             bufferSize;
@@ -255,7 +289,15 @@ namespace Logging
 #if REGAL_LOG_APP
 #define App(name,...) { \
   if (::REGAL_NAMESPACE_INTERNAL::Logging::enableApp) \
-    ::REGAL_NAMESPACE_INTERNAL::Logging::Output( ::REGAL_NAMESPACE_INTERNAL::Logging::LOG_APP, __FILE__, __LINE__, "app     ", " | ", name, ::boost::print::print_string( __VA_ARGS__) ); }
+  { \
+    if (::REGAL_NAMESPACE_INTERNAL::Logging::binary) \
+    { \
+      static ::REGAL_NAMESPACE_INTERNAL::Logging::Site regalLogSite = { ::REGAL_NAMESPACE_INTERNAL::Logging::LOG_APP, __FILE__, __LINE__, "app     ", name, 0 }; \
+      ::REGAL_NAMESPACE_INTERNAL::Logging::Binary::output( regalLogSite, __VA_ARGS__ ); \
+    } \
+    else \
+      ::REGAL_NAMESPACE_INTERNAL::Logging::Output( ::REGAL_NAMESPACE_INTERNAL::Logging::LOG_APP, __FILE__, __LINE__, "app     ", " | ", name, ::boost::print::print_string( __VA_ARGS__) ); \
+  } }
 #else
 #define App(...) {}
 #endif
@@ -263,7 +305,15 @@ namespace Logging
 #if REGAL_LOG_DRIVER
 #define Driver(name,...) { \
   if (::REGAL_NAMESPACE_INTERNAL::Logging::enableDriver) \
-    ::REGAL_NAMESPACE_INTERNAL::Logging::Output( ::REGAL_NAMESPACE_INTERNAL::Logging::LOG_DRIVER, __FILE__, __LINE__, "driver  ", " | ", name, ::boost::print::print_string( __VA_ARGS__) ); }
+  { \
+    if (::REGAL_NAMESPACE_INTERNAL::Logging::binary) \
+    { \
+      static ::REGAL_NAMESPACE_INTERNAL::Logging::Site regalLogSite = { ::REGAL_NAMESPACE_INTERNAL::Logging::LOG_DRIVER, __FILE__, __LINE__, "driver  ", name, 0 }; \
+      ::REGAL_NAMESPACE_INTERNAL::Logging::Binary::output( regalLogSite, __VA_ARGS__ ); \
+    } \
+    else \
+      ::REGAL_NAMESPACE_INTERNAL::Logging::Output( ::REGAL_NAMESPACE_INTERNAL::Logging::LOG_DRIVER, __FILE__, __LINE__, "driver  ", " | ", name, ::boost::print::print_string( __VA_ARGS__) ); \
+  } }
 #else
 #define Driver(...) {}
 #endif
@@ -271,7 +321,15 @@ namespace Logging
 #if REGAL_LOG_INTERNAL
 #define Internal(name,...) { \
   if (::REGAL_NAMESPACE_INTERNAL::Logging::enableInternal) \
-    ::REGAL_NAMESPACE_INTERNAL::Logging::Output( ::REGAL_NAMESPACE_INTERNAL::Logging::LOG_INTERNAL, __FILE__, __LINE__, "internal", " | ", name, ::boost::print::print_string( __VA_ARGS__) ); }
+  { \
+    if (::REGAL_NAMESPACE_INTERNAL::Logging::binary) \
+    { \
+      static ::REGAL_NAMESPACE_INTERNAL::Logging::Site regalLogSite = { ::REGAL_NAMESPACE_INTERNAL::Logging::LOG_INTERNAL, __FILE__, __LINE__, "internal", name, 0 }; \
+      ::REGAL_NAMESPACE_INTERNAL::Logging::Binary::output( regalLogSite, __VA_ARGS__ ); \
+    } \
+    else \
+      ::REGAL_NAMESPACE_INTERNAL::Logging::Output( ::REGAL_NAMESPACE_INTERNAL::Logging::LOG_INTERNAL, __FILE__, __LINE__, "internal", " | ", name, ::boost::print::print_string( __VA_ARGS__) ); \
+  } }
 #else
 #define Internal(...) {}
 #endif
@@ -286,4 +344,6 @@ namespace Logging
 
 REGAL_NAMESPACE_END
 
+#include "RegalLogBinary.h"
+
 #endif
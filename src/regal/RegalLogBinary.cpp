@@ -0,0 +1,446 @@
+/*
+  Copyright (c) 2011-2013 NVIDIA Corporation
+  Copyright (c) 2013 Mark Adams
+  Copyright (c) 2013 Nigel Stewart
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+  OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+  OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+
+ Regal binary logging
+
+ */
+
+#include "pch.h" /* For MS precompiled header support */
+
+#include "RegalUtil.h"
+
+REGAL_GLOBAL_BEGIN
+
+#include <map>
+#include <vector>
+#include <algorithm>
+
+#include "RegalLog.h"
+#include "RegalLogBinary.h"
+#include "RegalTimer.h"
+#include "RegalThread.h"
+#include "RegalMutex.h"
+
+REGAL_GLOBAL_END
+
+REGAL_NAMESPACE_BEGIN
+
+using ::std::string;
+using ::boost::print::print_string;
+
+namespace Logging {
+
+  extern Timer timer;
+
+namespace Binary {
+
+namespace {
+
+  const unsigned int nullString = ~0u;
+
+  Thread::Mutex siteMutex;
+  unsigned int  siteCount = 0;
+
+  template<typename T>
+  inline void append(string &data, const T v)
+  {
+    data.append(reinterpret_cast<const char *>(&v),sizeof(T));
+  }
+
+  inline void append(string &data, const char *v)
+  {
+    if (!v)
+    {
+      append(data,nullString);
+      return;
+    }
+    const unsigned int length = static_cast<unsigned int>(strlen(v));
+    append(data,length);
+    data.append(v,length);
+  }
+
+  inline void append(string &data, const string &v)
+  {
+    append(data,static_cast<unsigned int>(v.length()));
+    data.append(v);
+  }
+
+  // The size of a record is set once it's complete
+
+  inline void begin(string &data, const RecordType type)
+  {
+    append(data,0u);
+    append(data,static_cast<unsigned char>(type));
+  }
+
+  inline void end(string &data)
+  {
+    const unsigned int size = static_cast<unsigned int>(data.size());
+    memcpy(&data[0],&size,sizeof(size));
+  }
+
+  // Define the site, if no other thread beat us to it
+
+  void define(Site &site)
+  {
+    Thread::ScopedLock lock(&siteMutex);
+    if (site.id)
+      return;
+
+    site.id = ++siteCount;
+
+    string data;
+    begin(data,RECORD_SITE);
+    append(data,site.id);
+    append(data,static_cast<unsigned char>(site.mode));
+    append(data,site.line);
+    append(data,site.file);
+    append(data,site.prefix);
+    append(data,site.name);
+    end(data);
+    write(data.c_str(),data.size());
+  }
+
+  //
+  // Decoding
+  //
+
+  struct Reader
+  {
+    Reader(const char *data, size_t size) : _data(data), _size(size), _ok(true) {}
+
+    template<typename T>
+    T get()
+    {
+      T v = T();
+      if (_size<sizeof(T))
+        _ok = false;
+      if (!_ok)
+        return v;
+      memcpy(&v,_data,sizeof(T));
+      _data += sizeof(T);
+      _size -= sizeof(T);
+      return v;
+    }
+
+    // NULL strings are returned as NULL
+
+    const char *getString(string &v)
+    {
+      const unsigned int length = get<unsigned int>();
+      if (length==nullString)
+        return NULL;
+      if (_size<length)
+        _ok = false;
+      if (!_ok)
+        return NULL;
+      v.assign(_data,length);
+      _data += length;
+      _size -= length;
+      return v.c_str();
+    }
+
+    inline size_t size() const { return _size; }
+    inline bool   ok()   const { return _ok; }
+
+    const char *_data;
+    size_t      _size;
+    bool        _ok;
+  };
+
+  struct DecodedSite
+  {
+    DecodedSite() : mode(LOG_INFO), hasPrefix(false), hasName(false) {}
+
+    Mode   mode;
+    string prefix;
+    string name;
+    bool   hasPrefix;
+    bool   hasName;
+  };
+
+  struct Event
+  {
+    Timer::Value       time;
+    unsigned long long thread;
+    unsigned short     indent;
+    unsigned int       site;      // Zero for text
+    string             prefix;
+    string             name;
+    bool               hasName;
+    string             text;
+  };
+
+  bool eventLess(const Event *a, const Event *b)
+  {
+    return a->time < b->time;
+  }
+
+  // Arguments formatted as boost::print does
+
+  bool decodeArguments(Reader &r, string &text)
+  {
+    while (r.ok() && r.size())
+    {
+      switch (r.get<unsigned char>())
+      {
+        case TAG_BOOL:    text += print_string(r.get<unsigned char>()!=0);     break;
+        case TAG_CHAR:    text += print_string(r.get<char>());                 break;
+        case TAG_SCHAR:   text += print_string(r.get<signed char>());          break;
+        case TAG_UCHAR:   text += print_string(r.get<unsigned char>());        break;
+        case TAG_SHORT:   text += print_string(r.get<signed short>());         break;
+        case TAG_USHORT:  text += print_string(r.get<unsigned short>());       break;
+        case TAG_INT:     text += print_string(r.get<signed int>());           break;
+        case TAG_UINT:    text += print_string(r.get<unsigned int>());         break;
+        case TAG_LONG:    text += print_string(r.get<signed long long>());     break;
+        case TAG_ULONG:   text += print_string(r.get<unsigned long long>());   break;
+        case TAG_FLOAT:   text += print_string(r.get<float>());                break;
+        case TAG_DOUBLE:  text += print_string(r.get<double>());               break;
+        case TAG_POINTER: text += print_string(reinterpret_cast<const void *>(static_cast<size_t>(r.get<unsigned long long>()))); break;
+        case TAG_STRING:
+        {
+          string s;
+          r.getString(s);
+          text += s;
+          break;
+        }
+        default:
+          return false;
+      }
+    }
+    return r.ok();
+  }
+}
+
+void
+header(string &data)
+{
+  data.append(magic,sizeof(magic));
+  append(data,version);
+  append(data,static_cast<unsigned long long>(Thread::procId()));
+}
+
+void
+text(const Mode mode, const char *prefix, const char *name, const string &str)
+{
+  string data;
+  begin(data,RECORD_TEXT);
+  append(data,static_cast<unsigned char>(mode));
+  append(data,static_cast<unsigned long long>(timer.now()));
+  append(data,static_cast<unsigned long long>(Thread::threadId()));
+  append(data,static_cast<unsigned short>(indent()));
+  append(data,prefix);
+  append(data,name);
+  append(data,str);
+  end(data);
+  write(data.c_str(),data.size());
+}
+
+Record::Record(Site &site)
+: _size(0)
+{
+  if (!site.id)
+    define(site);
+
+  const unsigned int       size   = 0;
+  const unsigned char      type   = RECORD_MESSAGE;
+  const unsigned long long time   = timer.now();
+  const unsigned long long thread = Thread::threadId();
+  const unsigned short     indentation = static_cast<unsigned short>(indent());
+
+  put(&size,sizeof(size));
+  put(&type,sizeof(type));
+  put(&site.id,sizeof(site.id));
+  put(&time,sizeof(time));
+  put(&thread,sizeof(thread));
+  put(&indentation,sizeof(indentation));
+}
+
+void
+Record::characters(const char *v, size_t length)
+{
+  const char         tag  = TAG_STRING;
+  const unsigned int size = static_cast<unsigned int>(length);
+  put(&tag,1);
+  put(&size,sizeof(size));
+  put(v,length);
+}
+
+void
+Record::put(const void *data, size_t size)
+{
+  if (_spill.empty() && _size + size <= sizeof(_buffer))
+  {
+    memcpy(_buffer + _size, data, size);
+    _size += size;
+    return;
+  }
+
+  if (_spill.empty())
+    _spill.assign(_buffer,_size);
+  _spill.append(static_cast<const char *>(data),size);
+}
+
+void
+Record::end()
+{
+  if (_spill.empty())
+  {
+    const unsigned int size = static_cast<unsigned int>(_size);
+    memcpy(_buffer,&size,sizeof(size));
+    write(_buffer,_size);
+  }
+  else
+  {
+    const unsigned int size = static_cast<unsigned int>(_spill.size());
+    memcpy(&_spill[0],&size,sizeof(size));
+    write(_spill.c_str(),_spill.size());
+  }
+}
+
+bool
+decode(const char *data, size_t size, string &text, string &json)
+{
+  if (size<sizeof(magic) || memcmp(data,magic,sizeof(magic)))
+    return false;
+
+  Reader r(data+sizeof(magic),size-sizeof(magic));
+  if (r.get<unsigned int>()!=version)
+    return false;
+  const size_t process = static_cast<size_t>(r.get<unsigned long long>());
+
+  std::map<unsigned int,DecodedSite> sites;
+  std::vector<Event>                 events;
+  bool ok = r.ok();
+
+  while (ok && r.size())
+  {
+    const unsigned int recordSize = r.get<unsigned int>();
+    if (!r.ok() || recordSize<sizeof(unsigned int)+1 || recordSize-sizeof(unsigned int)>r.size())
+    {
+      ok = false;
+      break;
+    }
+
+    Reader record(r._data,recordSize-sizeof(unsigned int));
+    r._data += record._size;
+    r._size -= record._size;
+
+    switch (record.get<unsigned char>())
+    {
+      case RECORD_SITE:
+      {
+        DecodedSite &s = sites[record.get<unsigned int>()];
+        s.mode = static_cast<Mode>(record.get<unsigned char>());
+        record.get<int>();
+        string file;
+        record.getString(file);
+        s.hasPrefix = record.getString(s.prefix)!=NULL;
+        s.hasName   = record.getString(s.name)!=NULL;
+        break;
+      }
+
+      case RECORD_MESSAGE:
+      {
+        Event e;
+        e.site    = record.get<unsigned int>();
+        e.time    = record.get<unsigned long long>();
+        e.thread  = record.get<unsigned long long>();
+        e.indent  = record.get<unsigned short>();
+        e.hasName = false;
+        if (!e.site || !decodeArguments(record,e.text))
+          ok = false;
+        events.push_back(e);
+        break;
+      }
+
+      case RECORD_TEXT:
+      {
+        Event e;
+        record.get<unsigned char>();
+        e.site    = 0;
+        e.time    = record.get<unsigned long long>();
+        e.thread  = record.get<unsigned long long>();
+        e.indent  = record.get<unsigned short>();
+        record.getString(e.prefix);
+        e.hasName = record.getString(e.name)!=NULL;
+        record.getString(e.text);
+        events.push_back(e);
+        break;
+      }
+
+      default:
+        ok = false;
+        break;
+    }
+    ok = ok && record.ok();
+  }
+
+  // Threads wrote their records independently, put them back in order
+
+  std::vector<const Event *> order(events.size());
+  for (size_t i = 0; i<events.size(); ++i)
+    order[i] = &events[i];
+  std::stable_sort(order.begin(),order.end(),eventLess);
+
+  json += "{ \"traceEvents\" : [\n";
+  for (size_t i = 0; i<order.size(); ++i)
+  {
+    const Event &e = *order[i];
+    if (e.text.empty())
+      continue;
+
+    const char *prefix = e.prefix.c_str();
+    const char *name   = e.hasName ? e.name.c_str() : NULL;
+    if (e.site)
+    {
+      std::map<unsigned int,DecodedSite>::const_iterator s = sites.find(e.site);
+      if (s==sites.end())
+      {
+        ok = false;
+        continue;
+      }
+      prefix = s->second.prefix.c_str();
+      name   = s->second.hasName ? s->second.name.c_str() : NULL;
+    }
+
+    text += message(prefix," | ",name,e.text,e.indent,process,static_cast<size_t>(e.thread));
+    json += jsonObject(prefix,name,e.text,process,static_cast<size_t>(e.thread),e.time) + ",\n";
+  }
+  json += "{} ] }\n";
+
+  return ok;
+}
+
+}
+
+}
+
+REGAL_NAMESPACE_END
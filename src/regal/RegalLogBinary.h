@@ -0,0 +1,322 @@
+/*
+  Copyright (c) 2011-2013 NVIDIA Corporation
+  Copyright (c) 2013 Mark Adams
+  Copyright (c) 2013 Nigel Stewart
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+  OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+  OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+
+ Regal binary logging
+
+ */
+
+#ifndef __REGAL_LOG_BINARY_H__
+#define __REGAL_LOG_BINARY_H__
+
+#include "RegalUtil.h"
+
+REGAL_GLOBAL_BEGIN
+
+#include <cstring>
+#include <string>
+
+#include <boost/print/print_string.hpp>
+
+#include "RegalLog.h"
+
+REGAL_GLOBAL_END
+
+REGAL_NAMESPACE_BEGIN
+
+namespace Logging {
+
+namespace Binary
+{
+  //
+  // The binary log is a header followed by records, each of them a 32-bit
+  // size of the whole record and a type.  Messages refer to their call site,
+  // defined by a site record the first time it is logged.  The arguments
+  // of a message are kept as tagged raw values, formatted by the decoder
+  // as boost::print would have at the time.
+  //
+  // Records are in the byte order of the logging machine, and in the order
+  // written by each thread.  The decoder sorts them by time.
+  //
+
+  const char         magic[8] = { 'R', 'E', 'G', 'A', 'L', 'L', 'O', 'G' };
+  const unsigned int version  = 1;
+
+  enum RecordType
+  {
+    RECORD_SITE = 1,  // id, mode, line, file, prefix, name
+    RECORD_MESSAGE,   // site, time, thread, indent, arguments
+    RECORD_TEXT       // mode, time, thread, indent, prefix, name, text
+  };
+
+  enum Tag
+  {
+    TAG_BOOL = 1,
+    TAG_CHAR,
+    TAG_SCHAR,
+    TAG_UCHAR,
+    TAG_SHORT,
+    TAG_USHORT,
+    TAG_INT,
+    TAG_UINT,
+    TAG_LONG,
+    TAG_ULONG,
+    TAG_FLOAT,
+    TAG_DOUBLE,
+    TAG_POINTER,
+    TAG_STRING
+  };
+
+  // Write the header of a new log
+
+  extern void header(std::string &data);
+
+  // Append a record to the log
+
+  extern void write(const char *data, size_t size);
+
+  // Messages logged as text, such as errors and warnings
+
+  extern void text(const Mode mode, const char *prefix, const char *name, const std::string &str);
+
+  // Text and JSON as they would have been logged, for the records of a
+  // binary log.  Returns false for a truncated or invalid log.
+
+  extern bool decode(const char *data, size_t size, std::string &text, std::string &json);
+
+  //
+  // Record
+  //
+  // A message record, built on the stack unless the arguments are too
+  // large.  Values that aren't numbers, pointers or strings are printed
+  // when logged, as usual.
+  //
+
+  struct Record
+  {
+  public:
+    Record(Site &site);
+
+    inline void arg(const bool               v) { value(TAG_BOOL,   static_cast<unsigned char>(v)); }
+    inline void arg(const char               v) { value(TAG_CHAR,   v); }
+    inline void arg(const signed char        v) { value(TAG_SCHAR,  v); }
+    inline void arg(const unsigned char      v) { value(TAG_UCHAR,  v); }
+    inline void arg(const signed short       v) { value(TAG_SHORT,  v); }
+    inline void arg(const unsigned short     v) { value(TAG_USHORT, v); }
+    inline void arg(const signed int         v) { value(TAG_INT,    v); }
+    inline void arg(const unsigned int       v) { value(TAG_UINT,   v); }
+    inline void arg(const signed long        v) { value(TAG_LONG,   static_cast<signed long long>(v)); }
+    inline void arg(const unsigned long      v) { value(TAG_ULONG,  static_cast<unsigned long long>(v)); }
+    inline void arg(const signed long long   v) { value(TAG_LONG,   v); }
+    inline void arg(const unsigned long long v) { value(TAG_ULONG,  v); }
+    inline void arg(const float              v) { value(TAG_FLOAT,  v); }
+    inline void arg(const double             v) { value(TAG_DOUBLE, v); }
+
+    inline void arg(const char        *v) { characters(v, v ? std::strlen(v) : 0); }
+    inline void arg(const std::string &v) { characters(v.c_str(), v.length()); }
+
+    template<typename T> inline void arg(const T *v) { value(TAG_POINTER, static_cast<unsigned long long>(reinterpret_cast<size_t>(v))); }
+
+    template<typename T> inline void arg(const ::boost::print::detail::optional<T> &v) { if (v._enabled) arg(v._val); }
+
+    template<typename T> inline void arg(const T &v) { arg(::boost::print::print_string(v)); }
+
+    void end();
+
+  private:
+    template<typename T>
+    inline void value(const Tag tag, const T v)
+    {
+      if (_size + 1 + sizeof(T) <= sizeof(_buffer))
+      {
+        _buffer[_size] = static_cast<char>(tag);
+        std::memcpy(_buffer + _size + 1, &v, sizeof(T));
+        _size += 1 + sizeof(T);
+      }
+      else
+      {
+        const char t = static_cast<char>(tag);
+        put(&t, 1);
+        put(&v, sizeof(T));
+      }
+    }
+
+    void characters(const char *v, size_t length);
+    void put(const void *data, size_t size);
+
+    char        _buffer[256];
+    size_t      _size;
+    std::string _spill;         // Once the buffer is full
+
+    Record(const Record &other);
+    Record &operator=(const Record &other);
+  };
+
+  template<typename A1>
+  void output(Site &site, const A1 &a1)
+  { Record r(site); r.arg(a1); r.end(); }
+
+  template<typename A1, typename A2>
+  void output(Site &site, const A1 &a1, const A2 &a2)
+  { Record r(site); r.arg(a1); r.arg(a2); r.end(); }
+
+  template<typename A1, typename A2, typename A3>
+  void output(Site &site, const A1 &a1, const A2 &a2, const A3 &a3)
+  { Record r(site); r.arg(a1); r.arg(a2); r.arg(a3); r.end(); }
+
+  template<typename A1, typename A2, typename A3, typename A4>
+  void output(Site &site, const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4)
+  { Record r(site); r.arg(a1); r.arg(a2); r.arg(a3); r.arg(a4); r.end(); }
+
+  template<typename A1, typename A2, typename A3, typename A4, typename A5>
+  void output(Site &site, const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4, const A5 &a5)
+  { Record r(site); r.arg(a1); r.arg(a2); r.arg(a3); r.arg(a4); r.arg(a5); r.end(); }
+
+  template<typename A1, typename A2, typename A3, typename A4, typename A5, typename A6>
+  void output(Site &site, const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4, const A5 &a5, const A6 &a6)
+  { Record r(site); r.arg(a1); r.arg(a2); r.arg(a3); r.arg(a4); r.arg(a5); r.arg(a6); r.end(); }
+
+  template<typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7>
+  void output(Site &site, const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4, const A5 &a5, const A6 &a6, const A7 &a7)
+  { Record r(site); r.arg(a1); r.arg(a2); r.arg(a3); r.arg(a4); r.arg(a5); r.arg(a6); r.arg(a7); r.end(); }
+
+  template<typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8>
+  void output(Site &site, const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4, const A5 &a5, const A6 &a6, const A7 &a7, const A8 &a8)
+  { Record r(site); r.arg(a1); r.arg(a2); r.arg(a3); r.arg(a4); r.arg(a5); r.arg(a6); r.arg(a7); r.arg(a8); r.end(); }
+
+  template<typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9>
+  void output(Site &site, const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4, const A5 &a5, const A6 &a6, const A7 &a7, const A8 &a8, const A9 &a9)
+  { Record r(site); r.arg(a1); r.arg(a2); r.arg(a3); r.arg(a4); r.arg(a5); r.arg(a6); r.arg(a7); r.arg(a8); r.arg(a9); r.end(); }
+
+  template<typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10>
+  void output(Site &site, const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4, const A5 &a5, const A6 &a6, const A7 &a7, const A8 &a8, const A9 &a9, const A10 &a10)
+  { Record r(site); r.arg(a1); r.arg(a2); r.arg(a3); r.arg(a4); r.arg(a5); r.arg(a6); r.arg(a7); r.arg(a8); r.arg(a9); r.arg(a10); r.end(); }
+
+  template<typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10, typename A11>
+  void output(Site &site, const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4, const A5 &a5, const A6 &a6, const A7 &a7, const A8 &a8, const A9 &a9, const A10 &a10, const A11 &a11)
+  { Record r(site); r.arg(a1); r.arg(a2); r.arg(a3); r.arg(a4); r.arg(a5); r.arg(a6); r.arg(a7); r.arg(a8); r.arg(a9); r.arg(a10); r.arg(a11); r.end(); }
+
+  template<typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10, typename A11, typename A12>
+  void output(Site &site, const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4, const A5 &a5, const A6 &a6, const A7 &a7, const A8 &a8, const A9 &a9, const A10 &a10, const A11 &a11, const A12 &a12)
+  { Record r(site); r.arg(a1); r.arg(a2); r.arg(a3); r.arg(a4); r.arg(a5); r.arg(a6); r.arg(a7); r.arg(a8); r.arg(a9); r.arg(a10); r.arg(a11); r.arg(a12); r.end(); }
+
+  template<typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10, typename A11, typename A12, typename A13>
+  void output(Site &site, const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4, const A5 &a5, const A6 &a6, const A7 &a7, const A8 &a8, const A9 &a9, const A10 &a10, const A11 &a11, const A12 &a12, const A13 &a13)
+  { Record r(site); r.arg(a1); r.arg(a2); r.arg(a3); r.arg(a4); r.arg(a5); r.arg(a6); r.arg(a7); r.arg(a8); r.arg(a9); r.arg(a10); r.arg(a11); r.arg(a12); r.arg(a13); r.end(); }
+
+  template<typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10, typename A11, typename A12, typename A13, typename A14>
+  void output(Site &site, const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4, const A5 &a5, const A6 &a6, const A7 &a7, const A8 &a8, const A9 &a9, const A10 &a10, const A11 &a11, const A12 &a12, const A13 &a13, const A14 &a14)
+  { Record r(site); r.arg(a1); r.arg(a2); r.arg(a3); r.arg(a4); r.arg(a5); r.arg(a6); r.arg(a7); r.arg(a8); r.arg(a9); r.arg(a10); r.arg(a11); r.arg(a12); r.arg(a13); r.arg(a14); r.end(); }
+
+  template<typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10, typename A11, typename A12, typename A13, typename A14, typename A15>
+  void output(Site &site, const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4, const A5 &a5, const A6 &a6, const A7 &a7, const A8 &a8, const A9 &a9, const A10 &a10, const A11 &a11, const A12 &a12, const A13 &a13, const A14 &a14, const A15 &a15)
+  { Record r(site); r.arg(a1); r.arg(a2); r.arg(a3); r.arg(a4); r.arg(a5); r.arg(a6); r.arg(a7); r.arg(a8); r.arg(a9); r.arg(a10); r.arg(a11); r.arg(a12); r.arg(a13); r.arg(a14); r.arg(a15); r.end(); }
+
+  template<typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10, typename A11, typename A12, typename A13, typename A14, typename A15, typename A16>
+  void output(Site &site, const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4, const A5 &a5, const A6 &a6, const A7 &a7, const A8 &a8, const A9 &a9, const A10 &a10, const A11 &a11, const A12 &a12, const A13 &a13, const A14 &a14, const A15 &a15, const A16 &a16)
+  { Record r(site); r.arg(a1); r.arg(a2); r.arg(a3); r.arg(a4); r.arg(a5); r.arg(a6); r.arg(a7); r.arg(a8); r.arg(a9); r.arg(a10); r.arg(a11); r.arg(a12); r.arg(a13); r.arg(a14); r.arg(a15); r.arg(a16); r.end(); }
+
+  template<typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10, typename A11, typename A12, typename A13, typename A14, typename A15, typename A16, typename A17>
+  void output(Site &site, const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4, const A5 &a5, const A6 &a6, const A7 &a7, const A8 &a8, const A9 &a9, const A10 &a10, const A11 &a11, const A12 &a12, const A13 &a13, const A14 &a14, const A15 &a15, const A16 &a16, const A17 &a17)
+  { Record r(site); r.arg(a1); r.arg(a2); r.arg(a3); r.arg(a4); r.arg(a5); r.arg(a6); r.arg(a7); r.arg(a8); r.arg(a9); r.arg(a10); r.arg(a11); r.arg(a12); r.arg(a13); r.arg(a14); r.arg(a15); r.arg(a16); r.arg(a17); r.end(); }
+
+  template<typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10, typename A11, typename A12, typename A13, typename A14, typename A15, typename A16, typename A17, typename A18>
+  void output(Site &site, const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4, const A5 &a5, const A6 &a6, const A7 &a7, const A8 &a8, const A9 &a9, const A10 &a10, const A11 &a11, const A12 &a12, const A13 &a13, const A14 &a14, const A15 &a15, const A16 &a16, const A17 &a17, const A18 &a18)
+  { Record r(site); r.arg(a1); r.arg(a2); r.arg(a3); r.arg(a4); r.arg(a5); r.arg(a6); r.arg(a7); r.arg(a8); r.arg(a9); r.arg(a10); r.arg(a11); r.arg(a12); r.arg(a13); r.arg(a14); r.arg(a15); r.arg(a16); r.arg(a17); r.arg(a18); r.end(); }
+
+  template<typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10, typename A11, typename A12, typename A13, typename A14, typename A15, typename A16, typename A17, typename A18, typename A19>
+  void output(Site &site, const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4, const A5 &a5, const A6 &a6, const A7 &a7, const A8 &a8, const A9 &a9, const A10 &a10, const A11 &a11, const A12 &a12, const A13 &a13, const A14 &a14, const A15 &a15, const A16 &a16, const A17 &a17, const A18 &a18, const A19 &a19)
+  { Record r(site); r.arg(a1); r.arg(a2); r.arg(a3); r.arg(a4); r.arg(a5); r.arg(a6); r.arg(a7); r.arg(a8); r.arg(a9); r.arg(a10); r.arg(a11); r.arg(a12); r.arg(a13); r.arg(a14); r.arg(a15); r.arg(a16); r.arg(a17); r.arg(a18); r.arg(a19); r.end(); }
+
+  template<typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10, typename A11, typename A12, typename A13, typename A14, typename A15, typename A16, typename A17, typename A18, typename A19, typename A20>
+  void output(Site &site, const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4, const A5 &a5, const A6 &a6, const A7 &a7, const A8 &a8, const A9 &a9, const A10 &a10, const A11 &a11, const A12 &a12, const A13 &a13, const A14 &a14, const A15 &a15, const A16 &a16, const A17 &a17, const A18 &a18, const A19 &a19, const A20 &a20)
+  { Record r(site); r.arg(a1); r.arg(a2); r.arg(a3); r.arg(a4); r.arg(a5); r.arg(a6); r.arg(a7); r.arg(a8); r.arg(a9); r.arg(a10); r.arg(a11); r.arg(a12); r.arg(a13); r.arg(a14); r.arg(a15); r.arg(a16); r.arg(a17); r.arg(a18); r.arg(a19); r.arg(a20); r.end(); }
+
+  template<typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10, typename A11, typename A12, typename A13, typename A14, typename A15, typename A16, typename A17, typename A18, typename A19, typename A20, typename A21>
+  void output(Site &site, const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4, const A5 &a5, const A6 &a6, const A7 &a7, const A8 &a8, const A9 &a9, const A10 &a10, const A11 &a11, const A12 &a12, const A13 &a13, const A14 &a14, const A15 &a15, const A16 &a16, const A17 &a17, const A18 &a18, const A19 &a19, const A20 &a20, const A21 &a21)
+  { Record r(site); r.arg(a1); r.arg(a2); r.arg(a3); r.arg(a4); r.arg(a5); r.arg(a6); r.arg(a7); r.arg(a8); r.arg(a9); r.arg(a10); r.arg(a11); r.arg(a12); r.arg(a13); r.arg(a14); r.arg(a15); r.arg(a16); r.arg(a17); r.arg(a18); r.arg(a19); r.arg(a20); r.arg(a21); r.end(); }
+
+  template<typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10, typename A11, typename A12, typename A13, typename A14, typename A15, typename A16, typename A17, typename A18, typename A19, typename A20, typename A21, typename A22>
+  void output(Site &site, const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4, const A5 &a5, const A6 &a6, const A7 &a7, const A8 &a8, const A9 &a9, const A10 &a10, const A11 &a11, const A12 &a12, const A13 &a13, const A14 &a14, const A15 &a15, const A16 &a16, const A17 &a17, const A18 &a18, const A19 &a19, const A20 &a20, const A21 &a21, const A22 &a22)
+  { Record r(site); r.arg(a1); r.arg(a2); r.arg(a3); r.arg(a4); r.arg(a5); r.arg(a6); r.arg(a7); r.arg(a8); r.arg(a9); r.arg(a10); r.arg(a11); r.arg(a12); r.arg(a13); r.arg(a14); r.arg(a15); r.arg(a16); r.arg(a17); r.arg(a18); r.arg(a19); r.arg(a20); r.arg(a21); r.arg(a22); r.end(); }
+
+  template<typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10, typename A11, typename A12, typename A13, typename A14, typename A15, typename A16, typename A17, typename A18, typename A19, typename A20, typename A21, typename A22, typename A23>
+  void output(Site &site, const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4, const A5 &a5, const A6 &a6, const A7 &a7, const A8 &a8, const A9 &a9, const A10 &a10, const A11 &a11, const A12 &a12, const A13 &a13, const A14 &a14, const A15 &a15, const A16 &a16, const A17 &a17, const A18 &a18, const A19 &a19, const A20 &a20, const A21 &a21, const A22 &a22, const A23 &a23)
+  { Record r(site); r.arg(a1); r.arg(a2); r.arg(a3); r.arg(a4); r.arg(a5); r.arg(a6); r.arg(a7); r.arg(a8); r.arg(a9); r.arg(a10); r.arg(a11); r.arg(a12); r.arg(a13); r.arg(a14); r.arg(a15); r.arg(a16); r.arg(a17); r.arg(a18); r.arg(a19); r.arg(a20); r.arg(a21); r.arg(a22); r.arg(a23); r.end(); }
+
+  template<typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10, typename A11, typename A12, typename A13, typename A14, typename A15, typename A16, typename A17, typename A18, typename A19, typename A20, typename A21, typename A22, typename A23, typename A24>
+  void output(Site &site, const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4, const A5 &a5, const A6 &a6, const A7 &a7, const A8 &a8, const A9 &a9, const A10 &a10, const A11 &a11, const A12 &a12, const A13 &a13, const A14 &a14, const A15 &a15, const A16 &a16, const A17 &a17, const A18 &a18, const A19 &a19, const A20 &a20, const A21 &a21, const A22 &a22, const A23 &a23, const A24 &a24)
+  { Record r(site); r.arg(a1); r.arg(a2); r.arg(a3); r.arg(a4); r.arg(a5); r.arg(a6); r.arg(a7); r.arg(a8); r.arg(a9); r.arg(a10); r.arg(a11); r.arg(a12); r.arg(a13); r.arg(a14); r.arg(a15); r.arg(a16); r.arg(a17); r.arg(a18); r.arg(a19); r.arg(a20); r.arg(a21); r.arg(a22); r.arg(a23); r.arg(a24); r.end(); }
+
+  template<typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10, typename A11, typename A12, typename A13, typename A14, typename A15, typename A16, typename A17, typename A18, typename A19, typename A20, typename A21, typename A22, typename A23, typename A24, typename A25>
+  void output(Site &site, const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4, const A5 &a5, const A6 &a6, const A7 &a7, const A8 &a8, const A9 &a9, const A10 &a10, const A11 &a11, const A12 &a12, const A13 &a13, const A14 &a14, const A15 &a15, const A16 &a16, const A17 &a17, const A18 &a18, const A19 &a19, const A20 &a20, const A21 &a21, const A22 &a22, const A23 &a23, const A24 &a24, const A25 &a25)
+  { Record r(site); r.arg(a1); r.arg(a2); r.arg(a3); r.arg(a4); r.arg(a5); r.arg(a6); r.arg(a7); r.arg(a8); r.arg(a9); r.arg(a10); r.arg(a11); r.arg(a12); r.arg(a13); r.arg(a14); r.arg(a15); r.arg(a16); r.arg(a17); r.arg(a18); r.arg(a19); r.arg(a20); r.arg(a21); r.arg(a22); r.arg(a23); r.arg(a24); r.arg(a25); r.end(); }
+
+  template<typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10, typename A11, typename A12, typename A13, typename A14, typename A15, typename A16, typename A17, typename A18, typename A19, typename A20, typename A21, typename A22, typename A23, typename A24, typename A25, typename A26>
+  void output(Site &site, const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4, const A5 &a5, const A6 &a6, const A7 &a7, const A8 &a8, const A9 &a9, const A10 &a10, const A11 &a11, const A12 &a12, const A13 &a13, const A14 &a14, const A15 &a15, const A16 &a16, const A17 &a17, const A18 &a18, const A19 &a19, const A20 &a20, const A21 &a21, const A22 &a22, const A23 &a23, const A24 &a24, const A25 &a25, const A26 &a26)
+  { Record r(site); r.arg(a1); r.arg(a2); r.arg(a3); r.arg(a4); r.arg(a5); r.arg(a6); r.arg(a7); r.arg(a8); r.arg(a9); r.arg(a10); r.arg(a11); r.arg(a12); r.arg(a13); r.arg(a14); r.arg(a15); r.arg(a16); r.arg(a17); r.arg(a18); r.arg(a19); r.arg(a20); r.arg(a21); r.arg(a22); r.arg(a23); r.arg(a24); r.arg(a25); r.arg(a26); r.end(); }
+
+  template<typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10, typename A11, typename A12, typename A13, typename A14, typename A15, typename A16, typename A17, typename A18, typename A19, typename A20, typename A21, typename A22, typename A23, typename A24, typename A25, typename A26, typename A27>
+  void output(Site &site, const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4, const A5 &a5, const A6 &a6, const A7 &a7, const A8 &a8, const A9 &a9, const A10 &a10, const A11 &a11, const A12 &a12, const A13 &a13, const A14 &a14, const A15 &a15, const A16 &a16, const A17 &a17, const A18 &a18, const A19 &a19, const A20 &a20, const A21 &a21, const A22 &a22, const A23 &a23, const A24 &a24, const A25 &a25, const A26 &a26, const A27 &a27)
+  { Record r(site); r.arg(a1); r.arg(a2); r.arg(a3); r.arg(a4); r.arg(a5); r.arg(a6); r.arg(a7); r.arg(a8); r.arg(a9); r.arg(a10); r.arg(a11); r.arg(a12); r.arg(a13); r.arg(a14); r.arg(a15); r.arg(a16); r.arg(a17); r.arg(a18); r.arg(a19); r.arg(a20); r.arg(a21); r.arg(a22); r.arg(a23); r.arg(a24); r.arg(a25); r.arg(a26); r.arg(a27); r.end(); }
+
+  template<typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10, typename A11, typename A12, typename A13, typename A14, typename A15, typename A16, typename A17, typename A18, typename A19, typename A20, typename A21, typename A22, typename A23, typename A24, typename A25, typename A26, typename A27, typename A28>
+  void output(Site &site, const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4, const A5 &a5, const A6 &a6, const A7 &a7, const A8 &a8, const A9 &a9, const A10 &a10, const A11 &a11, const A12 &a12, const A13 &a13, const A14 &a14, const A15 &a15, const A16 &a16, const A17 &a17, const A18 &a18, const A19 &a19, const A20 &a20, const A21 &a21, const A22 &a22, const A23 &a23, const A24 &a24, const A25 &a25, const A26 &a26, const A27 &a27, const A28 &a28)
+  { Record r(site); r.arg(a1); r.arg(a2); r.arg(a3); r.arg(a4); r.arg(a5); r.arg(a6); r.arg(a7); r.arg(a8); r.arg(a9); r.arg(a10); r.arg(a11); r.arg(a12); r.arg(a13); r.arg(a14); r.arg(a15); r.arg(a16); r.arg(a17); r.arg(a18); r.arg(a19); r.arg(a20); r.arg(a21); r.arg(a22); r.arg(a23); r.arg(a24); r.arg(a25); r.arg(a26); r.arg(a27); r.arg(a28); r.end(); }
+
+  template<typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10, typename A11, typename A12, typename A13, typename A14, typename A15, typename A16, typename A17, typename A18, typename A19, typename A20, typename A21, typename A22, typename A23, typename A24, typename A25, typename A26, typename A27, typename A28, typename A29>
+  void output(Site &site, const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4, const A5 &a5, const A6 &a6, const A7 &a7, const A8 &a8, const A9 &a9, const A10 &a10, const A11 &a11, const A12 &a12, const A13 &a13, const A14 &a14, const A15 &a15, const A16 &a16, const A17 &a17, const A18 &a18, const A19 &a19, const A20 &a20, const A21 &a21, const A22 &a22, const A23 &a23, const A24 &a24, const A25 &a25, const A26 &a26, const A27 &a27, const A28 &a28, const A29 &a29)
+  { Record r(site); r.arg(a1); r.arg(a2); r.arg(a3); r.arg(a4); r.arg(a5); r.arg(a6); r.arg(a7); r.arg(a8); r.arg(a9); r.arg(a10); r.arg(a11); r.arg(a12); r.arg(a13); r.arg(a14); r.arg(a15); r.arg(a16); r.arg(a17); r.arg(a18); r.arg(a19); r.arg(a20); r.arg(a21); r.arg(a22); r.arg(a23); r.arg(a24); r.arg(a25); r.arg(a26); r.arg(a27); r.arg(a28); r.arg(a29); r.end(); }
+
+  template<typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10, typename A11, typename A12, typename A13, typename A14, typename A15, typename A16, typename A17, typename A18, typename A19, typename A20, typename A21, typename A22, typename A23, typename A24, typename A25, typename A26, typename A27, typename A28, typename A29, typename A30>
+  void output(Site &site, const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4, const A5 &a5, const A6 &a6, const A7 &a7, const A8 &a8, const A9 &a9, const A10 &a10, const A11 &a11, const A12 &a12, const A13 &a13, const A14 &a14, const A15 &a15, const A16 &a16, const A17 &a17, const A18 &a18, const A19 &a19, const A20 &a20, const A21 &a21, const A22 &a22, const A23 &a23, const A24 &a24, const A25 &a25, const A26 &a26, const A27 &a27, const A28 &a28, const A29 &a29, const A30 &a30)
+  { Record r(site); r.arg(a1); r.arg(a2); r.arg(a3); r.arg(a4); r.arg(a5); r.arg(a6); r.arg(a7); r.arg(a8); r.arg(a9); r.arg(a10); r.arg(a11); r.arg(a12); r.arg(a13); r.arg(a14); r.arg(a15); r.arg(a16); r.arg(a17); r.arg(a18); r.arg(a19); r.arg(a20); r.arg(a21); r.arg(a22); r.arg(a23); r.arg(a24); r.arg(a25); r.arg(a26); r.arg(a27); r.arg(a28); r.arg(a29); r.arg(a30); r.end(); }
+
+  template<typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10, typename A11, typename A12, typename A13, typename A14, typename A15, typename A16, typename A17, typename A18, typename A19, typename A20, typename A21, typename A22, typename A23, typename A24, typename A25, typename A26, typename A27, typename A28, typename A29, typename A30, typename A31>
+  void output(Site &site, const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4, const A5 &a5, const A6 &a6, const A7 &a7, const A8 &a8, const A9 &a9, const A10 &a10, const A11 &a11, const A12 &a12, const A13 &a13, const A14 &a14, const A15 &a15, const A16 &a16, const A17 &a17, const A18 &a18, const A19 &a19, const A20 &a20, const A21 &a21, const A22 &a22, const A23 &a23, const A24 &a24, const A25 &a25, const A26 &a26, const A27 &a27, const A28 &a28, const A29 &a29, const A30 &a30, const A31 &a31)
+  { Record r(site); r.arg(a1); r.arg(a2); r.arg(a3); r.arg(a4); r.arg(a5); r.arg(a6); r.arg(a7); r.arg(a8); r.arg(a9); r.arg(a10); r.arg(a11); r.arg(a12); r.arg(a13); r.arg(a14); r.arg(a15); r.arg(a16); r.arg(a17); r.arg(a18); r.arg(a19); r.arg(a20); r.arg(a21); r.arg(a22); r.arg(a23); r.arg(a24); r.arg(a25); r.arg(a26); r.arg(a27); r.arg(a28); r.arg(a29); r.arg(a30); r.arg(a31); r.end(); }
+
+  template<typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10, typename A11, typename A12, typename A13, typename A14, typename A15, typename A16, typename A17, typename A18, typename A19, typename A20, typename A21, typename A22, typename A23, typename A24, typename A25, typename A26, typename A27, typename A28, typename A29, typename A30, typename A31, typename A32>
+  void output(Site &site, const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4, const A5 &a5, const A6 &a6, const A7 &a7, const A8 &a8, const A9 &a9, const A10 &a10, const A11 &a11, const A12 &a12, const A13 &a13, const A14 &a14, const A15 &a15, const A16 &a16, const A17 &a17, const A18 &a18, const A19 &a19, const A20 &a20, const A21 &a21, const A22 &a22, const A23 &a23, const A24 &a24, const A25 &a25, const A26 &a26, const A27 &a27, const A28 &a28, const A29 &a29, const A30 &a30, const A31 &a31, const A32 &a32)
+  { Record r(site); r.arg(a1); r.arg(a2); r.arg(a3); r.arg(a4); r.arg(a5); r.arg(a6); r.arg(a7); r.arg(a8); r.arg(a9); r.arg(a10); r.arg(a11); r.arg(a12); r.arg(a13); r.arg(a14); r.arg(a15); r.arg(a16); r.arg(a17); r.arg(a18); r.arg(a19); r.arg(a20); r.arg(a21); r.arg(a22); r.arg(a23); r.arg(a24); r.arg(a25); r.arg(a26); r.arg(a27); r.arg(a28); r.arg(a29); r.arg(a30); r.arg(a31); r.arg(a32); r.end(); }
+
+  template<typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10, typename A11, typename A12, typename A13, typename A14, typename A15, typename A16, typename A17, typename A18, typename A19, typename A20, typename A21, typename A22, typename A23, typename A24, typename A25, typename A26, typename A27, typename A28, typename A29, typename A30, typename A31, typename A32, typename A33>
+  void output(Site &site, const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4, const A5 &a5, const A6 &a6, const A7 &a7, const A8 &a8, const A9 &a9, const A10 &a10, const A11 &a11, const A12 &a12, const A13 &a13, const A14 &a14, const A15 &a15, const A16 &a16, const A17 &a17, const A18 &a18, const A19 &a19, const A20 &a20, const A21 &a21, const A22 &a22, const A23 &a23, const A24 &a24, const A25 &a25, const A26 &a26, const A27 &a27, const A28 &a28, const A29 &a29, const A30 &a30, const A31 &a31, const A32 &a32, const A33 &a33)
+  { Record r(site); r.arg(a1); r.arg(a2); r.arg(a3); r.arg(a4); r.arg(a5); r.arg(a6); r.arg(a7); r.arg(a8); r.arg(a9); r.arg(a10); r.arg(a11); r.arg(a12); r.arg(a13); r.arg(a14); r.arg(a15); r.arg(a16); r.arg(a17); r.arg(a18); r.arg(a19); r.arg(a20); r.arg(a21); r.arg(a22); r.arg(a23); r.arg(a24); r.arg(a25); r.arg(a26); r.arg(a27); r.arg(a28); r.arg(a29); r.arg(a30); r.arg(a31); r.arg(a32); r.arg(a33); r.end(); }
+
+  template<typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10, typename A11, typename A12, typename A13, typename A14, typename A15, typename A16, typename A17, typename A18, typename A19, typename A20, typename A21, typename A22, typename A23, typename A24, typename A25, typename A26, typename A27, typename A28, typename A29, typename A30, typename A31, typename A32, typename A33, typename A34>
+  void output(Site &site, const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4, const A5 &a5, const A6 &a6, const A7 &a7, const A8 &a8, const A9 &a9, const A10 &a10, const A11 &a11, const A12 &a12, const A13 &a13, const A14 &a14, const A15 &a15, const A16 &a16, const A17 &a17, const A18 &a18, const A19 &a19, const A20 &a20, const A21 &a21, const A22 &a22, const A23 &a23, const A24 &a24, const A25 &a25, const A26 &a26, const A27 &a27, const A28 &a28, const A29 &a29, const A30 &a30, const A31 &a31, const A32 &a32, const A33 &a33, const A34 &a34)
+  { Record r(site); r.arg(a1); r.arg(a2); r.arg(a3); r.arg(a4); r.arg(a5); r.arg(a6); r.arg(a7); r.arg(a8); r.arg(a9); r.arg(a10); r.arg(a11); r.arg(a12); r.arg(a13); r.arg(a14); r.arg(a15); r.arg(a16); r.arg(a17); r.arg(a18); r.arg(a19); r.arg(a20); r.arg(a21); r.arg(a22); r.arg(a23); r.arg(a24); r.arg(a25); r.arg(a26); r.arg(a27); r.arg(a28); r.arg(a29); r.arg(a30); r.arg(a31); r.arg(a32); r.arg(a33); r.arg(a34); r.end(); }
+}
+
+}
+
+REGAL_NAMESPACE_END
+
+#endif
@@ -0,0 +1,400 @@
+/*
+  Copyright (c) 2011-2013 NVIDIA Corporation
+  Copyright (c) 2013 Mark Adams
+  Copyright (c) 2013 Nigel Stewart
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+  OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+  OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+
+ Regal asynchronous log sink
+
+ */
+
+#include "pch.h" /* For MS precompiled header support */
+
+#include "RegalUtil.h"
+
+REGAL_GLOBAL_BEGIN
+
+#include <cstring>
+
+#include "RegalLogSink.h"
+
+#if REGAL_WORKER_THREADS
+#include <sys/time.h>
+#include <time.h>
+#endif
+
+REGAL_GLOBAL_END
+
+REGAL_NAMESPACE_BEGIN
+
+namespace Logging
+{
+
+#if REGAL_WORKER_THREADS
+
+namespace {
+
+  // Each record is a header and the data, padded to a multiple of the
+  // header size.  A pad record skips the remainder of the ring, so that
+  // records are always contiguous.
+
+  struct Header
+  {
+    unsigned int size;
+    unsigned int kind;
+  };
+
+  const unsigned int padKind = ~0u;
+
+  inline size_t recordSize(size_t size)
+  {
+    return sizeof(Header) + ((size + sizeof(Header) - 1) & ~(sizeof(Header) - 1));
+  }
+
+  template<typename T> inline T    loadAcquire(const T &v)    { return __atomic_load_n(&v, __ATOMIC_ACQUIRE); }
+  template<typename T> inline void storeRelease(T &v, T value) { __atomic_store_n(&v, value, __ATOMIC_RELEASE); }
+
+  void deadline(timespec &ts, unsigned int ms)
+  {
+    timeval now;
+    gettimeofday(&now, NULL);
+    ts.tv_sec  = now.tv_sec + ms/1000;
+    ts.tv_nsec = long(now.tv_usec)*1000 + long(ms%1000)*1000000;
+    if (ts.tv_nsec >= 1000000000)
+    {
+      ts.tv_sec  += 1;
+      ts.tv_nsec -= 1000000000;
+    }
+  }
+}
+
+//
+// Ring
+//
+// Single producer, single consumer.  The producer advances head and the
+// writer advances tail, both count bytes from the start.
+//
+
+struct Sink::Ring
+{
+  Ring(size_t size) : data(size), head(0), tail(0), orphaned(false) {}
+
+  std::vector<char> data;
+  size_t            head;
+  size_t            tail;
+  bool              orphaned;     // The thread it was created for has exited
+};
+
+#else
+
+struct Sink::Ring {};
+
+#endif
+
+Sink::Sink(Consume consume, Commit commit, void *user, size_t ringSize, unsigned int interval)
+: _consume(consume)
+, _commit(commit)
+, _user(user)
+, _ringSize(4096)
+, _interval(interval ? interval : 1)
+, _running(false)
+{
+  RegalAssert(consume);
+
+  while (_ringSize < ringSize)
+    _ringSize *= 2;
+
+#if REGAL_WORKER_THREADS
+  pthread_key_create(&_key, release);
+  pthread_mutex_init(&_mutex, NULL);
+  pthread_cond_init(&_wake, NULL);
+  pthread_cond_init(&_passed, NULL);
+  _passRequested = _passDone = 0;
+  _stop = false;
+#endif
+}
+
+Sink::~Sink()
+{
+  stop();
+#if REGAL_WORKER_THREADS
+  for (size_t i = 0; i < _rings.size(); ++i)
+    delete _rings[i];
+  pthread_cond_destroy(&_passed);
+  pthread_cond_destroy(&_wake);
+  pthread_mutex_destroy(&_mutex);
+  pthread_key_delete(_key);
+#endif
+}
+
+bool
+Sink::start()
+{
+#if REGAL_WORKER_THREADS
+  if (_running)
+    return true;
+
+  _stop = false;
+  if (pthread_create(&_thread, NULL, main, this))
+    return false;
+  _running = true;
+  return true;
+#else
+  return false;
+#endif
+}
+
+void
+Sink::stop()
+{
+#if REGAL_WORKER_THREADS
+  if (!_running)
+    return;
+
+  // The writer makes a last pass before exiting
+
+  pthread_mutex_lock(&_mutex);
+  _stop = true;
+  pthread_cond_signal(&_wake);
+  pthread_mutex_unlock(&_mutex);
+
+  pthread_join(_thread, NULL);
+  _running = false;
+#endif
+}
+
+void
+Sink::push(unsigned int kind, const char *data, size_t size)
+{
+#if REGAL_WORKER_THREADS
+  // The writer itself, and consumers logging, can't wait for the writer
+
+  Ring *r = _running && !pthread_equal(pthread_self(), _thread) ? ring() : NULL;
+  const size_t need = recordSize(size);
+
+  if (r && need <= r->data.size()/2)
+  {
+    const size_t capacity = r->data.size();
+    size_t head = r->head;
+    size_t pos  = head & (capacity - 1);
+    const size_t toEnd = capacity - pos;
+    const size_t total = need + (toEnd < need ? toEnd : 0);
+
+    // Full, wait for the writer to make room
+
+    while (head + total - loadAcquire(r->tail) > capacity)
+      flush();
+
+    Header h;
+    if (toEnd < need)
+    {
+      h.size = static_cast<unsigned int>(toEnd);
+      h.kind = padKind;
+      memcpy(&r->data[pos], &h, sizeof(h));
+      head += toEnd;
+      pos = 0;
+    }
+
+    h.size = static_cast<unsigned int>(size);
+    h.kind = kind;
+    memcpy(&r->data[pos], &h, sizeof(h));
+    if (size)
+      memcpy(&r->data[pos + sizeof(h)], data, size);
+    head += need;
+    storeRelease(r->head, head);
+
+    if (head - loadAcquire(r->tail) > capacity/2)
+      pthread_cond_signal(&_wake);
+    return;
+  }
+
+  // Records too large for the ring are written directly, after
+  // anything this thread queued before them.
+
+  if (r)
+    flush();
+#endif
+
+  Thread::ScopedLock lock(&_commitMutex);
+  _consume(_user, kind, data, size);
+  if (_commit)
+    _commit(_user);
+}
+
+bool
+Sink::flush(unsigned int timeout)
+{
+#if REGAL_WORKER_THREADS
+  if (!_running || pthread_equal(pthread_self(), _thread))
+    return true;
+
+  timespec ts;
+  if (timeout)
+    deadline(ts, timeout);
+
+  pthread_mutex_lock(&_mutex);
+  const unsigned long ticket = ++_passRequested;
+  pthread_cond_signal(&_wake);
+  bool ok = true;
+  while (ok && _passDone < ticket)
+    ok = (timeout ? pthread_cond_timedwait(&_passed, &_mutex, &ts) : pthread_cond_wait(&_passed, &_mutex)) == 0 || _passDone >= ticket;
+  pthread_mutex_unlock(&_mutex);
+  return ok;
+#else
+  UNUSED_PARAMETER(timeout);
+  return true;
+#endif
+}
+
+void
+Sink::drain()
+{
+#if REGAL_WORKER_THREADS
+  if (!_running)
+    return;
+
+  if (!pthread_equal(pthread_self(), _thread) && flush(1000))
+    return;
+
+  // The writer is stuck, or it's the one crashing.  Racing with it is
+  // the lesser evil at this point.
+
+  if (consumeRings(_rings) && _commit)
+    _commit(_user);
+#endif
+}
+
+#if REGAL_WORKER_THREADS
+
+Sink::Ring *
+Sink::ring()
+{
+  Ring *r = static_cast<Ring *>(pthread_getspecific(_key));
+  if (r)
+    return r;
+
+  // Reuse the empty ring of an exited thread, if there is one
+
+  pthread_mutex_lock(&_mutex);
+  for (size_t i = 0; !r && i < _rings.size(); ++i)
+    if (loadAcquire(_rings[i]->orphaned) && _rings[i]->head == loadAcquire(_rings[i]->tail))
+    {
+      r = _rings[i];
+      r->orphaned = false;
+    }
+  if (!r)
+  {
+    r = new Ring(_ringSize);
+    _rings.push_back(r);
+  }
+  pthread_mutex_unlock(&_mutex);
+
+  pthread_setspecific(_key, r);
+  return r;
+}
+
+void
+Sink::release(void *ring)
+{
+  storeRelease(static_cast<Ring *>(ring)->orphaned, true);
+}
+
+bool
+Sink::consumeRings(const std::vector<Ring *> &rings)
+{
+  bool consumed = false;
+  for (size_t i = 0; i < rings.size(); ++i)
+  {
+    Ring &r = *rings[i];
+    const size_t mask = r.data.size() - 1;
+    const size_t head = loadAcquire(r.head);
+    size_t       tail = r.tail;
+    while (tail != head)
+    {
+      const size_t pos = tail & mask;
+      Header h;
+      memcpy(&h, &r.data[pos], sizeof(h));
+      if (h.kind == padKind)
+      {
+        tail += h.size;
+        continue;
+      }
+      _consume(_user, h.kind, &r.data[pos + sizeof(h)], h.size);
+      tail += recordSize(h.size);
+      consumed = true;
+    }
+    storeRelease(r.tail, tail);
+  }
+  return consumed;
+}
+
+void *
+Sink::main(void *sink)
+{
+  Sink &s = *static_cast<Sink *>(sink);
+
+  std::vector<Ring *> rings;
+
+  pthread_mutex_lock(&s._mutex);
+  for (;;)
+  {
+    if (s._passRequested == s._passDone && !s._stop)
+    {
+      timespec ts;
+      deadline(ts, s._interval);
+      pthread_cond_timedwait(&s._wake, &s._mutex, &ts);
+    }
+
+    // Everything pushed before the pass was requested is in the rings now
+
+    const unsigned long pass = s._passRequested;
+    const bool stop = s._stop;
+    rings = s._rings;
+    pthread_mutex_unlock(&s._mutex);
+
+    {
+      Thread::ScopedLock lock(&s._commitMutex);
+      if (s.consumeRings(rings) && s._commit)
+        s._commit(s._user);
+    }
+
+    pthread_mutex_lock(&s._mutex);
+    s._passDone = pass;
+    pthread_cond_broadcast(&s._passed);
+    if (stop)
+      break;
+  }
+  pthread_mutex_unlock(&s._mutex);
+
+  return NULL;
+}
+
+#endif
+
+}
+
+REGAL_NAMESPACE_END
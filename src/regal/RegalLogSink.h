@@ -0,0 +1,130 @@
+/*
+  Copyright (c) 2011-2013 NVIDIA Corporation
+  Copyright (c) 2013 Mark Adams
+  Copyright (c) 2013 Nigel Stewart
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+  OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+  OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+
+ Regal asynchronous log sink
+
+ */
+
+#ifndef __REGAL_LOG_SINK_H__
+#define __REGAL_LOG_SINK_H__
+
+#include "RegalUtil.h"
+
+REGAL_GLOBAL_BEGIN
+
+#include <cstddef>
+#include <vector>
+
+#include "RegalWorker.h"
+#include "RegalMutex.h"
+
+REGAL_GLOBAL_END
+
+REGAL_NAMESPACE_BEGIN
+
+namespace Logging
+{
+  //
+  // Sink
+  //
+  // Records pushed by each thread are queued in a ring of that thread,
+  // with no locking, and passed to the consumer on a writer thread.
+  // The writer wakes up every interval milliseconds, or when a ring is
+  // half full, and commits once for each batch of records.
+  //
+  // Without worker threads, or until started, records are consumed and
+  // committed as they are pushed.
+  //
+
+  struct Sink
+  {
+  public:
+    typedef void (*Consume)(void *user, unsigned int kind, const char *data, size_t size);
+    typedef void (*Commit)(void *user);
+
+    Sink(Consume consume, Commit commit, void *user, size_t ringSize = 256*1024, unsigned int interval = 10);
+    ~Sink();
+
+    bool start();
+    void stop();                        // Writes out everything pushed so far
+
+    inline bool running() const { return _running; }
+
+    void push(unsigned int kind, const char *data, size_t size);
+
+    // Wait for everything pushed so far, by any thread, to be committed.
+    // Returns false if the writer took longer than timeout milliseconds.
+
+    bool flush(unsigned int timeout = 0);
+
+    // For crash handlers: write out whatever is queued, by the writer if it
+    // responds within a second, otherwise by the calling thread.
+
+    void drain();
+
+  private:
+
+    struct Ring;
+
+    Consume      _consume;
+    Commit       _commit;
+    void        *_user;
+    size_t       _ringSize;
+    unsigned int _interval;
+    bool         _running;
+
+#if REGAL_WORKER_THREADS
+    static void *main(void *sink);
+    static void  release(void *ring);
+
+    Ring *ring();
+    bool  consumeRings(const std::vector<Ring *> &rings);
+
+    pthread_key_t       _key;
+    pthread_mutex_t     _mutex;            // Guards the rings and the pass counters
+    pthread_cond_t      _wake;
+    pthread_cond_t      _passed;
+    pthread_t           _thread;
+    std::vector<Ring *> _rings;
+    unsigned long       _passRequested;
+    unsigned long       _passDone;
+    bool                _stop;
+#endif
+
+    Thread::Mutex       _commitMutex;      // Held while records are consumed
+
+    Sink(const Sink &other);
+    Sink &operator=(const Sink &other);
+  };
+}
+
+REGAL_NAMESPACE_END
+
+#endif
@@ -48,6 +48,17 @@ REGAL_GLOBAL_BEGIN
 
 #include "RegalPixelConversions.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+# define REGAL_PIXEL_SSE2 1
+# include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+# define REGAL_PIXEL_NEON 1
+# include <arm_neon.h>
+#elif defined(__wasm_simd128__)
+# define REGAL_PIXEL_WASM 1
+# include <wasm_simd128.h>
+#endif
+
 REGAL_GLOBAL_END
 
 
@@ -148,16 +159,367 @@ Registry<GL_LUMINANCE,       GL_UNSIGNED_BYTE,          Pixel<uint8_t,  1,   0xf
 Registry<GL_RGBA,            GL_RGB5,                   Pixel<uint16_t, 2, 0x001f, 0x03e0, 0x7c00,      0>     > rgb_555_;
 
 // 16bpp
+typedef Pixel<uint16_t, 2, 0xf800, 0x07e0, 0x001f,      0> RGB565;
+typedef Pixel<uint16_t, 2, 0xf000, 0x0f00, 0x00f0, 0x000f> RGBA4444;
+typedef Pixel<uint16_t, 2, 0xf800, 0x07c0, 0x003e, 0x0001> RGBA5551;
+
 Registry<GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE,          Pixel<uint16_t, 2, 0x00ff,      0,      0, 0xff00>     > la_88_;
-Registry<GL_RGB,             GL_UNSIGNED_SHORT_5_6_5,   Pixel<uint16_t, 2, 0xf800, 0x07e0, 0x001f,      0>     > rgb_565_;
-Registry<GL_RGBA,            GL_UNSIGNED_SHORT_4_4_4_4, Pixel<uint16_t, 2, 0xf000, 0x0f00, 0x00f0, 0x000f>     > rgba_4444_;
-Registry<GL_RGBA,            GL_UNSIGNED_SHORT_5_5_5_1, Pixel<uint16_t, 2, 0xf800, 0x07c0, 0x003e, 0x0001>     > rgba_5551_;
+Registry<GL_RGB,             GL_UNSIGNED_SHORT_5_6_5,   RGB565                                                 > rgb_565_;
+Registry<GL_RGBA,            GL_UNSIGNED_SHORT_4_4_4_4, RGBA4444                                               > rgba_4444_;
+Registry<GL_RGBA,            GL_UNSIGNED_SHORT_5_5_5_1, RGBA5551                                               > rgba_5551_;
 
 // 24bpp (needs some special handling)
 Registry<GL_RGB,             GL_UNSIGNED_BYTE,          PixelAny<uint24_t, 3, 0x0000ff, 0x00ff00, 0xff0000, 0> > rgb_888_;
 
 // 32bpp
 Registry<GL_RGBA,            GL_UNSIGNED_BYTE,          Pixel<uint32_t, 4, 0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000> > rgba_8888_;
+Registry<GL_BGRA,            GL_UNSIGNED_BYTE,          Pixel<uint32_t, 4, 0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000> > bgra_8888_;
+
+// ===========================================================================
+// Direct conversions.
+//
+// The most common pairs are converted in a single pass, rather than through
+// the RGBA 8888 intermediate with a virtual call for each side. Each pair has
+// a scalar kernel, and a SIMD kernel converting eight pixels per iteration
+// (SSE2, NEON or wasm SIMD) that leaves the remainder to the scalar kernel.
+// The SIMD kernels are chosen at runtime if the CPU supports them.
+//
+// The 16 bit packers truncate each component exactly as Component<>::p8
+// does, so they match the Pack32 conversions bit for bit. Luminance is
+// replicated to red, green and blue as glTexImage2D specifies, whereas the
+// generic conversion only fills red.
+//
+// Unpacked RGBA 8888 has red in the lowest byte (see the note above).
+// ===========================================================================
+
+static void RGBA8888toRGB565( const void* src, void* dst, size_t cnt )
+{
+  RGB565::Pack32( static_cast<const uint32_t*>( src ), static_cast<uint16_t*>( dst ), cnt );
+}
+
+static void RGBA8888toRGBA4444( const void* src, void* dst, size_t cnt )
+{
+  RGBA4444::Pack32( static_cast<const uint32_t*>( src ), static_cast<uint16_t*>( dst ), cnt );
+}
+
+static void RGBA8888toRGBA5551( const void* src, void* dst, size_t cnt )
+{
+  RGBA5551::Pack32( static_cast<const uint32_t*>( src ), static_cast<uint16_t*>( dst ), cnt );
+}
+
+static void LA88toRGBA8888( const void* src, void* dst, size_t cnt )
+{
+  const uint16_t* s = static_cast<const uint16_t*>( src );
+  uint32_t*       d = static_cast<uint32_t*>( dst );
+  while ( cnt-- ) {
+    const uint32_t v = *s++;
+    *d++ = ( v & 0xff ) * 0x00010101 | ( v & 0xff00 ) << 16;
+  }
+}
+
+static void BGRA8888toRGBA8888( const void* src, void* dst, size_t cnt )
+{
+  const uint32_t* s = static_cast<const uint32_t*>( src );
+  uint32_t*       d = static_cast<uint32_t*>( dst );
+  while ( cnt-- ) {
+    const uint32_t v = *s++;
+    *d++ = ( v & 0xff00ff00 ) | ( ( v >> 16 ) & 0xff ) | ( ( v & 0xff ) << 16 );
+  }
+}
+
+#if REGAL_PIXEL_SSE2
+
+static inline __m128i Pack565( __m128i p )
+{
+  const __m128i r = _mm_slli_epi32( _mm_and_si128( p, _mm_set1_epi32( 0x000000f8 ) ), 8 );
+  const __m128i g = _mm_and_si128( _mm_srli_epi32( p,  5 ), _mm_set1_epi32( 0x000007e0 ) );
+  const __m128i b = _mm_and_si128( _mm_srli_epi32( p, 19 ), _mm_set1_epi32( 0x0000001f ) );
+  return _mm_or_si128( _mm_or_si128( r, g ), b );
+}
+
+static inline __m128i Pack4444( __m128i p )
+{
+  const __m128i r = _mm_slli_epi32( _mm_and_si128( p, _mm_set1_epi32( 0x000000f0 ) ), 8 );
+  const __m128i g = _mm_and_si128( _mm_srli_epi32( p,  4 ), _mm_set1_epi32( 0x00000f00 ) );
+  const __m128i b = _mm_and_si128( _mm_srli_epi32( p, 16 ), _mm_set1_epi32( 0x000000f0 ) );
+  const __m128i a = _mm_srli_epi32( p, 28 );
+  return _mm_or_si128( _mm_or_si128( r, g ), _mm_or_si128( b, a ) );
+}
+
+static inline __m128i Pack5551( __m128i p )
+{
+  const __m128i r = _mm_slli_epi32( _mm_and_si128( p, _mm_set1_epi32( 0x000000f8 ) ), 8 );
+  const __m128i g = _mm_and_si128( _mm_srli_epi32( p,  5 ), _mm_set1_epi32( 0x000007c0 ) );
+  const __m128i b = _mm_and_si128( _mm_srli_epi32( p, 18 ), _mm_set1_epi32( 0x0000003e ) );
+  const __m128i a = _mm_srli_epi32( p, 31 );
+  return _mm_or_si128( _mm_or_si128( r, g ), _mm_or_si128( b, a ) );
+}
+
+// _mm_packs_epi32 saturates as signed, so sign extend the low halves first.
+
+static inline void Pack16x8( const uint32_t* s, uint16_t* d, __m128i (*pack)( __m128i ) )
+{
+  __m128i lo = pack( _mm_loadu_si128( reinterpret_cast<const __m128i*>( s ) ) );
+  __m128i hi = pack( _mm_loadu_si128( reinterpret_cast<const __m128i*>( s + 4 ) ) );
+  lo = _mm_srai_epi32( _mm_slli_epi32( lo, 16 ), 16 );
+  hi = _mm_srai_epi32( _mm_slli_epi32( hi, 16 ), 16 );
+  _mm_storeu_si128( reinterpret_cast<__m128i*>( d ), _mm_packs_epi32( lo, hi ) );
+}
+
+static inline void Pack565x8 ( const uint32_t* s, uint16_t* d ) { Pack16x8( s, d, Pack565  ); }
+static inline void Pack4444x8( const uint32_t* s, uint16_t* d ) { Pack16x8( s, d, Pack4444 ); }
+static inline void Pack5551x8( const uint32_t* s, uint16_t* d ) { Pack16x8( s, d, Pack5551 ); }
+
+static inline __m128i ExpandLA88( __m128i w )
+{
+  const __m128i l = _mm_and_si128( w, _mm_set1_epi32( 0x000000ff ) );
+  const __m128i a = _mm_slli_epi32( _mm_and_si128( w, _mm_set1_epi32( 0x0000ff00 ) ), 16 );
+  return _mm_or_si128( _mm_or_si128( l, _mm_slli_epi32( l, 8 ) ), _mm_or_si128( _mm_slli_epi32( l, 16 ), a ) );
+}
+
+static inline void ExpandLA88x8( const uint16_t* s, uint32_t* d )
+{
+  const __m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i*>( s ) );
+  const __m128i z = _mm_setzero_si128();
+  _mm_storeu_si128( reinterpret_cast<__m128i*>( d ),     ExpandLA88( _mm_unpacklo_epi16( v, z ) ) );
+  _mm_storeu_si128( reinterpret_cast<__m128i*>( d + 4 ), ExpandLA88( _mm_unpackhi_epi16( v, z ) ) );
+}
+
+static inline __m128i SwapRB( __m128i p )
+{
+  const __m128i ag = _mm_and_si128( p, _mm_set1_epi32( static_cast<int>( 0xff00ff00 ) ) );
+  const __m128i rb = _mm_and_si128( p, _mm_set1_epi32( 0x00ff00ff ) );
+  return _mm_or_si128( ag, _mm_or_si128( _mm_slli_epi32( rb, 16 ), _mm_srli_epi32( rb, 16 ) ) );
+}
+
+static inline void SwapRBx8( const uint32_t* s, uint32_t* d )
+{
+  _mm_storeu_si128( reinterpret_cast<__m128i*>( d ),     SwapRB( _mm_loadu_si128( reinterpret_cast<const __m128i*>( s ) ) ) );
+  _mm_storeu_si128( reinterpret_cast<__m128i*>( d + 4 ), SwapRB( _mm_loadu_si128( reinterpret_cast<const __m128i*>( s + 4 ) ) ) );
+}
+
+#elif REGAL_PIXEL_NEON
+
+// vld4 splits the pixels into component planes, then each component is
+// shifted into place with vsri, which keeps the bits already inserted above.
+
+static inline void Pack565x8( const uint32_t* s, uint16_t* d )
+{
+  const uint8x8x4_t p = vld4_u8( reinterpret_cast<const uint8_t*>( s ) );
+  uint16x8_t v = vshll_n_u8( p.val[0], 8 );
+  v = vsriq_n_u16( v, vshll_n_u8( p.val[1], 8 ),  5 );
+  v = vsriq_n_u16( v, vshll_n_u8( p.val[2], 8 ), 11 );
+  vst1q_u16( d, v );
+}
+
+static inline void Pack4444x8( const uint32_t* s, uint16_t* d )
+{
+  const uint8x8x4_t p = vld4_u8( reinterpret_cast<const uint8_t*>( s ) );
+  uint16x8_t v = vshll_n_u8( p.val[0], 8 );
+  v = vsriq_n_u16( v, vshll_n_u8( p.val[1], 8 ),  4 );
+  v = vsriq_n_u16( v, vshll_n_u8( p.val[2], 8 ),  8 );
+  v = vsriq_n_u16( v, vshll_n_u8( p.val[3], 8 ), 12 );
+  vst1q_u16( d, v );
+}
+
+static inline void Pack5551x8( const uint32_t* s, uint16_t* d )
+{
+  const uint8x8x4_t p = vld4_u8( reinterpret_cast<const uint8_t*>( s ) );
+  uint16x8_t v = vshll_n_u8( p.val[0], 8 );
+  v = vsriq_n_u16( v, vshll_n_u8( p.val[1], 8 ),  5 );
+  v = vsriq_n_u16( v, vshll_n_u8( p.val[2], 8 ), 10 );
+  v = vsriq_n_u16( v, vshll_n_u8( p.val[3], 8 ), 15 );
+  vst1q_u16( d, v );
+}
+
+static inline void ExpandLA88x8( const uint16_t* s, uint32_t* d )
+{
+  const uint8x8x2_t la = vld2_u8( reinterpret_cast<const uint8_t*>( s ) );
+  uint8x8x4_t p;
+  p.val[0] = la.val[0];
+  p.val[1] = la.val[0];
+  p.val[2] = la.val[0];
+  p.val[3] = la.val[1];
+  vst4_u8( reinterpret_cast<uint8_t*>( d ), p );
+}
+
+static inline void SwapRBx8( const uint32_t* s, uint32_t* d )
+{
+  uint8x8x4_t p = vld4_u8( reinterpret_cast<const uint8_t*>( s ) );
+  const uint8x8_t t = p.val[0];
+  p.val[0] = p.val[2];
+  p.val[2] = t;
+  vst4_u8( reinterpret_cast<uint8_t*>( d ), p );
+}
+
+#elif REGAL_PIXEL_WASM
+
+static inline v128_t Pack565( v128_t p )
+{
+  const v128_t r = wasm_i32x4_shl( wasm_v128_and( p, wasm_i32x4_splat( 0x000000f8 ) ), 8 );
+  const v128_t g = wasm_v128_and( wasm_u32x4_shr( p,  5 ), wasm_i32x4_splat( 0x000007e0 ) );
+  const v128_t b = wasm_v128_and( wasm_u32x4_shr( p, 19 ), wasm_i32x4_splat( 0x0000001f ) );
+  return wasm_v128_or( wasm_v128_or( r, g ), b );
+}
+
+static inline v128_t Pack4444( v128_t p )
+{
+  const v128_t r = wasm_i32x4_shl( wasm_v128_and( p, wasm_i32x4_splat( 0x000000f0 ) ), 8 );
+  const v128_t g = wasm_v128_and( wasm_u32x4_shr( p,  4 ), wasm_i32x4_splat( 0x00000f00 ) );
+  const v128_t b = wasm_v128_and( wasm_u32x4_shr( p, 16 ), wasm_i32x4_splat( 0x000000f0 ) );
+  const v128_t a = wasm_u32x4_shr( p, 28 );
+  return wasm_v128_or( wasm_v128_or( r, g ), wasm_v128_or( b, a ) );
+}
+
+static inline v128_t Pack5551( v128_t p )
+{
+  const v128_t r = wasm_i32x4_shl( wasm_v128_and( p, wasm_i32x4_splat( 0x000000f8 ) ), 8 );
+  const v128_t g = wasm_v128_and( wasm_u32x4_shr( p,  5 ), wasm_i32x4_splat( 0x000007c0 ) );
+  const v128_t b = wasm_v128_and( wasm_u32x4_shr( p, 18 ), wasm_i32x4_splat( 0x0000003e ) );
+  const v128_t a = wasm_u32x4_shr( p, 31 );
+  return wasm_v128_or( wasm_v128_or( r, g ), wasm_v128_or( b, a ) );
+}
+
+// The packed values fit in 16 bits, so the saturating narrow is exact.
+
+static inline void Pack16x8( const uint32_t* s, uint16_t* d, v128_t (*pack)( v128_t ) )
+{
+  const v128_t lo = pack( wasm_v128_load( s ) );
+  const v128_t hi = pack( wasm_v128_load( s + 4 ) );
+  wasm_v128_store( d, wasm_u16x8_narrow_i32x4( lo, hi ) );
+}
+
+static inline void Pack565x8 ( const uint32_t* s, uint16_t* d ) { Pack16x8( s, d, Pack565  ); }
+static inline void Pack4444x8( const uint32_t* s, uint16_t* d ) { Pack16x8( s, d, Pack4444 ); }
+static inline void Pack5551x8( const uint32_t* s, uint16_t* d ) { Pack16x8( s, d, Pack5551 ); }
+
+static inline v128_t ExpandLA88( v128_t w )
+{
+  const v128_t l = wasm_v128_and( w, wasm_i32x4_splat( 0x000000ff ) );
+  const v128_t a = wasm_i32x4_shl( wasm_v128_and( w, wasm_i32x4_splat( 0x0000ff00 ) ), 16 );
+  return wasm_v128_or( wasm_v128_or( l, wasm_i32x4_shl( l, 8 ) ), wasm_v128_or( wasm_i32x4_shl( l, 16 ), a ) );
+}
+
+static inline void ExpandLA88x8( const uint16_t* s, uint32_t* d )
+{
+  const v128_t v = wasm_v128_load( s );
+  wasm_v128_store( d,     ExpandLA88( wasm_u32x4_extend_low_u16x8( v ) ) );
+  wasm_v128_store( d + 4, ExpandLA88( wasm_u32x4_extend_high_u16x8( v ) ) );
+}
+
+static inline v128_t SwapRB( v128_t p )
+{
+  return wasm_i8x16_shuffle( p, p, 2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15 );
+}
+
+static inline void SwapRBx8( const uint32_t* s, uint32_t* d )
+{
+  wasm_v128_store( d,     SwapRB( wasm_v128_load( s ) ) );
+  wasm_v128_store( d + 4, SwapRB( wasm_v128_load( s + 4 ) ) );
+}
+
+#endif
+
+#if REGAL_PIXEL_SSE2 || REGAL_PIXEL_NEON || REGAL_PIXEL_WASM
+
+static void RGBA8888toRGB565Simd( const void* src, void* dst, size_t cnt )
+{
+  const uint32_t* s = static_cast<const uint32_t*>( src );
+  uint16_t*       d = static_cast<uint16_t*>( dst );
+  for ( ; cnt >= 8; cnt -= 8, s += 8, d += 8 )
+    Pack565x8( s, d );
+  RGBA8888toRGB565( s, d, cnt );
+}
+
+static void RGBA8888toRGBA4444Simd( const void* src, void* dst, size_t cnt )
+{
+  const uint32_t* s = static_cast<const uint32_t*>( src );
+  uint16_t*       d = static_cast<uint16_t*>( dst );
+  for ( ; cnt >= 8; cnt -= 8, s += 8, d += 8 )
+    Pack4444x8( s, d );
+  RGBA8888toRGBA4444( s, d, cnt );
+}
+
+static void RGBA8888toRGBA5551Simd( const void* src, void* dst, size_t cnt )
+{
+  const uint32_t* s = static_cast<const uint32_t*>( src );
+  uint16_t*       d = static_cast<uint16_t*>( dst );
+  for ( ; cnt >= 8; cnt -= 8, s += 8, d += 8 )
+    Pack5551x8( s, d );
+  RGBA8888toRGBA5551( s, d, cnt );
+}
+
+static void LA88toRGBA8888Simd( const void* src, void* dst, size_t cnt )
+{
+  const uint16_t* s = static_cast<const uint16_t*>( src );
+  uint32_t*       d = static_cast<uint32_t*>( dst );
+  for ( ; cnt >= 8; cnt -= 8, s += 8, d += 8 )
+    ExpandLA88x8( s, d );
+  LA88toRGBA8888( s, d, cnt );
+}
+
+static void BGRA8888toRGBA8888Simd( const void* src, void* dst, size_t cnt )
+{
+  const uint32_t* s = static_cast<const uint32_t*>( src );
+  uint32_t*       d = static_cast<uint32_t*>( dst );
+  for ( ; cnt >= 8; cnt -= 8, s += 8, d += 8 )
+    SwapRBx8( s, d );
+  BGRA8888toRGBA8888( s, d, cnt );
+}
+
+#else
+
+#define RGBA8888toRGB565Simd   RGBA8888toRGB565
+#define RGBA8888toRGBA4444Simd RGBA8888toRGBA4444
+#define RGBA8888toRGBA5551Simd RGBA8888toRGBA5551
+#define LA88toRGBA8888Simd     LA88toRGBA8888
+#define BGRA8888toRGBA8888Simd BGRA8888toRGBA8888
+
+#endif
+
+// SSE2 is checked with cpuid, for the benefit of 32 bit x86 builds.
+// NEON and wasm SIMD are only available if enabled at compile time.
+
+static bool SimdSupported()
+{
+#if REGAL_PIXEL_SSE2 && defined(__GNUC__) && ( defined(__i386__) || defined(__x86_64__) )
+  static const bool sse2 = __builtin_cpu_supports( "sse2" ) != 0;
+  return sse2;
+#elif REGAL_PIXEL_SSE2 || REGAL_PIXEL_NEON || REGAL_PIXEL_WASM
+  return true;
+#else
+  return false;
+#endif
+}
+
+struct Direct
+{
+  GLenum           srcFormat;
+  GLenum           srcType;
+  GLenum           dstFormat;
+  GLenum           dstType;
+  DirectConversion scalar;
+  DirectConversion simd;
+};
+
+static const Direct directConversions[] =
+{
+  { GL_RGBA,            GL_UNSIGNED_BYTE, GL_RGB,  GL_UNSIGNED_SHORT_5_6_5,   RGBA8888toRGB565,   RGBA8888toRGB565Simd   },
+  { GL_RGBA,            GL_UNSIGNED_BYTE, GL_RGBA, GL_UNSIGNED_SHORT_4_4_4_4, RGBA8888toRGBA4444, RGBA8888toRGBA4444Simd },
+  { GL_RGBA,            GL_UNSIGNED_BYTE, GL_RGBA, GL_UNSIGNED_SHORT_5_5_5_1, RGBA8888toRGBA5551, RGBA8888toRGBA5551Simd },
+  { GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE, GL_RGBA, GL_UNSIGNED_BYTE,          LA88toRGBA8888,     LA88toRGBA8888Simd     },
+  { GL_BGRA,            GL_UNSIGNED_BYTE, GL_RGBA, GL_UNSIGNED_BYTE,          BGRA8888toRGBA8888, BGRA8888toRGBA8888Simd },
+};
+
+static inline const Direct *LookupDirect( GLenum srcFormat, GLenum srcType, GLenum dstFormat, GLenum dstType )
+{
+  for ( size_t i = 0; i < array_size( directConversions ); ++i ) {
+    const Direct &d = directConversions[ i ];
+    if ( d.srcFormat == srcFormat && d.srcType == srcType && d.dstFormat == dstFormat && d.dstType == dstType )
+      return &d;
+  }
+  return NULL;
+}
 
 }  // namespace
 
@@ -166,6 +528,29 @@ IConversion *GetConversionInterface(GLenum format, GLenum type)
   return Conversion::RegistryBase::Lookup(format, type);
 }
 
+DirectConversion GetDirectConversion( GLenum srcFormat, GLenum srcType, GLenum dstFormat, GLenum dstType, bool simd )
+{
+  const Conversion::Direct *d = Conversion::LookupDirect( srcFormat, srcType, dstFormat, dstType );
+  if ( d == NULL )
+    return NULL;
+  return simd && Conversion::SimdSupported() ? d->simd : d->scalar;
+}
+
+void PackRGBA8888ToRGB565( const uint32_t* src, uint16_t* dst, size_t cnt )
+{
+  ( Conversion::SimdSupported() ? Conversion::RGBA8888toRGB565Simd : Conversion::RGBA8888toRGB565 )( src, dst, cnt );
+}
+
+void PackRGBA8888ToRGBA4444( const uint32_t* src, uint16_t* dst, size_t cnt )
+{
+  ( Conversion::SimdSupported() ? Conversion::RGBA8888toRGBA4444Simd : Conversion::RGBA8888toRGBA4444 )( src, dst, cnt );
+}
+
+void PackRGBA8888ToRGBA5551( const uint32_t* src, uint16_t* dst, size_t cnt )
+{
+  ( Conversion::SimdSupported() ? Conversion::RGBA8888toRGBA5551Simd : Conversion::RGBA8888toRGBA5551 )( src, dst, cnt );
+}
+
 REGAL_NAMESPACE_END
 
 #endif // REGAL_EMULATION
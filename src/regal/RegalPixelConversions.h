@@ -93,6 +93,24 @@ class IConversion
 // Note that there is no need to delete or otherwise free the interface.
 IConversion *GetConversionInterface(GLenum format, GLenum type);
 
+// Packs RGBA_8888 pixel data directly into one of the 16 bit formats, using
+// SSE2, NEON or wasm SIMD where available. The output matches Pack32 of the
+// corresponding conversion interface bit for bit.
+void PackRGBA8888ToRGB565  ( const uint32_t* src, uint16_t* dst, size_t cnt );
+void PackRGBA8888ToRGBA4444( const uint32_t* src, uint16_t* dst, size_t cnt );
+void PackRGBA8888ToRGBA5551( const uint32_t* src, uint16_t* dst, size_t cnt );
+
+// A single pass conversion of cnt pixels from one format to another, without
+// the RGBA_8888 intermediate. Defined for RGBA_8888 to the 16 bit formats,
+// LUMINANCE_ALPHA_88 to RGBA_8888 and BGRA_8888 to RGBA_8888.
+typedef void (*DirectConversion)( const void* src, void* dst, size_t cnt );
+
+// Gets the direct conversion between the given formats, or NULL if there is
+// none. The SIMD implementation is returned if the CPU supports it, unless
+// simd is false. The source must be aligned to its pixel size.
+DirectConversion GetDirectConversion( GLenum srcFormat, GLenum srcType,
+                                      GLenum dstFormat, GLenum dstType, bool simd = true );
+
 REGAL_NAMESPACE_END
 
 #endif // REGAL_EMULATION
@@ -35,8 +35,26 @@
 REGAL_GLOBAL_BEGIN
 
 #include "RegalShader.h"
+#include "RegalShaderBake.h"
+#include "RegalWorker.h"
 
 #if REGAL_GLSL_OPTIMIZER
+#include <list>
+
+#include <boost/cstdint.hpp>
+using ::boost::uint32_t;
+using ::boost::uint64_t;
+
+#include <lookup3.h>
+
+#include "RegalConfig.h"
+#include "RegalMutex.h"
+#include "RegalThread.h"
+#include "RegalSharedHashMap.h"
+#if REGAL_CACHE
+#include "RegalCachePack.h"
+#endif
+
 #include "ast.h"
 #include "glsl_parser_extras.h"
 #include "glsl_parser.h"
@@ -63,19 +81,106 @@ _mesa_new_shader(struct gl_context *ctx, GLuint name, GLenum type);
 
 namespace Shader {
 
-  // external interface for using the GLSL optimizer
-  bool OptimizeGLSL (bool is_es, GLenum type, string input, string& output, Emu::Iff::CompareFunc comp )
-#if !REGAL_GLSL_OPTIMIZER
+#if REGAL_GLSL_OPTIMIZER
+  static regal_glsl_ctx* regal_glsl_thread_ctx (gl_api api);
+
+  //
+  // Memo
+  //
+  // OptimizeGLSL results keyed by a 64-bit hash of the source, the API,
+  // the shader type and the alpha test function.  Up to
+  // Config::glslMemoSize KB of output is kept in memory, least recently
+  // used evicted first.  With the shader cache enabled, optimized sources
+  // are also written to and read from the cache pack, so they outlive
+  // the process.
+  //
+
+  struct Memo
   {
-    // returning false here means output will be ignored and the original shader will be used
-    return false;
+    struct Entry
+    {
+      bool                               ok;
+      string                             output;
+      std::list<uint64_t>::iterator      lru;
+    };
+
+    Memo() : bytes(0) {}
+
+    static Memo &instance()
+    {
+      static Memo memo;
+      return memo;
+    }
+
+    bool find(uint64_t key, string &output, bool &ok)
+    {
+      Thread::ScopedLock lock(&mutex);
+      hash_map<uint64_t,Entry>::iterator i = entries.find(key);
+      if (i==entries.end())
+      {
+        ++stats.misses;
+        return false;
+      }
+      ++stats.hits;
+      lru.splice(lru.begin(),lru,i->second.lru);
+      ok     = i->second.ok;
+      output = i->second.output;
+      return true;
+    }
+
+    // Failures are kept too, so count the entry itself towards the limit
+
+    static size_t cost(const string &output)
+    {
+      return output.length() + sizeof(Entry) + sizeof(uint64_t);
+    }
+
+    void insert(uint64_t key, const string &output, bool ok)
+    {
+      const size_t limit = size_t(Config::glslMemoSize)*1024;
+      if (cost(output)>limit)
+        return;
+
+      Thread::ScopedLock lock(&mutex);
+      if (entries.count(key))
+        return;
+
+      while (!lru.empty() && bytes+cost(output)>limit)
+      {
+        bytes -= cost(entries.find(lru.back())->second.output);
+        entries.erase(lru.back());
+        lru.pop_back();
+        ++stats.evictions;
+      }
+
+      lru.push_front(key);
+      Entry &e = entries[key];
+      e.ok     = ok;
+      e.output = output;
+      e.lru    = lru.begin();
+      bytes += cost(output);
+    }
+
+    hash_map<uint64_t,Entry> entries;
+    std::list<uint64_t>      lru;
+    size_t                   bytes;
+    OptimizeGLSLStats        stats;
+    Thread::Mutex            mutex;
+  };
+
+  static uint64_t memo_key (bool is_es, GLenum type, const string &input, Emu::Iff::CompareFunc comp)
+  {
+    uint32_t pc = uint32_t(type)<<1 | uint32_t(is_es);
+    uint32_t pb = uint32_t(comp);
+    Lookup3::hashlittle2(input.c_str(),input.length(),&pc,&pb);
+    return uint64_t(pc)<<32 | pb;
   }
-#else
+
+  static bool optimize_glsl (bool is_es, GLenum type, const string &input, string& output, Emu::Iff::CompareFunc comp )
   {
     bool res = true;
 
-    // this needs to be a global/plublic class member somewhere
-    regal_glsl_ctx* ctx = regal_glsl_initialize(is_es ? API_OPENGLES2 : API_OPENGL_COMPAT);
+    regal_glsl_ctx* ctx = regal_glsl_thread_ctx(is_es ? API_OPENGLES2 : API_OPENGL_COMPAT);
 
     regal_glsl_shader_type shader_type = (type == GL_VERTEX_SHADER) ? kRegalGlslShaderVertex : kRegalGlslShaderFragment;
     regal_glsl_shader* shader = regal_glsl_parse (ctx, shader_type, input.c_str());
@@ -96,9 +201,150 @@ namespace Shader {
       res = false;
     }
 
+    ralloc_arena_stats arena;
+    if (ralloc_arena_get_stats(shader, &arena))
+    {
+      Memo &memo = Memo::instance();
+      Thread::ScopedLock lock(&memo.mutex);
+      memo.stats.arenaAllocations += arena.allocations;
+      memo.stats.arenaChunks      += arena.chunks;
+    }
+
     regal_glsl_shader_delete (shader);
 
-    regal_glsl_cleanup (ctx);
+    return res;
+  }
+#endif
+
+  OptimizeGLSLStats GetOptimizeGLSLStats ()
+  {
+    OptimizeGLSLStats stats;
+#if REGAL_GLSL_OPTIMIZER
+    Memo &memo = Memo::instance();
+    Thread::ScopedLock lock(&memo.mutex);
+    stats = memo.stats;
+    stats.entries = memo.entries.size();
+    stats.bytes   = memo.bytes;
+#endif
+    return stats;
+  }
+
+  struct OptimizeTask : public Thread::Task
+  {
+    OptimizeTask(bool is_es_, ShaderInstance::ShaderSource &source_, Emu::Iff::CompareFunc comp_)
+    : is_es(is_es_), source(source_), comp(comp_)
+    {
+    }
+
+    virtual void run()
+    {
+      string output;
+      if (OptimizeGLSL(is_es, source.type, source.src, output, comp))
+        source.src.swap(output);
+    }
+
+    bool                          is_es;
+    ShaderInstance::ShaderSource &source;
+    Emu::Iff::CompareFunc         comp;
+  };
+
+  void OptimizeGLSL (bool is_es, std::vector<ShaderInstance::ShaderSource> &sources, Emu::Iff::CompareFunc comp )
+  {
+#if REGAL_GLSL_OPTIMIZER
+    if (sources.empty())
+      return;
+
+    // Queue all but the first, which this thread optimizes meanwhile
+
+    Thread::Workers &workers = Thread::Workers::instance();
+    std::vector<OptimizeTask *> tasks;
+    for (size_t i = 1; i < sources.size(); ++i)
+    {
+      tasks.push_back(new OptimizeTask(is_es, sources[i], comp));
+      workers.submit(tasks.back());
+    }
+
+    OptimizeTask(is_es, sources[0], comp).run();
+
+    for (size_t i = 0; i < tasks.size(); ++i)
+    {
+      workers.wait(tasks[i]);
+      delete tasks[i];
+    }
+#else
+    // Only baked output to look up, no need for the workers
+
+    for (size_t i = 0; i < sources.size(); ++i)
+      OptimizeTask(is_es, sources[i], comp).run();
+#endif
+  }
+
+  // Output baked offline by regalbake, see RegalShaderBake.h
+
+  static bool find_baked (bool is_es, GLenum type, const string &input, string& output, Emu::Iff::CompareFunc comp )
+  {
+    const Baked &baked = Baked::instance();
+    if (!baked.size())
+      return false;
+
+    const char *data = NULL;
+    size_t      size = 0;
+    if (!baked.find(bakeKey(input.c_str(), input.length()), bakeOptions(is_es, type, comp), data, size))
+      return false;
+
+    output.assign(data, size);
+    return true;
+  }
+
+  // external interface for using the GLSL optimizer
+  bool OptimizeGLSL (bool is_es, GLenum type, string input, string& output, Emu::Iff::CompareFunc comp )
+#if !REGAL_GLSL_OPTIMIZER
+  {
+    // returning false here means output will be ignored and the original shader will be used
+    return find_baked(is_es, type, input, output, comp);
+  }
+#else
+  {
+    if (find_baked(is_es, type, input, output, comp))
+      return true;
+
+    const uint64_t key = memo_key(is_es, type, input, comp);
+    Memo &memo = Memo::instance();
+
+    bool res = false;
+    if (Config::glslMemoSize>0 && memo.find(key, output, res))
+      return res;
+
+#if REGAL_CACHE
+    const bool cached = Config::cache && Config::cacheShader;
+    if (REGAL_CACHE_SHADER_READ && cached && Config::cacheShaderRead)
+    {
+      const void *data = NULL;
+      size_t      size = 0;
+      if (Cache::Pack::instance().find(Cache::packKey("glsl", &key, sizeof(key)), data, size))
+      {
+        output.assign(static_cast<const char *>(data), size);
+        Internal( "Shader optimize cached: ", boost::print::hex(key));
+        {
+          Thread::ScopedLock lock(&memo.mutex);
+          ++memo.stats.packHits;
+        }
+        if (Config::glslMemoSize>0)
+          memo.insert(key, output, true);
+        return true;
+      }
+    }
+#endif
+
+    res = optimize_glsl(is_es, type, input, output, comp);
+
+    if (Config::glslMemoSize>0)
+      memo.insert(key, output, res);
+
+#if REGAL_CACHE
+    if (REGAL_CACHE_SHADER_WRITE && res && cached && Config::cacheShaderWrite)
+      Cache::Pack::instance().insert(Cache::packKey("glsl", &key, sizeof(key)), output.c_str(), output.length());
+#endif
 
     return res;
   }
@@ -156,10 +402,6 @@ namespace Shader {
   struct regal_glsl_ctx {
     regal_glsl_ctx (gl_api api) {
       mem_ctx = ralloc_context (NULL);
-#if ! REGAL_NO_ASSERT
-      RegalContext *_context = REGAL_GET_CONTEXT();
-      RegalAssert(_context);
-#endif
       initialize_mesa_context (&mesa_ctx, api);
     }
     ~regal_glsl_ctx() {
@@ -174,20 +416,146 @@ namespace Shader {
     return new regal_glsl_ctx(api);
   }
 
+  // Mesa keeps the glsl types and the builtin function library in process
+  // global storage, parsing each builtin profile the first time a shader
+  // calls into it.  The first optimizer context for an API parses the
+  // profiles Iff shaders link against, so no shader pays for them later.
+
+  static Thread::Mutex builtinsMutex;
+  static bool          builtinsParsed[2] = { false, false };
+
+  static void regal_glsl_parse_builtins (regal_glsl_ctx* ctx, gl_api api)
+  {
+    static const char * const es[] = {
+      "#version 100\nvoid main() { gl_Position = vec4(abs(0.0)); }\n",
+      "#version 100\nprecision mediump float;\nvoid main() { gl_FragColor = vec4(abs(0.0)); }\n"
+    };
+    static const char * const desktop[] = {
+      "#version 120\nvoid main() { gl_Position = vec4(abs(0.0)); }\n",
+      "#version 120\nvoid main() { gl_FragColor = vec4(abs(0.0)); }\n",
+      "#version 140\nvoid main() { gl_Position = vec4(abs(0.0)); }\n",
+      "#version 140\nout vec4 color;\nvoid main() { color = vec4(abs(0.0)); }\n"
+    };
+
+    const bool isEs = api == API_OPENGLES2;
+    Thread::ScopedLock lock(&builtinsMutex);
+    if (builtinsParsed[isEs])
+      return;
+
+    const char * const *src = isEs ? es : desktop;
+    const size_t        n   = isEs ? array_size(es) : array_size(desktop);
+    for (size_t i = 0; i < n; ++i)
+    {
+      regal_glsl_shader* shader = regal_glsl_parse (ctx, i&1 ? kRegalGlslShaderFragment : kRegalGlslShaderVertex, src[i]);
+      if (!regal_glsl_get_status(shader))
+        Warning( "GLSL builtin parse failed: ", regal_glsl_get_log(shader));
+      regal_glsl_shader_delete (shader);
+    }
+    builtinsParsed[isEs] = true;
+  }
+
+  // Releases the process global Mesa state along with the context, so
+  // it must not race with OptimizeGLSL on other threads.
+
   void regal_glsl_cleanup (regal_glsl_ctx* ctx)
   {
     delete ctx;
+
+    Thread::ScopedLock lock(&builtinsMutex);
     _mesa_glsl_release_types();
     _mesa_glsl_release_functions();
+    builtinsParsed[0] = builtinsParsed[1] = false;
   }
 
+  // OptimizeGLSL contexts are thread-confined: each thread gets one per
+  // API, created on first use and deleted when the thread exits.
+
+  struct regal_glsl_thread
+  {
+    regal_glsl_thread ()
+    {
+      ctx[0] = ctx[1] = NULL;
+    }
+
+    ~regal_glsl_thread ()
+    {
+      delete ctx[0];
+      delete ctx[1];
+    }
+
+    regal_glsl_ctx *ctx[2];
+  };
+
+#if REGAL_NO_TLS
+  static regal_glsl_thread glslThread;
+
+  static inline regal_glsl_thread &regal_glsl_thread_instance ()
+  {
+    return glslThread;
+  }
+#elif REGAL_SYS_WIN32
+  // Contexts of threads that exit are not reclaimed on Windows.
+
+  static __declspec(thread) regal_glsl_thread *glslThread = NULL;
+
+  static inline regal_glsl_thread &regal_glsl_thread_instance ()
+  {
+    if (!glslThread)
+      glslThread = new regal_glsl_thread();
+    return *glslThread;
+  }
+#else
+  static pthread_once_t glslThreadOnce = PTHREAD_ONCE_INIT;
+  static pthread_key_t  glslThreadKey;
+
+  static void regal_glsl_thread_exit (void *thread)
+  {
+    delete static_cast<regal_glsl_thread *>(thread);
+  }
+
+  static void regal_glsl_thread_key ()
+  {
+    pthread_key_create(&glslThreadKey, regal_glsl_thread_exit);
+  }
+
+  static inline regal_glsl_thread &regal_glsl_thread_instance ()
+  {
+    pthread_once(&glslThreadOnce, regal_glsl_thread_key);
+    regal_glsl_thread *thread = static_cast<regal_glsl_thread *>(pthread_getspecific(glslThreadKey));
+    if (!thread)
+    {
+      thread = new regal_glsl_thread();
+      pthread_setspecific(glslThreadKey, thread);
+    }
+    return *thread;
+  }
+#endif
+
+  static regal_glsl_ctx* regal_glsl_thread_ctx (gl_api api)
+  {
+    regal_glsl_ctx *&ctx = regal_glsl_thread_instance().ctx[api == API_OPENGLES2];
+    if (!ctx)
+    {
+      ctx = new regal_glsl_ctx(api);
+      regal_glsl_parse_builtins(ctx, api);
+    }
+    return ctx;
+  }
+
+
+  // With Config::glslArena, the shader node roots an arena that everything
+  // allocated for it is carved from, the IR included. Deleting the shader
+  // then returns all of it at once instead of freeing the tree node by node.
 
   struct regal_glsl_shader
   {
     static void* operator new(size_t size, void *mem_ctx)
     {
       void *node;
-      node = ralloc_size(mem_ctx, size);
+      if (Config::glslArena)
+        node = ralloc_arena_size(mem_ctx, size, 0);
+      else
+        node = ralloc_size(mem_ctx, size);
       assert(node != NULL);
       return node;
     }
@@ -204,7 +572,10 @@ namespace Shader {
     {
       infoLog = "Shader not compiled yet";
 
-      whole_program = rzalloc (NULL, struct gl_shader_program);
+      ralloc_arena_stats stats;
+      arena = ralloc_arena_get_stats(this, &stats);
+
+      whole_program = rzalloc (arena ? this : NULL, struct gl_shader_program);
       assert(whole_program != NULL);
       whole_program->InfoLog = ralloc_strdup(whole_program, "");
 
@@ -218,6 +589,11 @@ namespace Shader {
 
     ~regal_glsl_shader()
     {
+      // Released along with the arena
+
+      if (arena)
+        return;
+
       ralloc_free (shader->ir);
       ralloc_free (state);
       for (unsigned i = 0; i < MESA_SHADER_TYPES; i++)
@@ -234,6 +610,7 @@ namespace Shader {
     char*	optimizedOutput;
     const char*	infoLog;
     bool	status;
+    bool	arena;
   };
 
   static inline void debug_print_ir (const char* name, exec_list* ir, _mesa_glsl_parse_state* state, void* memctx)
@@ -254,12 +631,12 @@ namespace Shader {
       case kRegalGlslShaderVertex: shader->shader->Type = GL_VERTEX_SHADER; printMode = kPrintGlslVertex; break;
       case kRegalGlslShaderFragment: shader->shader->Type = GL_FRAGMENT_SHADER; printMode = kPrintGlslFragment; break;
       default:
-        shader->infoLog = ralloc_asprintf (ctx->mem_ctx, "Unknown shader type %d", (int)type);
+        shader->infoLog = ralloc_asprintf (shader, "Unknown shader type %d", (int)type);
         shader->status = false;
         return shader;
     }
 
-    _mesa_glsl_parse_state* state = new (ctx->mem_ctx) _mesa_glsl_parse_state (&ctx->mesa_ctx, shader->shader->Type, ctx->mem_ctx);
+    _mesa_glsl_parse_state* state = new (shader) _mesa_glsl_parse_state (&ctx->mesa_ctx, shader->shader->Type, shader);
     shader->state = state;
     state->error = 0;
 
@@ -275,7 +652,7 @@ namespace Shader {
     _mesa_glsl_parse (state);
     _mesa_glsl_lexer_dtor (state);
 
-    exec_list* ir = new (ctx->mem_ctx) exec_list();
+    exec_list* ir = new (shader) exec_list();
     shader->shader->ir = ir;
 
     if (!state->error && !state->translation_unit.is_empty())
@@ -284,7 +661,7 @@ namespace Shader {
     // Un-optimized output
     if (!state->error) {
       validate_ir_tree(ir);
-      shader->rawOutput = _mesa_print_ir_glsl(ir, state, ralloc_strdup(ctx->mem_ctx, ""), printMode);
+      shader->rawOutput = _mesa_print_ir_glsl(ir, state, ralloc_strdup(shader, ""), printMode);
     }
 
     return shader;
@@ -302,7 +679,7 @@ namespace Shader {
       case GL_VERTEX_SHADER: printMode = kPrintGlslVertex; break;
       case GL_FRAGMENT_SHADER: printMode = kPrintGlslFragment; break;
       default:
-        shader->infoLog = ralloc_asprintf (ctx->mem_ctx, "Unknown shader type %d", (int)shader->shader->Type);
+        shader->infoLog = ralloc_asprintf (shader, "Unknown shader type %d", (int)shader->shader->Type);
         shader->status = false;
         return;
     }
@@ -315,7 +692,7 @@ namespace Shader {
 
     if (!state->error && !ir->is_empty())	{
       gl_shader * linked_shader =
-      link_intrastage_shaders(ctx->mem_ctx, &ctx->mesa_ctx, shader->whole_program, shader->whole_program->Shaders, shader->whole_program->NumShaders);
+      link_intrastage_shaders(shader, &ctx->mesa_ctx, shader->whole_program, shader->whole_program->Shaders, shader->whole_program->NumShaders);
       if (!linked_shader) {
         shader->status = false;
         shader->infoLog = shader->whole_program->InfoLog;
@@ -333,7 +710,7 @@ namespace Shader {
 
     // Final optimized output
     if (!state->error) {
-      shader->optimizedOutput = _mesa_print_ir_glsl(ir, state, ralloc_strdup(ctx->mem_ctx, ""), printMode);
+      shader->optimizedOutput = _mesa_print_ir_glsl(ir, state, ralloc_strdup(shader, ""), printMode);
     }
 
     shader->status = !state->error;
@@ -344,7 +721,7 @@ namespace Shader {
   class add_alpha_test : public ir_hierarchical_visitor {
   public:
 
-    add_alpha_test( Emu::Iff::CompareFunc cf ) : func( cf ), alphaRef( NULL ), fragColor( NULL ), fragData( NULL ), fragDataIndex( -1 ) {}
+    add_alpha_test( Emu::Iff::CompareFunc cf ) : func( cf ), alphaRef( NULL ), alphaFunc( NULL ), fragColor( NULL ), fragData( NULL ), fragDataIndex( -1 ) {}
 
     virtual ir_visitor_status visit(ir_variable *var) {
       if( (fragColor == NULL) && !strcmp(var->name, "gl_FragColor") && (var->used == 1) && ( var->mode == ir_var_shader_out ) ) {
@@ -366,6 +743,10 @@ namespace Shader {
       void * ctx = ralloc_parent( ir_f );
       alphaRef = new(ctx) ir_variable( glsl_type::vec2_type, "rglAlphaRef", ir_var_uniform, glsl_precision_undefined);
       ir_f->insert_before( alphaRef );
+      if( func == Emu::Iff::CF_Uniform ) {
+        alphaFunc = new(ctx) ir_variable( glsl_type::vec3_type, "rglAlphaFunc", ir_var_uniform, glsl_precision_undefined);
+        ir_f->insert_before( alphaFunc );
+      }
       return visit_continue;
     }
 
@@ -394,6 +775,24 @@ namespace Shader {
         case Emu::Iff::CF_NotEqual: test = new(ctx) ir_expression( ir_binop_any_nequal, glsl_type::bool_type, a, ref ); break;
         case Emu::Iff::CF_Never:    test = new(ctx) ir_constant( false ); break;
         case Emu::Iff::CF_Always:   test = new(ctx) ir_constant( true );  break;
+        case Emu::Iff::CF_Uniform:
+        {
+          // rglAlphaFunc has one for each of less, equal and greater that passes,
+          // the low three bits of the GL comparison function
+
+          ir_rvalue * lt = new(ctx) ir_expression( ir_binop_less, glsl_type::bool_type, a, ref );
+          ir_rvalue * eq = new(ctx) ir_expression( ir_binop_all_equal, glsl_type::bool_type, a->clone( ctx, NULL ), ref->clone( ctx, NULL ) );
+          ir_rvalue * gt = new(ctx) ir_expression( ir_binop_greater, glsl_type::bool_type, a->clone( ctx, NULL ), ref->clone( ctx, NULL ) );
+          ir_rvalue * pass = NULL;
+          ir_rvalue * cmp[3] = { lt, eq, gt };
+          for( unsigned i = 0; i < 3; i++ ) {
+            ir_rvalue * mask = new(ctx) ir_swizzle( new(ctx) ir_dereference_variable( alphaFunc ), i, 0, 0, 0, 1 );
+            ir_rvalue * term = new(ctx) ir_expression( ir_binop_mul, glsl_type::float_type, new(ctx) ir_expression( ir_unop_b2f, glsl_type::float_type, cmp[i], NULL ), mask );
+            pass = pass ? new(ctx) ir_expression( ir_binop_add, glsl_type::float_type, pass, term ) : term;
+          }
+          test = new(ctx) ir_expression( ir_binop_greater, glsl_type::bool_type, pass, new(ctx) ir_constant( 0.0f ) );
+          break;
+        }
         default:
           // assert
           break;
@@ -407,6 +806,7 @@ namespace Shader {
 
     Emu::Iff::CompareFunc func;
     ir_variable *alphaRef;
+    ir_variable *alphaFunc;
     ir_variable *fragColor;
     ir_variable *fragData;
     int fragDataIndex;
@@ -51,6 +51,31 @@ REGAL_NAMESPACE_BEGIN
 namespace Shader {
 
   bool OptimizeGLSL (bool is_es, GLenum type, string input, string& output, Emu::Iff::CompareFunc comp );
+
+  // Optimize independent sources concurrently, on the worker threads
+  // and the calling thread.  Sources that fail to optimize are left as
+  // they are.
+
+  void OptimizeGLSL (bool is_es, std::vector<ShaderInstance::ShaderSource> &sources, Emu::Iff::CompareFunc comp );
+
+  // Counters of OptimizeGLSL, its memo table and the compiler arenas
+
+  struct OptimizeGLSLStats
+  {
+    OptimizeGLSLStats() : hits(0), misses(0), packHits(0), evictions(0), entries(0), bytes(0),
+                          arenaAllocations(0), arenaChunks(0) {}
+
+    size_t hits;             // Found in memory
+    size_t misses;           // Not in memory
+    size_t packHits;         // Not in memory, found in the cache pack
+    size_t evictions;        // Evicted to stay within Config::glslMemoSize
+    size_t entries;
+    size_t bytes;            // Optimized source held in memory
+    size_t arenaAllocations; // Compiler allocations carved from shader arenas
+    size_t arenaChunks;      // Arena chunks taken from malloc in their place
+  };
+
+  OptimizeGLSLStats GetOptimizeGLSLStats ();
 #if REGAL_GLSL_OPTIMIZER
   struct regal_glsl_shader;
   struct regal_glsl_ctx;
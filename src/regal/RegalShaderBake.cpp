@@ -0,0 +1,264 @@
+/*
+  Copyright (c) 2011-2012 NVIDIA Corporation
+  Copyright (c) 2011-2012 Cass Everitt
+  Copyright (c) 2012 Scott Nations
+  Copyright (c) 2012 Mathias Schott
+  Copyright (c) 2012 Nigel Stewart
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+  OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+  OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+
+ Baked GLSL optimizer output, computed offline by regalbake
+
+ */
+
+#include "pch.h" /* For MS precompiled header support */
+
+#include "RegalUtil.h"
+
+#if REGAL_EMULATION
+
+REGAL_GLOBAL_BEGIN
+
+#include "RegalConfig.h"
+#include "RegalLog.h"
+#include "RegalMutex.h"
+#include "RegalShaderBake.h"
+
+#include <lookup3.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <map>
+
+using namespace ::std;
+using ::boost::uint32_t;
+using ::boost::uint64_t;
+
+REGAL_GLOBAL_END
+
+REGAL_NAMESPACE_BEGIN
+
+namespace Shader {
+
+namespace {
+
+const char     bakeMagic[8] = { 'R','E','G','A','L','G','S','B' };
+const uint32_t bakeVersion  = 1;
+const size_t   headerSize   = 16;
+
+struct BakedEntry
+{
+  uint64_t key;
+  uint32_t options;
+  uint32_t offset;
+  uint32_t size;
+  uint32_t reserved;
+};
+
+inline bool entryLess(const Baked::Entry &a, const Baked::Entry &b)
+{
+  return a.key<b.key || (a.key==b.key && a.options<b.options);
+}
+
+#ifdef REGAL_GLSL_BAKED
+#include REGAL_GLSL_BAKED
+#endif
+
+}
+
+Baked::Baked()
+: _entries(NULL),
+  _count(0),
+  _strings(NULL),
+  _stringsSize(0)
+{
+}
+
+bool
+Baked::load(const void *data, size_t size)
+{
+  const char *p = static_cast<const char *>(data);
+  uint32_t version = 0;
+  uint32_t count   = 0;
+
+  _entries = NULL;
+  _count   = 0;
+
+  if (!p || size<headerSize || memcmp(p,bakeMagic,8))
+    return false;
+
+  memcpy(&version,p+8, sizeof(version));
+  memcpy(&count,  p+12,sizeof(count));
+  if (version!=bakeVersion || count>(size-headerSize)/sizeof(BakedEntry))
+    return false;
+
+  _entries     = p + headerSize;
+  _count       = count;
+  _strings     = _entries + count*sizeof(BakedEntry);
+  _stringsSize = size - headerSize - count*sizeof(BakedEntry);
+  return true;
+}
+
+bool
+Baked::open(const string &filename)
+{
+  FILE *f = fopen(filename.c_str(),"rb");
+  if (!f)
+    return false;
+
+  fseek(f,0,SEEK_END);
+  long n = ftell(f);
+  fseek(f,0,SEEK_SET);
+  _buffer.resize(n>0 ? size_t(n) : 0);
+  bool ok = n>0 && fread(&_buffer[0],1,_buffer.size(),f)==_buffer.size();
+  fclose(f);
+
+  if (!ok || !load(&_buffer[0],_buffer.size()))
+  {
+    Warning("GLSL bake table ",filename," not valid, ignoring.");
+    _buffer.clear();
+    return false;
+  }
+
+  Info("GLSL bake table ",filename," loaded, ",_count," entries.");
+  return true;
+}
+
+bool
+Baked::find(uint64_t key, uint32_t options, const char *&output, size_t &size) const
+{
+  // Binary search of the sorted entries
+
+  size_t lo = 0;
+  size_t hi = _count;
+  while (lo<hi)
+  {
+    const size_t mid = lo + (hi-lo)/2;
+    BakedEntry e;
+    memcpy(&e,_entries+mid*sizeof(BakedEntry),sizeof(BakedEntry));
+    if (e.key<key || (e.key==key && e.options<options))
+      lo = mid + 1;
+    else if (e.key==key && e.options==options)
+    {
+      if (e.offset>_stringsSize || e.size>=_stringsSize-e.offset)
+        return false;
+      output = _strings + e.offset;
+      size   = e.size;
+      return true;
+    }
+    else
+      hi = mid;
+  }
+  return false;
+}
+
+void
+Baked::write(vector<Entry> &entries, vector<char> &table)
+{
+  sort(entries.begin(),entries.end(),entryLess);
+
+  // Identical output is stored once, vertex shaders are often baked
+  // for every alpha test function, for example.
+
+  map<string, uint32_t> offsets;
+  string strings;
+  vector<BakedEntry> index;
+  for (size_t i=0; i<entries.size(); ++i)
+  {
+    if (i && !entryLess(entries[i-1],entries[i]))
+      continue;
+
+    map<string, uint32_t>::const_iterator j = offsets.find(entries[i].output);
+    if (j==offsets.end())
+    {
+      j = offsets.insert(make_pair(entries[i].output,uint32_t(strings.size()))).first;
+      strings.append(entries[i].output);
+      strings.push_back('\0');
+    }
+
+    BakedEntry e;
+    e.key      = entries[i].key;
+    e.options  = entries[i].options;
+    e.offset   = j->second;
+    e.size     = uint32_t(entries[i].output.size());
+    e.reserved = 0;
+    index.push_back(e);
+  }
+
+  const uint32_t count = uint32_t(index.size());
+  table.resize(headerSize + count*sizeof(BakedEntry) + strings.size());
+  memset(&table[0],0,headerSize);
+  memcpy(&table[0],bakeMagic,8);
+  memcpy(&table[8],&bakeVersion,sizeof(bakeVersion));
+  memcpy(&table[12],&count,sizeof(count));
+  if (count)
+    memcpy(&table[headerSize],&index[0],count*sizeof(BakedEntry));
+  if (!strings.empty())
+    memcpy(&table[headerSize+count*sizeof(BakedEntry)],strings.data(),strings.size());
+}
+
+const Baked &
+Baked::instance()
+{
+  static Baked         *baked = NULL;
+  static Thread::Mutex  mutex;
+
+  Thread::ScopedLock lock(&mutex);
+  if (!baked)
+  {
+    baked = new Baked();
+#ifdef REGAL_GLSL_BAKED
+    if (baked->load(regalGlslBaked,sizeof(regalGlslBaked)))
+      Info("GLSL bake table compiled in, ",baked->size()," entries.");
+    else
+#endif
+    if (!Config::glslBakeFile.empty())
+      baked->open(Config::glslBakeFile);
+  }
+  return *baked;
+}
+
+uint64_t
+bakeKey(const char *source, size_t length)
+{
+  uint32_t pc = 0;
+  uint32_t pb = 0;
+  Lookup3::hashlittle2(source,length,&pc,&pb);
+  return uint64_t(pc) | (uint64_t(pb)<<32);
+}
+
+uint32_t
+bakeOptions(bool is_es, GLenum type, Emu::Iff::CompareFunc comp)
+{
+  return (is_es ? 1u : 0u) | (type==GL_FRAGMENT_SHADER ? 2u : 0u) | (uint32_t(comp)<<8);
+}
+
+}
+
+REGAL_NAMESPACE_END
+
+#endif // REGAL_EMULATION
@@ -0,0 +1,133 @@
+/*
+  Copyright (c) 2011-2012 NVIDIA Corporation
+  Copyright (c) 2011-2012 Cass Everitt
+  Copyright (c) 2012 Scott Nations
+  Copyright (c) 2012 Mathias Schott
+  Copyright (c) 2012 Nigel Stewart
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+  OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+  OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+
+ Baked GLSL optimizer output, computed offline by regalbake
+
+ */
+
+#ifndef __REGAL_SHADER_BAKE_H__
+#define __REGAL_SHADER_BAKE_H__
+
+#include "RegalUtil.h"
+
+#if REGAL_EMULATION
+
+REGAL_GLOBAL_BEGIN
+
+#include <string>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+
+#include "RegalIff.h"
+
+REGAL_GLOBAL_END
+
+REGAL_NAMESPACE_BEGIN
+
+namespace Shader {
+
+  //
+  // Baked
+  //
+  // A table of OptimizeGLSL output keyed by the source and the options
+  // it was optimized with, written by the regalbake tool.  It gives the
+  // builds without the GLSL optimizer (Emscripten, by default) alpha
+  // tested user shaders, and spares the builds with it the work.
+  //
+  // The table is a single blob, little endian, used in place:
+  //
+  //   header   16 bytes: magic, version and the number of entries
+  //   entries  24 bytes each: key, options, string offset and size,
+  //            sorted by key and options
+  //   strings  the optimized sources, nul terminated
+  //
+  // A table compiled into Regal with -DREGAL_GLSL_BAKED='"file.h"',
+  // as written by regalbake --embed, takes precedence over the file
+  // named by REGAL_GLSL_BAKE_FILE.
+  //
+
+  struct Baked
+  {
+  public:
+    Baked();
+
+    // Use the table in data, which has to outlive it
+
+    bool load(const void *data, size_t size);
+
+    // Read the table from a file
+
+    bool open(const ::std::string &filename);
+
+    bool find(::boost::uint64_t key, ::boost::uint32_t options, const char *&output, size_t &size) const;
+
+    inline size_t size() const { return _count; }
+
+    // Write a table, for regalbake
+
+    struct Entry
+    {
+      ::boost::uint64_t key;
+      ::boost::uint32_t options;
+      ::std::string     output;
+    };
+
+    static void write(::std::vector<Entry> &entries, ::std::vector<char> &table);
+
+    // The process-wide table
+
+    static const Baked &instance();
+
+  private:
+    const char          *_entries;
+    size_t               _count;
+    const char          *_strings;
+    size_t               _stringsSize;
+    ::std::vector<char>  _buffer;
+
+    Baked(const Baked &other);
+    Baked &operator=(const Baked &other);
+  };
+
+  // Table key of a shader source, and options of an OptimizeGLSL call
+
+  ::boost::uint64_t bakeKey(const char *source, size_t length);
+  ::boost::uint32_t bakeOptions(bool is_es, GLenum type, Emu::Iff::CompareFunc comp);
+
+}
+
+REGAL_NAMESPACE_END
+
+#endif // REGAL_EMULATION
+
+#endif // __REGAL_SHADER_BAKE_H__
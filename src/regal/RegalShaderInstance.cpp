@@ -436,6 +436,11 @@ namespace ShaderInstance {
 
   }
 
+  // Locations beyond this are looked up by a search of the uniforms,
+  // rather than growing the location table to match.
+
+  static const GLint maxIndexedLocation = 1<<16;
+
   void Program::AddUniform( const string & name, GLint loc, GLint count, GLenum type ) {
     Uniform u;
     u.name = name;
@@ -443,53 +448,52 @@ namespace ShaderInstance {
     u.count = count;
     u.type = type;
     u.offset = int( uniformStore.size() * sizeof( GLuint ) );
-    u.ver = 0;
     // FIXME: deal with alignment
     int sz = GetTypeSize( u.type );
     uniformStore.insert( uniformStore.end(), ( sz * u.count ) / sizeof( GLint ), 0 );
-    uniforms[ loc ] =  u;
+    if( loc + count <= maxIndexedLocation ) {
+      if( locations.size() < size_t( loc + count ) ) {
+        locations.resize( loc + count, -1 );
+      }
+      for( GLint i = 0; i < count; i++ ) {
+        locations[ loc + i ] = int( uniforms.size() );
+      }
+    }
+    uniforms.push_back( u );
+    for( size_t i = 0; i < dirty.size(); i++ ) {
+      dirty[i].resize( ( uniforms.size() + 31 ) / 32, 0 );
+    }
   }
 
-  void Program::UpdateUniformStore( GLint location, GLint count, const void * ptr ) {
-    int found_location = -1;
-    if( uniforms.find( location ) == uniforms.end() ) {
-
-      // check if the location is within a uniform array
-      for( Program::uniforms_iter iter = uniforms.begin(); iter != uniforms.end(); iter++ ) {
-        Uniform &test = iter->second;
-
-        // if the test uniform is not an array, skip
-        if ( test.count < 2 )
-        {
-          continue;
-        }
-
-        // if the location is before this array, skip
-        if ( location - test.loc < 0 )
-        {
-          continue;
-        }
-
-        // if the location is after the array, skip
-        if ( location > test.loc + test.count)
-        {
-          continue;
-        }
-
-        found_location = test.loc;
-        break;
+  int Program::UniformIndex( GLint location ) const {
+    if( location < 0 ) {
+      return -1;
+    }
+    if( location < maxIndexedLocation ) {
+      return size_t( location ) < locations.size() ? locations[ location ] : -1;
+    }
+    for( size_t i = 0; i < uniforms.size(); i++ ) {
+      const Uniform & u = uniforms[i];
+      if( location >= u.loc && location < u.loc + u.count ) {
+        return int( i );
       }
+    }
+    return -1;
+  }
 
-      // if the location is not found, then bail on the update
-      if (found_location == -1) {
-        Warning( "UpdateUniformStore() skipping update to unknown uniform location ", location );
-        return;
-      }
-    } else {
-      found_location = location;
+  size_t Program::AddInstance() {
+    dirty.push_back( vector<GLuint>( ( uniforms.size() + 31 ) / 32, 0 ) );
+    return dirty.size() - 1;
+  }
+
+  void Program::UpdateUniformStore( GLint location, GLint count, const void * ptr ) {
+    int index = UniformIndex( location );
+    if( index < 0 ) {
+      Warning( "UpdateUniformStore() skipping update to unknown uniform location ", location );
+      return;
     }
 
-    Uniform &u = uniforms[ found_location ];
+    Uniform &u = uniforms[ index ];
     GLint locoffset = location - u.loc;
     if( location + count > u.loc + u.count ) {
       // abort update.  trying to update past the end of allocated storage
@@ -498,33 +502,43 @@ namespace ShaderInstance {
     }
     int sz = GetTypeSize( u.type );
     memcpy( reinterpret_cast<char *>(&uniformStore[0]) + u.offset + sz * locoffset, ptr, sz * count );
-    u.ver = ++ver;
+    for( size_t i = 0; i < dirty.size(); i++ ) {
+      dirty[i][ index / 32 ] |= 1u << ( index % 32 );
+    }
+    ++ver;
   }
 
-  void ProgramInstance::InitializeUniforms( DispatchTableGL & tbl, const Program & p ) {
-    uniforms.clear();
-    for( Program::Map::const_reverse_iterator it = p.uniforms.rbegin(); it != p.uniforms.rend(); ++it ) {
-      const Uniform & u = it->second;
-      UniformInstance ui;
-      ui.location = u.loc;
-      ui.instanceLocation = tbl.call(&tbl.glGetUniformLocation)( prog, u.name.c_str() );
-      ui.ver = ~ GLuint64(0);
+  void ProgramInstance::InitializeUniforms( DispatchTableGL & tbl, Program & p ) {
+    if( slot >= p.dirty.size() ) {
+      slot = p.AddInstance();
+    }
+    locations.resize( p.uniforms.size() );
+    for( size_t i = 0; i < p.uniforms.size(); i++ ) {
+      locations[i] = tbl.call(&tbl.glGetUniformLocation)( prog, p.uniforms[i].name.c_str() );
+    }
 
-      uniforms.push_back( ui );
+    // everything is uploaded the first time the instance is used
+    vector<GLuint> & d = p.dirty[ slot ];
+    std::fill( d.begin(), d.end(), ~ GLuint(0) );
+    if( p.uniforms.size() % 32 ) {
+      d.back() = ( 1u << ( p.uniforms.size() % 32 ) ) - 1;
     }
   }
 
-  void ProgramInstance::UpdateUniforms( DispatchTableGL & tbl, const Program & p ) {
-    if( ver == p.ver ) {
+  void ProgramInstance::UpdateUniforms( DispatchTableGL & tbl, Program & p ) {
+    if( ver == p.ver || slot >= p.dirty.size() ) {
       return;
     }
-    for( size_t i = 0; i < uniforms.size(); i++ ) {
-      UniformInstance & ui = uniforms[i];
-      const Uniform & u = p.uniforms.find( ui.location )->second;
-      if( ui.ver != u.ver ) {
-        SetUniform( tbl, ui.instanceLocation, u.count, u.type, reinterpret_cast<const char *>(&p.uniformStore[0]) + u.offset );
-        ui.ver = u.ver;
+    vector<GLuint> & d = p.dirty[ slot ];
+    for( size_t w = 0; w < d.size(); w++ ) {
+      GLuint bits = d[w];
+      for( size_t i = w * 32; bits; bits >>= 1, i++ ) {
+        if( bits & 1 ) {
+          const Uniform & u = p.uniforms[i];
+          SetUniform( tbl, locations[i], u.count, u.type, reinterpret_cast<const char *>(&p.uniformStore[0]) + u.offset );
+        }
       }
+      d[w] = 0;
     }
     ver = p.ver;
   }
@@ -589,6 +603,9 @@ namespace ShaderInstance {
         continue; // rgl namespace is reserved
       }
       GLint loc = tbl.call(&tbl.glGetUniformLocation)( prog, name );
+      if( loc < 0 ) {
+        continue; // in a uniform block
+      }
       p.AddUniform( name, loc, count, type );
       char buf[4096];
       GetUniform( tbl, prog, loc, count, type, buf );
@@ -597,7 +614,7 @@ namespace ShaderInstance {
     free(name);
   }
 
-  void InitProgramInstance( DispatchTableGL & tbl, const Program & p, GLuint inst, ProgramInstance &pi ) {
+  void InitProgramInstance( DispatchTableGL & tbl, Program & p, GLuint inst, ProgramInstance &pi ) {
 
     pi.prog = inst;
 
@@ -629,7 +646,7 @@ namespace ShaderInstance {
     // now the uniforms only need to be updated for the instance to be used
   }
 
-  void CreateProgramInstance( DispatchTableGL & tbl, const Program & p, const std::vector<ShaderSource> & sources, ProgramInstance &pi ) {
+  void CreateProgramInstance( DispatchTableGL & tbl, Program & p, const std::vector<ShaderSource> & sources, ProgramInstance &pi ) {
     GLuint inst = tbl.call(&tbl.glCreateProgram)();
     for( int i = 0; i < (int)sources.size(); i++ ) {
       GLuint si = CreateShader( tbl, sources[i] );
@@ -67,43 +67,43 @@ namespace ShaderInstance {
     GLint count;
     GLenum type;
     int offset; // byte offset into a uniform store
-    GLuint64 ver;
   };
 
+  // The uniforms of the original program are kept in a flat array, indexed
+  // through a table of locations.  Each instance of the program has a bitset
+  // of the uniforms changed since it was last current, so that switching to
+  // it uploads only those.
+
   struct Program {
     Program() : prog(0), ver(0) {}
     void AddUniform( const std::string & name, GLint loc, GLint count, GLenum type );
     void UpdateUniformStore( GLint location, GLint count, const void * ptr );
+    int UniformIndex( GLint location ) const;
+    size_t AddInstance();
 
     GLint prog;
     GLuint64 ver;
-    typedef std::map<GLint,Uniform> Map;
-    typedef std::map<GLint,Uniform>::iterator uniforms_iter;
-    Map uniforms;
+    std::vector<Uniform> uniforms;
+    std::vector<int> locations;               // uniform index by location, -1 if none
     std::vector<GLuint> uniformStore;
-  };
-
-  struct UniformInstance {
-    UniformInstance() : location(-1), instanceLocation(-1), ver(~ GLuint64(0)) {}
-    GLint location;
-    GLint instanceLocation;
-    GLuint64 ver;
+    std::vector< std::vector<GLuint> > dirty; // dirty uniform bitset per instance
   };
 
   struct ProgramInstance {
-    ProgramInstance() : prog(0), ver(~ GLuint64(0)) {}
+    ProgramInstance() : prog(0), ver(~ GLuint64(0)), slot(~ size_t(0)) {}
     GLint prog;
     GLuint64 ver;
-    std::vector<UniformInstance> uniforms;
-    void InitializeUniforms( DispatchTableGL & tbl, const Program & p );
-    void UpdateUniforms( DispatchTableGL & tbl, const Program & p );
+    size_t slot;                              // of the dirty bitset in the program
+    std::vector<GLint> locations;             // instance location by uniform index
+    void InitializeUniforms( DispatchTableGL & tbl, Program & p );
+    void UpdateUniforms( DispatchTableGL & tbl, Program & p );
   };
 
   void GetShaderSource( DispatchTableGL & tbl, GLuint shader, ShaderSource & ss );
   void GetProgramSources( DispatchTableGL & tbl, GLuint prog, std::vector<ShaderSource> & sources );
   void InitProgram( DispatchTableGL & tbl, GLuint prog, Program & p );
-  void InitProgramInstance( DispatchTableGL & tbl, const Program & p, GLuint inst, ProgramInstance & pi );
-  void CreateProgramInstance( DispatchTableGL & tbl, const Program & p, const std::vector<ShaderSource> & sources, ProgramInstance & pi );
+  void InitProgramInstance( DispatchTableGL & tbl, Program & p, GLuint inst, ProgramInstance & pi );
+  void CreateProgramInstance( DispatchTableGL & tbl, Program & p, const std::vector<ShaderSource> & sources, ProgramInstance & pi );
 
   int GetTypeSize( GLenum type );
   void GetUniform( DispatchTableGL & tbl, GLuint program, GLint location, GLsizei count, GLenum type, void *value );
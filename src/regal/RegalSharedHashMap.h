@@ -0,0 +1,242 @@
+/*
+  Copyright (c) 2012 Igor Chernyshev
+  Copyright (c) 2012 Nigel Stewart, NVIDIA Corporation
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+  OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+  OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef __REGAL_SHARED_HASH_MAP_H__
+#define __REGAL_SHARED_HASH_MAP_H__
+
+#include "RegalUtil.h"
+
+REGAL_GLOBAL_BEGIN
+
+#include "RegalSharedPtr.h"
+
+#include <utility>
+
+#include <boost/cstdint.hpp>
+
+REGAL_GLOBAL_END
+
+REGAL_NAMESPACE_BEGIN
+
+//
+// hash_map - an open addressing hash map for integer keys
+//
+// Lookups probe linearly from a Fibonacci hash of the key through a
+// power of two table of (key, node) slots, so a hit is usually a
+// single cache line.  Erase shifts the rest of the probe sequence
+// back, rather than leaving tombstones.
+//
+// Each (key, value) pair is allocated separately, so pointers to
+// values stay valid as the table grows, as they do for std::map.
+// Iterators are pointers to the pairs, and end() is NULL.
+//
+// Only the subset of the std::map API that Regal uses is provided.
+//
+
+template<typename K, typename V>
+class hash_map
+{
+  public:
+
+    typedef ::std::pair<const K,V>  value_type;
+    typedef value_type             *iterator;
+    typedef const value_type       *const_iterator;
+    typedef ::std::size_t           size_type;
+
+    inline hash_map() : _slots(NULL), _capacity(0), _shift(32), _size(0) {}
+    inline ~hash_map() { clear(); delete [] _slots; }
+
+    inline size_type size() const { return _size; }
+
+    inline iterator       end()       { return NULL; }
+    inline const_iterator end() const { return NULL; }
+
+    inline iterator find(const K &k)
+    {
+      if (!_size)
+        return NULL;
+      for (size_type i = index(k); _slots[i].node; i = (i + 1) & (_capacity - 1))
+        if (_slots[i].key == k)
+          return _slots[i].node;
+      return NULL;
+    }
+
+    inline const_iterator find(const K &k) const { return const_cast<hash_map *>(this)->find(k); }
+
+    inline size_type count(const K &k) const { return find(k) ? 1 : 0; }
+
+    V &operator[](const K &k)
+    {
+      iterator i = find(k);
+      if (i)
+        return i->second;
+
+      // Keep the load factor below 3/4
+
+      if ((_size + 1) * 4 > _capacity * 3)
+        rehash(_capacity ? _capacity * 2 : 16);
+
+      value_type *node = new value_type(k, V());
+      place(k, node);
+      ++_size;
+      return node->second;
+    }
+
+    size_type erase(const K &k)
+    {
+      if (!_size)
+        return 0;
+
+      const size_type mask = _capacity - 1;
+      size_type i = index(k);
+      while (_slots[i].node && _slots[i].key != k)
+        i = (i + 1) & mask;
+      if (!_slots[i].node)
+        return 0;
+
+      value_type *node = _slots[i].node;
+      _slots[i].node = NULL;
+      --_size;
+
+      // Move back any entry further along the probe sequence that
+      // would otherwise no longer be reachable from its home slot.
+
+      for (size_type j = (i + 1) & mask; _slots[j].node; j = (j + 1) & mask)
+      {
+        const size_type h = index(_slots[j].key);
+        if (i <= j ? (i < h && h <= j) : (i < h || h <= j))
+          continue;
+        _slots[i] = _slots[j];
+        _slots[j].node = NULL;
+        i = j;
+      }
+
+      // Destroy the value last, in case its destructor looks
+      // the map up again.
+
+      delete node;
+      return 1;
+    }
+
+    void clear()
+    {
+      for (size_type i = 0; i < _capacity; ++i)
+      {
+        delete _slots[i].node;
+        _slots[i].node = NULL;
+      }
+      _size = 0;
+    }
+
+  private:
+
+    struct Slot
+    {
+      K           key;
+      value_type *node;
+    };
+
+    Slot      *_slots;
+    size_type  _capacity;
+    int        _shift;
+    size_type  _size;
+
+    inline size_type index(const K &k) const
+    {
+      return static_cast<size_type>(static_cast< ::boost::uint32_t>(static_cast< ::boost::uint32_t>(k) * 0x9e3779b9u) >> _shift);
+    }
+
+    inline void place(const K &k, value_type *node)
+    {
+      size_type i = index(k);
+      while (_slots[i].node)
+        i = (i + 1) & (_capacity - 1);
+      _slots[i].key  = k;
+      _slots[i].node = node;
+    }
+
+    void rehash(size_type capacity)
+    {
+      Slot     *slots = _slots;
+      size_type n     = _capacity;
+
+      _slots    = new Slot[capacity];
+      _capacity = capacity;
+      for (_shift = 32; capacity > 1; capacity >>= 1)
+        --_shift;
+      for (size_type i = 0; i < _capacity; ++i)
+        _slots[i].node = NULL;
+
+      for (size_type i = 0; i < n; ++i)
+        if (slots[i].node)
+          place(slots[i].key, slots[i].node);
+      delete [] slots;
+    }
+
+    // Not copyable, share with shared_hash_map instead
+
+    hash_map(const hash_map &);
+    hash_map &operator=(const hash_map &);
+};
+
+//
+// shared_hash_map - a shared_ptr to a hash_map, as shared_map
+// is to a std::map
+//
+
+template<typename K, typename V>
+class shared_hash_map : public shared_ptr< hash_map<K,V> >
+{
+  public:
+
+    typedef hash_map<K,V>      map;
+    typedef shared_ptr<map>    parent;
+    typedef ::std::size_t      size_type;
+
+    typedef typename map::iterator       iterator;
+    typedef typename map::const_iterator const_iterator;
+
+    inline shared_hash_map()  : parent(new map()) {}
+    inline ~shared_hash_map() {}
+
+    inline size_type size() const                { RegalAssert(parent::get()); return parent::get()->size(); }
+
+    inline       V &operator[](const K &k)       { RegalAssert(parent::get()); return parent::get()->operator[](k); }
+
+    inline size_type erase(const K &k)           { RegalAssert(parent::get()); return parent::get()->erase(k);      }
+
+    inline size_type count(const K &k) const     { RegalAssert(parent::get()); return parent::get()->count(k);      }
+
+    inline iterator       find(const K &k)       { RegalAssert(parent::get()); return parent::get()->find(k);      }
+    inline iterator       end()                  { RegalAssert(parent::get()); return parent::get()->end();      }
+    inline const_iterator find(const K &k) const { RegalAssert(parent::get()); return parent::get()->find(k);      }
+    inline const_iterator end() const            { RegalAssert(parent::get()); return parent::get()->end();      }
+};
+
+REGAL_NAMESPACE_END
+
+#endif
@@ -47,6 +47,12 @@ REGAL_GLOBAL_BEGIN
 #include "RegalToken.h"
 #include "RegalEmuInfo.h"
 #include "RegalPixelConversions.h"
+#include "RegalConfig.h"
+#include "RegalLog.h"
+#include "RegalPush.h"
+#if REGAL_EMU_XFER
+#include "RegalXfer.h"
+#endif
 
 REGAL_GLOBAL_END
 
@@ -116,13 +122,25 @@ ConvertedBuffer::ConvertFrom( GLsizei width, GLsizei height, GLenum sourceFormat
   const size_t sourcePixelsPerRow  = width;
   const size_t sourceStride        = ( sourcePixelsPerRow * sourcePixelSize + sourceAlignment - 1 ) & ~( sourceAlignment - 1 );
 
-  std::vector<uint32_t> rowBuffer;
   targetBuffer_ .resize( targetStride * height );
-  rowBuffer.resize( width * sizeof( uint32_t ) );
 
   const uint8_t* sourceRowData = static_cast<const uint8_t*>( sourcePixels );
   uint8_t*       targetRowData = &targetBuffer_[ 0 ];
 
+  // Common pairs are converted in a single pass, if the rows are aligned to
+  // the source pixel size.
+  DirectConversion direct = GetDirectConversion( sourceFormat, sourceType, targetFormat_, targetType_ );
+  if ( direct != NULL && ( reinterpret_cast<size_t>( sourceRowData ) | sourceStride ) % sourcePixelSize == 0 ) {
+    while ( height-- ) {
+      direct( sourceRowData, targetRowData, width );
+      sourceRowData += sourceStride;
+      targetRowData += targetStride;
+    }
+    return true;
+  }
+
+  std::vector<uint32_t> rowBuffer( width );
+
   // Perform the conversion
   while ( height-- ) {
     sourceConverter->Unpack32( sourceRowData, &rowBuffer[ 0 ], width );
@@ -134,10 +152,108 @@ ConvertedBuffer::ConvertFrom( GLsizei width, GLsizei height, GLenum sourceFormat
   return true;
 }
 
+size_t
+ConvertedBuffer::SourceSize( GLsizei width, GLsizei height, GLenum sourceFormat, GLenum sourceType ) const
+{
+  if ( ( sourceFormat == targetFormat_ ) && ( sourceType == targetType_ ) ) {
+    return 0;
+  }
+  if ( ( pss_.alignment != 1 ) && ( pss_.alignment != 2 ) && ( pss_.alignment != 4 ) && ( pss_.alignment != 8 ) ) {
+    return 0;
+  }
+  if ( ( width <= 0 ) || ( height <= 0 ) ) {
+    return 0;
+  }
+  if ( GetConversionInterface( targetFormat_, targetType_ ) == NULL ) {
+    return 0;
+  }
+  IConversion* sourceConverter = GetConversionInterface( sourceFormat, sourceType );
+  if ( sourceConverter == NULL ) {
+    return 0;
+  }
+
+  // As for ConvertFrom, but the last row need not be padded.
+  const size_t sourcePixelSize = sourceConverter->GetPackedPixelByteSize();
+  const size_t sourceAlignment = std::max( sourceConverter->GetPackedPixelAlignmentSize(), static_cast<size_t>( pss_.alignment ) );
+  const size_t sourceStride    = ( width * sourcePixelSize + sourceAlignment - 1 ) & ~( sourceAlignment - 1 );
+  return sourceStride * ( height - 1 ) + width * sourcePixelSize;
+}
+
+// ====================================
+// Upload
+// ====================================
+
+Upload::Upload( GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height )
+: texture( 0 )
+, target( target )
+, level( level )
+, xoffset( xoffset )
+, yoffset( yoffset )
+, width( width )
+, height( height )
+, format( GL_RGBA )
+, type( GL_UNSIGNED_BYTE )
+, alignment( 4 )
+{
+}
+
+namespace {
+
+// TexC's own conversion, with a copy of the source pixels and pixel storage
+// state.
+
+struct ConvertUpload : public Upload
+{
+  ConvertUpload( const PixelStorageStateGLES20& pss, GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum sourceFormat, GLenum sourceType )
+  : Upload( target, level, xoffset, yoffset, width, height )
+  , pss( pss )
+  , sourceFormat( sourceFormat )
+  , sourceType( sourceType )
+  {
+  }
+
+  void run()
+  {
+    ConvertedBuffer buffer( pss, format, type );
+    if ( buffer.ConvertFrom( width, height, sourceFormat, sourceType, &source[ 0 ] ) ) {
+      pixels.swap( buffer.targetBuffer_ );
+    }
+    std::vector<uint8_t>().swap( source );
+  }
+
+  PixelStorageStateGLES20 pss;
+  GLenum sourceFormat;
+  GLenum sourceType;
+  std::vector<uint8_t> source;
+};
+
+inline GLenum BindingTarget( GLenum target )
+{
+  switch ( target ) {
+    case GL_TEXTURE_CUBE_MAP_POSITIVE_X:
+    case GL_TEXTURE_CUBE_MAP_NEGATIVE_X:
+    case GL_TEXTURE_CUBE_MAP_POSITIVE_Y:
+    case GL_TEXTURE_CUBE_MAP_NEGATIVE_Y:
+    case GL_TEXTURE_CUBE_MAP_POSITIVE_Z:
+    case GL_TEXTURE_CUBE_MAP_NEGATIVE_Z:
+      return GL_TEXTURE_CUBE_MAP;
+    default:
+      return target;
+  }
+}
+
+}
+
 // ====================================
 // TextureState
 // ====================================
 
+TextureState::TextureState()
+: name( 0 )
+, levelSpecified( 0 )
+{
+}
+
 TextureState::~TextureState()
 {
   UnbindAll();
@@ -146,7 +262,8 @@ TextureState::~TextureState()
 void TextureState::Reset()
 {
   UnbindAll();
-  textureLevelState.clear();
+  levelSpecified = 0;
+  defaultLevelState = TextureLevelState();
 }
 
 void TextureState::Bind( TextureUnitState* unit )
@@ -173,18 +290,22 @@ void TextureState::UnbindAll()
 
 TextureLevelState& TextureState::GetLevelState_( GLint level )
 {
-  TextureLevelStateMap::iterator f = textureLevelState.find( level );
-
-  if ( f == textureLevelState.end() ) {
-    f = textureLevelState.insert( std::make_pair ( DEFAULT_FORMAT_LEVEL, TextureLevelState() ) ).first;
+  if ( level >= 0 && level < MAX_FORMAT_LEVELS && ( levelSpecified & ( 1u << level ) ) ) {
+    return textureLevelState[ level ];
   }
 
-  return f->second;
+  return defaultLevelState;
 }
 
 void TextureState::SetFormatAndType( GLint level, GLenum format, GLenum type )
 {
+  // Levels out of range are an error for the implementation to report.
+  if ( level < 0 || level >= MAX_FORMAT_LEVELS ) {
+    return;
+  }
+
   textureLevelState[ level ] = TextureLevelState( format, type );
+  levelSpecified |= 1u << level;
 }
 
 void TextureState::GetFormatAndType( GLint level, GLenum* format, GLenum* type )
@@ -196,9 +317,8 @@ void TextureState::GetFormatAndType( GLint level, GLenum* format, GLenum* type )
 
 void TextureState::SimulateComputeMipMaps()
 {
-  TextureLevelStateMap newLevelState;
-  newLevelState.insert( std::make_pair ( DEFAULT_FORMAT_LEVEL, GetLevelState_( 0 ) ) );
-  newLevelState.swap( textureLevelState );
+  defaultLevelState = GetLevelState_( 0 );
+  levelSpecified = 0;
 }
 
 // ====================================
@@ -307,6 +427,10 @@ TextureUnitState::GetBinding( GLenum target ) const
 // ====================================
 
 TexC::TexC()
+: asyncUploads( false )
+, pixelBufferObject( false )
+, pendingBytes( 0 )
+, unpackBuffer( 0 )
 {
   Reset_();
 }
@@ -319,6 +443,11 @@ TexC::Init( RegalContext& ctx )
   RegalAssert(ctx.emuInfo);
   ctx.emuInfo->gl_max_combined_texture_image_units = REGAL_EMU_MAX_COMBINED_TEXTURE_IMAGE_UNITS;
 
+  asyncUploads = Config::asyncTextureUpload;
+  RegalAssert(ctx.info);
+  pixelBufferObject = ctx.info->gl_arb_pixel_buffer_object || ctx.info->gl_ext_pixel_buffer_object ||
+                      ctx.info->gl_nv_pixel_buffer_object || ( ctx.info->es2 && ctx.info->gles_version_major >= 3 );
+
   RegalContext* sharingWith = ctx.shareGroup->front();
   if ( sharingWith != NULL ) {
     mapTextureToTextureState = sharingWith->texc->mapTextureToTextureState;
@@ -461,7 +590,9 @@ TexC::GenTexture_( GLuint texture )
     return;
   }
 
-  mapTextureToTextureState[ texture ].Reset();
+  TextureState& state = mapTextureToTextureState[ texture ];
+  state.Reset();
+  state.name = texture;
 }
 
 void
@@ -474,6 +605,186 @@ TexC::DeleteTexture_( GLuint texture )
   mapTextureToTextureState.erase( texture );
 }
 
+void
+TexC::Cleanup( RegalContext &ctx )
+{
+  // The context is going away, so just wait for the workers.
+  for ( size_t i = 0; i < pendingUploads.size(); ++i ) {
+    Thread::Workers::instance().wait( pendingUploads[ i ] );
+    delete pendingUploads[ i ];
+  }
+  pendingUploads.clear();
+  pendingBytes = 0;
+
+  if ( unpackBuffer ) {
+    ctx.dispatcher.emulation.glDeleteBuffers( 1, &unpackBuffer );
+    unpackBuffer = 0;
+  }
+}
+
+bool
+TexC::QueueTexSubImage2D( RegalContext &ctx, GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const GLvoid* pixels )
+{
+  if ( !asyncUploads || pixels == NULL ) {
+    return false;
+  }
+
+  // With a pixel unpack buffer bound, pixels is an offset into it.
+  if ( pixelBufferObject ) {
+    GLint binding = 0;
+    ctx.dispatcher.emulation.glGetIntegerv( GL_PIXEL_UNPACK_BUFFER_BINDING, &binding );
+    if ( binding ) {
+      return false;
+    }
+  }
+
+  GLenum targetFormat;
+  GLenum targetType;
+  GetFormatAndType( target, level, &targetFormat, &targetType );
+  const size_t size = ConvertedBuffer( unpackPSS, targetFormat, targetType ).SourceSize( width, height, format, type );
+  if ( size == 0 ) {
+    return false;
+  }
+
+  ConvertUpload* upload = new ConvertUpload( unpackPSS, target, level, xoffset, yoffset, width, height, format, type );
+  upload->format = targetFormat;
+  upload->type = targetType;
+  upload->source.assign( static_cast<const uint8_t*>( pixels ), static_cast<const uint8_t*>( pixels ) + size );
+  QueueUpload( ctx, upload, size );
+  return true;
+}
+
+void
+TexC::QueueUpload( RegalContext &ctx, Upload* upload, size_t bytes )
+{
+  RegalAssert( upload );
+
+  if ( pendingBytes + bytes > MAX_PENDING_BYTES ) {
+    FlushUploads( ctx );
+  }
+
+  TextureState* bound = GetBoundTextureUnit_( currentTextureUnit, BindingTarget( upload->target ) );
+  upload->texture = bound ? bound->name : 0;
+  pendingUploads.push_back( upload );
+  pendingBytes += bytes;
+  Thread::Workers::instance().submit( upload );
+}
+
+void
+TexC::FlushUploads( RegalContext &ctx )
+{
+  if ( pendingUploads.empty() ) {
+    return;
+  }
+
+  std::vector<Upload*> uploads;
+  uploads.swap( pendingUploads );
+  pendingBytes = 0;
+  IssueUploads_( ctx, uploads );
+}
+
+void
+TexC::FlushUploads( RegalContext &ctx, GLenum target, GLint level )
+{
+  if ( pendingUploads.empty() ) {
+    return;
+  }
+
+  TextureState* bound = GetBoundTextureUnit_( currentTextureUnit, BindingTarget( target ) );
+  const GLuint texture = bound ? bound->name : 0;
+
+  std::vector<Upload*> uploads;
+  std::vector<Upload*> others;
+  for ( size_t i = 0; i < pendingUploads.size(); ++i ) {
+    Upload* upload = pendingUploads[ i ];
+    const bool match = upload->texture == texture && upload->target == target && upload->level == level;
+    ( match ? uploads : others ).push_back( upload );
+  }
+  if ( uploads.empty() ) {
+    return;
+  }
+
+  pendingUploads.swap( others );
+  IssueUploads_( ctx, uploads );
+}
+
+void
+TexC::IssueUploads_( RegalContext &ctx, const std::vector<Upload*>& uploads )
+{
+  // Xfer queues uploads from a higher emulation level.
+  Push<int> pushLevel( ctx.emuLevel );
+  ctx.emuLevel = 1;
+
+  DispatchTableGL& tbl = ctx.dispatcher.emulation;
+
+  // The converted pixels are tightly packed.
+  #if REGAL_EMU_XFER
+  const bool xferUnpack = ctx.xfer && ( ctx.xfer->unpackRowLength || ctx.xfer->unpackSkipRows || ctx.xfer->unpackSkipPixels );
+  if ( xferUnpack ) {
+    tbl.glPixelStorei( GL_UNPACK_ROW_LENGTH, 0 );
+    tbl.glPixelStorei( GL_UNPACK_SKIP_ROWS, 0 );
+    tbl.glPixelStorei( GL_UNPACK_SKIP_PIXELS, 0 );
+  }
+  #endif
+
+  GLint buffer = 0;
+  if ( pixelBufferObject ) {
+    tbl.glGetIntegerv( GL_PIXEL_UNPACK_BUFFER_BINDING, &buffer );
+    if ( !unpackBuffer ) {
+      tbl.glGenBuffers( 1, &unpackBuffer );
+    }
+    tbl.glBindBuffer( GL_PIXEL_UNPACK_BUFFER, unpackBuffer );
+  }
+
+  GLint alignment = unpackPSS.alignment;
+  for ( size_t i = 0; i < uploads.size(); ++i ) {
+    Upload* upload = uploads[ i ];
+    Thread::Workers::instance().wait( upload );
+
+    if ( !upload->pixels.empty() ) {
+      const GLenum binding = BindingTarget( upload->target );
+      TextureState* bound = GetBoundTextureUnit_( currentTextureUnit, binding );
+      const GLuint texture = bound ? bound->name : 0;
+
+      if ( upload->texture != texture ) {
+        tbl.glBindTexture( binding, upload->texture );
+      }
+      if ( upload->alignment != alignment ) {
+        alignment = upload->alignment;
+        tbl.glPixelStorei( GL_UNPACK_ALIGNMENT, alignment );
+      }
+
+      const GLvoid* pixels = &upload->pixels[ 0 ];
+      if ( pixelBufferObject ) {
+        // Orphan the previous contents rather than wait for them.
+        tbl.glBufferData( GL_PIXEL_UNPACK_BUFFER, upload->pixels.size(), pixels, GL_STREAM_DRAW );
+        pixels = NULL;
+      }
+      tbl.glTexSubImage2D( upload->target, upload->level, upload->xoffset, upload->yoffset, upload->width, upload->height, upload->format, upload->type, pixels );
+
+      if ( upload->texture != texture ) {
+        tbl.glBindTexture( binding, texture );
+      }
+    }
+
+    delete upload;
+  }
+
+  if ( alignment != unpackPSS.alignment ) {
+    tbl.glPixelStorei( GL_UNPACK_ALIGNMENT, unpackPSS.alignment );
+  }
+  if ( pixelBufferObject ) {
+    tbl.glBindBuffer( GL_PIXEL_UNPACK_BUFFER, buffer );
+  }
+  #if REGAL_EMU_XFER
+  if ( xferUnpack ) {
+    tbl.glPixelStorei( GL_UNPACK_ROW_LENGTH, ctx.xfer->unpackRowLength );
+    tbl.glPixelStorei( GL_UNPACK_SKIP_ROWS, ctx.xfer->unpackSkipRows );
+    tbl.glPixelStorei( GL_UNPACK_SKIP_PIXELS, ctx.xfer->unpackSkipPixels );
+  }
+  #endif
+}
+
 }
 
 REGAL_NAMESPACE_END
@@ -52,7 +52,8 @@ REGAL_GLOBAL_BEGIN
 
 #include "RegalEmu.h"
 #include "RegalContext.h"
-#include "RegalSharedMap.h"
+#include "RegalSharedHashMap.h"
+#include "RegalWorker.h"
 
 using ::boost::uint8_t;
 using ::boost::uint16_t;
@@ -80,6 +81,10 @@ struct ConvertedBuffer
 
   bool ConvertFrom( GLsizei width, GLsizei height, GLenum sourceFormat, GLenum sourceType, const GLvoid* sourcePixels );
 
+  // The number of bytes ConvertFrom would read, or zero if it would not
+  // convert the pixels.
+  size_t SourceSize( GLsizei width, GLsizei height, GLenum sourceFormat, GLenum sourceType ) const;
+
   const GLvoid* Get() const {
     return &targetBuffer_[ 0 ];
   }
@@ -113,11 +118,12 @@ struct TextureLevelState
 
 struct TextureState
 {
-  enum FormatLevel { DEFAULT_FORMAT_LEVEL = -1 };
+  // Enough levels for a 32768x32768 texture.
+  enum { MAX_FORMAT_LEVELS = 16 };
 
   typedef std::vector<TextureUnitState*> BoundTextureUnits;
-  typedef std::map<GLint, TextureLevelState> TextureLevelStateMap;
 
+  TextureState();
   ~TextureState();
 
   void Reset();
@@ -134,7 +140,14 @@ struct TextureState
 
   BoundTextureUnits boundTextureUnits;
 
-  TextureLevelStateMap textureLevelState;
+  // The texture name, for TexC::FlushUploads to bind it.
+  GLuint name;
+
+  // The format and type of each level that has been specified, as flagged
+  // in levelSpecified. Any other level has the default format and type.
+  TextureLevelState textureLevelState[ MAX_FORMAT_LEVELS ];
+  uint32_t levelSpecified;
+  TextureLevelState defaultLevelState;
 };
 
 struct TextureUnitState;
@@ -174,16 +187,35 @@ struct TextureUnitState
 };
 
 
+// A glTexSubImage2D with the pixels converted on a worker thread, and
+// issued by TexC::FlushUploads.
+
+struct Upload : public Thread::Task
+{
+  Upload( GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height );
+
+  GLuint texture;   // Set by TexC::QueueUpload
+  GLenum target;
+  GLint level;
+  GLint xoffset;
+  GLint yoffset;
+  GLsizei width;
+  GLsizei height;
+
+  // The converted pixels, as set by run()
+  GLenum format;
+  GLenum type;
+  GLint alignment;
+  std::vector<uint8_t> pixels;
+};
+
 struct TexC
 {
   TexC();
 
   void Init( RegalContext &ctx );
 
-  void Cleanup( RegalContext &ctx )
-  {
-    UNUSED_PARAMETER(ctx);
-  }
+  void Cleanup( RegalContext &ctx );
 
   void Reset_();
 
@@ -207,10 +239,31 @@ struct TexC
   void GenTexture_( GLuint texture );
   void DeleteTexture_( GLuint texture );
 
-  // TODO(lpique) Replace with a hashmap for speed. (But caution -- need an
-  // implementation which keeps pointers to TextureStates valid, or another
-  // binding mechanism)
-  typedef shared_map < GLuint, TextureState > MapTextureToTextureState;
+  // Asynchronous conversion and upload, with Config::asyncTextureUpload.
+  // A copy of the application's pixels is converted by a worker thread, and
+  // uploaded from a pixel unpack buffer where supported. Pending uploads are
+  // flushed before drawing, and before anything else that uses the texture
+  // level.
+
+  bool QueueTexSubImage2D( RegalContext &ctx, GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const GLvoid* pixels );
+  void QueueUpload( RegalContext &ctx, Upload* upload, size_t bytes );
+  void FlushUploads( RegalContext &ctx );
+  void FlushUploads( RegalContext &ctx, GLenum target, GLint level );
+  void IssueUploads_( RegalContext &ctx, const std::vector<Upload*>& uploads );
+
+  // Pending uploads hold a copy of the pixels, so limit the memory used
+  // before the next draw.
+  enum { MAX_PENDING_BYTES = 64 * 1024 * 1024 };
+
+  bool asyncUploads;
+  bool pixelBufferObject;
+  std::vector<Upload*> pendingUploads;
+  size_t pendingBytes;
+  GLuint unpackBuffer;
+
+  // The hash map keeps pointers to TextureStates valid, as the texture units
+  // bind them by pointer.
+  typedef shared_hash_map < GLuint, TextureState > MapTextureToTextureState;
 
   enum { TEXTURE_ZERO = 0 };
 
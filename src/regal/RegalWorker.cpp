@@ -0,0 +1,205 @@
+/*
+  Copyright (c) 2011-2013 NVIDIA Corporation
+  Copyright (c) 2013 Mark Adams
+  Copyright (c) 2013 Nigel Stewart
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+  OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+  OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "pch.h" /* For MS precompiled header support */
+
+#include "RegalUtil.h"
+
+REGAL_GLOBAL_BEGIN
+
+#include "RegalWorker.h"
+#include "RegalConfig.h"
+#include "RegalLog.h"
+#include "RegalMutex.h"
+
+REGAL_GLOBAL_END
+
+REGAL_NAMESPACE_BEGIN
+
+namespace Thread
+{
+
+Workers::Workers()
+: _stop(false)
+{
+#if REGAL_WORKER_THREADS
+  pthread_mutex_init(&_mutex, NULL);
+  pthread_cond_init(&_queued, NULL);
+  pthread_cond_init(&_done, NULL);
+#endif
+}
+
+Workers::~Workers()
+{
+  start(0);
+#if REGAL_WORKER_THREADS
+  pthread_cond_destroy(&_done);
+  pthread_cond_destroy(&_queued);
+  pthread_mutex_destroy(&_mutex);
+#endif
+}
+
+void
+Workers::start(size_t threads)
+{
+#if REGAL_WORKER_THREADS
+  // Stop the current threads, once the queue is empty
+
+  pthread_mutex_lock(&_mutex);
+  _stop = true;
+  pthread_cond_broadcast(&_queued);
+  pthread_mutex_unlock(&_mutex);
+
+  for (size_t i = 0; i < _threads.size(); ++i)
+    pthread_join(_threads[i], NULL);
+  _threads.clear();
+
+  // Anything left over, when there were no threads
+
+  while (!_queue.empty())
+    wait(_queue.front());
+
+  _stop = false;
+  for (size_t i = 0; i < threads; ++i)
+  {
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, main, this))
+    {
+      Warning("Regal::Thread::Workers::start failed to create worker thread ", i);
+      break;
+    }
+    _threads.push_back(thread);
+  }
+#else
+  if (threads)
+    Info("Regal::Thread::Workers::start worker threads not supported, running tasks synchronously.");
+#endif
+}
+
+void
+Workers::submit(Task *task)
+{
+  RegalAssert(task);
+
+#if REGAL_WORKER_THREADS
+  pthread_mutex_lock(&_mutex);
+  task->done = false;
+  if (_threads.size())
+  {
+    _queue.push_back(task);
+    pthread_cond_signal(&_queued);
+    pthread_mutex_unlock(&_mutex);
+    return;
+  }
+  pthread_mutex_unlock(&_mutex);
+#endif
+
+  task->run();
+  task->done = true;
+}
+
+void
+Workers::wait(Task *task)
+{
+  RegalAssert(task);
+
+#if REGAL_WORKER_THREADS
+  pthread_mutex_lock(&_mutex);
+  for (std::deque<Task *>::iterator i = _queue.begin(); i != _queue.end(); ++i)
+  {
+    if (*i == task)
+    {
+      _queue.erase(i);
+      pthread_mutex_unlock(&_mutex);
+
+      task->run();
+
+      pthread_mutex_lock(&_mutex);
+      task->done = true;
+      pthread_cond_broadcast(&_done);
+      break;
+    }
+  }
+  while (!task->done)
+    pthread_cond_wait(&_done, &_mutex);
+  pthread_mutex_unlock(&_mutex);
+#else
+  RegalAssert(task->done);
+#endif
+}
+
+#if REGAL_WORKER_THREADS
+
+void *
+Workers::main(void *workers)
+{
+  Workers &w = *static_cast<Workers *>(workers);
+
+  pthread_mutex_lock(&w._mutex);
+  for (;;)
+  {
+    while (w._queue.empty() && !w._stop)
+      pthread_cond_wait(&w._queued, &w._mutex);
+    if (w._queue.empty())
+      break;
+
+    Task *task = w._queue.front();
+    w._queue.pop_front();
+    pthread_mutex_unlock(&w._mutex);
+
+    task->run();
+
+    pthread_mutex_lock(&w._mutex);
+    task->done = true;
+    pthread_cond_broadcast(&w._done);
+  }
+  pthread_mutex_unlock(&w._mutex);
+
+  return NULL;
+}
+
+#endif
+
+Workers &
+Workers::instance()
+{
+  static Workers *workers = NULL;
+  static Mutex    mutex;
+
+  ScopedLock lock(&mutex);
+  if (!workers)
+  {
+    workers = new Workers();
+    workers->start(Config::workerThreads > 0 ? size_t(Config::workerThreads) : 0);
+  }
+  return *workers;
+}
+
+}
+
+REGAL_NAMESPACE_END
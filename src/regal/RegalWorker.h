@@ -0,0 +1,137 @@
+/*
+  Copyright (c) 2011-2013 NVIDIA Corporation
+  Copyright (c) 2013 Mark Adams
+  Copyright (c) 2013 Nigel Stewart
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+  OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+  OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+
+ Regal worker threads
+
+ */
+
+#ifndef __REGAL_WORKER_H__
+#define __REGAL_WORKER_H__
+
+#include "RegalUtil.h"
+
+REGAL_GLOBAL_BEGIN
+
+#include <deque>
+#include <vector>
+
+// Worker threads need pthreads, which Emscripten only provides
+// when building with -pthread.  Otherwise tasks run synchronously,
+// in Workers::submit.
+
+#ifndef REGAL_WORKER_THREADS
+#  if REGAL_SYS_WIN32 || (REGAL_SYS_EMSCRIPTEN && !defined(__EMSCRIPTEN_PTHREADS__))
+#    define REGAL_WORKER_THREADS 0
+#  else
+#    define REGAL_WORKER_THREADS 1
+#  endif
+#endif
+
+#if REGAL_WORKER_THREADS
+#include <pthread.h>
+#endif
+
+REGAL_GLOBAL_END
+
+REGAL_NAMESPACE_BEGIN
+
+namespace Thread
+{
+  //
+  // Task
+  //
+  // A unit of work for the worker threads.  The submitter owns
+  // the task, and must wait for it before deleting it.
+  //
+
+  struct Task
+  {
+    inline Task() : done(false) {}
+    virtual ~Task() {}
+
+    virtual void run() = 0;
+
+    bool done;    // Guarded by the Workers mutex
+  };
+
+  //
+  // Workers
+  //
+  // A pool of threads running tasks in the order submitted.
+  // With no threads, tasks run as soon as they are submitted.
+  //
+
+  struct Workers
+  {
+  public:
+    Workers();
+    ~Workers();
+
+    // Start (or stop, for zero) the threads, waiting for any
+    // tasks already submitted.
+
+    void start(size_t threads);
+
+    inline size_t threads() const { return _threads.size(); }
+
+    void submit(Task *task);
+
+    // Wait for a task to be done.  A task still queued is run
+    // by the calling thread instead.
+
+    void wait(Task *task);
+
+    // The process-wide pool, with Config::workerThreads threads
+
+    static Workers &instance();
+
+  private:
+
+#if REGAL_WORKER_THREADS
+    static void *main(void *workers);
+
+    pthread_mutex_t        _mutex;
+    pthread_cond_t         _queued;
+    pthread_cond_t         _done;
+    std::vector<pthread_t> _threads;
+#else
+    std::vector<int>       _threads;
+#endif
+    std::deque<Task *>     _queue;
+    bool                   _stop;
+
+    Workers(const Workers &other);
+    Workers &operator=(const Workers &other);
+  };
+}
+
+REGAL_NAMESPACE_END
+
+#endif
@@ -58,6 +58,11 @@ typedef boost::print::string_list<string> string_list;
 #include "RegalLog.h"
 #include "RegalToken.h"
 #include "RegalHelper.h"
+#include "RegalConfig.h"
+#include "RegalPixelConversions.h"
+#if REGAL_EMU_TEXC
+#include "RegalTexC.h"
+#endif
 
 // alloca for VC8
 
@@ -122,6 +127,80 @@ namespace Emu {
     }
   }
 
+  // Swizzle a scan line of BGRA, ABGR (complex 1) or BGR (complex 2)
+
+  static void SwizzleLine( int complex, GLenum format, const GLubyte *pix, GLubyte *vline, GLsizei width, DirectConversion swapRB )
+  {
+    switch( complex ) {
+      case 1:
+        // BGRA -> RGBA
+        if (format == GL_BGRA && swapRB) {
+          swapRB( pix, vline, width );
+        } else if (format == GL_BGRA) {
+          for( int j = 0; j < width * 4; j+=4 )
+          {
+            vline[ j + 0 ] = pix[ j + 2 ];
+            vline[ j + 1 ] = pix[ j + 1 ];
+            vline[ j + 2 ] = pix[ j + 0 ];
+            vline[ j + 3 ] = pix[ j + 3 ];
+          }
+        } else if (format == GL_RGBA) {
+          for( int j = 0; j < width * 4; j+=4 )
+          {
+            vline[ j + 0 ] = pix[ j + 3 ];
+            vline[ j + 1 ] = pix[ j + 2 ];
+            vline[ j + 2 ] = pix[ j + 1 ];
+            vline[ j + 3 ] = pix[ j + 0 ];
+          }
+        }
+        break;
+      case 2:
+        for( int j = 0; j < width * 3; j+=3 )
+        {
+          vline[ j + 0 ] = pix[ j + 2 ];
+          vline[ j + 1 ] = pix[ j + 1 ];
+          vline[ j + 2 ] = pix[ j + 0 ];
+        }
+        break;
+      default:
+        break;
+    }
+  }
+
+#if REGAL_EMU_TEXC
+
+  // With Config::asyncTextureUpload, the swizzle runs on a worker thread
+  // and the upload is issued by TexC::FlushUploads.
+
+  struct SwizzleUpload : public Upload
+  {
+    SwizzleUpload( GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, int complex, GLenum sourceFormat, int rowLength )
+    : Upload( target, level, xoffset, yoffset, width, height ), complex( complex ), sourceFormat( sourceFormat ), rowLength( rowLength )
+    {
+      alignment = complex == 2 ? 1 : 4;
+    }
+
+    void run()
+    {
+      const size_t lineSize = size_t( width ) * ( complex == 2 ? 3 : 4 );
+      pixels.resize( lineSize * height );
+      const GLubyte *pix = &source[ 0 ];
+      DirectConversion swapRB = NULL;
+      if ( ( reinterpret_cast<size_t>( pix ) | rowLength ) % 4 == 0 )
+        swapRB = GetDirectConversion( GL_BGRA, GL_UNSIGNED_BYTE, GL_RGBA, GL_UNSIGNED_BYTE );
+      for( GLsizei i = 0; i < height; i++, pix += rowLength )
+        SwizzleLine( complex, sourceFormat, pix, &pixels[ i * lineSize ], width, swapRB );
+      std::vector<uint8_t>().swap( source );
+    }
+
+    int    complex;
+    GLenum sourceFormat;
+    int    rowLength;
+    std::vector<uint8_t> source;
+  };
+
+#endif
+
   static void SubImage2D( RegalContext * ctx, GLenum target, GLint internalFormat, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const GLvoid *pixels )
   {
     Internal("Regal::Xfer::SubImage2D","ctx=",ctx," target=",Token::GLenumToString(target)," internalFormat=",Token::GLenumToString(internalFormat)," level=",level," format=",Token::GLenumToString(format)," type=",Token::GLenumToString(type));
@@ -172,41 +251,25 @@ namespace Emu {
       // now unpack the packed formats into their canonical formats
       const GLubyte * pix = static_cast<const GLubyte *>(pixels);
       pix += ctx->xfer->unpackSkipRows * rowLength + ctx->xfer->unpackSkipPixels * pixelSize;
+#if REGAL_EMU_TEXC
+      if( ctx->texc && ctx->texc->asyncUploads && width > 0 && height > 0 ) {
+        SwizzleUpload *upload = new SwizzleUpload( target, level, xoffset, yoffset, width, height, complex, format, rowLength );
+        upload->format = TargetFormat(*ctx, internalFormat, tgtfmt);
+        upload->type = tgttype;
+        const size_t size = size_t( rowLength ) * ( height - 1 ) + size_t( pixelSize ) * width;
+        upload->source.assign( pix, pix + size );
+        ctx->texc->QueueUpload( *ctx, upload, size );
+        return;
+      }
+#endif
       tbl.glPixelStorei( GL_UNPACK_SKIP_ROWS, 0 );
       tbl.glPixelStorei( GL_UNPACK_SKIP_PIXELS, 0 );
+      // the direct conversion needs 32 bit aligned rows
+      DirectConversion swapRB = NULL;
+      if ( ( reinterpret_cast<size_t>( pix ) | rowLength ) % 4 == 0 )
+        swapRB = GetDirectConversion( GL_BGRA, GL_UNSIGNED_BYTE, GL_RGBA, GL_UNSIGNED_BYTE );
       for( int i = 0; i < height; i++ ) {
-        switch( complex ) {
-          case 1:
-            // BGRA -> RGBA
-            if (format == GL_BGRA) {
-              for( int j = 0; j < width * 4; j+=4 )
-              {
-                vline[ j + 0 ] = pix[ j + 2 ];
-                vline[ j + 1 ] = pix[ j + 1 ];
-                vline[ j + 2 ] = pix[ j + 0 ];
-                vline[ j + 3 ] = pix[ j + 3 ];
-              }
-            } else if (format == GL_RGBA) {
-              for( int j = 0; j < width * 4; j+=4 )
-              {
-                vline[ j + 0 ] = pix[ j + 3 ];
-                vline[ j + 1 ] = pix[ j + 2 ];
-                vline[ j + 2 ] = pix[ j + 1 ];
-                vline[ j + 3 ] = pix[ j + 0 ];
-              }
-            }
-            break;
-          case 2:
-            for( int j = 0; j < width * 3; j+=3 )
-            {
-              vline[ j + 0 ] = pix[ j + 2 ];
-              vline[ j + 1 ] = pix[ j + 1 ];
-              vline[ j + 2 ] = pix[ j + 0 ];
-            }
-            break;
-          default:
-            break;
-        }
+        SwizzleLine( complex, format, pix, vline, width, swapRB );
         tbl.glTexSubImage2D( target, level, xoffset, yoffset + i, width, 1, TargetFormat(*ctx, internalFormat, tgtfmt), tgttype, vline );
         pix += rowLength;
       }
@@ -226,7 +289,6 @@ namespace Emu {
     {
       case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
       case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
-        // GAB: added, but need to implement
       case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
       case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
       case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
@@ -239,6 +301,109 @@ namespace Emu {
     return false;
   }
 
+  // Decompressed S3TC data is uploaded as RGBA8 by default, at eight times
+  // the GPU memory of DXT1.  With Config::xferRecode16 it is re-encoded to
+  // 16 bits per pixel instead: DXT1 as RGB565, or RGBA5551 for its one bit
+  // alpha, DXT3 and DXT5 as RGBA5551 if all the alpha values are 0 or 255
+  // and as RGBA4444 otherwise.  sRGB has no 16 bit equivalent.
+
+  static bool BinaryAlphaDXT3Block( const GLubyte *block )
+  {
+    for( int i = 0; i < 8; i++ ) {
+      const GLubyte lo = block[ i ] & 0x0f;
+      const GLubyte hi = block[ i ] >> 4;
+      if( ( lo != 0 && lo != 0x0f ) || ( hi != 0 && hi != 0x0f ) )
+        return false;
+    }
+    return true;
+  }
+
+  // Alpha palette and indices decoded as per squish::DecompressAlphaDxt5
+
+  static bool BinaryAlphaDXT5Block( const GLubyte *block )
+  {
+    const int alpha0 = block[ 0 ];
+    const int alpha1 = block[ 1 ];
+
+    int codes[ 8 ];
+    codes[ 0 ] = alpha0;
+    codes[ 1 ] = alpha1;
+    if( alpha0 <= alpha1 ) {
+      for( int i = 1; i < 5; i++ )
+        codes[ 1 + i ] = ( ( 5 - i ) * alpha0 + i * alpha1 ) / 5;
+      codes[ 6 ] = 0;
+      codes[ 7 ] = 255;
+    } else {
+      for( int i = 1; i < 7; i++ )
+        codes[ 1 + i ] = ( ( 7 - i ) * alpha0 + i * alpha1 ) / 7;
+    }
+
+    for( int i = 0; i < 2; i++ ) {
+      const GLubyte *src = block + 2 + i * 3;
+      const GLuint value = src[ 0 ] | ( src[ 1 ] << 8 ) | ( src[ 2 ] << 16 );
+      for( int j = 0; j < 8; j++ ) {
+        const int code = codes[ ( value >> 3 * j ) & 0x7 ];
+        if( code != 0 && code != 255 )
+          return false;
+      }
+    }
+    return true;
+  }
+
+  static bool BinaryAlpha( GLenum internalFormat, GLsizei imageSize, const GLvoid *data )
+  {
+    if( !data || imageSize < 16 )
+      return false;
+
+    const GLubyte *block = static_cast<const GLubyte *>(data);
+    for( GLsizei i = 0; i < imageSize / 16; i++, block += 16 ) {
+      if( internalFormat == GL_COMPRESSED_RGBA_S3TC_DXT3_EXT ? !BinaryAlphaDXT3Block( block ) : !BinaryAlphaDXT5Block( block ) )
+        return false;
+    }
+    return true;
+  }
+
+  static GLenum DecompressedType( GLenum internalFormat, GLsizei imageSize, const GLvoid *data )
+  {
+    if( !Config::xferRecode16 )
+      return GL_UNSIGNED_BYTE;
+
+    switch( internalFormat )
+    {
+      case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+        return GL_UNSIGNED_SHORT_5_6_5;
+      case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+        return GL_UNSIGNED_SHORT_5_5_5_1;
+      case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+      case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+        return BinaryAlpha( internalFormat, imageSize, data ) ? GL_UNSIGNED_SHORT_5_5_5_1 : GL_UNSIGNED_SHORT_4_4_4_4;
+      default:
+        return GL_UNSIGNED_BYTE;
+    }
+  }
+
+  inline GLenum DecompressedFormat( GLenum type )
+  {
+    return type == GL_UNSIGNED_SHORT_5_6_5 ? GL_RGB : GL_RGBA;
+  }
+
+  // ES 2.0 requires internalformat == format, desktop GL needs the sized
+  // format to actually store 16 bits per pixel.
+
+  inline GLenum DecompressedInternalFormat( const RegalContext &context, GLenum type )
+  {
+    if (context.isES2())
+      return DecompressedFormat( type );
+
+    switch( type )
+    {
+      case GL_UNSIGNED_SHORT_5_6_5:   return GL_RGB565;
+      case GL_UNSIGNED_SHORT_4_4_4_4: return GL_RGBA4;
+      case GL_UNSIGNED_SHORT_5_5_5_1: return GL_RGB5_A1;
+      default:                        return GL_RGBA;
+    }
+  }
+
 #if !REGAL_NO_SQUISH
 
   void DecompressDXT1Line( const GLvoid * data, GLubyte *lines, int width )
@@ -254,12 +419,24 @@ namespace Emu {
     }
   }
 
+  void DecompressDXT3Line( const GLvoid * data, GLubyte *lines, int width )
+  {
+    int blocks = width / 4;
+    for( int i = 0; i < blocks; i++ ) {
+      GLubyte rgba[64];
+      squish::Decompress(rgba, ( (const GLubyte *)data ) + i * 16, squish::kDxt3);
+
+      for( int j = 0; j < 4; j++ ) {
+        memcpy( lines + i * 16 + j * width * 4, rgba + j * 16, 16 );
+      }
+    }
+  }
+
   void DecompressDXT5Line( const GLvoid * data, GLubyte *lines, int width )
   {
     int blocks = width / 4;
     for( int i = 0; i < blocks; i++ ) {
       GLubyte rgba[64];
-      squish::Decompress(rgba,  ( (const GLubyte *)data ) + i * 16 + 8, squish::kDxt5);
       squish::Decompress(rgba, ( (const GLubyte *)data ) + i * 16, squish::kDxt5);
 
       for( int j = 0; j < 4; j++ ) {
@@ -268,6 +445,106 @@ namespace Emu {
     }
   }
 
+  // Upload up to four decompressed scan lines, packed down to the 16 bit
+  // type the texture was allocated with, if any.
+
+  static void DecompressedSubImage2D( RegalContext * ctx, GLenum target, GLint level, GLint internalFormat, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum type, const GLubyte *vline )
+  {
+    DispatchTableGL & tbl = ctx->dispatcher.emulation;
+    const size_t n = width * 4;
+
+    switch( type )
+    {
+      case GL_UNSIGNED_SHORT_5_6_5:
+      case GL_UNSIGNED_SHORT_4_4_4_4:
+      case GL_UNSIGNED_SHORT_5_5_5_1:
+      {
+        const uint32_t *src = reinterpret_cast<const uint32_t *>(vline);
+        uint16_t *packed = (uint16_t *) alloca( n * sizeof( uint16_t ) );
+        if( type == GL_UNSIGNED_SHORT_5_6_5 )
+          PackRGBA8888ToRGB565( src, packed, n );
+        else if( type == GL_UNSIGNED_SHORT_4_4_4_4 )
+          PackRGBA8888ToRGBA4444( src, packed, n );
+        else
+          PackRGBA8888ToRGBA5551( src, packed, n );
+        tbl.glTexSubImage2D( target, level, xoffset, yoffset, width, height, DecompressedFormat( type ), type, packed );
+        break;
+      }
+
+      default:
+        tbl.glTexSubImage2D( target, level, xoffset, yoffset, width, height, TargetFormat(*ctx, internalFormat, GL_RGBA), GL_UNSIGNED_BYTE, vline );
+        break;
+    }
+  }
+
+#if REGAL_EMU_TEXC
+
+  // With Config::asyncTextureUpload, the whole image is decompressed (and
+  // packed to 16 bits) on a worker thread.
+
+  struct DecompressUpload : public Upload
+  {
+    DecompressUpload( GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum compressed )
+    : Upload( target, level, xoffset, yoffset, width, height ), compressed( compressed )
+    {
+    }
+
+    void run()
+    {
+      const size_t lineSize = size_t( width ) * 4;
+      std::vector<uint8_t> rgba( lineSize * ( ( height + 3 ) & ~3 ), 255 );
+      const GLubyte *data = &source[ 0 ];
+      for( GLsizei i = 0; i < height; i+=4 )
+      {
+        switch( compressed )
+        {
+          case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+          case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+            DecompressDXT5Line( data + i * width, &rgba[ i * lineSize ], width );
+            break;
+          case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+          case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+          case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+            DecompressDXT1Line( data + i * width / 2, &rgba[ i * lineSize ], width );
+            break;
+          case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+            DecompressDXT3Line( data + i * width, &rgba[ i * lineSize ], width );
+            break;
+          default:
+            break;
+        }
+      }
+      std::vector<uint8_t>().swap( source );
+
+      const size_t n = size_t( width ) * height;
+      const uint32_t *src = reinterpret_cast<const uint32_t *>( &rgba[ 0 ] );
+      switch( type )
+      {
+        case GL_UNSIGNED_SHORT_5_6_5:
+          pixels.resize( n * 2 );
+          PackRGBA8888ToRGB565( src, reinterpret_cast<uint16_t *>( &pixels[ 0 ] ), n );
+          break;
+        case GL_UNSIGNED_SHORT_4_4_4_4:
+          pixels.resize( n * 2 );
+          PackRGBA8888ToRGBA4444( src, reinterpret_cast<uint16_t *>( &pixels[ 0 ] ), n );
+          break;
+        case GL_UNSIGNED_SHORT_5_5_5_1:
+          pixels.resize( n * 2 );
+          PackRGBA8888ToRGBA5551( src, reinterpret_cast<uint16_t *>( &pixels[ 0 ] ), n );
+          break;
+        default:
+          rgba.resize( n * 4 );
+          pixels.swap( rgba );
+          break;
+      }
+    }
+
+    GLenum compressed;
+    std::vector<uint8_t> source;
+  };
+
+#endif
+
 #endif
 
   // See also:
@@ -284,6 +561,17 @@ namespace Emu {
     if( ShouldDecompress( ctx, format ) )
     {
       Internal("Regal::Xfer::CompressedSubImage2D", "decompressing texture data");
+      const GLenum type = ctx->xfer->BoundDecompressed().type;
+#if REGAL_EMU_TEXC
+      if( ctx->texc && ctx->texc->asyncUploads && width > 0 && height > 0 && imageSize > 0 ) {
+        DecompressUpload *upload = new DecompressUpload( target, level, xoffset, yoffset, width, height, format );
+        upload->format = type == GL_UNSIGNED_BYTE ? TargetFormat(*ctx, internalFormat, GL_RGBA) : DecompressedFormat( type );
+        upload->type = type;
+        upload->source.assign( static_cast<const GLubyte *>(data), static_cast<const GLubyte *>(data) + imageSize );
+        ctx->texc->QueueUpload( *ctx, upload, size_t( imageSize ) + size_t( width ) * height * 4 );
+        return;
+      }
+#endif
       const int sz = width * 4 * 4;                      // Four scan lines of four bytes (RGBA) per pixel
       GLubyte *vline = (GLubyte *) alloca( sz );         // Allocate enough memory for four scan lines
       memset( vline, 255, sz );                          // Clear to white - debug mode only?
@@ -301,7 +589,7 @@ namespace Emu {
           for( GLsizei i = 0; i < height; i+=4 )         // In blocks of four scan lines
           {
             DecompressDXT5Line( static_cast<const GLubyte *>(data) + i * width, vline, width );
-            tbl.glTexSubImage2D( target, level, xoffset, yoffset + i, width, 4, TargetFormat(*ctx, internalFormat, GL_RGBA), GL_UNSIGNED_BYTE, vline );
+            DecompressedSubImage2D( ctx, target, level, internalFormat, xoffset, yoffset + i, width, min<GLsizei>( 4, height - i ), type, vline );
           }
           break;
 
@@ -318,14 +606,23 @@ namespace Emu {
           for( GLsizei i = 0; i < height; i+=4 )             // In blocks of four scan lines
           {
             DecompressDXT1Line( static_cast<const GLubyte *>(data) + i * width / 2, vline, width );
-            tbl.glTexSubImage2D( target, level, xoffset, yoffset + i, width, 4, TargetFormat(*ctx, internalFormat, GL_RGBA), GL_UNSIGNED_BYTE, vline );
+            DecompressedSubImage2D( ctx, target, level, internalFormat, xoffset, yoffset + i, width, min<GLsizei>( 4, height - i ), type, vline );
           }
           break;
 
-          case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
-            // GAB: Need to implement
-            break;
-          default:
+        // DXT2 and DXT3 (collectively also known as Block Compression 2 or BC2) store the
+        // alpha channel explicitly as a 4x4 table of 4 bit values, followed by 64 bits of
+        // color data encoded the same way as DXT1.[1]
+
+        case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+          for( GLsizei i = 0; i < height; i+=4 )         // In blocks of four scan lines
+          {
+            DecompressDXT3Line( static_cast<const GLubyte *>(data) + i * width, vline, width );
+            DecompressedSubImage2D( ctx, target, level, internalFormat, xoffset, yoffset + i, width, min<GLsizei>( 4, height - i ), type, vline );
+          }
+          break;
+
+        default:
           break;
       }
     }
@@ -336,6 +633,34 @@ namespace Emu {
     }
   }
 
+void Xfer::Cleanup( RegalContext &ctx )
+{
+  UNUSED_PARAMETER(ctx);
+
+  const size_t saved = BytesSaved();
+  if( saved )
+    Info("Regal::Xfer::Cleanup ", saved, " bytes of GPU memory saved by storing decompressed S3TC textures at 16 bits per pixel.");
+}
+
+size_t Xfer::BytesSaved( GLuint name ) const
+{
+  size_t saved = 0;
+  std::map< GLuint, Decompressed >::const_iterator i = name2decompressed.find( name );
+  if( i != name2decompressed.end() ) {
+    for( std::map< GLint, size_t >::const_iterator j = i->second.bytesSaved.begin(); j != i->second.bytesSaved.end(); ++j )
+      saved += j->second;
+  }
+  return saved;
+}
+
+size_t Xfer::BytesSaved() const
+{
+  size_t saved = 0;
+  for( std::map< GLuint, Decompressed >::const_iterator i = name2decompressed.begin(); i != name2decompressed.end(); ++i )
+    saved += BytesSaved( i->first );
+  return saved;
+}
+
 void Xfer::PixelStore( RegalContext * ctx, GLenum pname, GLint param )
 {
   UNUSED_PARAMETER(ctx);
@@ -445,6 +770,7 @@ void Xfer::CompressedTexImage2D( RegalContext * ctx, GLenum target, GLint level,
   if( ShouldDecompress( ctx, internalFormat ) ) {
     Internal("Regal::Xfer::CompressedTexImage2D","decompressing texture data");
     GLenum ifmt = GL_RGBA;
+    GLenum type = GL_UNSIGNED_BYTE;
     switch( internalFormat ) {
       case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
       case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
@@ -452,19 +778,42 @@ void Xfer::CompressedTexImage2D( RegalContext * ctx, GLenum target, GLint level,
       case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
       case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
       case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+      {
+        // All the levels need the same format and type, so the type is
+        // chosen when the first level (or level zero) is specified.
+
+        Decompressed &dec = BoundDecompressed();
+        if( level == 0 || dec.bytesSaved.empty() ) {
+          dec.type = DecompressedType( internalFormat, imageSize, data );
+          dec.bytesSaved.clear();
+        }
+        type = dec.type;
+
         if (internalFormat == GL_COMPRESSED_SRGB_S3TC_DXT1_EXT ||
             internalFormat == GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT)
           ifmt = GL_SRGB_ALPHA_EXT;
-        tbl.glTexImage2D( target, level, ifmt, width, height, border, TargetFormat(*ctx, ifmt, GL_RGBA), GL_UNSIGNED_BYTE, NULL );
+
+        GLenum fmt = TargetFormat(*ctx, ifmt, GL_RGBA);
+        if( type != GL_UNSIGNED_BYTE ) {
+          ifmt = DecompressedInternalFormat( *ctx, type );
+          fmt  = DecompressedFormat( type );
+        }
+
+        dec.bytesSaved[ level ] = type == GL_UNSIGNED_BYTE ? 0 : size_t( width ) * size_t( height ) * 2;
+        Internal("Regal::Xfer::CompressedTexImage2D","type=", Token::GLenumToString(type), " saved=", dec.bytesSaved[ level ], " bytes");
+
+        tbl.glTexImage2D( target, level, ifmt, width, height, border, fmt, type, NULL );
         if( width == 4 && height == 4 ) {
+          // White in RGBA8 as well as in each of the 16 bit types
           const GLubyte tail[] = { 255, 255, 255, 255,
                                    255, 255, 255, 255,
                                    255, 255, 255, 255,
                                    255, 255, 255, 255 };
-          tbl.glTexImage2D( target, level + 1, ifmt, 2, 2, border, TargetFormat(*ctx, ifmt, GL_RGBA), GL_UNSIGNED_BYTE, tail );
-          tbl.glTexImage2D( target, level + 2, ifmt, 1, 1, border, TargetFormat(*ctx, ifmt, GL_RGBA), GL_UNSIGNED_BYTE, tail );
+          tbl.glTexImage2D( target, level + 1, ifmt, 2, 2, border, fmt, type, tail );
+          tbl.glTexImage2D( target, level + 2, ifmt, 1, 1, border, fmt, type, tail );
         }
         break;
+      }
       default:
         break;
     }
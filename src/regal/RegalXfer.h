@@ -81,10 +81,7 @@ struct Xfer
     unpackSkipPixels = 0;
   }
 
-  void Cleanup( RegalContext &ctx )
-  {
-    UNUSED_PARAMETER(ctx);
-  }
+  void Cleanup( RegalContext &ctx );
 
   void PixelStore( RegalContext * ctx, GLenum pname, GLint param );
 
@@ -120,6 +117,27 @@ struct Xfer
   int activeTextureIndex;
   GLuint textureBinding2D[REGAL_EMU_MAX_COMBINED_TEXTURE_IMAGE_UNITS];
   std::map< GLuint, GLuint > name2ifmt;
+
+  // Decompressed S3TC textures, optionally stored at 16 bits per pixel.
+  // See Config::xferRecode16
+
+  struct Decompressed
+  {
+    Decompressed() : type( GL_UNSIGNED_BYTE ) {}
+
+    GLenum                    type;        // Upload type of all levels
+    std::map< GLint, size_t > bytesSaved;  // GPU memory saved versus RGBA8, per level
+  };
+
+  std::map< GLuint, Decompressed > name2decompressed;
+
+  Decompressed &BoundDecompressed()
+  {
+    return name2decompressed[ textureBinding2D[ activeTextureIndex ] ];
+  }
+
+  size_t BytesSaved( GLuint name ) const;
+  size_t BytesSaved() const;
 };
 
 }
@@ -0,0 +1,342 @@
+/*
+  Copyright (c) 2011-2012 NVIDIA Corporation
+  Copyright (c) 2011-2012 Cass Everitt
+  Copyright (c) 2012 Scott Nations
+  Copyright (c) 2012 Mathias Schott
+  Copyright (c) 2012 Nigel Stewart
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+  OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+  OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+
+ regalbake - GLSL optimizer output computed offline
+
+ Optimizes shader sources, given as files or found in a Regal cache
+ pack, with each of the options Regal may ask OptimizeGLSL for, and
+ writes the table described in RegalShaderBake.h.  That table can be
+ loaded at runtime with REGAL_GLSL_BAKE_FILE, or compiled into Regal
+ with -DREGAL_GLSL_BAKED='"file.h"' from the --embed output.
+
+ */
+
+#include <GL/Regal.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "RegalUtil.h"
+
+#if REGAL_GLSL_OPTIMIZER
+#include <main/mtypes.h>
+#endif
+#include "RegalShader.h"
+#include "RegalShaderBake.h"
+#if REGAL_CACHE
+#include "RegalCachePack.h"
+#endif
+
+using namespace std;
+using namespace Regal::Shader;
+using Regal::Emu::Iff;
+
+namespace {
+
+const char *compareNames[] = { "invalid", "never", "less", "equal", "lequal", "greater", "notequal", "gequal", "always", "uniform" };
+
+struct Source
+{
+  string name;
+  string src;
+  GLenum type;    // GL_NONE if it has to be tried as either
+};
+
+void usage()
+{
+  fprintf(stderr,
+    "Usage: regalbake [options] shader...\n"
+    "\n"
+    "  -o file          Table to write, regal.bake by default\n"
+    "  --embed file     Also write the table as a C array, for -DREGAL_GLSL_BAKED\n"
+    "  --cache dir      Also bake the shader sources in the Regal cache pack in dir\n"
+    "  --es, --gl       Bake for OpenGL ES or desktop OpenGL only, both by default\n"
+    "  --alpha list     Comma separated alpha test functions, all by default:\n"
+    "                   never,less,equal,lequal,greater,notequal,gequal,always,\n"
+    "                   uniform (for REGAL_GLSL_ALPHA_UNIFORM)\n"
+    "  -v               List each shader as it is baked\n"
+    "\n"
+    "Shaders named *.vert, *.vs or *.vsh are vertex shaders, *.frag, *.fs\n"
+    "or *.fsh fragment shaders.  Others are baked as whichever compiles.\n");
+}
+
+bool endsWith(const string &s, const char *suffix)
+{
+  const size_t n = strlen(suffix);
+  return s.length()>=n && s.compare(s.length()-n,n,suffix)==0;
+}
+
+GLenum shaderType(const string &filename)
+{
+  if (endsWith(filename,".vert") || endsWith(filename,".vs") || endsWith(filename,".vsh"))
+    return GL_VERTEX_SHADER;
+  if (endsWith(filename,".frag") || endsWith(filename,".fs") || endsWith(filename,".fsh"))
+    return GL_FRAGMENT_SHADER;
+  return GL_NONE;
+}
+
+bool readFile(const string &filename, string &data)
+{
+  FILE *f = fopen(filename.c_str(),"rb");
+  if (!f)
+    return false;
+  char buffer[4096];
+  size_t n;
+  data.clear();
+  while ((n = fread(buffer,1,sizeof(buffer),f))>0)
+    data.append(buffer,n);
+  const bool ok = !ferror(f);
+  fclose(f);
+  return ok;
+}
+
+bool writeTable(const string &filename, const vector<char> &table)
+{
+  FILE *f = fopen(filename.c_str(),"wb");
+  if (!f)
+    return false;
+  bool ok = fwrite(&table[0],table.size(),1,f)==1;
+  ok = !fclose(f) && ok;
+  return ok;
+}
+
+bool writeEmbed(const string &filename, const vector<char> &table)
+{
+  FILE *f = fopen(filename.c_str(),"w");
+  if (!f)
+    return false;
+  fprintf(f,"// Generated by regalbake, for -DREGAL_GLSL_BAKED\n\n");
+  fprintf(f,"static const unsigned char regalGlslBaked[%u] = {\n",unsigned(table.size()));
+  for (size_t i=0; i<table.size(); ++i)
+    fprintf(f,"%s0x%02x,%s",i%16 ? "" : "  ",unsigned(static_cast<unsigned char>(table[i])),i%16==15 || i+1==table.size() ? "\n" : "");
+  fprintf(f,"};\n");
+  return !fclose(f);
+}
+
+#if REGAL_CACHE
+bool readCache(const string &directory, vector<Source> &sources)
+{
+  using namespace Regal::Cache;
+
+  Pack pack;
+  if (!pack.open(directory))
+    return false;
+
+  // The pack holds textures and program binaries too, shader sources
+  // are the entries keyed by their own content.
+
+  vector<boost::uint64_t> keys;
+  pack.keys(keys);
+  for (size_t i=0; i<keys.size(); ++i)
+  {
+    const void *data = NULL;
+    size_t      size = 0;
+    if (!pack.find(keys[i],data,size) || packKey("shader",data,size)!=keys[i])
+      continue;
+
+    char name[32];
+    sprintf(name,"%016llx",static_cast<unsigned long long>(keys[i]));
+
+    Source s;
+    s.name = directory + " " + name;
+    s.src.assign(static_cast<const char *>(data),size);
+    s.type = GL_NONE;
+    sources.push_back(s);
+  }
+  return true;
+}
+#endif
+
+}
+
+int main(int argc, char *argv[])
+{
+  string output = "regal.bake";
+  string embed;
+  vector<string> caches;
+  vector<Source> sources;
+  bool es = true;
+  bool gl = true;
+  bool verbose = false;
+  vector<Iff::CompareFunc> compares;
+
+  for (int i=1; i<argc; ++i)
+  {
+    const string arg = argv[i];
+    const bool value = i+1<argc;
+    if (arg=="-o" && value)
+      output = argv[++i];
+    else if (arg=="--embed" && value)
+      embed = argv[++i];
+    else if (arg=="--cache" && value)
+      caches.push_back(argv[++i]);
+    else if (arg=="--es")
+      gl = false;
+    else if (arg=="--gl")
+      es = false;
+    else if (arg=="--alpha" && value)
+    {
+      string list = string(argv[++i]) + ",";
+      for (size_t p = 0, q; (q = list.find(',',p))!=string::npos; p = q+1)
+      {
+        const string name = list.substr(p,q-p);
+        size_t c = Iff::CF_Never;
+        while (c<=Iff::CF_Uniform && name!=compareNames[c])
+          ++c;
+        if (c>Iff::CF_Uniform)
+        {
+          fprintf(stderr,"regalbake: unknown alpha test function '%s'\n",name.c_str());
+          return 1;
+        }
+        compares.push_back(Iff::CompareFunc(c));
+      }
+    }
+    else if (arg=="-v")
+      verbose = true;
+    else if (arg=="-h" || arg=="--help")
+    {
+      usage();
+      return 0;
+    }
+    else if (!arg.empty() && arg[0]=='-')
+    {
+      usage();
+      return 1;
+    }
+    else
+    {
+      Source s;
+      s.name = arg;
+      s.type = shaderType(arg);
+      if (!readFile(arg,s.src))
+      {
+        fprintf(stderr,"regalbake: could not read %s\n",arg.c_str());
+        return 1;
+      }
+      sources.push_back(s);
+    }
+  }
+
+  for (size_t i=0; i<caches.size(); ++i)
+  {
+#if REGAL_CACHE
+    if (!readCache(caches[i],sources))
+    {
+      fprintf(stderr,"regalbake: no cache pack in %s\n",caches[i].c_str());
+      return 1;
+    }
+#else
+    fprintf(stderr,"regalbake: built without REGAL_CACHE, can't read %s\n",caches[i].c_str());
+    return 1;
+#endif
+  }
+
+  if (sources.empty())
+  {
+    usage();
+    return 1;
+  }
+
+#if !REGAL_GLSL_OPTIMIZER
+  fprintf(stderr,"regalbake: built without REGAL_GLSL_OPTIMIZER, nothing to bake with\n");
+  return 1;
+#endif
+
+  if (compares.empty())
+    for (int c=Iff::CF_Never; c<=Iff::CF_Uniform; ++c)
+      compares.push_back(Iff::CompareFunc(c));
+
+  vector<Baked::Entry> entries;
+  size_t failed = 0;
+  for (size_t i=0; i<sources.size(); ++i)
+  {
+    const Source &s = sources[i];
+    const boost::uint64_t key = bakeKey(s.src.c_str(),s.src.length());
+
+    for (int api=0; api<2; ++api)
+    {
+      const bool is_es = api==1;
+      if (is_es ? !es : !gl)
+        continue;
+
+      for (int t=0; t<2; ++t)
+      {
+        const GLenum type = t ? GL_FRAGMENT_SHADER : GL_VERTEX_SHADER;
+        if (s.type!=GL_NONE && s.type!=type)
+          continue;
+
+        size_t baked = 0;
+        for (size_t c=0; c<compares.size(); ++c)
+        {
+          Baked::Entry e;
+          e.key     = key;
+          e.options = bakeOptions(is_es,type,compares[c]);
+          if (!OptimizeGLSL(is_es,type,s.src,e.output,compares[c]))
+            continue;
+          entries.push_back(e);
+          ++baked;
+        }
+
+        if (verbose && baked)
+          printf("%s: %s %s shader, %u variants\n",s.name.c_str(),is_es ? "ES" : "GL",
+            t ? "fragment" : "vertex",unsigned(baked));
+        if (!baked && s.type!=GL_NONE)
+          ++failed;
+      }
+    }
+  }
+
+  vector<char> table;
+  Baked::write(entries,table);
+
+  if (!writeTable(output,table))
+  {
+    fprintf(stderr,"regalbake: could not write %s\n",output.c_str());
+    return 1;
+  }
+
+  if (!embed.empty() && !writeEmbed(embed,table))
+  {
+    fprintf(stderr,"regalbake: could not write %s\n",embed.c_str());
+    return 1;
+  }
+
+  printf("regalbake: %u shaders, %u entries, %u bytes written to %s\n",
+    unsigned(sources.size()),unsigned(entries.size()),unsigned(table.size()),output.c_str());
+  if (failed)
+    fprintf(stderr,"regalbake: %u shaders failed to optimize\n",unsigned(failed));
+
+  return failed ? 2 : 0;
+}
@@ -0,0 +1,155 @@
+/*
+  Copyright (c) 2011-2012 NVIDIA Corporation
+  Copyright (c) 2011-2012 Cass Everitt
+  Copyright (c) 2012 Scott Nations
+  Copyright (c) 2012 Mathias Schott
+  Copyright (c) 2012 Nigel Stewart
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+  OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+  OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+
+ regallog - decoder for Regal binary logs
+
+ Reads a log written with REGAL_LOG_BINARY and writes the text log, or
+ with --json the Chrome tracing JSON, that Regal would have written at
+ the time.
+
+ */
+
+#include <GL/Regal.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "RegalUtil.h"
+#include "RegalLog.h"
+
+using namespace std;
+
+namespace Logging = Regal::Logging;
+
+namespace {
+
+void usage()
+{
+  fprintf(stderr,
+    "Usage: regallog [options] file\n"
+    "\n"
+    "  -o file          Output file, standard output by default\n"
+    "  --json           Write the JSON trace rather than the text log\n"
+    "  --thread         Thread ids in the text log, as REGAL_LOG_THREAD\n"
+    "  --process        Process id in the text log, as REGAL_LOG_PROCESS\n"
+    "  --max-lines n    Lines per message, as REGAL_LOG_MAX_LINES\n");
+}
+
+bool readFile(const string &filename, string &data)
+{
+  FILE *f = fopen(filename.c_str(),"rb");
+  if (!f)
+    return false;
+  char buffer[65536];
+  size_t n;
+  data.clear();
+  while ((n = fread(buffer,1,sizeof(buffer),f))>0)
+    data.append(buffer,n);
+  const bool ok = !ferror(f);
+  fclose(f);
+  return ok;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+  string input;
+  string output;
+  bool json = false;
+
+  Logging::thread   = false;
+  Logging::process  = false;
+  Logging::maxLines = -1;
+
+  for (int i=1; i<argc; ++i)
+  {
+    const string arg = argv[i];
+    const bool value = i+1<argc;
+    if (arg=="-o" && value)
+      output = argv[++i];
+    else if (arg=="--json")
+      json = true;
+    else if (arg=="--thread")
+      Logging::thread = true;
+    else if (arg=="--process")
+      Logging::process = true;
+    else if (arg=="--max-lines" && value)
+      Logging::maxLines = atoi(argv[++i]);
+    else if (arg=="-h" || arg=="--help")
+    {
+      usage();
+      return 0;
+    }
+    else if (!arg.empty() && arg[0]!='-' && input.empty())
+      input = arg;
+    else
+    {
+      usage();
+      return 1;
+    }
+  }
+
+  if (input.empty())
+  {
+    usage();
+    return 1;
+  }
+
+  string data;
+  if (!readFile(input,data))
+  {
+    fprintf(stderr,"regallog: could not read %s\n",input.c_str());
+    return 1;
+  }
+
+  // A log cut short by a crash still decodes up to where it ends
+
+  string text, trace;
+  const bool ok = Logging::Binary::decode(data.c_str(),data.size(),text,trace);
+  if (!ok)
+    fprintf(stderr,"regallog: %s is truncated or not a Regal binary log\n",input.c_str());
+
+  const string &result = json ? trace : text;
+  FILE *f = output.empty() ? stdout : fopen(output.c_str(),"wb");
+  if (!f)
+  {
+    fprintf(stderr,"regallog: could not write %s\n",output.c_str());
+    return 1;
+  }
+  fwrite(result.c_str(),1,result.length(),f);
+  if (f!=stdout)
+    fclose(f);
+
+  return ok ? 0 : 2;
+}
@@ -0,0 +1,731 @@
+/*
+  Copyright (c) 2011-2012 NVIDIA Corporation
+  Copyright (c) 2011-2012 Cass Everitt
+  Copyright (c) 2012 Scott Nations
+  Copyright (c) 2012 Mathias Schott
+  Copyright (c) 2012 Nigel Stewart
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+  OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+  OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+
+ regalreplay - Regal CPU overhead benchmark
+
+ Replays an apitrace trace through the Regal entry points with the
+ driver dispatch table routed to a no-op backend, and reports the time
+ spent in Regal per call, per function and, with --layers, per dispatch
+ layer.
+
+ Arguments are passed according to the platform calling convention from
+ the values recorded in the trace, without per-function code.  Pointers
+ recorded as plain addresses are replaced by a zero-filled scratch
+ buffer, object names are not remapped and window system calls are
+ skipped, so the replay measures Regal rather than reproducing the
+ rendering.
+
+ */
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "os_time.hpp"
+#include "trace_parser.hpp"
+
+#include <GL/Regal.h>
+
+#include "RegalUtil.h"
+#include "RegalLog.h"
+#include "RegalContext.h"
+#include "RegalDispatcherGL.h"
+
+// Xlib's Bool would hide trace::Bool
+
+#undef Bool
+
+#if defined(__x86_64__) && !defined(_WIN32)
+# define REPLAY_INT_REGS 6      // System V AMD64
+#elif defined(__aarch64__) && !defined(__APPLE__)
+# define REPLAY_INT_REGS 8      // AAPCS64
+#else
+# error "regalreplay: unsupported calling convention"
+#endif
+
+#define REPLAY_FP_REGS     8
+#define REPLAY_STACK_SLOTS 16
+
+using namespace std;
+
+namespace Logging = Regal::Logging;
+
+using Regal::DispatchTableGL;
+using Regal::DispatcherGL;
+using Regal::RegalContext;
+
+namespace {
+
+// Zero-filled memory standing in for recorded addresses and mapped buffers
+
+const size_t scratchSize = 16*1024*1024;
+char *scratch = NULL;
+
+//
+// No-op driver
+//
+// Missing::Init provides a correctly typed stub for every entry point,
+// the queries Regal makes during context initialization and the object
+// creation calls are answered here.
+
+namespace NoOp {
+
+string version = "4.5.0 regalreplay";
+string extensions;
+GLuint names = 0;
+
+const GLubyte * REGAL_CALL glGetString(GLenum name)
+{
+  switch (name)
+  {
+    case GL_VENDOR:     return reinterpret_cast<const GLubyte *>("Regal");
+    case GL_RENDERER:   return reinterpret_cast<const GLubyte *>("regalreplay no-op");
+    case GL_VERSION:    return reinterpret_cast<const GLubyte *>(version.c_str());
+    case GL_EXTENSIONS: return reinterpret_cast<const GLubyte *>(extensions.c_str());
+    case GL_SHADING_LANGUAGE_VERSION: return reinterpret_cast<const GLubyte *>("4.50");
+    default:            return reinterpret_cast<const GLubyte *>("");
+  }
+}
+
+const GLubyte * REGAL_CALL glGetStringi(GLenum name, GLuint index)
+{
+  UNUSED_PARAMETER(name);
+  UNUSED_PARAMETER(index);
+  return reinterpret_cast<const GLubyte *>("");
+}
+
+void REGAL_CALL glGetIntegerv(GLenum pname, GLint *data)
+{
+  if (!data)
+    return;
+  switch (pname)
+  {
+    case GL_NUM_EXTENSIONS:
+    case GL_CONTEXT_FLAGS:
+    case GL_CONTEXT_PROFILE_MASK:
+      *data = 0;
+      break;
+    default:
+      *data = 16;       // Limits: texture units, attributes, stack depths...
+      break;
+  }
+}
+
+void REGAL_CALL glGetFloatv(GLenum pname, GLfloat *data)
+{
+  UNUSED_PARAMETER(pname);
+  if (data)
+    *data = 0.0f;
+}
+
+void REGAL_CALL glGetBooleanv(GLenum pname, GLboolean *data)
+{
+  UNUSED_PARAMETER(pname);
+  if (data)
+    *data = GL_FALSE;
+}
+
+GLenum REGAL_CALL glGetError(void)
+{
+  return GL_NO_ERROR;
+}
+
+void REGAL_CALL glGenNames(GLsizei n, GLuint *objects)
+{
+  for (GLsizei i=0; objects && i<n; ++i)
+    objects[i] = ++names;
+}
+
+GLuint REGAL_CALL glGenLists(GLsizei range)
+{
+  const GLuint first = names + 1;
+  names += GLuint(range);
+  return first;
+}
+
+GLuint REGAL_CALL glCreateProgram(void)
+{
+  return ++names;
+}
+
+GLuint REGAL_CALL glCreateShader(GLenum type)
+{
+  UNUSED_PARAMETER(type);
+  return ++names;
+}
+
+void REGAL_CALL glGetObjectiv(GLuint object, GLenum pname, GLint *params)
+{
+  UNUSED_PARAMETER(object);
+  if (params)
+    *params = pname==GL_COMPILE_STATUS || pname==GL_LINK_STATUS || pname==GL_VALIDATE_STATUS ? GL_TRUE : 0;
+}
+
+GLenum REGAL_CALL glCheckFramebufferStatus(GLenum target)
+{
+  UNUSED_PARAMETER(target);
+  return GL_FRAMEBUFFER_COMPLETE;
+}
+
+void * REGAL_CALL glMapBuffer(GLenum target, GLenum access)
+{
+  UNUSED_PARAMETER(target);
+  UNUSED_PARAMETER(access);
+  return scratch;
+}
+
+GLvoid * REGAL_CALL glMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access)
+{
+  UNUSED_PARAMETER(target);
+  UNUSED_PARAMETER(offset);
+  UNUSED_PARAMETER(access);
+  return size_t(length)<=scratchSize ? scratch : NULL;
+}
+
+GLsync REGAL_CALL glFenceSync(GLenum condition, GLbitfield flags)
+{
+  UNUSED_PARAMETER(condition);
+  UNUSED_PARAMETER(flags);
+  return reinterpret_cast<GLsync>(scratch);
+}
+
+GLenum REGAL_CALL glClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout)
+{
+  UNUSED_PARAMETER(sync);
+  UNUSED_PARAMETER(flags);
+  UNUSED_PARAMETER(timeout);
+  return GL_ALREADY_SIGNALED;
+}
+
+void Init(DispatchTableGL &tbl)
+{
+  Regal::Missing::Init(tbl);
+
+  tbl.glGetString              = glGetString;
+  tbl.glGetStringi             = glGetStringi;
+  tbl.glGetIntegerv            = glGetIntegerv;
+  tbl.glGetFloatv              = glGetFloatv;
+  tbl.glGetBooleanv            = glGetBooleanv;
+  tbl.glGetError               = glGetError;
+  tbl.glGenLists               = glGenLists;
+  tbl.glGenTextures            = glGenNames;
+  tbl.glGenBuffers             = glGenNames;
+  tbl.glGenQueries             = glGenNames;
+  tbl.glGenFramebuffers        = glGenNames;
+  tbl.glGenRenderbuffers       = glGenNames;
+  tbl.glGenVertexArrays        = glGenNames;
+  tbl.glGenSamplers            = glGenNames;
+  tbl.glGenProgramPipelines    = glGenNames;
+  tbl.glCreateProgram          = glCreateProgram;
+  tbl.glCreateShader           = glCreateShader;
+  tbl.glGetShaderiv            = glGetObjectiv;
+  tbl.glGetProgramiv           = glGetObjectiv;
+  tbl.glCheckFramebufferStatus = glCheckFramebufferStatus;
+  tbl.glMapBuffer              = glMapBuffer;
+  tbl.glMapBufferRange         = glMapBufferRange;
+  tbl.glFenceSync              = glFenceSync;
+  tbl.glClientWaitSync         = glClientWaitSync;
+}
+
+}
+
+//
+// Arguments in registers and stack slots, in calling convention order
+//
+
+struct Arguments
+{
+  GLuint64 ints[REPLAY_INT_REGS];
+  double   fps[REPLAY_FP_REGS];
+  GLuint64 stack[REPLAY_STACK_SLOTS];
+
+  size_t numInts, numFps, numStack;
+  bool   overflow;
+
+  // Marshalled arrays, stable while the call is made
+
+  deque< vector<char> > arrays;
+
+  void clear()
+  {
+    memset(ints,0,sizeof(ints));
+    memset(fps,0,sizeof(fps));
+    memset(stack,0,sizeof(stack));
+    numInts = numFps = numStack = 0;
+    overflow = false;
+    arrays.clear();
+  }
+
+  void pushStack(GLuint64 bits)
+  {
+    if (numStack<REPLAY_STACK_SLOTS)
+      stack[numStack++] = bits;
+    else
+      overflow = true;
+  }
+
+  void pushInt(GLuint64 value)
+  {
+    if (numInts<REPLAY_INT_REGS)
+      ints[numInts++] = value;
+    else
+      pushStack(value);
+  }
+
+  // Floats occupy the low half of a vector register or stack slot
+
+  void pushFloat(float value)
+  {
+    GLuint64 bits = 0;
+    memcpy(&bits,&value,sizeof(value));
+    pushFp(bits);
+  }
+
+  void pushDouble(double value)
+  {
+    GLuint64 bits;
+    memcpy(&bits,&value,sizeof(value));
+    pushFp(bits);
+  }
+
+  void pushFp(GLuint64 bits)
+  {
+    if (numFps<REPLAY_FP_REGS)
+      memcpy(&fps[numFps++],&bits,sizeof(bits));
+    else
+      pushStack(bits);
+  }
+};
+
+// Width of integer array elements, from the type suffix of the function
+// name such as glColor4ubv, glVertex2sv or glGetInteger64v.
+
+size_t integerWidth(const char *name)
+{
+  string n(name);
+  while (n.length() && isupper(n[n.length()-1]))   // ARB, EXT, NV...
+    n.erase(n.length()-1);
+
+  if (n.find("Boolean")!=string::npos || n.find("EdgeFlag")!=string::npos)
+    return 1;
+  if (n.find("64")!=string::npos)
+    return 8;
+
+  const size_t len = n.length();
+  if (len>=3 && (!n.compare(len-3,3,"ubv") || !n.compare(len-2,2,"bv")))
+    return 1;
+  if (len>=3 && (!n.compare(len-3,3,"usv") || !n.compare(len-2,2,"sv")))
+    return 2;
+  return 4;
+}
+
+// Converts recorded values into arguments, top-level values to registers
+// and slots, array elements to packed memory
+
+class Marshaller : public trace::Visitor
+{
+public:
+  Marshaller(Arguments &args, size_t width) : _args(args), _width(width), _array(NULL) {}
+
+  void visit(trace::Null *)       { integer(0); }
+  void visit(trace::Bool *node)   { integer(node->value ? 1 : 0); }
+  void visit(trace::SInt *node)   { integer(GLuint64(node->value)); }
+  void visit(trace::UInt *node)   { integer(node->value); }
+  void visit(trace::Enum *node)   { integer(GLuint64(node->value)); }
+  void visit(trace::Bitmask *node){ integer(node->value); }
+  void visit(trace::String *node) { pointer(node->value); }
+  void visit(trace::Blob *node)   { pointer(node->buf); }
+  void visit(trace::Pointer *node){ pointer(node->value ? scratch : NULL); }
+  void visit(trace::Struct *)     { pointer(NULL); }
+  void visit(trace::Repr *node)   { _visit(node->machineValue); }
+
+  void visit(trace::Float *node)
+  {
+    if (_array)
+      append(&node->value,sizeof(node->value));
+    else
+      _args.pushFloat(node->value);
+  }
+
+  void visit(trace::Double *node)
+  {
+    if (_array)
+      append(&node->value,sizeof(node->value));
+    else
+      _args.pushDouble(node->value);
+  }
+
+  void visit(trace::Array *node)
+  {
+    vector<char> *outer = _array;
+    _args.arrays.push_back(vector<char>());
+    _array = &_args.arrays.back();
+    _array->reserve(node->values.size()*8);
+    for (size_t i=0; i<node->values.size(); ++i)
+      _visit(node->values[i]);
+    _array->resize(max(_array->size(),size_t(16)));  // Room for a single query result
+    vector<char> *inner = _array;
+    _array = outer;
+    pointer(&(*inner)[0]);
+  }
+
+  void value(trace::Value *value)
+  {
+    if (value)
+      _visit(value);
+    else
+      integer(0);
+  }
+
+private:
+  void append(const void *data, size_t size)
+  {
+    const char *bytes = static_cast<const char *>(data);
+    _array->insert(_array->end(),bytes,bytes+size);
+  }
+
+  void integer(GLuint64 value)
+  {
+    if (_array)
+      append(&value,_width);    // Little-endian
+    else
+      _args.pushInt(value);
+  }
+
+  void pointer(const void *ptr)
+  {
+    if (_array)
+      append(&ptr,sizeof(ptr));
+    else
+      _args.pushInt(GLuint64(reinterpret_cast<size_t>(ptr)));
+  }
+
+  Arguments    &_args;
+  size_t        _width;
+  vector<char> *_array;
+};
+
+#if REPLAY_INT_REGS==6
+typedef GLuint64 (*Proc)(GLuint64, GLuint64, GLuint64, GLuint64, GLuint64, GLuint64,
+                         double, double, double, double, double, double, double, double,
+                         GLuint64, GLuint64, GLuint64, GLuint64, GLuint64, GLuint64, GLuint64, GLuint64,
+                         GLuint64, GLuint64, GLuint64, GLuint64, GLuint64, GLuint64, GLuint64, GLuint64);
+#define REPLAY_INTS(a) a.ints[0], a.ints[1], a.ints[2], a.ints[3], a.ints[4], a.ints[5]
+#else
+typedef GLuint64 (*Proc)(GLuint64, GLuint64, GLuint64, GLuint64, GLuint64, GLuint64, GLuint64, GLuint64,
+                         double, double, double, double, double, double, double, double,
+                         GLuint64, GLuint64, GLuint64, GLuint64, GLuint64, GLuint64, GLuint64, GLuint64,
+                         GLuint64, GLuint64, GLuint64, GLuint64, GLuint64, GLuint64, GLuint64, GLuint64);
+#define REPLAY_INTS(a) a.ints[0], a.ints[1], a.ints[2], a.ints[3], a.ints[4], a.ints[5], a.ints[6], a.ints[7]
+#endif
+
+inline void invoke(Proc proc, const Arguments &a)
+{
+  proc(REPLAY_INTS(a),
+       a.fps[0], a.fps[1], a.fps[2], a.fps[3], a.fps[4], a.fps[5], a.fps[6], a.fps[7],
+       a.stack[0],  a.stack[1],  a.stack[2],  a.stack[3],  a.stack[4],  a.stack[5],  a.stack[6],  a.stack[7],
+       a.stack[8],  a.stack[9],  a.stack[10], a.stack[11], a.stack[12], a.stack[13], a.stack[14], a.stack[15]);
+}
+
+//
+// Replay
+//
+
+struct FunctionStats
+{
+  FunctionStats() : calls(0), time(0) {}
+
+  string    name;
+  GLuint64  calls;
+  long long time;
+};
+
+struct Stats
+{
+  Stats() : enabled(true), calls(0), frames(0), skipped(0), time(0) {}
+
+  bool      enabled;        // The layer disabled for the pass was enabled
+
+  GLuint64  calls;
+  GLuint64  frames;
+  GLuint64  skipped;
+  long long time;           // os::timeFrequency units
+
+  vector<FunctionStats> functions;
+};
+
+struct Layer
+{
+  const char                   *name;
+  DispatchTableGL DispatcherGL::*table;
+};
+
+const Layer layers[] = {
+#if REGAL_TRACE
+  { "trace",      &DispatcherGL::trace      },
+#endif
+#if REGAL_HTTP
+  { "http",       &DispatcherGL::http       },
+#endif
+#if REGAL_DEBUG
+  { "debug",      &DispatcherGL::debug      },
+#endif
+#if REGAL_ERROR
+  { "error",      &DispatcherGL::error      },
+#endif
+#if REGAL_EMULATION
+  { "emulation",  &DispatcherGL::emulation  },
+#endif
+#if REGAL_CACHE
+  { "cache",      &DispatcherGL::cache      },
+#endif
+#if REGAL_CODE
+  { "code",       &DispatcherGL::code       },
+#endif
+#if REGAL_STATISTICS
+  { "statistics", &DispatcherGL::statistics },
+#endif
+#if REGAL_LOG
+  { "log",        &DispatcherGL::logging    },
+#endif
+  { NULL, NULL }
+};
+
+// Only OpenGL calls are replayed, window system calls and apitrace's
+// memcpy records of mapped memory are skipped.
+
+bool replayable(const char *name)
+{
+  return name[0]=='g' && name[1]=='l' && !(name[2]=='X' && isupper(name[3]));
+}
+
+bool replay(const string &filename, const Layer *disabled, Stats &stats)
+{
+  trace::Parser parser;
+  if (!parser.open(filename.c_str(), true))
+  {
+    fprintf(stderr,"regalreplay: could not read %s\n",filename.c_str());
+    return false;
+  }
+
+  // A fresh context for each pass, so that passes don't share state
+
+  static char sysCtx[64];
+  static size_t pass = 0;
+  RegalSystemContext ctx = reinterpret_cast<RegalSystemContext>(&sysCtx[pass++ % sizeof(sysCtx)]);
+  RegalMakeCurrent(ctx);
+
+  RegalContext *context = REGAL_GET_CONTEXT();
+  if (!context)
+  {
+    fprintf(stderr,"regalreplay: could not create a Regal context\n");
+    return false;
+  }
+  // The no-op driver warns about every call it doesn't implement
+
+  Logging::enableWarning = false;
+
+  if (disabled)
+  {
+    DispatchTableGL &table = context->dispatcher.*(disabled->table);
+    stats.enabled = context->dispatcher.isEnabled(table);
+    context->dispatcher.disable(table);
+  }
+
+  vector<Proc> procs;
+  Arguments args;
+
+  trace::Call *call;
+  while ((call = parser.parse_call()))
+  {
+    const size_t id = call->sig->id;
+    if (id>=procs.size())
+    {
+      procs.resize(id+1,NULL);
+      stats.functions.resize(max(stats.functions.size(),id+1));
+    }
+
+    if (call->flags & trace::CALL_FLAG_END_FRAME)
+      ++stats.frames;
+
+    Proc proc = procs[id];
+    if (!proc && replayable(call->name()))
+    {
+      proc = procs[id] = reinterpret_cast<Proc>(glGetProcAddressREGAL(call->name()));
+      stats.functions[id].name = call->name();
+    }
+
+    args.clear();
+    Marshaller marshaller(args,integerWidth(call->name()));
+    for (size_t i=0; i<call->args.size(); ++i)
+      marshaller.value(call->args[i].value);
+
+    if (!proc || args.overflow)
+    {
+      ++stats.skipped;
+      delete call;
+      continue;
+    }
+
+    const long long start = os::getTime();
+    invoke(proc,args);
+    const long long elapsed = os::getTime() - start;
+
+    ++stats.calls;
+    stats.time += elapsed;
+    ++stats.functions[id].calls;
+    stats.functions[id].time += elapsed;
+
+    delete call;
+  }
+
+  RegalMakeCurrent(NULL);
+  RegalDestroyContext(ctx);
+  return true;
+}
+
+bool byTime(const FunctionStats &a, const FunctionStats &b)
+{
+  return a.time > b.time;
+}
+
+double milliseconds(long long time)
+{
+  return double(time)*1000.0/double(os::timeFrequency);
+}
+
+void usage()
+{
+  fprintf(stderr,
+    "Usage: regalreplay [options] file.trace\n"
+    "\n"
+    "  --version string    GL_VERSION of the no-op driver, \"4.5.0\" by default\n"
+    "  --extensions string GL_EXTENSIONS of the no-op driver\n"
+    "  --functions n       Functions listed, 20 by default\n"
+    "  --layers            Replay again without each enabled layer, to time it\n");
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+  string input;
+  size_t numFunctions = 20;
+  bool   timeLayers = false;
+
+  for (int i=1; i<argc; ++i)
+  {
+    const string arg = argv[i];
+    const bool value = i+1<argc;
+    if (arg=="--version" && value)
+      NoOp::version = argv[++i];
+    else if (arg=="--extensions" && value)
+      NoOp::extensions = argv[++i];
+    else if (arg=="--functions" && value)
+      numFunctions = size_t(atoi(argv[++i]));
+    else if (arg=="--layers")
+      timeLayers = true;
+    else if (arg=="-h" || arg=="--help")
+    {
+      usage();
+      return 0;
+    }
+    else if (!arg.empty() && arg[0]!='-' && input.empty())
+      input = arg;
+    else
+    {
+      usage();
+      return 1;
+    }
+  }
+
+  if (input.empty())
+  {
+    usage();
+    return 1;
+  }
+
+  scratch = static_cast<char *>(calloc(scratchSize,1));
+  DispatcherGL::driverInit = NoOp::Init;
+
+  Stats stats;
+  if (!replay(input,NULL,stats))
+    return 1;
+
+  printf("%llu calls, %llu frames, %llu skipped\n",
+    (unsigned long long) stats.calls, (unsigned long long) stats.frames, (unsigned long long) stats.skipped);
+  printf("%.3f ms in Regal, %.0f calls/s, %.1f ns/call\n",
+    milliseconds(stats.time),
+    stats.time ? double(stats.calls)*double(os::timeFrequency)/double(stats.time) : 0.0,
+    stats.calls ? milliseconds(stats.time)*1.0e6/double(stats.calls) : 0.0);
+
+  vector<FunctionStats> functions;
+  for (size_t i=0; i<stats.functions.size(); ++i)
+    if (stats.functions[i].calls)
+      functions.push_back(stats.functions[i]);
+  sort(functions.begin(),functions.end(),byTime);
+  functions.resize(min(functions.size(),numFunctions));
+
+  printf("\n%-40s %12s %12s %10s\n","function","calls","ms","ns/call");
+  for (size_t i=0; i<functions.size(); ++i)
+    printf("%-40s %12llu %12.3f %10.1f\n",
+      functions[i].name.c_str(),
+      (unsigned long long) functions[i].calls,
+      milliseconds(functions[i].time),
+      milliseconds(functions[i].time)*1.0e6/double(functions[i].calls));
+
+  // Each layer costs the difference to a replay without it
+
+  if (timeLayers)
+  {
+    printf("\n%-40s %12s %12s\n","layer","ms","%");
+    for (const Layer *layer = layers; layer->name; ++layer)
+    {
+      Stats without;
+      if (!replay(input,layer,without))
+        return 1;
+      if (!without.enabled)
+        continue;
+      const long long cost = stats.time - without.time;
+      printf("%-40s %12.3f %12.1f\n",layer->name,milliseconds(cost),
+        stats.time ? 100.0*double(cost)/double(stats.time) : 0.0);
+    }
+  }
+
+  free(scratch);
+  return 0;
+}
@@ -138,7 +138,7 @@ const int kMaxIncrementCopyOverflow = 10;
 
 }  // namespace
 
-static inline void IncrementalCopyFastPath(const char* src, char* op, size_t len) {
+static inline void IncrementalCopyFastPath(const char* src, char* op, ptrdiff_t len) {
   while (op - src < 8) {
     UnalignedCopy64(src, op);
     len -= op - src;
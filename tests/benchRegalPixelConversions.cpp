@@ -0,0 +1,116 @@
+/*
+  Copyright (c) 2011-2012 NVIDIA Corporation
+  Copyright (c) 2011-2012 Cass Everitt
+  Copyright (c) 2012 Scott Nations
+  Copyright (c) 2012 Mathias Schott
+  Copyright (c) 2012 Nigel Stewart
+  Copyright (c) 2013 Google Inc
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+  OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+  OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Throughput of the pixel conversions, in MPixels/s, for each of the pairs
+// with a direct conversion: the generic Unpack32/Pack32 path, and the scalar
+// and SIMD direct kernels.
+
+#include "gtest/gtest.h"
+
+#include <GL/Regal.h>
+
+#include <cstdio>
+#include <vector>
+
+#include <RegalTimer.h>
+#include <RegalPixelConversions.h>
+
+namespace {
+
+using Regal::IConversion;
+using Regal::GetConversionInterface;
+using Regal::DirectConversion;
+using Regal::GetDirectConversion;
+using Regal::Timer;
+
+const size_t width      = 1024;
+const size_t height     = 256;
+const size_t iterations = 4;
+
+double MPixelsPerSecond( Timer &timer )
+{
+  const double us = static_cast<double>( timer.elapsed() );
+  return us > 0 ? double( width * height * iterations ) / us : 0.0;
+}
+
+void Bench( const char *name, GLenum srcFormat, GLenum srcType, GLenum dstFormat, GLenum dstType )
+{
+  IConversion *src = GetConversionInterface( srcFormat, srcType );
+  IConversion *dst = GetConversionInterface( dstFormat, dstType );
+  DirectConversion scalar = GetDirectConversion( srcFormat, srcType, dstFormat, dstType, false );
+  DirectConversion simd   = GetDirectConversion( srcFormat, srcType, dstFormat, dstType );
+  ASSERT_TRUE( src != NULL && dst != NULL && scalar != NULL && simd != NULL );
+
+  std::vector<uint32_t> in( width * height );
+  std::vector<uint32_t> out( width * height );
+  std::vector<uint32_t> row( width );
+  for ( size_t i = 0; i < in.size(); ++i )
+    in[ i ] = static_cast<uint32_t>( i * 0x9e3779b9u );
+
+  const size_t srcStride = width * src->GetPackedPixelByteSize();
+  const size_t dstStride = width * dst->GetPackedPixelByteSize();
+
+  Timer timer;
+  timer.restart();
+  for ( size_t n = 0; n < iterations; ++n ) {
+    for ( size_t y = 0; y < height; ++y ) {
+      src->Unpack32( reinterpret_cast<const uint8_t *>( &in[ 0 ] ) + y * srcStride, &row[ 0 ], width );
+      dst->Pack32( &row[ 0 ], reinterpret_cast<uint8_t *>( &out[ 0 ] ) + y * dstStride, width );
+    }
+  }
+  const double generic = MPixelsPerSecond( timer );
+
+  timer.restart();
+  for ( size_t n = 0; n < iterations; ++n ) {
+    for ( size_t y = 0; y < height; ++y )
+      scalar( reinterpret_cast<const uint8_t *>( &in[ 0 ] ) + y * srcStride, reinterpret_cast<uint8_t *>( &out[ 0 ] ) + y * dstStride, width );
+  }
+  const double direct = MPixelsPerSecond( timer );
+
+  timer.restart();
+  for ( size_t n = 0; n < iterations; ++n ) {
+    for ( size_t y = 0; y < height; ++y )
+      simd( reinterpret_cast<const uint8_t *>( &in[ 0 ] ) + y * srcStride, reinterpret_cast<uint8_t *>( &out[ 0 ] ) + y * dstStride, width );
+  }
+  const double vector = MPixelsPerSecond( timer );
+
+  printf( "%-18s generic %8.1f  scalar %8.1f  simd %8.1f MPixels/s\n", name, generic, direct, vector );
+}
+
+TEST( RegalPixelConversionsBench, Throughput ) {
+  Bench( "RGBA8 to RGB565",   GL_RGBA,            GL_UNSIGNED_BYTE, GL_RGB,  GL_UNSIGNED_SHORT_5_6_5   );
+  Bench( "RGBA8 to RGBA4444", GL_RGBA,            GL_UNSIGNED_BYTE, GL_RGBA, GL_UNSIGNED_SHORT_4_4_4_4 );
+  Bench( "RGBA8 to RGBA5551", GL_RGBA,            GL_UNSIGNED_BYTE, GL_RGBA, GL_UNSIGNED_SHORT_5_5_5_1 );
+  Bench( "LA8 to RGBA8",      GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE, GL_RGBA, GL_UNSIGNED_BYTE          );
+  Bench( "BGRA8 to RGBA8",    GL_BGRA,            GL_UNSIGNED_BYTE, GL_RGBA, GL_UNSIGNED_BYTE          );
+}
+
+} // namespace
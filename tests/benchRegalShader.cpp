@@ -0,0 +1,191 @@
+/*
+  Copyright (c) 2011-2012 NVIDIA Corporation
+  Copyright (c) 2011-2012 Cass Everitt
+  Copyright (c) 2012 Scott Nations
+  Copyright (c) 2012 Mathias Schott
+  Copyright (c) 2012 Nigel Stewart
+  Copyright (c) 2013 Google Inc
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+  OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+  OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+// Time per shader spent in the GLSL optimizer for the fixed function shader
+// variants Iff generates: a fresh optimizer context built and torn down
+// around every shader, the persistent per-thread context OptimizeGLSL
+// uses with the compiler IR allocated by malloc and from a per-shader
+// arena, and lookups in the OptimizeGLSL memo.
+
+#include "gtest/gtest.h"
+
+#include <GL/Regal.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <RegalTimer.h>
+#include <RegalUtil.h>
+
+#if REGAL_EMULATION && REGAL_GLSL_OPTIMIZER
+
+#include <main/mtypes.h>
+#include <RegalConfig.h>
+#include <RegalShader.h>
+
+namespace {
+
+using Regal::Emu::Iff;
+using Regal::Timer;
+
+using namespace Regal::Shader;
+
+const size_t iterations = 4;
+
+struct Source
+{
+  GLenum      type;
+  std::string src;
+};
+
+// Fixed function state permutations: unlit, lit with local and spot
+// lights, textured, fogged, clipped and alpha tested.
+
+void Variants( bool gles, bool legacy, std::vector<Source> &sources )
+{
+  for ( int v = 0; v < 8; ++v )
+  {
+    Iff iff;
+    iff.gles   = gles;
+    iff.legacy = legacy;
+
+    Iff::State::Store &st = iff.ffstate.raw;
+    st.lighting            = ( v & 1 ) != 0;
+    st.light[0].enable     = ( v & 1 ) != 0;
+    st.light[1].enable     = v == 7;
+    st.light[1].local      = v == 7;
+    st.colorSum            = ( v & 4 ) != 0;
+    st.fog.enable          = ( v & 2 ) != 0;
+    st.fog.mode            = v == 6 ? Iff::FG_Linear : Iff::FG_Exp;
+    st.clipPlaneEnabled[0] = v == 5;
+    st.alphaTest.enable    = v >= 4;
+    st.alphaTest.comp      = v >= 4 ? Iff::CF_Greater : Iff::CF_Always;
+    if ( v & 2 )
+    {
+      iff.textureUnit[0].ttb = Iff::TT_2D;
+      st.tex[0].enables      = Iff::TT_2D;
+    }
+
+    Source vs, fs;
+    vs.type = GL_VERTEX_SHADER;
+    fs.type = GL_FRAGMENT_SHADER;
+    iff.FixedFunctionSources( vs.src, fs.src );
+    sources.push_back( vs );
+    sources.push_back( fs );
+  }
+}
+
+bool Optimize( regal_glsl_ctx *ctx, const Source &s )
+{
+  regal_glsl_shader *shader = regal_glsl_parse( ctx, s.type == GL_VERTEX_SHADER ? kRegalGlslShaderVertex : kRegalGlslShaderFragment, s.src.c_str() );
+  regal_glsl_add_alpha_test( shader, Iff::CF_Greater );
+  regal_glsl_optimize( shader );
+  regal_glsl_gen_output( shader );
+  const bool ok = regal_glsl_get_status( shader );
+  regal_glsl_shader_delete( shader );
+  return ok;
+}
+
+double Persistent( bool gles, const std::vector<Source> &sources )
+{
+  std::string output;
+  Timer timer;
+  timer.restart();
+  for ( size_t n = 0; n < iterations; ++n ) {
+    for ( size_t i = 0; i < sources.size(); ++i )
+      EXPECT_TRUE( OptimizeGLSL( gles, sources[ i ].type, sources[ i ].src, output, Iff::CF_Greater ) );
+  }
+  return double( timer.elapsed() ) / double( iterations * sources.size() );
+}
+
+void Bench( const char *name, bool gles, bool legacy )
+{
+  std::vector<Source> sources;
+  Variants( gles, legacy, sources );
+  const gl_api api = gles ? API_OPENGLES2 : API_OPENGL_COMPAT;
+
+  Timer timer;
+  timer.restart();
+  for ( size_t n = 0; n < iterations; ++n ) {
+    for ( size_t i = 0; i < sources.size(); ++i ) {
+      regal_glsl_ctx *ctx = regal_glsl_initialize( api );
+      EXPECT_TRUE( Optimize( ctx, sources[ i ] ) );
+      regal_glsl_cleanup( ctx );
+    }
+  }
+  const double fresh = double( timer.elapsed() ) / double( iterations * sources.size() );
+
+  // first use creates the thread's context and parses the builtins
+  const int memoSize = Regal::Config::glslMemoSize;
+  Regal::Config::glslMemoSize = 0;
+  std::string output;
+  OptimizeGLSL( gles, sources[ 0 ].type, sources[ 0 ].src, output, Iff::CF_Always );
+
+  const bool arena = Regal::Config::glslArena;
+  Regal::Config::glslArena = false;
+  const double persistent = Persistent( gles, sources );
+
+  Regal::Config::glslArena = true;
+  const OptimizeGLSLStats before = GetOptimizeGLSLStats();
+  const double arenaTime = Persistent( gles, sources );
+  const OptimizeGLSLStats after = GetOptimizeGLSLStats();
+  Regal::Config::glslArena = arena;
+
+  const double allocations = double( after.arenaAllocations - before.arenaAllocations ) / double( iterations * sources.size() );
+  const double chunks = double( after.arenaChunks - before.arenaChunks ) / double( iterations * sources.size() );
+
+  Regal::Config::glslMemoSize = 4096;
+  for ( size_t i = 0; i < sources.size(); ++i )
+    OptimizeGLSL( gles, sources[ i ].type, sources[ i ].src, output, Iff::CF_Greater );
+
+  timer.restart();
+  for ( size_t n = 0; n < iterations; ++n ) {
+    for ( size_t i = 0; i < sources.size(); ++i )
+      EXPECT_TRUE( OptimizeGLSL( gles, sources[ i ].type, sources[ i ].src, output, Iff::CF_Greater ) );
+  }
+  const double memo = double( timer.elapsed() ) / double( iterations * sources.size() );
+  Regal::Config::glslMemoSize = memoSize;
+
+  printf( "%-8s %2d shaders  fresh context %9.1f  malloc %9.1f  arena %9.1f  memo %9.1f us/shader\n", name, int( sources.size() ), fresh, persistent, arenaTime, memo );
+  printf( "%-8s %2d shaders  %.0f allocations/shader served by the arena from %.1f chunks\n", name, int( sources.size() ), allocations, chunks );
+}
+
+TEST( RegalShaderBench, OptimizeFixedFunction ) {
+  Bench( "ES 2.0", true,  false );
+  Bench( "legacy", false, true  );
+  Bench( "GL 3.1", false, false );
+}
+
+} // namespace
+
+#endif // REGAL_EMULATION && REGAL_GLSL_OPTIMIZER
@@ -0,0 +1,169 @@
+/*
+  Copyright (c) 2011-2012 NVIDIA Corporation
+  Copyright (c) 2011-2012 Cass Everitt
+  Copyright (c) 2012 Scott Nations
+  Copyright (c) 2012 Mathias Schott
+  Copyright (c) 2012 Nigel Stewart
+  Copyright (c) 2012 Google Inc
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+  OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+  OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "gtest/gtest.h"
+
+#include <GL/Regal.h>
+
+#include <cstdio>
+#include <cstring>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+
+#include "RegalUtil.h"
+#include "RegalCachePack.h"
+
+#if REGAL_CACHE
+
+namespace {
+
+using namespace Regal;
+using namespace Regal::Cache;
+
+struct RegalCachePackTest : public ::testing::Test
+{
+  void SetUp()
+  {
+    char name[] = "/tmp/regalpackXXXXXX";
+    directory = mkdtemp(name) ? name : "";
+    ASSERT_FALSE(directory.empty());
+  }
+
+  void TearDown()
+  {
+    remove(makePath(directory,"regal.pack").c_str());
+    remove(makePath(directory,"regal.idx").c_str());
+    rmdir(directory.c_str());
+  }
+
+  std::string lookup(Pack &pack, ::boost::uint64_t key)
+  {
+    const void *data = NULL;
+    size_t      size = 0;
+    if (!pack.find(key,data,size))
+      return "<missing>";
+    return std::string(static_cast<const char *>(data),size);
+  }
+
+  std::string directory;
+};
+
+TEST_F( RegalCachePackTest, InsertFindReopen )
+{
+  const ::boost::uint64_t a = packKey("test","a",1);
+  const ::boost::uint64_t b = packKey("test","b",1);
+  EXPECT_NE( a, b );
+  EXPECT_NE( a, packKey("other","a",1) );
+
+  {
+    Pack pack;
+    ASSERT_TRUE( pack.open(directory) );
+    EXPECT_FALSE( pack.contains(a) );
+
+    EXPECT_TRUE( pack.insert(a,"alpha",5) );
+    EXPECT_TRUE( pack.insert(b,"beta",4) );
+    EXPECT_FALSE( pack.insert(a,"again",5) );
+
+    EXPECT_EQ( "alpha", lookup(pack,a) );
+    EXPECT_EQ( "beta",  lookup(pack,b) );
+  }
+
+  // Reopened, the entries come from the mapped pack, 8 byte aligned
+
+  Pack pack;
+  ASSERT_TRUE( pack.open(directory) );
+  EXPECT_EQ( "alpha", lookup(pack,a) );
+  EXPECT_EQ( "beta",  lookup(pack,b) );
+  EXPECT_EQ( "<missing>", lookup(pack,packKey("test","c",1)) );
+
+  const void *data = NULL;
+  size_t      size = 0;
+  ASSERT_TRUE( pack.find(b,data,size) );
+  EXPECT_EQ( 0u, reinterpret_cast<size_t>(data)%8 );
+}
+
+TEST_F( RegalCachePackTest, ReplaceAndCompact )
+{
+  const ::boost::uint64_t a = packKey("test","a",1);
+  const ::boost::uint64_t b = packKey("test","b",1);
+
+  {
+    Pack pack;
+    ASSERT_TRUE( pack.open(directory) );
+    EXPECT_TRUE( pack.insert(a,"first",5) );
+    EXPECT_TRUE( pack.insert(b,"other",5) );
+    EXPECT_TRUE( pack.insert(a,"second",6,true) );
+    EXPECT_EQ( "second", lookup(pack,a) );
+  }
+
+  // An index entry for data that was never written is ignored
+
+  FILE *index = fopen(makePath(directory,"regal.idx").c_str(),"ab");
+  ASSERT_TRUE( index!=NULL );
+  const ::boost::uint64_t truncated[3] = { packKey("test","c",1), 1u<<20, 16 };
+  fwrite(truncated,sizeof(truncated),1,index);
+  fclose(index);
+
+  long before = 0;
+  {
+    Pack pack;
+    ASSERT_TRUE( pack.open(directory) );
+    EXPECT_EQ( "second", lookup(pack,a) );
+    EXPECT_EQ( "<missing>", lookup(pack,truncated[0]) );
+    FILE *f = fopen(makePath(directory,"regal.pack").c_str(),"rb");
+    fseek(f,0,SEEK_END);
+    before = ftell(f);
+    fclose(f);
+  }
+
+  EXPECT_TRUE( Pack::compact(directory) );
+
+  Pack pack;
+  ASSERT_TRUE( pack.open(directory) );
+  EXPECT_EQ( "second", lookup(pack,a) );
+  EXPECT_EQ( "other",  lookup(pack,b) );
+
+  std::vector< ::boost::uint64_t> keys;
+  pack.keys(keys);
+  ASSERT_EQ( 2u, keys.size() );
+  EXPECT_TRUE( (keys[0]==a && keys[1]==b) || (keys[0]==b && keys[1]==a) );
+
+  FILE *f = fopen(makePath(directory,"regal.pack").c_str(),"rb");
+  fseek(f,0,SEEK_END);
+  EXPECT_LT( ftell(f), before );
+  fclose(f);
+}
+
+}  // namespace
+
+#endif // REGAL_CACHE
@@ -0,0 +1,109 @@
+/*
+  Copyright (c) 2011-2012 NVIDIA Corporation
+  Copyright (c) 2011-2012 Cass Everitt
+  Copyright (c) 2012 Scott Nations
+  Copyright (c) 2012 Mathias Schott
+  Copyright (c) 2012 Nigel Stewart
+  Copyright (c) 2012 Google Inc
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+  OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+  OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "gtest/gtest.h"
+
+#include <GL/Regal.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include <boost/print/string_list.hpp>
+
+#include "RegalUtil.h"
+#include "RegalCode.h"
+
+namespace {
+
+using namespace Regal::Code;
+using namespace boost::print;
+
+std::string temporary()
+{
+  char name[] = "/tmp/regalcodeXXXXXX";
+  int fd = mkstemp(name);
+  if (fd<0)
+    return std::string();
+  close(fd);
+  return name;
+}
+
+std::string contents(const std::string &filename)
+{
+  std::string data;
+  FILE *file = fopen(filename.c_str(),"rb");
+  if (!file)
+    return data;
+  char buffer[4096];
+  size_t size;
+  while ((size = fread(buffer,1,sizeof(buffer),file))>0)
+    data.append(buffer,size);
+  fclose(file);
+  return data;
+}
+
+TEST( RegalCode, MatchesStringList )
+{
+  const std::string filename = temporary();
+  ASSERT_FALSE(filename.empty());
+
+  // A small block, so that output is flushed many times, and some
+  // values don't fit a block at all
+
+  const GLubyte texture[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12 };
+  const std::string big(100,'x');
+
+  string_list< ::std::string > expected;
+  {
+    Output output(64);
+    ASSERT_TRUE(output.open(filename));
+    for (int i = 0; i < 1000; ++i)
+    {
+      const detail::pad<char> indent((i%3 + 1)*2);
+      output   << indent << "glUniform1f(" << i << ", " << 0.5f*i << ");\n";
+      expected << indent << "glUniform1f(" << i << ", " << 0.5f*i << ");\n";
+      output   << "const GLubyte texture" << i << "[] = " << array<GLubyte,const char * const>(texture,i%12,"","{ "," }",",") << ";\n";
+      expected << "const GLubyte texture" << i << "[] = " << array<GLubyte,const char * const>(texture,i%12,"","{ "," }",",") << ";\n";
+      output   << big << '\n' << GLuint(i) << hex(GLbitfield(i)) << static_cast<const void *>(NULL) << "\n";
+      expected << big << '\n' << GLuint(i) << hex(GLbitfield(i)) << static_cast<const void *>(NULL) << "\n";
+    }
+    output.close();
+    EXPECT_FALSE(output.isOpen());
+  }
+
+  EXPECT_EQ(expected.str(), contents(filename));
+  remove(filename.c_str());
+}
+
+}
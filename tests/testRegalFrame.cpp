@@ -0,0 +1,75 @@
+/*
+  Copyright (c) 2011-2012 NVIDIA Corporation
+  Copyright (c) 2011-2012 Cass Everitt
+  Copyright (c) 2012 Scott Nations
+  Copyright (c) 2012 Mathias Schott
+  Copyright (c) 2012 Nigel Stewart
+  Copyright (c) 2012 Google Inc
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+  OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+  OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "gtest/gtest.h"
+
+#include <GL/Regal.h>
+
+#include "RegalUtil.h"
+#include "RegalFrame.h"
+
+#if REGAL_FRAME
+
+namespace {
+
+using Regal::Frame;
+
+TEST( RegalFrame, TimingWindow )
+{
+  Frame::Window window;
+  EXPECT_EQ(0.0, window.min());
+  EXPECT_EQ(0.0, window.avg());
+  EXPECT_EQ(0.0, window.p99());
+
+  // 1..100 msec, out of order
+
+  for (int i = 0; i < 100; ++i)
+    window.push(double((i*37)%100 + 1));
+
+  EXPECT_EQ(100u,  window.size());
+  EXPECT_EQ(1.0,   window.min());
+  EXPECT_EQ(50.5,  window.avg());
+  EXPECT_EQ(99.0,  window.p99());
+
+  // A single hitch shows in the p99 of a short window
+
+  window.clear();
+  for (int i = 0; i < 10; ++i)
+    window.push(i==3 ? 50.0 : 16.0);
+
+  EXPECT_EQ(16.0,  window.min());
+  EXPECT_DOUBLE_EQ(19.4, window.avg());
+  EXPECT_EQ(50.0,  window.p99());
+}
+
+}  // namespace
+
+#endif // REGAL_FRAME
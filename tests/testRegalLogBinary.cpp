@@ -0,0 +1,114 @@
+/*
+  Copyright (c) 2011-2012 NVIDIA Corporation
+  Copyright (c) 2011-2012 Cass Everitt
+  Copyright (c) 2012 Scott Nations
+  Copyright (c) 2012 Mathias Schott
+  Copyright (c) 2012 Nigel Stewart
+  Copyright (c) 2012 Google Inc
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+  OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+  OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "gtest/gtest.h"
+
+#include <GL/Regal.h>
+
+#include <cstdio>
+#include <string>
+
+#include "RegalUtil.h"
+#include "RegalLog.h"
+
+namespace {
+
+using namespace Regal::Logging;
+
+// Log to a temporary file, then decode what was written
+
+struct BinaryLog
+{
+  BinaryLog()
+  {
+    binaryOutput = tmpfile();
+    std::string h;
+    Binary::header(h);
+    fwrite(h.c_str(),h.length(),1,binaryOutput);
+  }
+
+  ~BinaryLog()
+  {
+    fclose(binaryOutput);
+    binaryOutput = NULL;
+  }
+
+  std::string contents()
+  {
+    fflush(binaryOutput);
+    rewind(binaryOutput);
+    std::string data;
+    char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer,1,sizeof(buffer),binaryOutput))>0)
+      data.append(buffer,n);
+    return data;
+  }
+};
+
+TEST( RegalLogBinary, Decode )
+{
+  BinaryLog b;
+
+  Site site = { LOG_APP, __FILE__, __LINE__, "app     ", "glFoo", 0 };
+  const float value = 0.5f;
+  const std::string big(1000,'x');
+  Binary::output( site, "(", 1, ", ", GLenum(2), ", ", value, ", ", true, ", ", static_cast<const void *>(NULL), ")" );
+  Binary::output( site, "(", -3, ", ", big, ")" );
+  Binary::text( LOG_WARNING, "warning ", NULL, "two\nlines" );
+  EXPECT_NE(0u, site.id);
+
+  std::string text, json;
+  ASSERT_TRUE(Binary::decode(b.contents().c_str(),b.contents().size(),text,json));
+
+  const std::string expected =
+    message("app     "," | ","glFoo",boost::print::print_string("(",1,", ",GLenum(2),", ",value,", ",true,", ",static_cast<const void *>(NULL),")"),0,0,0) +
+    message("app     "," | ","glFoo","(-3, " + big + ")",0,0,0) +
+    message("warning "," | ",NULL,"two\nlines",0,0,0);
+  EXPECT_EQ(expected, text);
+  EXPECT_EQ(0u, json.find("{ \"traceEvents\" : [\n"));
+  EXPECT_NE(std::string::npos, json.find("\"glFoo\""));
+}
+
+TEST( RegalLogBinary, Truncated )
+{
+  BinaryLog b;
+
+  Site site = { LOG_INTERNAL, __FILE__, __LINE__, "internal", "Foo", 0 };
+  Binary::output( site, "(", 42, ")" );
+
+  const std::string data = b.contents();
+  std::string text, json;
+  EXPECT_FALSE(Binary::decode(data.c_str(),data.size()-1,text,json));
+  EXPECT_FALSE(Binary::decode("REGALBAD",8,text,json));
+}
+
+}
@@ -0,0 +1,156 @@
+/*
+  Copyright (c) 2011-2012 NVIDIA Corporation
+  Copyright (c) 2011-2012 Cass Everitt
+  Copyright (c) 2012 Scott Nations
+  Copyright (c) 2012 Mathias Schott
+  Copyright (c) 2012 Nigel Stewart
+  Copyright (c) 2012 Google Inc
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+  OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+  OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "gtest/gtest.h"
+
+#include <GL/Regal.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "RegalUtil.h"
+#include "RegalLogSink.h"
+
+namespace {
+
+using namespace Regal::Logging;
+
+struct Collect
+{
+  Collect() : commits(0) {}
+
+  std::vector<std::string> records;
+  std::vector<unsigned int> kinds;
+  size_t commits;
+
+  static void consume(void *user, unsigned int kind, const char *data, size_t size)
+  {
+    Collect &c = *static_cast<Collect *>(user);
+    c.records.push_back(std::string(data,size));
+    c.kinds.push_back(kind);
+  }
+
+  static void commit(void *user)
+  {
+    static_cast<Collect *>(user)->commits++;
+  }
+};
+
+std::string record(int thread, int i)
+{
+  char buffer[64];
+  sprintf(buffer,"%d %d",thread,i);
+  // Vary the length, so that records wrap around the end of the ring
+  return std::string(buffer) + std::string(i%37,'.');
+}
+
+TEST( RegalLogSink, Synchronous )
+{
+  Collect c;
+  Sink sink(Collect::consume,Collect::commit,&c);
+  sink.push(1,"abc",3);
+  ASSERT_EQ(1u, c.records.size());
+  EXPECT_EQ("abc", c.records[0]);
+  EXPECT_EQ(1u, c.kinds[0]);
+  EXPECT_EQ(1u, c.commits);
+}
+
+#if REGAL_WORKER_THREADS
+
+const int threadRecords = 2000;
+
+struct Producer
+{
+  Sink *sink;
+  int   thread;
+
+  static void *main(void *producer)
+  {
+    Producer &p = *static_cast<Producer *>(producer);
+    for (int i = 0; i<threadRecords; ++i)
+    {
+      const std::string r = record(p.thread,i);
+      p.sink->push(p.thread,r.c_str(),r.length());
+    }
+    return NULL;
+  }
+};
+
+TEST( RegalLogSink, Threads )
+{
+  Collect c;
+  Sink sink(Collect::consume,Collect::commit,&c,4096);
+  ASSERT_TRUE(sink.start());
+
+  Producer producers[4];
+  pthread_t threads[4];
+  for (int t = 0; t<4; ++t)
+  {
+    producers[t].sink = &sink;
+    producers[t].thread = t;
+    ASSERT_EQ(0, pthread_create(&threads[t],NULL,Producer::main,&producers[t]));
+  }
+  for (int t = 0; t<4; ++t)
+    pthread_join(threads[t],NULL);
+
+  // A record larger than the ring goes straight to the consumer
+
+  const std::string big(10000,'x');
+  sink.push(7,big.c_str(),big.length());
+  sink.flush();
+
+  ASSERT_EQ(size_t(4*threadRecords+1), c.records.size());
+  EXPECT_EQ(big, c.records.back());
+
+  // Each thread's records arrive intact and in order
+
+  int next[4] = { 0, 0, 0, 0 };
+  for (size_t i = 0; i+1<c.records.size(); ++i)
+  {
+    const unsigned int t = c.kinds[i];
+    ASSERT_LT(t, 4u);
+    EXPECT_EQ(record(t,next[t]), c.records[i]);
+    next[t]++;
+  }
+  EXPECT_LT(c.commits, c.records.size());
+
+  // Stopping writes out whatever is still queued
+
+  sink.push(5,"last",4);
+  sink.stop();
+  EXPECT_FALSE(sink.running());
+  EXPECT_EQ("last", c.records.back());
+}
+
+#endif
+
+}
@@ -39,6 +39,11 @@ namespace {
 
 using Regal::IConversion;
 using Regal::GetConversionInterface;
+using Regal::PackRGBA8888ToRGB565;
+using Regal::PackRGBA8888ToRGBA4444;
+using Regal::PackRGBA8888ToRGBA5551;
+using Regal::DirectConversion;
+using Regal::GetDirectConversion;
 
 #include "RegalPixelConversions.inl"
 
@@ -346,6 +351,81 @@ TEST( RegalPixelConversions, PackUnpack1555 ) {
   EXPECT_EQ( 0xaau, packed[ 11 ] );
 }
 
+TEST( RegalPixelConversions, PackRGBA8888To16 ) {
+  // The direct 16 bit packers must match the generic conversions exactly,
+  // including the leftover pixels past the last full SIMD iteration.
+
+  const size_t count = 37;
+
+  uint32_t src[ count ];
+  for ( size_t i = 0; i < count; ++i ) {
+    src[ i ] = static_cast<uint32_t>( i * 0x9e3779b9u );
+  }
+  src[ 0 ] = 0xffffffffu;
+  src[ 1 ] = 0x00000000u;
+  src[ 2 ] = 0x80808080u;
+
+  uint16_t expected[ count ];
+  uint16_t actual[ count ];
+
+  GetConversionInterface( GL_RGB, GL_UNSIGNED_SHORT_5_6_5 )->Pack32( src, expected, count );
+  PackRGBA8888ToRGB565( src, actual, count );
+  for ( size_t i = 0; i < count; ++i ) {
+    EXPECT_EQ( expected[ i ], actual[ i ] );
+  }
+
+  GetConversionInterface( GL_RGBA, GL_UNSIGNED_SHORT_4_4_4_4 )->Pack32( src, expected, count );
+  PackRGBA8888ToRGBA4444( src, actual, count );
+  for ( size_t i = 0; i < count; ++i ) {
+    EXPECT_EQ( expected[ i ], actual[ i ] );
+  }
+
+  GetConversionInterface( GL_RGBA, GL_UNSIGNED_SHORT_5_5_5_1 )->Pack32( src, expected, count );
+  PackRGBA8888ToRGBA5551( src, actual, count );
+  for ( size_t i = 0; i < count; ++i ) {
+    EXPECT_EQ( expected[ i ], actual[ i ] );
+  }
+}
+
+TEST( RegalPixelConversions, DirectConversions ) {
+  // The scalar and SIMD kernels must agree, and match the generic path apart
+  // from luminance, which is replicated to green and blue.
+
+  const size_t count = 37;
+
+  uint32_t src[ count ];
+  for ( size_t i = 0; i < count; ++i ) {
+    src[ i ] = static_cast<uint32_t>( i * 0x9e3779b9u );
+  }
+
+  uint32_t expected[ count ];
+  uint32_t scalar[ count ];
+  uint32_t simd[ count ];
+
+  DirectConversion bgra = GetDirectConversion( GL_BGRA, GL_UNSIGNED_BYTE, GL_RGBA, GL_UNSIGNED_BYTE );
+  ASSERT_TRUE( bgra != NULL );
+  GetConversionInterface( GL_BGRA, GL_UNSIGNED_BYTE )->Unpack32( src, expected, count );
+  GetDirectConversion( GL_BGRA, GL_UNSIGNED_BYTE, GL_RGBA, GL_UNSIGNED_BYTE, false )( src, scalar, count );
+  bgra( src, simd, count );
+  for ( size_t i = 0; i < count; ++i ) {
+    EXPECT_EQ( expected[ i ], scalar[ i ] );
+    EXPECT_EQ( expected[ i ], simd[ i ] );
+  }
+
+  DirectConversion la = GetDirectConversion( GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE, GL_RGBA, GL_UNSIGNED_BYTE );
+  ASSERT_TRUE( la != NULL );
+  GetConversionInterface( GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE )->Unpack32( src, expected, count );
+  GetDirectConversion( GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE, GL_RGBA, GL_UNSIGNED_BYTE, false )( src, scalar, count );
+  la( src, simd, count );
+  for ( size_t i = 0; i < count; ++i ) {
+    const uint32_t l = expected[ i ] & 0xffu;
+    EXPECT_EQ( expected[ i ] | l << 8 | l << 16, scalar[ i ] );
+    EXPECT_EQ( scalar[ i ], simd[ i ] );
+  }
+
+  EXPECT_EQ( NULL, GetDirectConversion( GL_RGB, GL_UNSIGNED_BYTE, GL_RGBA, GL_UNSIGNED_BYTE ) );
+}
+
 TEST( RegalPixelConversions, UnsupportedConversions ) {
   // Some conversions are just not supported.
 
@@ -0,0 +1,117 @@
+/*
+  Copyright (c) 2011-2012 NVIDIA Corporation
+  Copyright (c) 2011-2012 Cass Everitt
+  Copyright (c) 2012 Scott Nations
+  Copyright (c) 2012 Mathias Schott
+  Copyright (c) 2012 Nigel Stewart
+  Copyright (c) 2012 Google Inc
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+  OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+  OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "gtest/gtest.h"
+
+#include <GL/Regal.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "RegalUtil.h"
+
+#if REGAL_EMULATION
+
+#include "RegalShaderBake.h"
+
+namespace {
+
+using namespace Regal::Shader;
+using Regal::Emu::Iff;
+
+Baked::Entry entry( const char *source, bool es, GLenum type, Iff::CompareFunc comp, const char *output )
+{
+  Baked::Entry e;
+  e.key     = bakeKey( source, strlen( source ) );
+  e.options = bakeOptions( es, type, comp );
+  e.output  = output;
+  return e;
+}
+
+std::string lookup( const Baked &baked, const char *source, bool es, GLenum type, Iff::CompareFunc comp )
+{
+  const char *output = NULL;
+  size_t      size   = 0;
+  if ( !baked.find( bakeKey( source, strlen( source ) ), bakeOptions( es, type, comp ), output, size ) )
+    return "<missing>";
+  EXPECT_EQ( '\0', output[ size ] );
+  return std::string( output, size );
+}
+
+TEST( RegalShaderBake, WriteFind )
+{
+  std::vector<Baked::Entry> entries;
+  entries.push_back( entry( "fs", true,  GL_FRAGMENT_SHADER, Iff::CF_Greater, "fs es greater" ) );
+  entries.push_back( entry( "fs", true,  GL_FRAGMENT_SHADER, Iff::CF_Less,    "fs es less" ) );
+  entries.push_back( entry( "fs", false, GL_FRAGMENT_SHADER, Iff::CF_Greater, "fs gl greater" ) );
+  entries.push_back( entry( "vs", true,  GL_VERTEX_SHADER,   Iff::CF_Greater, "vs" ) );
+  entries.push_back( entry( "vs", true,  GL_VERTEX_SHADER,   Iff::CF_Less,    "vs" ) );
+
+  std::vector<char> table;
+  Baked::write( entries, table );
+
+  Baked baked;
+  ASSERT_TRUE( baked.load( &table[ 0 ], table.size() ) );
+  EXPECT_EQ( 5u, baked.size() );
+
+  EXPECT_EQ( "fs es greater", lookup( baked, "fs", true,  GL_FRAGMENT_SHADER, Iff::CF_Greater ) );
+  EXPECT_EQ( "fs es less",    lookup( baked, "fs", true,  GL_FRAGMENT_SHADER, Iff::CF_Less ) );
+  EXPECT_EQ( "fs gl greater", lookup( baked, "fs", false, GL_FRAGMENT_SHADER, Iff::CF_Greater ) );
+  EXPECT_EQ( "vs",            lookup( baked, "vs", true,  GL_VERTEX_SHADER,   Iff::CF_Less ) );
+  EXPECT_EQ( "<missing>",     lookup( baked, "fs", false, GL_FRAGMENT_SHADER, Iff::CF_Less ) );
+  EXPECT_EQ( "<missing>",     lookup( baked, "vs", true,  GL_FRAGMENT_SHADER, Iff::CF_Less ) );
+  EXPECT_EQ( "<missing>",     lookup( baked, "xx", true,  GL_VERTEX_SHADER,   Iff::CF_Less ) );
+
+  // Identical output is stored once
+
+  std::vector<char> unique;
+  entries.pop_back();
+  Baked::write( entries, unique );
+  EXPECT_EQ( table.size(), unique.size() + 24 );
+}
+
+TEST( RegalShaderBake, RejectsInvalid )
+{
+  Baked baked;
+  EXPECT_FALSE( baked.load( "not a table", 11 ) );
+  EXPECT_EQ( 0u, baked.size() );
+
+  std::vector<Baked::Entry> entries( 1, entry( "fs", true, GL_FRAGMENT_SHADER, Iff::CF_Greater, "output" ) );
+  std::vector<char> table;
+  Baked::write( entries, table );
+  EXPECT_FALSE( baked.load( &table[ 0 ], 16 + 23 ) );
+  EXPECT_TRUE( baked.load( &table[ 0 ], table.size() ) );
+}
+
+} // namespace
+
+#endif // REGAL_EMULATION
@@ -0,0 +1,104 @@
+/*
+  Copyright (c) 2011-2012 NVIDIA Corporation
+  Copyright (c) 2011-2012 Cass Everitt
+  Copyright (c) 2012 Scott Nations
+  Copyright (c) 2012 Mathias Schott
+  Copyright (c) 2012 Nigel Stewart
+  Copyright (c) 2012 Google Inc
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+  OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+  OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "gtest/gtest.h"
+
+#include <GL/Regal.h>
+
+#include <cstring>
+
+#include "RegalUtil.h"
+
+#if REGAL_EMULATION
+
+#include "RegalShaderInstance.h"
+
+namespace {
+
+using namespace Regal::ShaderInstance;
+
+bool isDirty( const Program &p, size_t slot, int index )
+{
+  return ( p.dirty[slot][ index / 32 ] >> ( index % 32 ) ) & 1;
+}
+
+TEST( RegalShaderInstance, UniformIndex )
+{
+  Program p;
+  p.AddUniform( "a", 0, 1, GL_FLOAT_VEC4 );
+  p.AddUniform( "b", 3, 4, GL_FLOAT );
+  p.AddUniform( "c", 100000, 2, GL_INT );
+
+  EXPECT_EQ(  0, p.UniformIndex( 0 ) );
+  EXPECT_EQ( -1, p.UniformIndex( 1 ) );
+  EXPECT_EQ(  1, p.UniformIndex( 3 ) );
+  EXPECT_EQ(  1, p.UniformIndex( 6 ) );
+  EXPECT_EQ( -1, p.UniformIndex( 7 ) );
+  EXPECT_EQ( -1, p.UniformIndex( -1 ) );
+  EXPECT_EQ(  2, p.UniformIndex( 100001 ) );
+  EXPECT_EQ( -1, p.UniformIndex( 100002 ) );
+}
+
+TEST( RegalShaderInstance, DirtyPerInstance )
+{
+  Program p;
+  for( int i = 0; i < 40; i++ ) {
+    p.AddUniform( "u", i, 1, GL_FLOAT );
+  }
+  size_t a = p.AddInstance();
+  size_t b = p.AddInstance();
+  ASSERT_EQ( 2u, p.dirty[a].size() );
+
+  GLfloat v = 1.0f;
+  GLuint64 ver = p.ver;
+  p.UpdateUniformStore( 35, 1, &v );
+  EXPECT_NE( ver, p.ver );
+  EXPECT_TRUE( isDirty( p, a, 35 ) );
+  EXPECT_TRUE( isDirty( p, b, 35 ) );
+  EXPECT_FALSE( isDirty( p, a, 34 ) );
+  EXPECT_EQ( 0, memcmp( &p.uniformStore[35], &v, sizeof( v ) ) );
+
+  // updates of unknown locations or past the end are dropped
+  ver = p.ver;
+  p.UpdateUniformStore( 40, 1, &v );
+  p.UpdateUniformStore( 39, 2, &v );
+  EXPECT_EQ( ver, p.ver );
+
+  // uniforms added later grow the existing bitsets
+  p.AddUniform( "w", 64, 1, GL_FLOAT );
+  EXPECT_EQ( 2u, p.dirty[b].size() );
+  p.UpdateUniformStore( 64, 1, &v );
+  EXPECT_TRUE( isDirty( p, b, 40 ) );
+}
+
+}
+
+#endif // REGAL_EMULATION
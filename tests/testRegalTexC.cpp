@@ -734,12 +734,12 @@ TEST ( RegalTexC, ShadowGenTextures )
   // default state.
   TextureState* texture = &texc.mapTextureToTextureState[ 11 ];
   EXPECT_EQ( 0u, texture->boundTextureUnits.size() );
-  EXPECT_EQ( 0u, texture->textureLevelState.size() );
+  EXPECT_EQ( 0u, texture->levelSpecified );
 
   // Pollute the state, so that the next part of this test correctly verifies
   // things get reset.
   texture->SetFormatAndType( 0, 0, 0 );
-  EXPECT_EQ( 1u, texture->textureLevelState.size() );
+  EXPECT_EQ( 1u, texture->levelSpecified );
 
   // Try to create texture zero, and recreate texture 11.
   GLuint textures2[ 2 ] = { 0, 11 };
@@ -750,7 +750,7 @@ TEST ( RegalTexC, ShadowGenTextures )
   // Texture 11 should have been reset to a default sate.
   texture = &texc.mapTextureToTextureState[ 11 ];
   EXPECT_EQ( 0u, texture->boundTextureUnits.size() );
-  EXPECT_EQ( 0u, texture->textureLevelState.size() );
+  EXPECT_EQ( 0u, texture->levelSpecified );
 
   // We should not have created texture zero, as it is special.
   EXPECT_TRUE( texc.mapTextureToTextureState.find( 0 ) == texc.mapTextureToTextureState.end() );
@@ -794,6 +794,36 @@ TEST ( RegalTexC, ShadowDeleteTextures )
   EXPECT_TRUE( texc.mapTextureToTextureState.find( 13 ) == texc.mapTextureToTextureState.end() );
 }
 
+TEST ( RegalTexC, ShadowGenDeleteManyTextures )
+{
+  // Interleave creating and deleting enough textures to grow the hash map
+  // several times, and verify every texture is still found afterwards.
+
+  TexC texc;
+
+  for ( GLuint i = 1; i <= 1000; ++i ) {
+    texc.ShadowGenTextures( 1, &i );
+    texc.mapTextureToTextureState[ i ].SetFormatAndType( 0, i, i );
+    if ( i % 3 == 0 ) {
+      GLuint t = i / 3;
+      texc.ShadowDeleteTextures( 1, &t );
+    }
+  }
+
+  EXPECT_EQ( 1000u - 333u, texc.mapTextureToTextureState.size() );
+  for ( GLuint i = 1; i <= 1000; ++i ) {
+    TexC::MapTextureToTextureState::iterator f = texc.mapTextureToTextureState.find( i );
+    if ( i <= 333 ) {
+      EXPECT_TRUE( f == texc.mapTextureToTextureState.end() );
+    } else {
+      ASSERT_TRUE( f != texc.mapTextureToTextureState.end() );
+      GLenum format, type;
+      f->second.GetFormatAndType( 0, &format, &type );
+      EXPECT_EQ( i, format );
+    }
+  }
+}
+
 TEST ( RegalTexC, ShadowActiveTexture )
 {
   // Test TexC::ShadowActiveTexture
@@ -864,16 +894,69 @@ TEST ( RegalTexC, ShadowGenerateMipmap )
   TextureState boundToUnit1;
   boundToUnit1.SetFormatAndType( 0, 11, 13 );
   boundToUnit1.SetFormatAndType( 1, 17, 19 );
-  EXPECT_TRUE( boundToUnit1.textureLevelState.find( TextureState::DEFAULT_FORMAT_LEVEL ) == boundToUnit1.textureLevelState.end() );
+  EXPECT_EQ( 3u, boundToUnit1.levelSpecified );
   texc.textureUnitArrayState[ 1 ].Bind( GL_TEXTURE_2D, &boundToUnit1 );
 
   // Invoke the function under test to emulate mipmap generation.
   texc.currentTextureUnit = 1;
   texc.ShadowGenerateMipmap( GL_TEXTURE_2D );
 
-  // We expect the texture state to indicate a single default format.
-  EXPECT_EQ( 1u, boundToUnit1.textureLevelState.size() );
-  EXPECT_TRUE( boundToUnit1.textureLevelState.find( TextureState::DEFAULT_FORMAT_LEVEL ) != boundToUnit1.textureLevelState.end() );
+  // We expect the texture state to indicate a single default format, that of
+  // the base level.
+  EXPECT_EQ( 0u, boundToUnit1.levelSpecified );
+  EXPECT_EQ( 11u, boundToUnit1.defaultLevelState.format );
+  EXPECT_EQ( 13u, boundToUnit1.defaultLevelState.type );
+}
+
+TEST ( RegalTexC, SourceSize )
+{
+  // The size of the client pixels read by ConvertFrom, which is what an
+  // asynchronous upload copies.
+
+  PixelStorageStateGLES20 pss;
+  pss.alignment = 4;
+
+  ConvertedBuffer buffer( pss, GL_RGBA, GL_UNSIGNED_BYTE );
+
+  // No conversion, nothing to copy.
+  EXPECT_EQ( 0u, buffer.SourceSize( 4, 4, GL_RGBA, GL_UNSIGNED_BYTE ) );
+  EXPECT_EQ( 0u, buffer.SourceSize( 0, 4, GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE ) );
+
+  // Rows are padded to the alignment, except the last.
+  EXPECT_EQ( 8u + 6u, buffer.SourceSize( 3, 2, GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE ) );
+  EXPECT_EQ( 6u, buffer.SourceSize( 3, 1, GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE ) );
+}
+
+struct CountTask : public Regal::Thread::Task
+{
+  CountTask() : count( 0 ) {}
+  void run() { ++count; }
+  int count;
+};
+
+TEST ( RegalTexC, WorkersRunEachTaskOnce )
+{
+  Regal::Thread::Workers workers;
+  workers.start( 2 );
+
+  std::vector<CountTask> tasks( 64 );
+  for ( size_t i = 0; i < tasks.size(); ++i )
+    workers.submit( &tasks[ i ] );
+  for ( size_t i = 0; i < tasks.size(); ++i )
+    workers.wait( &tasks[ i ] );
+
+  for ( size_t i = 0; i < tasks.size(); ++i )
+  {
+    EXPECT_TRUE( tasks[ i ].done );
+    EXPECT_EQ( 1, tasks[ i ].count );
+  }
+
+  // Without threads, tasks run when submitted.
+  workers.start( 0 );
+  CountTask task;
+  workers.submit( &task );
+  EXPECT_TRUE( task.done );
+  EXPECT_EQ( 1, task.count );
 }
 
 }  // namespace
@@ -0,0 +1,288 @@
+/*
+  Copyright (c) 2011-2012 NVIDIA Corporation
+  Copyright (c) 2011-2012 Cass Everitt
+  Copyright (c) 2012 Scott Nations
+  Copyright (c) 2012 Mathias Schott
+  Copyright (c) 2012 Nigel Stewart
+  Copyright (c) 2012 Google Inc
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+  OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+  OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "gtest/gtest.h"
+
+#if REGALTEST_APITRACE
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "trace_file.hpp"
+#include "trace_file_ring.hpp"
+#include "trace_parser.hpp"
+#include "trace_writer.hpp"
+
+namespace {
+
+using namespace trace;
+
+// Several chunks worth of mildly compressible data
+
+std::vector<char> payload()
+{
+  std::vector<char> data(3*1024*1024 + 12345);
+  unsigned int x = 1;
+  for (size_t i = 0; i < data.size(); ++i)
+  {
+    x = x*1103515245 + 12345;
+    data[i] = char((x>>16) & 0x0f);
+  }
+  return data;
+}
+
+std::string temporary()
+{
+  char name[] = "/tmp/regaltraceXXXXXX";
+  int fd = mkstemp(name);
+  if (fd<0)
+    return std::string();
+  close(fd);
+  return name;
+}
+
+void roundTrip(File *file)
+{
+  const std::string filename = temporary();
+  ASSERT_FALSE(filename.empty());
+
+  const std::vector<char> data = payload();
+  ASSERT_TRUE(file->open(filename, File::Write));
+
+  // Mix small writes with writes larger than a chunk
+
+  size_t i = 0;
+  for (size_t size = 1; i < data.size(); size = size*3 + 1)
+  {
+    size = std::min(size, data.size() - i);
+    ASSERT_TRUE(file->write(&data[i], size));
+    i += size;
+  }
+  file->close();
+  delete file;
+
+  File *in = File::createForRead(filename.c_str());
+  ASSERT_TRUE(in != NULL);
+  std::vector<char> back(data.size());
+  EXPECT_EQ(data.size(), in->read(&back[0], back.size()));
+  char extra;
+  EXPECT_EQ(0u, in->read(&extra, 1));
+  in->close();
+  delete in;
+
+  EXPECT_TRUE(data == back);
+  remove(filename.c_str());
+}
+
+TEST( RegalTraceFile, Snappy )
+{
+  roundTrip(File::createSnappy());
+}
+
+TEST( RegalTraceFile, SnappyAsync )
+{
+  roundTrip(File::createSnappyAsync());
+}
+
+TEST( RegalTraceFile, SnappyAsyncFlush )
+{
+  const std::string filename = temporary();
+  ASSERT_FALSE(filename.empty());
+
+  // After flush the data must be complete on disk, as it is when
+  // flushing after a crash
+
+  const std::vector<char> data = payload();
+  File *file = File::createSnappyAsync();
+  ASSERT_TRUE(file->open(filename, File::Write));
+  ASSERT_TRUE(file->write(&data[0], data.size()));
+  file->flush();
+
+  File *in = File::createForRead(filename.c_str());
+  ASSERT_TRUE(in != NULL);
+  std::vector<char> back(data.size());
+  EXPECT_EQ(data.size(), in->read(&back[0], back.size()));
+  in->close();
+  delete in;
+  EXPECT_TRUE(data == back);
+
+  file->close();
+  delete file;
+  remove(filename.c_str());
+}
+
+TEST( RegalTraceFile, SnappyMapped )
+{
+  const std::string filename = temporary();
+  ASSERT_FALSE(filename.empty());
+
+  const std::vector<char> data = payload();
+  File *file = File::createSnappy();
+  ASSERT_TRUE(file->open(filename, File::Write));
+  ASSERT_TRUE(file->write(&data[0], data.size()));
+  file->close();
+  delete file;
+
+  // Offsets of the mapped reader must match those of the stream reader,
+  // so that bookmarks can be shared between them
+
+  File *stream = File::createForRead(filename.c_str());
+  File *mapped = File::createForRead(filename.c_str(), true);
+  ASSERT_TRUE(stream != NULL);
+  ASSERT_TRUE(mapped != NULL);
+  ASSERT_TRUE(mapped->supportsOffsets());
+
+  std::vector<char> back(data.size());
+  std::vector<File::Offset> offsets;
+  std::vector<size_t> positions;
+  size_t i = 0;
+  for (size_t size = 7; i < data.size(); size = size*5 + 3)
+  {
+    File::Offset a = stream->currentOffset();
+    File::Offset b = mapped->currentOffset();
+    EXPECT_EQ(a.chunk, b.chunk);
+    EXPECT_EQ(a.offsetInChunk, b.offsetInChunk);
+    offsets.push_back(b);
+    positions.push_back(i);
+
+    size = std::min(size, data.size() - i);
+    EXPECT_TRUE(stream->skip(size));
+    EXPECT_EQ(size, mapped->read(&back[i], size));
+    i += size;
+  }
+  EXPECT_TRUE(data == back);
+  EXPECT_EQ(-1, mapped->getc());
+
+  // Seek backwards and forwards
+
+  for (size_t j = offsets.size(); j-- > 0; )
+  {
+    mapped->setCurrentOffset(offsets[j]);
+    EXPECT_EQ(data[positions[j]], char(mapped->getc()));
+  }
+  mapped->setCurrentOffset(offsets.back());
+  EXPECT_TRUE(mapped->skip(data.size() - positions.back()));
+  EXPECT_EQ(0u, mapped->read(&back[0], 1));
+
+  stream->close();
+  mapped->close();
+  delete stream;
+  delete mapped;
+  remove(filename.c_str());
+}
+
+// Writer keeping frames in a RingFile, rotated the way RegalWriter does
+
+class RingWriter : public Writer
+{
+public:
+  RingFile *ring;
+
+  RingWriter(size_t frames)
+  {
+    delete m_file;
+    m_file = ring = new RingFile(frames, 1024);
+  }
+
+  void call(const FunctionSig *sig)
+  {
+    unsigned no = beginEnter(sig, 0);
+    endEnter();
+    beginLeave(no);
+    endLeave();
+  }
+
+  void frame()
+  {
+    ring->nextSegment(call_no);
+    functions.clear();
+  }
+};
+
+TEST( RegalTraceFile, Ring )
+{
+  static const FunctionSig draw = {0, "glDrawArrays", 0, NULL};
+  static const FunctionSig swap = {1, "glXSwapBuffers", 0, NULL};
+
+  EXPECT_TRUE(Parser::lookupCallFlags(swap.name) & CALL_FLAG_END_FRAME);
+  EXPECT_FALSE(Parser::lookupCallFlags(draw.name) & CALL_FLAG_END_FRAME);
+
+  // Setup and three frames, only the last two are kept
+
+  RingWriter writer(2);
+  ASSERT_TRUE(writer.open("ring"));
+  for (int i = 0; i < 4; ++i)
+  {
+    writer.call(&draw);
+    writer.call(&swap);
+    if (i < 3)
+      writer.frame();
+  }
+  ASSERT_EQ(3u, writer.ring->numSegments());
+
+  // Each segment parses on its own, numbered from its first call
+
+  const unsigned first[] = { 0, 4, 6 };
+  for (size_t i = 0; i < 3; ++i)
+  {
+    EXPECT_EQ(first[i], writer.ring->segmentFirstCall(i));
+    Parser parser;
+    ASSERT_TRUE(parser.open(RingFile::createSegmentReader(writer.ring->segment(i)),
+                            writer.ring->segmentFirstCall(i)));
+    for (unsigned j = 0; j < 2; ++j)
+    {
+      Call *call = parser.parse_call();
+      ASSERT_TRUE(call != NULL);
+      EXPECT_EQ(first[i] + j, call->no);
+      EXPECT_STREQ(j ? swap.name : draw.name, call->name());
+      delete call;
+    }
+    EXPECT_TRUE(parser.parse_call() == NULL);
+  }
+
+  // Setup past the limit is dropped rather than split
+
+  RingFile setup(1, 16);
+  ASSERT_TRUE(setup.open("setup", File::Write));
+  EXPECT_TRUE(setup.write("0123456789", 10));
+  EXPECT_FALSE(setup.write("0123456789", 10));
+  EXPECT_FALSE(setup.write("0", 1));
+  EXPECT_TRUE(setup.prologueTruncated());
+  EXPECT_EQ(10u, setup.segment(0).size());
+}
+
+}  // namespace
+
+#endif // REGALTEST_APITRACE